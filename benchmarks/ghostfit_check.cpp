@@ -0,0 +1,329 @@
+/*
+	Check and benchmark of the ghost direction search of ZVKIN with the ghost fitted to the jet
+	tracks (ZVKIN FitGhostToTracks, GhostFinderStage1::fitToJetTracks).
+
+	- Every fit of GhostFitEngine is compared with the two prong fit of VertexFitterLSM of a ghost
+	  TrackState and the track, for ghosts at random angles and widths around the jet axis.
+	- The gradient GhostFinderStage1 gives the minimiser is compared component by component with
+	  central differences of its chi squared, around the ghost found for each jet. Points where a
+	  track crosses L=0 within the difference step, where the chi squared jumps, are skipped.
+	- ZVKIN is run on the jets with the ghost fitted to the tracks, on one thread and on several,
+	  which must give the same vertices, and without, for the time taken.
+
+	Jets are made from a fixed seed with 8-13 tracks from the IP, 2-4 from a B vertex and 2-3 from
+	a D vertex. Returns non zero if a check fails.
+
+	Build with -DBUILD_BENCHMARKS=ON, run as
+		ghostfit_check [jets] [threads]
+*/
+
+#include <algo/inc/zvkin.h>
+#include <zvtop/include/ghostfinderstage1.h>
+#include <zvtop/include/ghostfitengine.h>
+#include <zvtop/include/interactionpoint.h>
+#include <zvtop/include/vertexfitterlsm.h>
+#include <inc/event.h>
+#include <inc/jet.h>
+#include <inc/track.h>
+#include <inc/trackstate.h>
+#include <inc/vertex.h>
+#include <inc/decaychain.h>
+#include <util/inc/memorymanager.h>
+#include <util/inc/helixrep.h>
+#include <util/inc/matrix.h>
+#include <util/inc/vector3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace vertex_lcfi;
+using namespace vertex_lcfi::ZVTOP;
+using namespace vertex_lcfi::util;
+
+namespace
+{
+	std::mt19937 Random;
+
+	double gaussian() {return std::normal_distribution<double>(0,1)(Random);}
+	double uniform() {return std::uniform_real_distribution<double>(0,1)(Random);}
+
+	//Track through Vertex with xy direction Psi, curvature InvR and tan lambda TanLambda, with its
+	//d0 and z0 smeared by errors D0Error and Z0Error
+	Track* makeTrack(Event* MyEvent, const Vector3 & Vertex, double Psi, double InvR, double TanLambda, double D0Error, double Z0Error)
+	{
+		double CentreX = Vertex.x()+sin(Psi)/InvR;
+		double CentreY = Vertex.y()-cos(Psi)/InvR;
+		double Rho = (InvR > 0 ? 1 : -1)*sqrt(CentreX*CentreX+CentreY*CentreY);
+		double Phi = atan2(CentreX/Rho,-CentreY/Rho);
+		double Swum = std::remainder(Phi-Psi,2*M_PI)/InvR;
+		HelixRep Helix;
+		Helix.d0() = 1/InvR-Rho+D0Error*gaussian();
+		Helix.z0() = Vertex.z()-Swum*TanLambda+Z0Error*gaussian();
+		Helix.phi() = Phi;
+		Helix.invR() = InvR;
+		Helix.tanLambda() = TanLambda;
+		SymMatrix5x5 Covariance;
+		Covariance.clear();
+		Covariance(0,0) = D0Error*D0Error;
+		Covariance(1,1) = 1.0e-8;
+		Covariance(2,2) = 1.0e-12;
+		Covariance(3,3) = Z0Error*Z0Error;
+		Covariance(4,4) = 1.0e-8;
+		return MemoryManager<Track>::Event()->create(MyEvent,Helix,Vector3(cos(Psi),sin(Psi),TanLambda),InvR > 0 ? 1.0 : -1.0,Covariance,std::vector<int>(),(void*)0);
+	}
+
+	Jet* makeJet(Event* MyEvent)
+	{
+		double Phi = uniform()*2*M_PI;
+		double TanLambda = (uniform()-0.5)*1.5;
+		Jet* MyJet = new Jet(MyEvent,std::vector<Track*>(),40,Vector3(cos(Phi),sin(Phi),TanLambda),(void*)0);
+		MemoryManager<Jet>::Event()->registerObject(MyJet);
+		Vector3 B(3*cos(Phi)*(0.5+uniform()),3*sin(Phi)*(0.5+uniform()),3*TanLambda*(0.5+uniform()));
+		Vector3 D = B.add(Vector3(4*cos(Phi+0.05)*uniform(),4*sin(Phi+0.05)*uniform(),4*TanLambda*uniform()));
+		Vector3 Vertices[3] = {Vector3(0,0,0.01*gaussian()),B,D};
+		int NumTracks[3] = {8+int(uniform()*6),2+int(uniform()*3),2+int(uniform()*2)};
+		for (int v = 0;v < 3;++v)
+		{
+			for (int i = 0;i < NumTracks[v];++i)
+			{
+				double Momentum = 1+20*uniform();
+				double InvR = (uniform() < 0.5 ? 1 : -1)*3.0e-4*4/Momentum;
+				MyJet->addTrack(makeTrack(MyEvent,Vertices[v],Phi+0.2*gaussian(),InvR,TanLambda+0.2*gaussian(),0.005+0.01/Momentum,0.008+0.01/Momentum));
+			}
+		}
+		return MyJet;
+	}
+
+	Vector3 jetAxis(const Jet* MyJet)
+	{
+		Vector3 Axis(0,0,0);
+		for (std::vector<Track*>::const_iterator iTrack = MyJet->tracks().begin();iTrack != MyJet->tracks().end();++iTrack)
+			Axis = Axis.add((*iTrack)->momentum());
+		return Axis.unit();
+	}
+
+	//The ghost as GhostFinderStage1 makes it, a line through the origin
+	Track makeGhost(const std::vector<double> & Angles, double Width)
+	{
+		HelixRep Helix;
+		Helix.d0() = 0.0;
+		Helix.z0() = 0.0;
+		Helix.invR() = 0.0;
+		Helix.phi() = Angles[0];
+		Helix.tanLambda() = tan((M_PI/2.0)-Angles[1]);
+		SymMatrix5x5 Covariance;
+		Covariance.clear();
+		Covariance(0,0) = Width*Width;
+		Covariance(3,3) = (Width/cos(atan(Helix.tanLambda())))*(Width/cos(atan(Helix.tanLambda())));
+		Vector3 Momentum(cos(Angles[0])*sin(Angles[1]),sin(Angles[0])*sin(Angles[1]),cos(Angles[1]));
+		return Track(0,Helix,Momentum,0.0,Covariance,std::vector<int>());
+	}
+
+	//Every vertex of a decay chain, for comparing the output of two runs
+	void addVertices(const DecayChain* Chain, std::vector<double> & Values)
+	{
+		Values.push_back(Chain->vertices().size());
+		for (std::vector<Vertex*>::const_iterator iVertex = Chain->vertices().begin();iVertex != Chain->vertices().end();++iVertex)
+		{
+			Values.push_back((*iVertex)->tracks().size());
+			Values.push_back((*iVertex)->position().x());
+			Values.push_back((*iVertex)->position().y());
+			Values.push_back((*iVertex)->position().z());
+		}
+	}
+
+	double secondsSince(std::chrono::steady_clock::time_point Start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now()-Start).count();
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const int NumJets = (argc > 1) ? atoi(argv[1]) : 50;
+	const int NumThreads = (argc > 2) ? atoi(argv[2]) : 4;
+	bool Passed = true;
+
+	SymMatrix3x3 IPError;
+	IPError.clear();
+	IPError(0,0) = 25.0e-6;
+	IPError(1,1) = 25.0e-6;
+	IPError(2,2) = 400.0e-6;
+
+	//The engine against VertexFitterLSM
+	{
+		Random.seed(5);
+		long NumFits = 0;
+		long NumDiffering = 0;
+		VertexFitterLSM Fitter;
+		for (int j = 0;j < NumJets;++j)
+		{
+			Event* MyEvent = new Event(Vector3(0,0,0),IPError);
+			MemoryManager<Event>::Event()->registerObject(MyEvent);
+			Jet* MyJet = makeJet(MyEvent);
+			Vector3 Axis = jetAxis(MyJet);
+			std::vector<TrackState*> States;
+			for (std::vector<Track*>::const_iterator iTrack = MyJet->tracks().begin();iTrack != MyJet->tracks().end();++iTrack)
+				States.push_back((*iTrack)->makeState());
+			GhostFitEngine Engine;
+			Engine.setTracks(States);
+			for (int k = 0;k < 10;++k)
+			{
+				double Width = 0.0025*(1+20*uniform());
+				std::vector<double> Angles;
+				Angles.push_back(atan2(Axis.y(),Axis.x())+0.05*gaussian());
+				Angles.push_back(acos(Axis.z())+0.05*gaussian());
+				Track Ghost = makeGhost(Angles, Width);
+				TrackState GhostState(&Ghost);
+				std::vector<GhostFitEngine::Fit> Fits;
+				Engine.fitAll(Angles, Width, Fits);
+				for (size_t i = 0;i < States.size();++i)
+				{
+					std::vector<TrackState*> Pair;
+					GhostState.resetToRef();
+					Pair.push_back(&GhostState);
+					Pair.push_back(States[i]);
+					Vector3 Position;
+					double ChiSquared;
+					Fitter.fitVertex(Pair,0,Position,ChiSquared);
+					if (fabs(ChiSquared-Fits[i].ChiSquared) > 1.0e-3*std::max(1.0,ChiSquared))
+						++NumDiffering;
+					++NumFits;
+				}
+			}
+			MetaMemoryManager::Event()->delAllObjects();
+		}
+		//The old stepper can end tens of cm along the helix on a few tracks that curl up, where the
+		//engine keeps the closest approach nearest the reference point
+		const bool EngineAgrees = (NumDiffering*200 < NumFits);
+		printf("GhostFitEngine against VertexFitterLSM: %ld of %ld fits differ by more than 1e-3 in chi squared %s\n",
+			NumDiffering, NumFits, EngineAgrees ? "(ok)" : "(FAILED)");
+		Passed = Passed && EngineAgrees;
+	}
+
+	//The analytic gradient of the ghost chi squared against central differences
+	{
+		Random.seed(7);
+		long NumGradients = 0;
+		long NumComponents = 0;
+		long NumDiffering = 0;
+		long NumAcrossKinks = 0;
+		double LargestRelativeError = 0.0;
+		const double Step = 1.0e-6;
+		for (int j = 0;j < NumJets;++j)
+		{
+			Event* MyEvent = new Event(Vector3(0,0,0),IPError);
+			MemoryManager<Event>::Event()->registerObject(MyEvent);
+			Jet* MyJet = makeJet(MyEvent);
+			InteractionPoint IP(Vector3(0,0,0),IPError);
+			GhostFinderStage1 Finder;
+			Finder.fitToJetTracks() = true;
+			//Leaves the finder at its second stage chi squared and final width
+			Track* Ghost = Finder.findGhost(0.025,1.0,jetAxis(MyJet),MyJet->tracks(),&IP);
+			const double Phi = Ghost->helixRep().phi();
+			const double Theta = (M_PI/2.0)-atan(Ghost->helixRep().tanLambda());
+			const double Width = sqrt(Ghost->covarianceMatrix()(0,0));
+			//The same fits as the finder, to see where a track crosses L=0
+			std::vector<TrackState*> States;
+			for (std::vector<Track*>::const_iterator iTrack = MyJet->tracks().begin();iTrack != MyJet->tracks().end();++iTrack)
+				States.push_back((*iTrack)->makeState());
+			GhostFitEngine Engine;
+			Engine.setTracks(States);
+			for (int k = 0;k < 10;++k)
+			{
+				std::vector<double> Angles;
+				Angles.push_back(Phi+0.02*gaussian());
+				Angles.push_back(Theta+0.02*gaussian());
+				++NumGradients;
+				//In the second stage tracks with L<0 are dropped, so the chi squared jumps where one
+				//crosses L=0 and differences across that say nothing of the gradient
+				bool AcrossKink = false;
+				std::vector<GhostFitEngine::Fit> Fits[2];
+				for (int a = 0;a < 2 && !AcrossKink;++a)
+				{
+					std::vector<double> Offset = Angles;
+					Offset[a] = Angles[a]+Step;
+					Engine.fitAll(Offset, Width, Fits[0]);
+					Offset[a] = Angles[a]-Step;
+					Engine.fitAll(Offset, Width, Fits[1]);
+					for (size_t i = 0;i < Fits[0].size();++i)
+						if ((Fits[0][i].L >= 0.0) != (Fits[1][i].L >= 0.0))
+							AcrossKink = true;
+				}
+				if (AcrossKink)
+				{
+					++NumAcrossKinks;
+					continue;
+				}
+				std::vector<double> Gradient;
+				Finder.gradientAt(Angles, Gradient);
+				for (int a = 0;a < 2;++a)
+				{
+					std::vector<double> Offset = Angles;
+					Offset[a] = Angles[a]+Step;
+					const double Up = Finder.valueAt(Offset);
+					Offset[a] = Angles[a]-Step;
+					const double Down = Finder.valueAt(Offset);
+					const double Difference = (Up-Down)/(2.0*Step);
+					//Relative to the component, with a floor of the rounding of the differences
+					const double Scale = std::max(fabs(Difference), 1.0e-9*std::max(1.0,fabs(Up))/Step);
+					const double RelativeError = fabs(Gradient[a]-Difference)/Scale;
+					LargestRelativeError = std::max(LargestRelativeError, RelativeError);
+					if (RelativeError > 1.0e-3)
+						++NumDiffering;
+					++NumComponents;
+				}
+			}
+			MetaMemoryManager::Event()->delAllObjects();
+		}
+		const bool GradientAgrees = (NumDiffering == 0 && NumComponents > NumGradients);
+		printf("GhostFinderStage1 gradient against central differences: %ld of %ld components differ by more than 1e-3 relative, largest %.2g, %ld points across L=0 skipped %s\n",
+			NumDiffering, NumComponents, LargestRelativeError, NumAcrossKinks, GradientAgrees ? "(ok)" : "(FAILED)");
+		Passed = Passed && GradientAgrees;
+	}
+
+	//ZVKIN with the ghost fitted to the tracks, on one thread and several, and without
+	{
+		std::vector<double> Output[3];
+		double Seconds[3] = {0,0,0};
+		const char* Runs[3] = {"fitted to tracks, 1 thread","fitted to tracks, several threads","jet core weighting only"};
+		for (int r = 0;r < 3;++r)
+		{
+			Random.seed(3);
+			ZVKIN MyZVKIN;
+			MyZVKIN.setDoubleParameter("MinimumProbability",0.01);
+			MyZVKIN.setDoubleParameter("InitialGhostWidth",0.025);
+			MyZVKIN.setDoubleParameter("MaxChi2Allowed",1.0);
+			MyZVKIN.setStringParameter("AutoJetAxis","TRUE");
+			MyZVKIN.setStringParameter("UseEventIP","TRUE");
+			MyZVKIN.setDoubleParameter("NumberOfThreads",(r == 1) ? NumThreads : 1);
+			MyZVKIN.setStringParameter("FitGhostToTracks",(r < 2) ? "TRUE" : "FALSE");
+			for (int j = 0;j < NumJets;++j)
+			{
+				Event* MyEvent = new Event(Vector3(0,0,0),IPError);
+				MemoryManager<Event>::Event()->registerObject(MyEvent);
+				Jet* MyJet = makeJet(MyEvent);
+				std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+				DecayChain* Chain = MyZVKIN.calculateFor(MyJet);
+				Seconds[r] += secondsSince(Start);
+				addVertices(Chain, Output[r]);
+				MetaMemoryManager::Event()->delAllObjects();
+			}
+			long NumVertices = 0;
+			for (size_t i = 0;i < Output[r].size();i += 1+4*size_t(Output[r][i]))
+				NumVertices += long(Output[r][i]);
+			//After a new line, as VertexFinderGhost writes the chi squared and probability of each candidate to cout
+			printf("\nZVKIN, ghost %s: %ld vertices in %d jets, %.3f s\n", Runs[r], NumVertices, NumJets, Seconds[r]);
+		}
+		const bool ThreadsAgree = (Output[0] == Output[1]);
+		printf("ZVKIN output on %d threads %s that on 1\n", NumThreads, ThreadsAgree ? "is the same as (ok)" : "DIFFERS from (FAILED)");
+		Passed = Passed && ThreadsAgree;
+	}
+
+	return Passed ? 0 : 1;
+}
@@ -0,0 +1,183 @@
+/*
+	Check of the incremental (information form) fit of CandidateVertex (incrementalFit) against
+	refit with VertexFitterLSM, for vertices that hold the IP and those that don't.
+
+	Each vertex is 4-7 tracks from a point 0.5-10 mm out, smeared by their d0 and z0 errors, made
+	from a fixed seed. After a first fit one track is removed, which makes the information form.
+	- With the IP held from the start, or set after the information form was made, the vertex
+	  must be fitted by its fitter, so the position and chi squareds must equal those of LSM.
+	- After the IP is removed the position is solved from the information form, which must give
+	  no IP chi squared. Its distance from the LSM position is printed.
+	Returns non zero if a check fails.
+
+	Build with -DBUILD_BENCHMARKS=ON, run as
+		incrementalfit_check [vertices]
+*/
+
+#include <zvtop/include/candidatevertex.h>
+#include <zvtop/include/interactionpoint.h>
+#include <zvtop/include/vertexfitterlsm.h>
+#include <inc/event.h>
+#include <inc/track.h>
+#include <inc/trackstate.h>
+#include <util/inc/memorymanager.h>
+#include <util/inc/helixrep.h>
+#include <util/inc/matrix.h>
+#include <util/inc/vector3.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace vertex_lcfi;
+using namespace vertex_lcfi::ZVTOP;
+using namespace vertex_lcfi::util;
+
+namespace
+{
+	std::mt19937 Random;
+
+	double gaussian() {return std::normal_distribution<double>(0,1)(Random);}
+	double uniform() {return std::uniform_real_distribution<double>(0,1)(Random);}
+
+	//Track through Vertex with xy direction Psi, curvature InvR and tan lambda TanLambda, with its
+	//d0 and z0 smeared by errors D0Error and Z0Error
+	Track* makeTrack(Event* MyEvent, const Vector3 & Vertex, double Psi, double InvR, double TanLambda, double D0Error, double Z0Error)
+	{
+		double CentreX = Vertex.x()+sin(Psi)/InvR;
+		double CentreY = Vertex.y()-cos(Psi)/InvR;
+		double Rho = (InvR > 0 ? 1 : -1)*sqrt(CentreX*CentreX+CentreY*CentreY);
+		double Phi = atan2(CentreX/Rho,-CentreY/Rho);
+		double Swum = std::remainder(Phi-Psi,2*M_PI)/InvR;
+		HelixRep Helix;
+		Helix.d0() = 1/InvR-Rho+D0Error*gaussian();
+		Helix.z0() = Vertex.z()-Swum*TanLambda+Z0Error*gaussian();
+		Helix.phi() = Phi;
+		Helix.invR() = InvR;
+		Helix.tanLambda() = TanLambda;
+		SymMatrix5x5 Covariance;
+		Covariance.clear();
+		Covariance(0,0) = D0Error*D0Error;
+		Covariance(1,1) = 1.0e-8;
+		Covariance(2,2) = 1.0e-12;
+		Covariance(3,3) = Z0Error*Z0Error;
+		Covariance(4,4) = 1.0e-8;
+		return MemoryManager<Track>::Event()->create(MyEvent,Helix,Vector3(cos(Psi),sin(Psi),TanLambda),InvR > 0 ? 1.0 : -1.0,Covariance,std::vector<int>(),(void*)0);
+	}
+
+	std::vector<TrackState*> makeVertexTracks(Event* MyEvent)
+	{
+		double Phi = uniform()*2*M_PI;
+		double TanLambda = (uniform()-0.5)*1.5;
+		double Distance = 0.05+0.95*uniform();
+		Vector3 Vertex(Distance*cos(Phi),Distance*sin(Phi),Distance*TanLambda);
+		std::vector<TrackState*> States;
+		const int NumTracks = 4+int(uniform()*4);
+		for (int i = 0;i < NumTracks;++i)
+		{
+			double Momentum = 1+20*uniform();
+			double InvR = (uniform() < 0.5 ? 1 : -1)*3.0e-4*4/Momentum;
+			States.push_back(makeTrack(MyEvent,Vertex,Phi+0.2*gaussian(),InvR,TanLambda+0.2*gaussian(),0.005+0.01/Momentum,0.008+0.01/Momentum)->makeState());
+		}
+		return States;
+	}
+
+	struct FitValues
+	{
+		Vector3 Position;
+		double ChiSquaredOfFit;
+		double ChiSquaredOfIP;
+	};
+
+	FitValues fitValues(const CandidateVertex & CV)
+	{
+		FitValues Values;
+		Values.Position = CV.position();
+		Values.ChiSquaredOfFit = CV.chiSquaredOfFit();
+		Values.ChiSquaredOfIP = CV.chiSquaredOfIP();
+		return Values;
+	}
+
+	bool sameFit(const FitValues & A, const FitValues & B)
+	{
+		return A.Position.distanceTo(B.Position) < 1.0e-12
+			&& fabs(A.ChiSquaredOfFit-B.ChiSquaredOfFit) <= 1.0e-9*std::max(1.0,B.ChiSquaredOfFit)
+			&& fabs(A.ChiSquaredOfIP-B.ChiSquaredOfIP) <= 1.0e-9*std::max(1.0,B.ChiSquaredOfIP);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const int NumVertices = (argc > 1) ? atoi(argv[1]) : 500;
+
+	SymMatrix3x3 IPError;
+	IPError.clear();
+	IPError(0,0) = 25.0e-6;
+	IPError(1,1) = 25.0e-6;
+	IPError(2,2) = 400.0e-6;
+
+	Random.seed(13);
+	long NumHeldDiffering = 0;
+	long NumSetDiffering = 0;
+	long NumRemovedWithIPChi = 0;
+	std::vector<double> RemovedDistances;
+	VertexFitterLSM Fitter;
+	VertexFitterLSM Check;
+	for (int v = 0;v < NumVertices;++v)
+	{
+		Event* MyEvent = new Event(Vector3(0,0,0),IPError);
+		MemoryManager<Event>::Event()->registerObject(MyEvent);
+		InteractionPoint IP(Vector3(0,0,0),IPError);
+		std::vector<TrackState*> Tracks = makeVertexTracks(MyEvent);
+
+		//IP held from the start
+		{
+			CandidateVertex CV(Tracks,&IP,0,&Fitter);
+			CV.incrementalFit() = true;
+			CV.position();
+			CV.removeTrackState(Tracks.back());
+			const FitValues Incremental = fitValues(CV);
+			CV.refit(&Check);
+			if (!sameFit(Incremental, fitValues(CV)))
+				++NumHeldDiffering;
+		}
+
+		//IP set after the information form was made, then removed again
+		{
+			CandidateVertex CV(Tracks,0,&Fitter);
+			CV.incrementalFit() = true;
+			CV.position();
+			CV.removeTrackState(Tracks.back());
+			CV.setIP(&IP);
+			const FitValues Incremental = fitValues(CV);
+			CV.refit(&Check);
+			if (!sameFit(Incremental, fitValues(CV)))
+				++NumSetDiffering;
+
+			CV.removeIP();
+			CV.refit();
+			const FitValues Solved = fitValues(CV);
+			if (Solved.ChiSquaredOfIP != 0.0)
+				++NumRemovedWithIPChi;
+			CV.refit(&Check);
+			RemovedDistances.push_back(Solved.Position.distanceTo(CV.position()));
+		}
+		MetaMemoryManager::Event()->delAllObjects();
+	}
+
+	const bool HeldAgrees = (NumHeldDiffering == 0);
+	const bool SetAgrees = (NumSetDiffering == 0);
+	const bool RemovedAgrees = (NumRemovedWithIPChi == 0);
+	printf("IP held from the start: %ld of %d vertices differ from VertexFitterLSM %s\n",
+		NumHeldDiffering, NumVertices, HeldAgrees ? "(ok)" : "(FAILED)");
+	printf("IP set after the information form was made: %ld of %d vertices differ from VertexFitterLSM %s\n",
+		NumSetDiffering, NumVertices, SetAgrees ? "(ok)" : "(FAILED)");
+	std::sort(RemovedDistances.begin(), RemovedDistances.end());
+	printf("IP removed again: %ld of %d vertices with an IP chi squared %s, distance from VertexFitterLSM %.2g um median, %.2g um 99th percentile\n",
+		NumRemovedWithIPChi, NumVertices, RemovedAgrees ? "(ok)" : "(FAILED)",
+		RemovedDistances[RemovedDistances.size()/2]*1.0e4, RemovedDistances[(RemovedDistances.size()*99)/100]*1.0e4);
+	return (HeldAgrees && SetAgrees && RemovedAgrees) ? 0 : 1;
+}
@@ -0,0 +1,176 @@
+/*
+	Benchmark of the small matrix kernels of util/inc/smallmatrix.h against the uBLAS code they
+	replaced in InvertMatrix5x5, InvertMatrix and the chi squared quadratic forms.
+
+	Random positive definite matrices with entries of the size of track errors (cm^2) are inverted
+	both ways, the largest difference (relative to the diagonal) is printed along with the time
+	per call. Returns non zero if the two ways disagree.
+
+	Build with -DBUILD_BENCHMARKS=ON, run as
+		smallmatrix_benchmark [number of matrices]
+*/
+
+#include <util/inc/matrix.h>
+#include <util/inc/vector3.h>
+#include <util/inc/smallmatrix.h>
+
+#include <boost/numeric/ublas/operation.hpp>
+#include <boost/numeric/ublas/triangular.hpp>
+#include <boost/numeric/ublas/lu.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace vertex_lcfi::util;
+using namespace boost::numeric::ublas;
+
+namespace
+{
+	std::mt19937 Random(17);
+
+	//Inverse by uBLAS LU, as InvertMatrix5x5 was
+	template <class T>
+	T luInverse(const T & Input, unsigned int Size)
+	{
+		matrix<double> A(Input);
+		lu_factorize(A);
+		matrix<double> B(Size,Size);
+		B.clear();
+		for (unsigned int i = 0;i < Size;++i)
+			B(i,i) = 1;
+		lu_substitute<const matrix<double>,matrix<double> >(A,B);
+		return B;
+	}
+
+	//Inverse by cofactors of uBLAS 2x2 matrices, as InvertMatrix was
+	Matrix3x3 cofactorInverse(const Matrix3x3 & a)
+	{
+		double det = determinant(a);
+		Matrix3x3 inverse;
+		for (short j=0;j<3;j++)
+		{
+			for (short i=0;i<3;i++)
+			{
+				matrix<double> c(2,2);
+				short i1 = 0;
+				for (short ii=0;ii<3;ii++)
+				{
+					if (ii == i)
+						continue;
+					short j1 = 0;
+					for (short jj=0;jj<3;jj++)
+					{
+						if (jj == j)
+							continue;
+						c(i1,j1) = a(ii,jj);
+						j1++;
+					}
+					i1++;
+				}
+				double tempdet = (c(0,0)*c(1,1)) - (c(1,0)*c(0,1));
+				inverse(j,i) = (pow(-1.0,i+j+2.0) * tempdet)/det;
+			}
+		}
+		return inverse;
+	}
+
+	//Largest difference of two inverses, relative to the diagonal of the second
+	template <class A, class B>
+	double largestDifference(const A & First, const B & Second, unsigned int Size)
+	{
+		double Largest = 0.0;
+		for (unsigned int i = 0;i < Size;++i)
+			for (unsigned int j = 0;j < Size;++j)
+				Largest = std::max(Largest, fabs(First(i,j)-Second(i,j))/fabs(Second(i,i)));
+		return Largest;
+	}
+
+	double secondsSince(std::chrono::steady_clock::time_point Start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now()-Start).count();
+	}
+
+	//Time per call in ns of Function over Count matrices, the results are added to Sink so they are not optimised away
+	template <class F>
+	double nanosecondsPerCall(int Count, double & Sink, F Function)
+	{
+		std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+		for (int k = 0;k < Count;++k)
+			Sink += Function(k);
+		return secondsSince(Start)/Count*1.0e9;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const int Count = (argc > 1) ? atoi(argv[1]) : 2000;
+	std::uniform_real_distribution<double> Uniform(-0.5,0.5);
+
+	//A.A^T plus a bit of diagonal is positive definite, the 5x5 and 3x3 are its leading blocks
+	std::vector<SymMatrix6x6> Matrices6(Count);
+	std::vector<SymMatrix5x5> Matrices5(Count);
+	std::vector<Matrix3x3> Matrices3(Count);
+	for (int k = 0;k < Count;++k)
+	{
+		matrix<double> A(6,6);
+		for (int i = 0;i < 6;++i)
+			for (int j = 0;j < 6;++j)
+				A(i,j) = Uniform(Random);
+		matrix<double> S = prod(A,trans(A));
+		for (int i = 0;i < 6;++i)
+			S(i,i) += 0.1;
+		for (int i = 0;i < 6;++i)
+		{
+			for (int j = 0;j <= i;++j)
+			{
+				Matrices6[k](i,j) = S(i,j)*1.0e-6;
+				if (i < 5)
+					Matrices5[k](i,j) = S(i,j)*1.0e-6;
+				if (i < 3)
+					Matrices3[k](i,j) = Matrices3[k](j,i) = S(i,j)*1.0e-6;
+			}
+		}
+	}
+
+	double Error5 = 0.0, Error6 = 0.0, Error3 = 0.0;
+	for (int k = 0;k < Count;++k)
+	{
+		Error5 = std::max(Error5, largestDifference(InvertMatrix5x5(Matrices5[k]), luInverse(Matrices5[k],5), 5));
+		Error6 = std::max(Error6, largestDifference(InvertMatrix6x6(Matrices6[k]), luInverse(Matrices6[k],6), 6));
+		Error3 = std::max(Error3, largestDifference(InvertMatrix(Matrices3[k]), cofactorInverse(Matrices3[k]), 3));
+	}
+	printf("Largest relative difference from uBLAS: 5x5 %.2g, 6x6 %.2g, 3x3 %.2g\n", Error5, Error6, Error3);
+
+	double Sink = 0.0;
+	printf("5x5 inverse: uBLAS LU %.1f ns, Cholesky %.1f ns\n",
+		nanosecondsPerCall(Count, Sink, [&](int k){return luInverse(Matrices5[k],5)(1,2);}),
+		nanosecondsPerCall(Count, Sink, [&](int k){return InvertMatrix5x5(Matrices5[k])(1,2);}));
+	printf("6x6 inverse: uBLAS LU %.1f ns, Cholesky %.1f ns\n",
+		nanosecondsPerCall(Count, Sink, [&](int k){return luInverse(Matrices6[k],6)(1,2);}),
+		nanosecondsPerCall(Count, Sink, [&](int k){return InvertMatrix6x6(Matrices6[k])(1,2);}));
+	printf("3x3 inverse: uBLAS cofactors %.1f ns, closed form %.1f ns\n",
+		nanosecondsPerCall(Count, Sink, [&](int k){return cofactorInverse(Matrices3[k])(1,2);}),
+		nanosecondsPerCall(Count, Sink, [&](int k){return InvertMatrix(Matrices3[k])(1,2);}));
+
+	const Vector3 Offset(1.0e-3,2.0e-3,-1.0e-3);
+	double Error = 0.0;
+	for (int k = 0;k < Count;++k)
+	{
+		const double Reference = prec_inner_prod(Offset,prec_prod(Matrices3[k],Offset));
+		Error = std::max(Error, fabs(quadraticForm3(Matrices3[k],Offset)-Reference)/fabs(Reference));
+	}
+	printf("3x3 quadratic form: uBLAS %.1f ns, quadraticForm3 %.1f ns, largest relative difference %.2g\n",
+		nanosecondsPerCall(Count, Sink, [&](int k){return prec_inner_prod(Offset,prec_prod(Matrices3[k],Offset));}),
+		nanosecondsPerCall(Count, Sink, [&](int k){return quadraticForm3(Matrices3[k],Offset);}),
+		Error);
+
+	//Keeps the timed results live
+	if (Sink == 0.0)
+		printf("\n");
+	return (Error5 < 1.0e-10 && Error6 < 1.0e-10 && Error3 < 1.0e-10 && Error < 1.0e-10) ? 0 : 1;
+}
@@ -0,0 +1,144 @@
+/*
+	Check that the circle gap pre-cut of TwoTrackPid only drops pairs the vertex fit would fail.
+
+	TwoTrackPid skips the fit of a pair when the gap between the XY circles of the tracks, taken
+	TrackPath::Precision small at each end, squared over the sum of their d0 variances is at least
+	Chi2Cut. That relies on VertexFitterLSM giving the chi squared of the (d0,z0) residuals of the
+	tracks, which can't be less than that. Here each pair is two opposite charged tracks from
+	points up to 5 mm apart in XY, 0.2-10 GeV, with d0 and z0 errors 20-200 um correlated by up
+	to 0.5, made from a fixed seed. Every pair the gap cut drops is fitted as TwoTrackPid would,
+	and its chi squared must be at least Chi2Cut.
+	Returns non zero if a check fails.
+
+	Build with -DBUILD_BENCHMARKS=ON, run as
+		twotrackpid_check [pairs] [Chi2Cut]
+	with Chi2Cut as the default of TwoTrackPid if not given.
+*/
+
+#include <zvtop/include/vertexfitterlsm.h>
+#include <inc/event.h>
+#include <inc/track.h>
+#include <inc/trackstate.h>
+#include <inc/trackpath.h>
+#include <util/inc/memorymanager.h>
+#include <util/inc/helixcircle.h>
+#include <util/inc/helixrep.h>
+#include <util/inc/matrix.h>
+#include <util/inc/vector3.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace vertex_lcfi;
+using namespace vertex_lcfi::ZVTOP;
+using namespace vertex_lcfi::util;
+
+namespace
+{
+	std::mt19937 Random;
+
+	double gaussian() {return std::normal_distribution<double>(0,1)(Random);}
+	double uniform() {return std::uniform_real_distribution<double>(0,1)(Random);}
+
+	//Track through Vertex with xy direction Psi, momentum Momentum, charge Charge and tan lambda
+	//TanLambda, with its d0 and z0 smeared by errors D0Error and Z0Error correlated by Correlation
+	Track* makeTrack(Event* MyEvent, const Vector3 & Vertex, double Psi, double Momentum, double Charge, double TanLambda, double D0Error, double Z0Error, double Correlation)
+	{
+		const double Pt = Momentum/sqrt(1+TanLambda*TanLambda);
+		const double InvR = Charge*3.0e-4*4/Pt;
+		double CentreX = Vertex.x()+sin(Psi)/InvR;
+		double CentreY = Vertex.y()-cos(Psi)/InvR;
+		double Rho = (InvR > 0 ? 1 : -1)*sqrt(CentreX*CentreX+CentreY*CentreY);
+		double Phi = atan2(CentreX/Rho,-CentreY/Rho);
+		double Swum = std::remainder(Phi-Psi,2*M_PI)/InvR;
+		const double D0Smear = gaussian();
+		const double Z0Smear = Correlation*D0Smear+sqrt(1-Correlation*Correlation)*gaussian();
+		HelixRep Helix;
+		Helix.d0() = 1/InvR-Rho+D0Error*D0Smear;
+		Helix.z0() = Vertex.z()-Swum*TanLambda+Z0Error*Z0Smear;
+		Helix.phi() = Phi;
+		Helix.invR() = InvR;
+		Helix.tanLambda() = TanLambda;
+		SymMatrix5x5 Covariance;
+		Covariance.clear();
+		Covariance(0,0) = D0Error*D0Error;
+		Covariance(0,3) = Correlation*D0Error*Z0Error;
+		Covariance(1,1) = 1.0e-8;
+		Covariance(2,2) = 1.0e-12;
+		Covariance(3,3) = Z0Error*Z0Error;
+		Covariance(4,4) = 1.0e-8;
+		return MemoryManager<Track>::Event()->create(MyEvent,Helix,Vector3(Pt*cos(Psi),Pt*sin(Psi),Pt*TanLambda),Charge,Covariance,std::vector<int>(),(void*)0);
+	}
+
+	Track* makePairTrack(Event* MyEvent, const Vector3 & Vertex, double Psi, double TanLambda, double Charge)
+	{
+		const double Momentum = 0.2+9.8*uniform();
+		const double D0Error = 0.002+0.018*uniform();
+		const double Z0Error = 0.002+0.018*uniform();
+		return makeTrack(MyEvent,Vertex,Psi+0.3*gaussian(),Momentum,Charge,TanLambda+0.3*gaussian(),D0Error,Z0Error,(uniform()-0.5));
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const int NumPairs = (argc > 1) ? atoi(argv[1]) : 100000;
+	const double Chi2Cut = (argc > 2) ? atof(argv[2]) : 6.63;
+
+	SymMatrix3x3 IPError;
+	IPError.clear();
+	IPError(0,0) = 25.0e-6;
+	IPError(1,1) = 25.0e-6;
+	IPError(2,2) = 400.0e-6;
+
+	Random.seed(23);
+	long NumDropped = 0;
+	long NumPassing = 0;
+	double SmallestRatio = -1;
+	VertexFitterLSM Fitter;
+	for (int p = 0;p < NumPairs;++p)
+	{
+		Event* MyEvent = new Event(Vector3(0,0,0),IPError);
+		MemoryManager<Event>::Event()->registerObject(MyEvent);
+		const double Phi = uniform()*2*M_PI;
+		const double TanLambda = (uniform()-0.5)*1.5;
+		const double Distance = 0.05+2.95*uniform();
+		const Vector3 Vertex(Distance*cos(Phi),Distance*sin(Phi),Distance*TanLambda);
+		const double Apart = 0.5*uniform();
+		const double ApartAngle = uniform()*2*M_PI;
+		const Vector3 Vertex2(Vertex.x()+Apart*cos(ApartAngle),Vertex.y()+Apart*sin(ApartAngle),Vertex.z()+0.05*gaussian());
+		Track* Track1 = makePairTrack(MyEvent,Vertex,Phi,TanLambda,1.0);
+		Track* Track2 = makePairTrack(MyEvent,Vertex2,Phi,TanLambda,-1.0);
+
+		//The cut as TwoTrackPid makes it
+		const double Gap = HelixCircle(Track1->helixRep()).gapTo(HelixCircle(Track2->helixRep())) - 2*TrackPath::Precision;
+		const double Variance = Track1->positionCovarianceAt(0)(0,0) + Track2->positionCovarianceAt(0)(0,0);
+		if (Gap > 0 && Gap*Gap >= Chi2Cut*Variance)
+		{
+			++NumDropped;
+			TrackState State(Track1);
+			TrackState State2(Track2);
+			std::vector<TrackState*> PairStates;
+			PairStates.push_back(&State);
+			PairStates.push_back(&State2);
+			Vector3 Position;
+			double ChiSquared;
+			Fitter.fitVertex(PairStates,0,Position,ChiSquared);
+			if (ChiSquared < Chi2Cut)
+				++NumPassing;
+			const double Ratio = ChiSquared/(Gap*Gap/Variance);
+			if (SmallestRatio < 0 || Ratio < SmallestRatio)
+				SmallestRatio = Ratio;
+		}
+		MetaMemoryManager::Event()->delAllObjects();
+	}
+
+	const bool Conservative = (NumPassing == 0);
+	printf("%ld of %d pairs dropped by the gap cut at Chi2Cut %g, %ld of them with a fit chi squared under the cut %s\n",
+		NumDropped, NumPairs, Chi2Cut, NumPassing, Conservative ? "(ok)" : "(FAILED)");
+	printf("smallest fit chi squared over gap squared over d0 variances %.4g\n", SmallestRatio);
+	return (Conservative && NumDropped > 0) ? 0 : 1;
+}
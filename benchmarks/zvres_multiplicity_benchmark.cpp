@@ -0,0 +1,148 @@
+/*
+	Benchmark of ZVRES on high multiplicity jets, for the clustering of the candidate vertices
+	over the graph of unresolved pairs (VertexFinderClassic::findVertices).
+
+	Each event has two jets of 29-44 tracks: 22-31 from the IP, 4-7 from a B vertex a few mm out
+	and 3-5 from a D vertex beyond that, all smeared by their d0 and z0 errors. The events are
+	made from a fixed seed, so the printed checksums of the vertex positions, chi squareds and
+	track order can be compared between builds to show the output is unchanged.
+
+	Build with -DBUILD_BENCHMARKS=ON, run as
+		zvres_multiplicity_benchmark [events] [threads] [EqualSteps|GoldenSection]
+*/
+
+#include <algo/inc/zvres.h>
+#include <inc/event.h>
+#include <inc/jet.h>
+#include <inc/track.h>
+#include <inc/vertex.h>
+#include <inc/decaychain.h>
+#include <util/inc/memorymanager.h>
+#include <util/inc/helixrep.h>
+#include <util/inc/matrix.h>
+#include <util/inc/vector3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace vertex_lcfi;
+using namespace vertex_lcfi::util;
+
+namespace
+{
+	std::mt19937 Random;
+
+	double gaussian() {return std::normal_distribution<double>(0,1)(Random);}
+	double uniform() {return std::uniform_real_distribution<double>(0,1)(Random);}
+
+	//Track through Vertex with xy direction Psi, curvature InvR and tan lambda TanLambda, with its
+	//d0 and z0 smeared by errors D0Error and Z0Error
+	Track* makeTrack(Event* MyEvent, const Vector3 & Vertex, double Psi, double InvR, double TanLambda, double D0Error, double Z0Error)
+	{
+		double CentreX = Vertex.x()+sin(Psi)/InvR;
+		double CentreY = Vertex.y()-cos(Psi)/InvR;
+		double Rho = (InvR > 0 ? 1 : -1)*sqrt(CentreX*CentreX+CentreY*CentreY);
+		double Phi = atan2(CentreX/Rho,-CentreY/Rho);
+		double Swum = std::remainder(Phi-Psi,2*M_PI)/InvR;
+		HelixRep Helix;
+		Helix.d0() = 1/InvR-Rho+D0Error*gaussian();
+		Helix.z0() = Vertex.z()-Swum*TanLambda+Z0Error*gaussian();
+		Helix.phi() = Phi+1.0e-4*gaussian();
+		Helix.invR() = InvR;
+		Helix.tanLambda() = TanLambda+1.0e-4*gaussian();
+		SymMatrix5x5 Covariance;
+		Covariance.clear();
+		Covariance(0,0) = D0Error*D0Error;
+		Covariance(1,1) = 1.0e-8;
+		Covariance(2,2) = 1.0e-12;
+		Covariance(3,3) = Z0Error*Z0Error;
+		Covariance(4,4) = 1.0e-8;
+		return MemoryManager<Track>::Event()->create(MyEvent,Helix,Vector3(cos(Psi),sin(Psi),TanLambda),InvR > 0 ? 1.0 : -1.0,Covariance,std::vector<int>(),(void*)0);
+	}
+
+	Jet* makeJet(Event* MyEvent)
+	{
+		double Phi = uniform()*2*M_PI;
+		double TanLambda = (uniform()-0.5)*1.5;
+		Jet* MyJet = new Jet(MyEvent,std::vector<Track*>(),40,Vector3(cos(Phi),sin(Phi),TanLambda),(void*)0);
+		MemoryManager<Jet>::Event()->registerObject(MyJet);
+		Vector3 B(3*cos(Phi)*(0.5+uniform()),3*sin(Phi)*(0.5+uniform()),3*TanLambda*(0.5+uniform()));
+		Vector3 D = B.add(Vector3(4*cos(Phi+0.05)*uniform(),4*sin(Phi+0.05)*uniform(),4*TanLambda*uniform()));
+		Vector3 Vertices[3] = {Vector3(0,0,0.01*gaussian()),B,D};
+		int NumTracks[3] = {22+int(uniform()*10),4+int(uniform()*4),3+int(uniform()*3)};
+		for (int v = 0;v < 3;++v)
+		{
+			for (int i = 0;i < NumTracks[v];++i)
+			{
+				double Momentum = 1+20*uniform();
+				double InvR = (uniform() < 0.5 ? 1 : -1)*3.0e-4*4/Momentum;
+				MyJet->addTrack(makeTrack(MyEvent,Vertices[v],Phi+0.2*gaussian(),InvR,TanLambda+0.2*gaussian(),0.005+0.01/Momentum,0.008+0.01/Momentum));
+			}
+		}
+		return MyJet;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const int NumEvents = (argc > 1) ? atoi(argv[1]) : 40;
+	const int NumThreads = (argc > 2) ? atoi(argv[2]) : 1;
+	const std::string Resolver = (argc > 3) ? argv[3] : "EqualSteps";
+
+	ZVRES MyZVRES;
+	MyZVRES.setStringParameter("UseEventIP","TRUE");
+	MyZVRES.setDoubleParameter("NumberOfThreads",NumThreads);
+	MyZVRES.setStringParameter("VertexResolver",Resolver);
+
+	Random.seed(11);
+	SymMatrix3x3 IPError;
+	IPError.clear();
+	IPError(0,0) = 25.0e-6;
+	IPError(1,1) = 25.0e-6;
+	IPError(2,2) = 400.0e-6;
+	double Seconds = 0.0;
+	double PositionSum = 0.0;
+	double TrackOrderSum = 0.0;
+	long NumVertices = 0;
+	long NumVertexTracks = 0;
+	for (int e = 0;e < NumEvents;++e)
+	{
+		Event* MyEvent = new Event(Vector3(0,0,0),IPError);
+		MemoryManager<Event>::Event()->registerObject(MyEvent);
+		std::vector<Jet*> Jets;
+		Jets.push_back(makeJet(MyEvent));
+		Jets.push_back(makeJet(MyEvent));
+
+		std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+		for (std::vector<Jet*>::const_iterator iJet = Jets.begin();iJet != Jets.end();++iJet)
+		{
+			MyZVRES.setDoubleParameter("Kalpha",0.125*(*iJet)->energy());
+			DecayChain* Chain = MyZVRES.calculateFor(*iJet);
+			for (std::vector<Vertex*>::const_iterator iVertex = Chain->vertices().begin();iVertex != Chain->vertices().end();++iVertex)
+			{
+				++NumVertices;
+				PositionSum += (*iVertex)->position().x()+(*iVertex)->position().z()+(*iVertex)->chi2();
+				//Weighted by place in the vertex, so a change of track order shows
+				int Place = 1;
+				const std::vector<Track*> & JetTracks = (*iJet)->tracks();
+				for (std::vector<Track*>::const_iterator iTrack = (*iVertex)->tracks().begin();iTrack != (*iVertex)->tracks().end();++iTrack)
+				{
+					++NumVertexTracks;
+					TrackOrderSum += Place++*(std::find(JetTracks.begin(),JetTracks.end(),*iTrack)-JetTracks.begin());
+				}
+			}
+		}
+		Seconds += std::chrono::duration<double>(std::chrono::steady_clock::now()-Start).count();
+		MetaMemoryManager::Event()->delAllObjects();
+	}
+	printf("%d jets, %d threads, %s resolver\n", 2*NumEvents, NumThreads, Resolver.c_str());
+	printf("vertices %ld, tracks in vertices %ld, position checksum %.12g, track order checksum %.0f\n", NumVertices, NumVertexTracks, PositionSum, TrackOrderSum);
+	printf("vertex function values %ld, time %.3f s\n", MyZVRES.numVertexFuncValues(), Seconds);
+	return 0;
+}
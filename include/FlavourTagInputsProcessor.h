@@ -13,6 +13,7 @@
 #include "algo/inc/paramsignificance.h"
 #include "algo/inc/twotrackpid.h"
 #include "algo/inc/decaysignificance.h"
+#include "algo/inc/flavourtaginputs.h"
 
 using namespace lcio ;
 using namespace marlin ;
@@ -29,6 +30,8 @@ using vertex_lcfi::DecaySignificanceType;
  * All the variables are calculated inside independent classes that inherit from the vertex_lcfi::Algo template and not in the main 
  * processor file. This makes the processor file extremely flexible and new variables easy to add. 
  * Similary it is also very simple to remove undesired variables. 
+ * The algorithms are run together on each jet by vertex_lcfi::FlavourTagInputs, which shares what they have in common and
+ * fills a fixed vertex_lcfi::FlavourTagInputSet that is copied straight into the output.
  * The following variables are presently calculated (variables depending on the vertex_lcfi::TrackAttach procedure are marked by *, variables depending on vertex_lcfi::TwoTrackPid are marked by ^)
  * <br> D0Significance1 - calculated in vertex_lcfi::ParameterSignificance
  * <br> D0Significance2 - calculated in vertex_lcfi::ParameterSignificance
@@ -117,17 +120,10 @@ class FlavourTagInputsProcessor : public Processor {
   
   std::vector<std::string> _JetVariableNames{};
   
-  vertex_lcfi::Algo<DecayChain*,double>* _VertexMomentum{};
-  vertex_lcfi::Algo<DecayChain*,double>* _VertexMass{};
-  vertex_lcfi::Algo<DecayChain*,int>* _VerticesTrackMultiplicity{};
-  vertex_lcfi::Algo<DecayChain*,std::map<DecaySignificanceType, double> >* _VertexDecaySignificance{};
-  vertex_lcfi::Algo<DecayChain*,DecayChain* >* _TrackAttach{};
+  //!All the algorithms, run together on each jet
+  vertex_lcfi::FlavourTagInputs* _FlavourTagInputs{};
   vertex_lcfi::Algo<DecayChain*,DecayChain* >* _BAttach{};
   vertex_lcfi::Algo<DecayChain*,DecayChain* >* _CAttach{};
-  vertex_lcfi::Algo<DecayChain*,double >* _SecVertexProb{};
-  vertex_lcfi::Algo<Jet*,std::map<SignificanceType, double> >* _ParameterSignificance{};
-  vertex_lcfi::Algo<Jet*,std::map<Projection, double> >* _JointProb{};
-  vertex_lcfi::Algo<Jet*,std::map<PidCutType,std::vector< vertex_lcfi::Track* > > >* _TwoTrackPID{};
   double _VertexMassMaxMomentumAngle=0.0;
   double _VertexMassMaxKinematicCorrectionSigma=0.0;
   double _VertexMassMaxMomentumCorrection=0.0;
@@ -59,6 +59,8 @@ For more details on algorihmic parameters see the ZVKIN paper "zvkin.ps" in the
 \param InitialGhostWidth  Width in cm of the ghost inital ghosttrack also the smallest width it is allowed to have  
 \param MaxChi2Allowed  The ghost track is widened until all forward jet tracks have a chi squared lower than this value  
 \param OutputTrackChi2  If true the chi squared contributions of tracks to vertices is written to LCIO  
+\param NumberOfThreads  Number of threads the fits of the ghost track to the jet tracks are shared between  
+\param FitGhostToTracks  If true the ghost direction is fitted to the jet tracks, if false (default, as before) it only comes from the jet core weighting  
 */
 class ZVTOPZVKINProcessor : public Processor {
   
@@ -89,6 +91,8 @@ class ZVTOPZVKINProcessor : public Processor {
   double _InitialGhostWidth=0.0;
   double _MaxChi2Allowed=0.0;
   bool _OutputTrackChi2=false;
+  int _NumberOfThreads=1;
+  bool _FitGhostToTracks=false;
   int _nRun=-1;
   int _nEvt=-1;
 } ;
@@ -8,6 +8,7 @@
 #include <fstream>
 
 #include "inc/algo.h"
+#include "algo/inc/zvres.h"
 #include "inc/decaychain.h"
 #include "inc/jet.h"
 using namespace lcio ;
@@ -60,6 +61,14 @@ For more details on algorihmic parameters see the ZVTOP paper.
 \param TrackTrimCut Chi Squared cut for final trimming of tracks from vertices
 \param ResolverCut Cut to determine if two vertices are resolved
 \param OutputTrackChi2 If true the chi squared contributions of tracks to vertices is written to LCIO
+\param NumberOfThreads Number of threads used to vertex the jets of an event in parallel
+\param ThreadsPerJet Number of threads used within each jet, for the two prong fits, vertex function maxima and resolving (ZVRES NumberOfThreads). The threads of the jets and within them share one pool, so both can be set
+\param PairCutSigmas Track pairs further apart than this many combined d0/z0 errors are not fitted, 0 fits all pairs
+\param TubeCutSigmas Tracks further than this many errors from a point are left out of the vertex function there, 0 uses all tracks
+\param VertexFuncMaxFinder How the vertex function maxima are found, ClassicStepper (axis by axis steps) or Newton (trust region Newton steps on the analytic derivatives)
+\param VertexResolver How vertices are resolved, EqualSteps (vertex function at 9 points between them) or GoldenSection (golden section search for the minimum, with decisions kept for the jet)
+\param IncrementalFit If true vertex fits are updated as tracks are added and removed rather than fitted again
+\param VertexFitterSeed Where vertex fits start from, Pairwise (average of the two prong fits of every pair of tracks) or Linear (least squares point of the tracks as straight lines)
 */
 class ZVTOPZVRESProcessor : public Processor {
   
@@ -84,7 +93,10 @@ class ZVTOPZVRESProcessor : public Processor {
   std::string _IPVertexCollectionName {};
   std::string _DecayChainCollectionName{};
   //std::string _RelationCollectionName{};
-  vertex_lcfi::Algo<Jet*,DecayChain*>* _ZVRES{};
+  //One per thread, as Kalpha is set for each jet
+  std::vector<vertex_lcfi::ZVRES*> _ZVRES{};
+  //Holds the objects made by each thread until they are moved to the event context
+  std::vector<vertex_lcfi::EventContext*> _ThreadContexts{};
   bool _ManualPrimaryVertex=false;
   FloatVec _ManualPrimaryVertexPos{};
   FloatVec _ManualPrimaryVertexErr{};
@@ -94,6 +106,14 @@ class ZVTOPZVRESProcessor : public Processor {
   double _TrackTrimCut=0.0;
   double _ResolverCut=0.0;
   bool _OutputTrackChi2=false;
+  int _NumberOfThreads=1;
+  int _ThreadsPerJet=1;
+  double _PairCutSigmas=0.0;
+  double _TubeCutSigmas=0.0;
+  std::string _VertexFuncMaxFinder{};
+  std::string _VertexResolver{};
+  bool _IncrementalFit=false;
+  std::string _VertexFitterSeed{};
   int _nRun=-1;
   int _nEvt=-1;
 } ;
@@ -16,6 +16,7 @@
 #include <MarlinUtil.h>
 #include <marlinutil/GeometryUtil.h>
 #include <HelixClass.h>
+#include <util/inc/helixcircle.h>
 
 #define M_ELECTRON  0.00051
 #define M_PIPLUS    0.13957
@@ -280,6 +281,18 @@ void ConversionTagger::tagger( LCEvent *evt,
 	// get helix representation of these ReconstructedParticles
 	Track* trk1=rp1->getTracks()[0];
 	Track* trk2=rp2->getTracks()[0];
+
+	// the helices can be no closer than their circles in the xy plane,
+	// so pairs too far apart for the cut and the histogram range are
+	// dropped before the distance of closest approach is searched for.
+	// they are still counted in the histogram overflow.
+	double gap=vertex_lcfi::util::HelixCircle(trk1->getD0(),trk1->getPhi(),trk1->getOmega())
+	  .gapTo(vertex_lcfi::util::HelixCircle(trk2->getD0(),trk2->getPhi(),trk2->getOmega()));
+	if (gap>_distCut && gap>20) {
+	  histos->fill("helix_dist",gap,1,"distance between helices",100,0,20);
+	  continue;
+	}
+
 	HelixClass helix1,helix2;
 	helix1.Initialize_Canonical(trk1->getPhi(),trk1->getD0(),
 				    trk1->getZ0(),trk1->getOmega(),
@@ -32,6 +32,7 @@
 #include <inc/track.h>
 #include <inc/lciointerface.h>
 #include <algo/inc/twotrackpid.h>
+#include <algo/inc/flavourtaginputs.h>
 
 #include <vector>
 #include <string>
@@ -194,91 +195,62 @@ void FlavourTagInputsProcessor::init()
 	_nRun = 0 ;
 	_nEvt = 0 ;
 	
-	_VertexMomentum = new VertexMomentum();
-	MemoryManager<Algo<DecayChain*,double> >::Run()->registerObject(_VertexMomentum);
-	
-
-	_VertexMass = new VertexMass();
-	MemoryManager<Algo<DecayChain*,double> >::Run()->registerObject(_VertexMass);  
-	_VertexMass->setDoubleParameter("MaxMomentumAngle",_VertexMassMaxMomentumAngle);
-	_VertexMass->setDoubleParameter("MaxKinematicCorrectionSigma",_VertexMassMaxKinematicCorrectionSigma);
-	_VertexMass->setDoubleParameter("MaxMomentumCorrection",_VertexMassMaxMomentumCorrection);
-
-	_VerticesTrackMultiplicity = new VertexMultiplicity();
-	MemoryManager<Algo<DecayChain*,int> >::Run()->registerObject(_VerticesTrackMultiplicity);
-	
-	_VertexDecaySignificance = new VertexDecaySignificance();
-	MemoryManager<Algo<DecayChain*, std::map<DecaySignificanceType,double > > >::Run()->registerObject(_VertexDecaySignificance);
-	
-	_TrackAttach = new TrackAttach();
-	MemoryManager<Algo<DecayChain*, DecayChain*> > ::Run()->registerObject(_TrackAttach);
-	_TrackAttach->setDoubleParameter("AddAllTracksFromSecondary",_TrackAttachAddAllTracksFromSecondary );
-	_TrackAttach->setDoubleParameter("LoDCutmin",_TrackAttachLoDCutmin );
-	_TrackAttach->setDoubleParameter("LoDCutmax",_TrackAttachLoDCutmax );
-	_TrackAttach->setDoubleParameter("CloseapproachCut",_TrackAttachCloseapproachCut );
+	_FlavourTagInputs = new FlavourTagInputs();
+	MemoryManager<FlavourTagInputs>::Run()->registerObject(_FlavourTagInputs);
+
+	VertexMass & MyVertexMass = _FlavourTagInputs->vertexMass();
+	MyVertexMass.setDoubleParameter("MaxMomentumAngle",_VertexMassMaxMomentumAngle);
+	MyVertexMass.setDoubleParameter("MaxKinematicCorrectionSigma",_VertexMassMaxKinematicCorrectionSigma);
+	MyVertexMass.setDoubleParameter("MaxMomentumCorrection",_VertexMassMaxMomentumCorrection);
+
+	TrackAttach & MyTrackAttach = _FlavourTagInputs->trackAttach();
+	MyTrackAttach.setDoubleParameter("AddAllTracksFromSecondary",_TrackAttachAddAllTracksFromSecondary );
+	MyTrackAttach.setDoubleParameter("LoDCutmin",_TrackAttachLoDCutmin );
+	MyTrackAttach.setDoubleParameter("LoDCutmax",_TrackAttachLoDCutmax );
+	MyTrackAttach.setDoubleParameter("CloseapproachCut",_TrackAttachCloseapproachCut );
 		
-	_SecVertexProb = new SecVertexProb();
-	MemoryManager<Algo<DecayChain*, double > > ::Run()->registerObject(_SecVertexProb);
-	_SecVertexProb->setDoubleParameter("Chisquarecut",_SecondVertexProbChisquarecut);
-	_SecVertexProb->setDoubleParameter("Ntrackscut",_SecondVertexNtrackscut);
+	SecVertexProb & MySecVertexProb = _FlavourTagInputs->secVertexProb();
+	MySecVertexProb.setDoubleParameter("Chisquarecut",_SecondVertexProbChisquarecut);
+	MySecVertexProb.setDoubleParameter("Ntrackscut",_SecondVertexNtrackscut);
 			
-	_ParameterSignificance = new  ParameterSignificance();
-	MemoryManager<Algo<Jet*, std::map<SignificanceType,double > > >::Run()->registerObject( _ParameterSignificance);
-	_ParameterSignificance->setDoubleParameter("LayersHit",_LayersHit);
-	_ParameterSignificance->setDoubleParameter("AllbutOneLayersMomentumCut",_AllbutOneLayersMomentumCut);
-	_ParameterSignificance->setDoubleParameter("AllLayersMomentumCut",_AllLayersMomentumCut);
-
-	_JointProb = new  JointProb();
-	MemoryManager<Algo<Jet*, std::map<Projection,double > > >::Run()->registerObject( _JointProb);
-	_JointProb->setDoubleParameter("MaxD0Significance",_JProbMaxD0Significance);
-	_JointProb->setDoubleParameter("MaxD0andZ0",_JProbMaxD0andZ0);
+	ParameterSignificance & MyParameterSignificance = _FlavourTagInputs->parameterSignificance();
+	MyParameterSignificance.setDoubleParameter("LayersHit",_LayersHit);
+	MyParameterSignificance.setDoubleParameter("AllbutOneLayersMomentumCut",_AllbutOneLayersMomentumCut);
+	MyParameterSignificance.setDoubleParameter("AllLayersMomentumCut",_AllLayersMomentumCut);
+
+	JointProb & MyJointProb = _FlavourTagInputs->jointProb();
+	MyJointProb.setDoubleParameter("MaxD0Significance",_JProbMaxD0Significance);
+	MyJointProb.setDoubleParameter("MaxD0andZ0",_JProbMaxD0andZ0);
 	std::vector<double> temp;  
 	temp.push_back(_JProbResolutionParameterRphi[0]);
 	temp.push_back(_JProbResolutionParameterRphi[1]);
 	temp.push_back(_JProbResolutionParameterRphi[2]);
 	temp.push_back(_JProbResolutionParameterRphi[3]);
 	temp.push_back(_JProbResolutionParameterRphi[4]);
-	_JointProb->setPointerParameter("ResolutionParameterRphi", &temp);
+	MyJointProb.setPointerParameter("ResolutionParameterRphi", &temp);
 	std::vector<double> temp2;  
 	temp2.push_back(_JProbResolutionParameterZ[0]);
 	temp2.push_back(_JProbResolutionParameterZ[1]);
 	temp2.push_back(_JProbResolutionParameterZ[2]);
 	temp2.push_back(_JProbResolutionParameterZ[3]);
 	temp2.push_back(_JProbResolutionParameterZ[4]);
-	_JointProb->setPointerParameter("ResolutionParameterZ",  &temp2);
+	MyJointProb.setPointerParameter("ResolutionParameterZ",  &temp2);
 	
-	_TwoTrackPID = new TwoTrackPid();
- 	MemoryManager<Algo<Jet*, std::map<PidCutType,vector< vertex_lcfi::Track* > > > >::Run()->registerObject( _TwoTrackPID);
-	_TwoTrackPID->setDoubleParameter("MaxGammaMass",_PIDMaxGammaMass);
-	_TwoTrackPID->setDoubleParameter("MinKsMass",_PIDMinKsMass);
-	_TwoTrackPID->setDoubleParameter("MaxKsMass",_PIDMaxKsMass);
-	_TwoTrackPID->setDoubleParameter("Chi2Cut",_PIDChi2Cut);
-	_TwoTrackPID->setDoubleParameter("RPhiCut",_PIDRPhiCut);
-	_TwoTrackPID->setDoubleParameter("SignificanceCut",_PIDSignificanceCut);
+	TwoTrackPid & MyTwoTrackPid = _FlavourTagInputs->twoTrackPid();
+	MyTwoTrackPid.setDoubleParameter("MaxGammaMass",_PIDMaxGammaMass);
+	MyTwoTrackPid.setDoubleParameter("MinKsMass",_PIDMinKsMass);
+	MyTwoTrackPid.setDoubleParameter("MaxKsMass",_PIDMaxKsMass);
+	MyTwoTrackPid.setDoubleParameter("Chi2Cut",_PIDChi2Cut);
+	MyTwoTrackPid.setDoubleParameter("RPhiCut",_PIDRPhiCut);
+	MyTwoTrackPid.setDoubleParameter("SignificanceCut",_PIDSignificanceCut);
 
 }
 
 void FlavourTagInputsProcessor::processRunHeader( LCRunHeader* run) { 
 
 	_JetVariableNames.clear();
-	_JetVariableNames.push_back("JointProbRPhi");
-	_JetVariableNames.push_back("JointProbZ");
-	//	_JetVariableNames.push_back("JointProb3D");
-	_JetVariableNames.push_back("D0Significance1");
-	_JetVariableNames.push_back("D0Significance2");
-	_JetVariableNames.push_back("Z0Significance1");
-	_JetVariableNames.push_back("Z0Significance2");
-	_JetVariableNames.push_back("Momentum1");
-	_JetVariableNames.push_back("Momentum2");
-	_JetVariableNames.push_back("NumTracksInVertices");
-	_JetVariableNames.push_back("DecayLength");
-	_JetVariableNames.push_back("DecayLengthSignificance");
-	_JetVariableNames.push_back("RawMomentum");
-	_JetVariableNames.push_back("PTCorrectedMass");
-	_JetVariableNames.push_back("SecondaryVertexProbability");
-	_JetVariableNames.push_back("NumVertices");
-	_JetVariableNames.push_back("DecayLength(SeedToIP)");
-
+	for (int i = 0;i < FlavourTagInputSet::NumInputs;++i)
+		_JetVariableNames.push_back(FlavourTagInputSet::name(FlavourTagInputSet::Input(i)));
 	
 	run->parameters().setValues(_FlavourTagInputsCollectionName, _JetVariableNames);
 	
@@ -369,62 +341,14 @@ if( isFirstEvent() )
 		evt->addCollection(OutCollection,_FlavourTagInputsCollectionName);
 	
 	//Loop over the jets
+	FlavourTagInputSet Inputs;
 	for (vector<Jet*>::const_iterator iJet=MyEvent->jets().begin();iJet != MyEvent->jets().end();++iJet)
 	{
-		LCFloatVec FlavourTagInputs;
-		
-		//Probability that all tracks consistant with IP
-		std::map<Projection,double> JointProb;
-		
-		JointProb  = _JointProb->calculateFor(*iJet);
-		FlavourTagInputs.push_back(JointProb[RPhi]);
-		FlavourTagInputs.push_back(JointProb[Z]);
-		//FlavourTagInputs.push_back(JointProb[ThreeD]);
-		
-		//D0, Z0 significances and momentum of the two most D0 significant tracks
-		//First make a cut based on particle pid for this input
-		//TODO - Clean up
-		std::map<PidCutType, vector<vertex_lcfi::Track*> >* PIDCutTracks = new std::map<PidCutType	, vector<vertex_lcfi::Track*> >();
-		MemoryManager<std::map<PidCutType, vector<vertex_lcfi::Track*> > > ::Event()->registerObject(PIDCutTracks);
-		*PIDCutTracks = _TwoTrackPID->calculateFor(*iJet);
-		std::map<SignificanceType,double> ParSignificance;
-		_ParameterSignificance->setPointerParameter( "TwoTrackPidCut", PIDCutTracks);
-		ParSignificance  = _ParameterSignificance->calculateFor(*iJet);
-		FlavourTagInputs.push_back(ParSignificance[D0SigTrack1]);
-		FlavourTagInputs.push_back(ParSignificance[D0SigTrack2]);
-		FlavourTagInputs.push_back(ParSignificance[Z0SigTrack1]);
-		FlavourTagInputs.push_back(ParSignificance[Z0SigTrack2]);
-		FlavourTagInputs.push_back(ParSignificance[MomentumTrack1]);
-		FlavourTagInputs.push_back(ParSignificance[MomentumTrack2]);
-		
-		//Num Tracks in secondary and upwards vertices
-		FlavourTagInputs.push_back(_VerticesTrackMultiplicity->calculateFor(DecayChainOf[*iJet]))  ;
-		
-		//Decay Length and Significance of most significant vertex
-		std::map<DecaySignificanceType,double> DecaySignificance;
-		DecaySignificance  = _VertexDecaySignificance->calculateFor(DecayChainOf[*iJet]);
-		FlavourTagInputs.push_back(DecaySignificance[Distance]);
-		FlavourTagInputs.push_back(DecaySignificance[Significance]);
-		//Using cuts attach tracks that were not associated to the decay by vertexing
-	
-
-		DecayChain* AttachedTracksChain = _TrackAttach->calculateFor(DecayChainOf[*iJet]);
-		
-		        //Sum momentum of all tracks in decay chain (vertexed and attached)
-			FlavourTagInputs.push_back(_VertexMomentum->calculateFor(AttachedTracksChain));
-			//Vertex momentum corrected mass
-			FlavourTagInputs.push_back(_VertexMass->calculateFor(AttachedTracksChain));
-			//Probability of all tracks in decay chain belonging to one vertex
-			FlavourTagInputs.push_back(_SecVertexProb->calculateFor(AttachedTracksChain));
-			
-		//Num Vertices in the vertexing result 
-		FlavourTagInputs.push_back(DecayChainOf[*iJet]->vertices().size());
-		//std::cout << DecayChainOf[*iJet]->vertices().size();
-		//Extra Decay length from seed vertex (last vertex) to IP (IP at Origin for now)
-		//TODO De-obfuscate and upgrade to moveable IP
-		FlavourTagInputs.push_back((*(--(DecayChainOf[*iJet]->vertices().end())))->position().mag());
+		//Every input of the jet in one go, see vertex_lcfi::FlavourTagInputs
+		_FlavourTagInputs->calculateFor(*iJet, DecayChainOf[*iJet], Inputs);
 		
-		LCFloatVec* OutVec = new LCFloatVec(FlavourTagInputs);
+		LCFloatVec* OutVec = new LCFloatVec();
+		OutVec->assign(Inputs.Value, Inputs.Value + FlavourTagInputSet::NumInputs);
 		OutCollection->addElement(OutVec);
 		
 	}//End iJet Loop
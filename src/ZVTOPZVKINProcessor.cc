@@ -101,6 +101,14 @@ ZVTOPZVKINProcessor::ZVTOPZVKINProcessor() : Processor("ZVTOP_ZVKINProcessor") {
 			      "If true the chi squared contributions of tracks to vertices is written to LCIO"  ,
 			      _OutputTrackChi2,
 			      false) ;
+  registerOptionalParameter( "NumberOfThreads" , 
+			      "Number of threads the fits of the ghost track to the jet tracks are shared between, the result is the same whatever the number"  ,
+			      _NumberOfThreads,
+			      int(1)) ;
+  registerOptionalParameter( "FitGhostToTracks" , 
+			      "If true the ghost direction is fitted to the jet tracks, if false it only comes from the jet core weighting as in earlier releases"  ,
+			      _FitGhostToTracks,
+			      false) ;
 }
 
 
@@ -119,6 +127,8 @@ void ZVTOPZVKINProcessor::init() {
   _ZVKIN->setDoubleParameter("MinimumProbability",_MinimumProbability);
   _ZVKIN->setDoubleParameter("InitialGhostWidth",_InitialGhostWidth);
   _ZVKIN->setDoubleParameter("MaxChi2Allowed",_MaxChi2Allowed);
+  _ZVKIN->setDoubleParameter("NumberOfThreads",_NumberOfThreads);
+  _ZVKIN->setStringParameter("FitGhostToTracks",_FitGhostToTracks ? "TRUE" : "FALSE");
   _ZVKIN->setStringParameter("AutoJetAxis","TRUE");
   _ZVKIN->setStringParameter("UseEventIP","TRUE");
 	
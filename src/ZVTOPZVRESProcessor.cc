@@ -9,6 +9,7 @@
 #include <IMPL/LCRelationImpl.h>
 
 #include <util/inc/memorymanager.h>
+#include <util/inc/threadpool.h>
 #include <algo/inc/zvres.h>
 #include <util/inc/matrix.h>
 #include <inc/lciointerface.h>
@@ -109,6 +110,38 @@ ZVTOPZVRESProcessor::ZVTOPZVRESProcessor() : Processor("ZVTOP_ZVRESProcessor") {
 			      "If true the chi squared contributions of tracks to vertices is written to LCIO"  ,
 			      _OutputTrackChi2,
 			      false) ;
+  registerOptionalParameter( "NumberOfThreads" , 
+			      "Number of threads used to vertex the jets of an event in parallel, output is in jet order whatever the number"  ,
+			      _NumberOfThreads,
+			      int(1)) ;
+  registerOptionalParameter( "ThreadsPerJet" , 
+			      "Number of threads used within each jet (two prong fits, vertex function maxima and resolving), output is the same whatever the number"  ,
+			      _ThreadsPerJet,
+			      int(1)) ;
+  registerOptionalParameter( "PairCutSigmas" , 
+			      "Track pairs further apart than this many combined d0/z0 errors are not fitted as two prong vertices, 0 fits all pairs (8 removed no vertices in our tests)"  ,
+			      _PairCutSigmas,
+			      double(0.0)) ;
+  registerOptionalParameter( "TubeCutSigmas" , 
+			      "Tracks further than this many errors (in their smallest direction) from a point are taken as zero in the vertex function there, found from a grid index of the tracks, 0 uses all tracks"  ,
+			      _TubeCutSigmas,
+			      double(0.0)) ;
+  registerOptionalParameter( "VertexFuncMaxFinder" , 
+			      "How the vertex function maxima are found: ClassicStepper (axis by axis steps) or Newton (trust region Newton steps on the analytic derivatives, far fewer evaluations)"  ,
+			      _VertexFuncMaxFinder,
+			      std::string("ClassicStepper")) ;
+  registerOptionalParameter( "VertexResolver" , 
+			      "How vertices are resolved: EqualSteps (vertex function at 9 points between them) or GoldenSection (golden section search for the minimum with early exit, decisions kept for the jet)"  ,
+			      _VertexResolver,
+			      std::string("EqualSteps")) ;
+  registerOptionalParameter( "IncrementalFit" , 
+			      "If true vertex fits are updated as tracks are added and removed (information form, one 3x3 solve) rather than fitted again"  ,
+			      _IncrementalFit,
+			      false) ;
+  registerOptionalParameter( "VertexFitterSeed" , 
+			      "Where vertex fits start from: Pairwise (average of the two prong fits of every pair of tracks) or Linear (least squares point of the tracks as straight lines, O(N) and fewer minimiser steps, results differ slightly)"  ,
+			      _VertexFitterSeed,
+			      std::string("Pairwise")) ;
 
 }
 
@@ -121,17 +154,35 @@ void ZVTOPZVRESProcessor::init() {
   _nRun = 0 ;
   _nEvt = 0 ;
   
-  //Make the ZVRES algorithm object and set its parameters
-  _ZVRES = new ZVRES();
-  MemoryManager<Algo<Jet*,DecayChain*> >::Run()->registerObject(_ZVRES);
+  if (_NumberOfThreads < 1) _NumberOfThreads = 1;
+  if (_ThreadsPerJet < 1) _ThreadsPerJet = 1;
+  
+  //Make the ZVRES algorithm objects, one per thread, and set their parameters
+  for (int i=0;i<_NumberOfThreads;++i)
+  {
+    ZVRES* MyZVRES = new ZVRES();
+    MemoryManager<Algo<Jet*,DecayChain*> >::Run()->registerObject(MyZVRES);
   
-  _ZVRES->setDoubleParameter("Kip",_IPWeighting);
-  //_ZVRES->setDoubleParameter("Kalpha",);    // Kaplha set on per jet basis
-  _ZVRES->setDoubleParameter("TwoProngCut",_TwoTrackCut);
-  _ZVRES->setDoubleParameter("TrackTrimCut",_TrackTrimCut);
-  _ZVRES->setDoubleParameter("ResolverCut",_ResolverCut);
-  _ZVRES->setStringParameter("AutoJetAxis","TRUE");
-  _ZVRES->setStringParameter("UseEventIP","TRUE");
+    MyZVRES->setDoubleParameter("Kip",_IPWeighting);
+    //MyZVRES->setDoubleParameter("Kalpha",);    // Kaplha set on per jet basis
+    MyZVRES->setDoubleParameter("TwoProngCut",_TwoTrackCut);
+    MyZVRES->setDoubleParameter("TrackTrimCut",_TrackTrimCut);
+    MyZVRES->setDoubleParameter("ResolverCut",_ResolverCut);
+    MyZVRES->setStringParameter("AutoJetAxis","TRUE");
+    MyZVRES->setStringParameter("UseEventIP","TRUE");
+    MyZVRES->setDoubleParameter("NumberOfThreads",_ThreadsPerJet);
+    MyZVRES->setDoubleParameter("PairCutSigmas",_PairCutSigmas);
+    MyZVRES->setDoubleParameter("TubeCutSigmas",_TubeCutSigmas);
+    MyZVRES->setStringParameter("VertexFuncMaxFinder",_VertexFuncMaxFinder);
+    MyZVRES->setStringParameter("VertexResolver",_VertexResolver);
+    MyZVRES->setStringParameter("IncrementalFit",_IncrementalFit ? "TRUE" : "FALSE");
+    MyZVRES->setStringParameter("VertexFitterSeed",_VertexFitterSeed);
+    _ZVRES.push_back(MyZVRES);
+    
+    EventContext* MyContext = new EventContext();
+    MemoryManager<EventContext>::Run()->registerObject(MyContext);
+    _ThreadContexts.push_back(MyContext);
+  }
 	
 }
 
@@ -204,15 +255,32 @@ void ZVTOPZVRESProcessor::processEvent( LCEvent * evt ) {
 		}
 	std::cout << "Z:";
 	int nRCP = JetCollection->getNumberOfElements()  ;
+	//Making a jet adds it to the event, so they are all made here first
+	std::vector<Jet*> Jets;
 	for(int i=0; i< nRCP ; i++)
 	{
-		Jet* MyJet = jetFromLCIORP(MyEvent,dynamic_cast<ReconstructedParticle*>(JetCollection->getElementAt(i)));
-		
+		Jets.push_back(jetFromLCIORP(MyEvent,dynamic_cast<ReconstructedParticle*>(JetCollection->getElementAt(i))));
+	}
+	
+	//Run ZVTOP-ZVRES, jets are independent so may be done in parallel. Each thread
+	//uses its own ZVRES and EventContext, given by the slot it runs in
+	std::vector<DecayChain*> ZVTOPResults(nRCP,(DecayChain*)0);
+	util::ThreadPool::instance()->parallelFor(nRCP, _NumberOfThreads, [&](size_t iJet, size_t Slot)
+	{
 		//Set any jet depandant parameters
-		_ZVRES->setDoubleParameter("Kalpha", _JetWeightingEnergyScaling * MyJet->energy());
-		
-		//Run ZVTOP-ZVRES
-		DecayChain* ZVTOPResult = _ZVRES->calculateFor(MyJet);
+		_ZVRES[Slot]->setDoubleParameter("Kalpha", _JetWeightingEnergyScaling * Jets[iJet]->energy());
+		ZVTOPResults[iJet] = _ZVRES[Slot]->calculateFor(Jets[iJet],_ThreadContexts[Slot]);
+	});
+	//Objects made by the threads now belong to the event like the rest
+	for (std::vector<EventContext*>::iterator iContext = _ThreadContexts.begin();iContext != _ThreadContexts.end();++iContext)
+	{
+		EventContext::current()->takeObjectsFrom(**iContext);
+	}
+	
+	//Store the results in jet order
+	for(int i=0; i< nRCP ; i++)
+	{
+		DecayChain* ZVTOPResult = ZVTOPResults[i];
 		std::cout << ZVTOPResult->vertices().size() << " ";
 		
 		//Store resulting decay chain in the LCIO file
@@ -249,10 +317,27 @@ void ZVTOPZVRESProcessor::check( LCEvent* ) {
 
 void ZVTOPZVRESProcessor::end(){ 
   
+	long PairsTried = 0;
+	long PairsCut = 0;
+	long VertexFuncValues = 0;
+	long VertexFuncDerivatives = 0;
+	for (std::vector<ZVRES*>::const_iterator iZVRES = _ZVRES.begin();iZVRES != _ZVRES.end();++iZVRES)
+	{
+		PairsTried += (*iZVRES)->numPairsTried();
+		PairsCut += (*iZVRES)->numPairsCut();
+		VertexFuncValues += (*iZVRES)->numVertexFuncValues();
+		VertexFuncDerivatives += (*iZVRES)->numVertexFuncDerivatives();
+	}
 	MetaMemoryManager::Run()->delAllObjects();
    	std::cout << "ZVTOPZVRESProcessor::end()  " << name() 
  	    << " processed " << _nEvt << " events in " << _nRun << " runs "
  	    << std::endl ;
+	if (_PairCutSigmas > 0.0)
+		std::cout << "ZVTOPZVRESProcessor::end()  " << PairsCut << " of " << PairsTried
+		    << " track pairs not fitted (PairCutSigmas " << _PairCutSigmas << ")" << std::endl;
+	std::cout << "ZVTOPZVRESProcessor::end()  Vertex function found at " << VertexFuncValues << " points, derivatives at "
+	    << VertexFuncDerivatives << " points (VertexFuncMaxFinder " << _VertexFuncMaxFinder
+	    << ", VertexResolver " << _VertexResolver << ")" << std::endl;
 
 }
 
@@ -82,6 +82,14 @@ namespace vertex_lcfi
 		\return map containing the following keys: "Significance", "Distance"
 		*/
 	       std::map<DecaySignificanceType, double> calculateFor(DecayChain* MyDecayChain) const;
+
+		//! Most significant decay length, as calculateFor without the map
+		/*!
+		\param MyDecayChain Decay chain to be analysed
+		\param DecayLength Filled with the most significant decay length
+		\param DecayLengthSignificance Filled with its significance
+		*/
+		void findMostSignificant(DecayChain* MyDecayChain, double & DecayLength, double & DecayLengthSignificance) const;
 		
 	private:
 		std::string _Name{};
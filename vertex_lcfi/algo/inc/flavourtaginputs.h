@@ -0,0 +1,105 @@
+#ifndef LCFIFLAVOURTAGINPUTS_H
+#define LCFIFLAVOURTAGINPUTS_H
+
+#include <algo/inc/jointprob.h>
+#include <algo/inc/twotrackpid.h>
+#include <algo/inc/paramsignificance.h>
+#include <algo/inc/vertexmultiplicity.h>
+#include <algo/inc/decaysignificance.h>
+#include <algo/inc/trackattach.h>
+#include <algo/inc/vertexmomentum.h>
+#include <algo/inc/vertexmass.h>
+#include <algo/inc/secondvertexprob.h>
+#include <vector>
+#include <utility>
+
+namespace vertex_lcfi
+{
+	//Forward Declarations
+	class Jet;
+	class Track;
+	class DecayChain;
+
+	//!Flavour tag inputs of a jet
+	/*!
+	Fixed layout, in the order written out by FlavourTagInputsProcessor.
+	*/
+	struct FlavourTagInputSet
+	{
+		//!Index of each input in Value
+		enum Input {JointProbRPhi, JointProbZ,
+			D0Significance1, D0Significance2, Z0Significance1, Z0Significance2, Momentum1, Momentum2,
+			NumTracksInVertices, DecayLength, DecayLengthSignificance,
+			RawMomentum, PTCorrectedMass, SecondaryVertexProbability,
+			NumVertices, DecayLengthSeedToIP,
+			NumInputs};
+
+		double Value[NumInputs];
+
+		//!Name of an input, as in the run parameters of the output collection
+		static const char* name(Input Index);
+	};
+
+	//!Calculation of all the flavour tag inputs of a jet together
+	/*!
+	Gives the same values as running each of the algorithms (JointProb, TwoTrackPid, ParameterSignificance,
+	VertexMultiplicity, VertexDecaySignificance, TrackAttach, VertexMomentum, VertexMass and SecVertexProb)
+	on the jet and its decay chain, which stay as the reference. The tracks of the jet are gone through
+	once for the jet inputs, with the significance of each track found once for JointProb and TwoTrackPid,
+	and nothing is put into maps. The decay chain inputs share the results kept in the DecayChain.
+	<br>Each algorithm is set up through its accessor, with the parameters it has on its own, e.g.
+	<br><pre>Inputs.jointProb().setDoubleParameter("MaxD0Significance",200);</pre>
+	<br>Lists used for a jet are kept between jets, so an object should not be used from several threads at once.
+	*/
+	class FlavourTagInputs
+	{
+	public:
+		FlavourTagInputs() {}
+		FlavourTagInputs(const FlavourTagInputs&) = delete;
+		FlavourTagInputs& operator=(const FlavourTagInputs&) = delete;
+
+		//!Algorithm for JointProbRPhi and JointProbZ
+		JointProb & jointProb() {return _JointProb;}
+		//!Algorithm flagging tracks from gamma and Ks, not used for D0Significance1 etc.
+		TwoTrackPid & twoTrackPid() {return _TwoTrackPid;}
+		//!Algorithm for D0Significance1, D0Significance2, Z0Significance1, Z0Significance2, Momentum1 and Momentum2
+		ParameterSignificance & parameterSignificance() {return _ParameterSignificance;}
+		//!Algorithm attaching the tracks for RawMomentum, PTCorrectedMass and SecondaryVertexProbability
+		TrackAttach & trackAttach() {return _TrackAttach;}
+		//!Algorithm for PTCorrectedMass
+		VertexMass & vertexMass() {return _VertexMass;}
+		//!Algorithm for SecondaryVertexProbability
+		SecVertexProb & secVertexProb() {return _SecVertexProb;}
+
+		//!Calculate the inputs
+		/*!
+		\param MyJet Jet to be analysed
+		\param MyDecayChain Decay chain found for MyJet, with at least one vertex
+		\param Inputs Filled with every input
+		*/
+		void calculateFor(Jet* MyJet, DecayChain* MyDecayChain, FlavourTagInputSet & Inputs) const;
+
+	private:
+		JointProb _JointProb{};
+		TwoTrackPid _TwoTrackPid{};
+		ParameterSignificance _ParameterSignificance{};
+		VertexMultiplicity _VertexMultiplicity{};
+		VertexDecaySignificance _VertexDecaySignificance{};
+		TrackAttach _TrackAttach{};
+		VertexMomentum _VertexMomentum{};
+		VertexMass _VertexMass{};
+		SecVertexProb _SecVertexProb{};
+
+		//Kept between jets so their space is reused
+		//Significances passing the JointProb cuts in RPhi and Z
+		mutable std::vector<double> _RPhiSignificances{};
+		mutable std::vector<double> _ZSignificances{};
+		//Tracks passing the TwoTrackPid significance cut, and those it flags
+		mutable std::vector<Track*> _PidTracks{};
+		mutable std::vector<Track*> _Gammas{};
+		mutable std::vector<Track*> _KShorts{};
+		//Tracks passing the ParameterSignificance momentum cut, with their momentum
+		mutable std::vector<std::pair<Track*,double> > _MomentumTracks{};
+	};
+}
+#endif //LCFIFLAVOURTAGINPUTS_H
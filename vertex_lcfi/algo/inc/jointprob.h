@@ -6,6 +6,7 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <cstddef>
 
 using std::string;
 using vertex_lcfi::util::Projection;
@@ -14,6 +15,7 @@ namespace vertex_lcfi
 	//Forward Declarations
 	class Vertex;
 	class Jet;
+	class Track;
 	
 	//!Calculation of the Joint probability flavour tag inputs. 
 	/*!
@@ -29,6 +31,9 @@ namespace vertex_lcfi
 	  It must point to a vector containing 5 double elements. These are the standard deviations of the impact parameter significances of the distribution of  tracks coming from the primary vertex. These values can be obtained from a fit to the impact parameter distribution of tracks behind the interaction point, i.e. with negative impact parameter, where the direction of reference is the Jet direction. Please note that ideally these parameters should be calculated whenever the boundary conditions change in a way that affects the impact parameter distributions, by running a separate processor beforehand. This at the moment is not done and the values are inserted as parameters. The default values have been inherited from previous studies. 
 	  \param ResolutionParameterZ Similar as ResolutionParameterRphi, but for the Z direction. 
 	  \param ResolutionParameter3D Similar as before but for the 3-D calculation 
+	  <br>The resolution function of each projection is set up when the parameters are set, with its value at
+	  MaxD0Significance and its normalisation (value at 0) worked out then, so a track only costs the terms of its
+	  own significance.
 	  \author Erik Devetak (e.devetak1@physics.ox.ac.uk)
 	*/
 	
@@ -91,6 +96,21 @@ namespace vertex_lcfi
 		\return Map containing the following keys: RPhi, Z and ThreeD
 		*/
 	       std::map<Projection, double> calculateFor(Jet* MyJet) const;
+
+		//! Does the track pass the MaxD0andZ0 cut
+		bool passesD0andZ0Cut(const Track* MyTrack) const;
+
+		//! Maximum d0 significance, tracks are only used if their significance in a projection is below it
+		double maxD0Significance() const {return _MaxD0Significance;}
+
+		//! Joint probability of one projection
+		/*!
+		As calculateFor, for tracks already found to pass the cuts
+		\param Proj Projection the significances are in
+		\param Significances Absolute significances of the tracks passing the cuts
+		\return the joint probability, -1 if there are no tracks
+		*/
+		double jointProbability(Projection Proj, const std::vector<double> & Significances) const;
 		
 	private:
 		std::string _Name{};
@@ -105,7 +125,31 @@ namespace vertex_lcfi
 		std::vector<double> temp2{};
 		double _MaxD0Significance=0.0;
 		double _MaxD0andZ0=0.0;
-		double probparam(double, int, double  ) const;
+
+		//Resolution function of one projection, with the terms that don't depend on the significance worked out
+		struct ResolutionKernel
+		{
+			//ThreeD has the squared gaussian parametrisation
+			bool ThreeD=false;
+			double Param[5]={0,0,0,0,0};
+			//Scale of the gaussian argument
+			double GaussDenominator=1.0;
+			//Gaussian and tail terms at the maximum significance, subtracted from those at the track
+			double GaussAtMax=0.0;
+			double Tail1AtMax=0.0;
+			double Tail2AtMax=0.0;
+			//Value at significance 0
+			double Norm=1.0;
+
+			void build(const std::vector<double> & Parameters, bool IsThreeD, double MaxSignificance);
+			//Probability (unnormalised) of significance, as probparam
+			double probability(double Significance) const;
+			//Probabilities of N significances
+			void probabilities(const double* Significances, size_t N, double* Probabilities) const;
+		};
+		ResolutionKernel _Kernels[3];
+		//Set up the kernels from the parameters, after any is set
+		void _buildKernels();
 	  };
 
 	}
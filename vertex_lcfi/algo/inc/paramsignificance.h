@@ -98,6 +98,23 @@ namespace vertex_lcfi
 		"Z0SigTrack2","MomentumTrack1","MomentumTrack2".
 		*/
 	       std::map<SignificanceType, double> calculateFor(Jet* MyJet) const;
+
+		//! Does the track pass the momentum cut for the number of layers it hits
+		/*!
+		\param MyTrack Track to check
+		\param Momentum Magnitude of the momentum of MyTrack
+		*/
+		bool passesMomentumCut(const Track* MyTrack, double Momentum) const;
+
+		//! The two tracks with the highest RPhi significance of those added, as kept by calculateFor
+		struct MostSignificant
+		{
+			double D0Significance[2]={-100,-100};
+			double Z0Significance[2]={-100,-100};
+			double Momentum[2]={0,0};
+			//! Add a track passing the cuts
+			void add(double TrackD0Significance, double TrackZ0Significance, double TrackMomentum);
+		};
 		
 	private:		
 		double _LayersHit=0.0;
@@ -76,6 +76,9 @@ namespace vertex_lcfi
 		\return Pointer to Vertex of algorithm result
 		*/
 		Vertex* calculateFor(Event* MyEvent) const;
+		
+		//! Run the algorithm with its event objects held by a given EventContext
+		using Algo<Event*,Vertex*>::calculateFor;
 	
 	private:
 		std::string _Name{};
@@ -32,6 +32,10 @@ namespace vertex_lcfi
 	  \param RPhiCut cut on the maximum RPhi of the vertex that the tracks form.
 	  \param SignificanceCut cut on the minimum rphi significance of the tracks with respect to the IP.
 
+	  Only tracks passing SignificanceCut are paired. The masses are found from the momenta before
+	  any fit, and pairs whose circles in the XY plane are too far apart to pass Chi2Cut (see
+	  util::HelixCircle) are dropped, so the vertex fit is only done for pairs that could be flagged.
+
 	  \author Erik Devetak (e.devetak1@physics.ox.ac.uk)
 	*/
 	class TwoTrackPid:
@@ -95,6 +99,17 @@ namespace vertex_lcfi
 		satisfy these criteria. 
 		*/
 		std::map<PidCutType, std::vector<Track*> > calculateFor(Jet* MyJet) const;
+
+		//! Cut on the minimum rphi significance of the tracks
+		double significanceCut() const {return _SignificanceCut;}
+
+		//! Flag pairs of tracks as calculateFor, for tracks already found to pass SignificanceCut
+		/*!
+		\param Tracks Tracks passing SignificanceCut, in the order they are to be paired (as in the jet)
+		\param Gammas Tracks consistent with gamma->ee are added to this if not in it already
+		\param KShorts Tracks consistent with Ks->pi pi are added to this if not in it already
+		*/
+		void findPairs(const std::vector<Track*> & Tracks, std::vector<Track*> & Gammas, std::vector<Track*> & KShorts) const;
 		
 		private:
 		double _MaxGammaMass=0.0, _MinKsMass=0.0, _MaxKsMass=0.0, _Chi2Cut=0.0,  _RPhiCut=0.0,  _SignificanceCut=0.0;
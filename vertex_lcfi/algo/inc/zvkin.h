@@ -82,6 +82,9 @@ namespace vertex_lcfi
 		*/
 		DecayChain* calculateFor(Jet* MyJet) const;
 		
+		//! Run the algorithm with its event objects held by a given EventContext
+		using Algo<Jet*,DecayChain*>::calculateFor;
+		
 	private:
 		bool _UseEventIP=false;
 		bool _AutoJetAxis=false;
@@ -89,6 +92,9 @@ namespace vertex_lcfi
 		double _MinimumProbability=0.0;
 		double _InitialGhostWidth=0.0;
 		double _MaxChi2Allowed=0.0;
+		int _NumberOfThreads=1;
+		//Ghost direction fitted to the jet tracks rather than from the jet core weighting only
+		bool _FitGhostToTracks=false;
 		
 		
 	};
@@ -5,6 +5,7 @@
 #include <inc/decaychain.h>
 #include <string>
 #include <vector>
+#include <atomic>
 #include <util/inc/vector3.h>
 
 using std::string;
@@ -82,9 +83,44 @@ namespace vertex_lcfi
 		*/
 		DecayChain* calculateFor(Jet* MyJet) const;
 		
+		//! Run the algorithm with its event objects held by a given EventContext
+		using Algo<Jet*,DecayChain*>::calculateFor;
+		
+		//! Number of track pairs considered for two prong vertices, over all jets so far
+		inline long numPairsTried() const
+		{return _NumPairsTried;}
+		
+		//! Number of those not fitted as they were further apart than PairCutSigmas
+		inline long numPairsCut() const
+		{return _NumPairsCut;}
+		
+		//! Number of points the vertex function was found at, over all jets so far
+		inline long numVertexFuncValues() const
+		{return _NumVertexFuncValues;}
+		
+		//! Number of points the vertex function derivatives were found at, over all jets so far
+		inline long numVertexFuncDerivatives() const
+		{return _NumVertexFuncDerivatives;}
+		
 	private:
 		double _Kip,_Kalpha,_TwoProngCut,_TrackTrimCut,_ResolverCut;
 		bool _AutoJetAxis,_UseEventIP;
+		int _NumberOfThreads;
+		double _PairCutSigmas;
+		double _TubeCutSigmas;
+		//Jets may be done on several threads at once
+		mutable std::atomic<long> _NumPairsTried{0};
+		mutable std::atomic<long> _NumPairsCut{0};
+		mutable std::atomic<long> _NumVertexFuncValues{0};
+		mutable std::atomic<long> _NumVertexFuncDerivatives{0};
+		//VertexFuncMaxFinderNewton rather than the fallback classic stepper
+		bool _NewtonMaxFinder;
+		//VertexResolverGoldenSection rather than the fallback equal steps
+		bool _GoldenSectionResolver;
+		//Candidate vertices update their fits as tracks change rather than fitting again
+		bool _IncrementalFit;
+		//Vertex fits seeded by VertexFitterLSM::LinearSeed rather than the pairwise seed
+		bool _LinearFitterSeed;
 		Vector3 _JetAxis{};
 	};
 }
@@ -43,13 +43,26 @@ namespace vertex_lcfi
   
   std::map<DecaySignificanceType ,double> VertexDecaySignificance::calculateFor(DecayChain* MyDecayChain) const
   {
-    double distance = 0;
-    double significance = 0;
     double maxsig = 0;
     double maxdistance = 0;
-    double error = 0;
     std::map<DecaySignificanceType,double> ResultMap;
 
+    this->findMostSignificant(MyDecayChain, maxdistance, maxsig);
+
+    ResultMap[Significance] =  maxsig;
+    ResultMap[Distance] =  maxdistance;
+    //return distance
+    return ResultMap;
+  }
+
+  void VertexDecaySignificance::findMostSignificant(DecayChain* MyDecayChain, double & maxdistance, double & maxsig) const
+  {
+    double distance = 0;
+    double significance = 0;
+    double error = 0;
+    maxsig = 0;
+    maxdistance = 0;
+
     if (MyDecayChain->vertices().size()>1) //If we have more than just the IP
       {
 	//Look at the distances between vertices.
@@ -78,11 +91,6 @@ namespace vertex_lcfi
 	      }
 	  } 
       }
-
-    ResultMap[Significance] =  maxsig;
-    ResultMap[Distance] =  maxdistance;
-    //return distance
-    return ResultMap;
   }
 
 
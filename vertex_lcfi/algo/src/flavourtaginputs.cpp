@@ -0,0 +1,88 @@
+#include <algo/inc/flavourtaginputs.h>
+#include <inc/jet.h>
+#include <inc/track.h>
+#include <inc/vertex.h>
+#include <inc/decaychain.h>
+#include <util/inc/projection.h>
+#include <algorithm>
+#include <cmath>
+
+namespace vertex_lcfi
+{
+	using namespace util;
+
+	const char* FlavourTagInputSet::name(Input Index)
+	{
+		static const char* Names[NumInputs] = {"JointProbRPhi", "JointProbZ",
+			"D0Significance1", "D0Significance2", "Z0Significance1", "Z0Significance2", "Momentum1", "Momentum2",
+			"NumTracksInVertices", "DecayLength", "DecayLengthSignificance",
+			"RawMomentum", "PTCorrectedMass", "SecondaryVertexProbability",
+			"NumVertices", "DecayLength(SeedToIP)"};
+		return Names[Index];
+	}
+
+	void FlavourTagInputs::calculateFor(Jet* MyJet, DecayChain* MyDecayChain, FlavourTagInputSet & Inputs) const
+	{
+		double* Value = Inputs.Value;
+		_RPhiSignificances.clear();
+		_ZSignificances.clear();
+		_PidTracks.clear();
+		_Gammas.clear();
+		_KShorts.clear();
+		_MomentumTracks.clear();
+
+		//Everything wanted from the tracks alone, in jet order
+		const double MaxD0Significance = _JointProb.maxD0Significance();
+		const double PidSignificanceCut = _TwoTrackPid.significanceCut();
+		for (std::vector<Track*>::const_iterator iTrack = MyJet->tracks().begin();iTrack != MyJet->tracks().end();++iTrack)
+		{
+			const double RPhiSignificance = (*iTrack)->significance(RPhi);
+			if (_JointProb.passesD0andZ0Cut(*iTrack))
+			{
+				if (fabs(RPhiSignificance) < MaxD0Significance)
+					_RPhiSignificances.push_back(fabs(RPhiSignificance));
+				const double ZSignificance = fabs((*iTrack)->significance(Z));
+				if (ZSignificance < MaxD0Significance)
+					_ZSignificances.push_back(ZSignificance);
+			}
+			if (RPhiSignificance > PidSignificanceCut)
+				_PidTracks.push_back(*iTrack);
+			const double Momentum = (*iTrack)->momentum().mag();
+			if (_ParameterSignificance.passesMomentumCut(*iTrack, Momentum))
+				_MomentumTracks.push_back(std::make_pair(*iTrack, Momentum));
+		}
+
+		Value[FlavourTagInputSet::JointProbRPhi] = _JointProb.jointProbability(RPhi, _RPhiSignificances);
+		Value[FlavourTagInputSet::JointProbZ] = _JointProb.jointProbability(Z, _ZSignificances);
+
+		//The two most significant tracks not flagged as from a gamma or Ks
+		_TwoTrackPid.findPairs(_PidTracks, _Gammas, _KShorts);
+		ParameterSignificance::MostSignificant Most;
+		for (std::vector<std::pair<Track*,double> >::const_iterator iTrack = _MomentumTracks.begin();iTrack != _MomentumTracks.end();++iTrack)
+		{
+			if (std::find(_Gammas.begin(), _Gammas.end(), iTrack->first) != _Gammas.end()) continue;
+			if (std::find(_KShorts.begin(), _KShorts.end(), iTrack->first) != _KShorts.end()) continue;
+			const double D0Significance = iTrack->first->signedSignificance(RPhi, MyJet);
+			const double Z0Significance = iTrack->first->signedSignificance(Z, MyJet);
+			Most.add(D0Significance, Z0Significance, iTrack->second);
+		}
+		Value[FlavourTagInputSet::D0Significance1] = Most.D0Significance[0];
+		Value[FlavourTagInputSet::D0Significance2] = Most.D0Significance[1];
+		Value[FlavourTagInputSet::Z0Significance1] = Most.Z0Significance[0];
+		Value[FlavourTagInputSet::Z0Significance2] = Most.Z0Significance[1];
+		Value[FlavourTagInputSet::Momentum1] = Most.Momentum[0];
+		Value[FlavourTagInputSet::Momentum2] = Most.Momentum[1];
+
+		Value[FlavourTagInputSet::NumTracksInVertices] = _VertexMultiplicity.calculateFor(MyDecayChain);
+		_VertexDecaySignificance.findMostSignificant(MyDecayChain, Value[FlavourTagInputSet::DecayLength], Value[FlavourTagInputSet::DecayLengthSignificance]);
+
+		//The attached chain keeps the track sums and fit, shared by these three
+		DecayChain* AttachedTracksChain = _TrackAttach.calculateFor(MyDecayChain);
+		Value[FlavourTagInputSet::RawMomentum] = _VertexMomentum.calculateFor(AttachedTracksChain);
+		Value[FlavourTagInputSet::PTCorrectedMass] = _VertexMass.calculateFor(AttachedTracksChain);
+		Value[FlavourTagInputSet::SecondaryVertexProbability] = _SecVertexProb.calculateFor(AttachedTracksChain);
+
+		Value[FlavourTagInputSet::NumVertices] = MyDecayChain->vertices().size();
+		Value[FlavourTagInputSet::DecayLengthSeedToIP] = MyDecayChain->seedVertex()->position().mag();
+	}
+}
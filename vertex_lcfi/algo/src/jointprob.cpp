@@ -55,6 +55,7 @@ namespace vertex_lcfi
     _ParameterValues.push_back("Default Values");
     _ParameterValues.push_back("Default Values");
 
+    this->_buildKernels();
   }
 
   string JointProb::name() const
@@ -96,6 +97,7 @@ namespace vertex_lcfi
     if (Parameter == "MaxD0Significance")
        {
 	 _MaxD0Significance = Value;
+	 this->_buildKernels();
 	 return;
        }
     if (Parameter == "MaxD0andZ0")
@@ -111,16 +113,19 @@ namespace vertex_lcfi
      if (Parameter == "ResolutionParameterRphi")
        {
 	 _ResolutionParameterRphi = *(std::vector<double>*) Value;
+	 this->_buildKernels();
 	 return;
        }
    if (Parameter == "ResolutionParameterZ")
       {
 	_ResolutionParameterZ = *(std::vector<double>*) Value;
+	this->_buildKernels();
 	return;
       }
    if (Parameter == "ResolutionParameter3D")
       {
 	_ResolutionParameter3D = *(std::vector<double>*) Value;
+	this->_buildKernels();
 	return;
       }
     else this->badParameter(Parameter);
@@ -131,17 +136,12 @@ namespace vertex_lcfi
 
     std::map<Projection,double> ResultMap;
         
-    
-    double totalprod[3] = {1,1,1};
-    double jprob[3] = {0,0,0};
-    int ntraks[3] = {0,0,0};
     int j= 0;  
-    int k= 0;
-    double maxdz = _MaxD0andZ0; // maximum cuts for d0 and z0 implemented below
     double maxd0sig = _MaxD0Significance; // maximum cuts for d0 significance implemented below
     double significancecompare = 0;
-    float sigma = 0 ; 
-    float fact =0;
+    //significances passing the cuts, for each of (d0,z0,3-d)
+    std::vector<double> passed[3];
+    const Projection projections[3] = {RPhi, Z, ThreeD};
     
 
      
@@ -149,132 +149,128 @@ namespace vertex_lcfi
       {
 	//series of cuts
 	
-	if( fabs( (*iTrack)->helixRep().d0() )< maxdz  && fabs( (*iTrack)->helixRep().z0() ) < maxdz  )
+	if( this->passesD0andZ0Cut(*iTrack) )
 	  {
 	    
 	    //(d0,z0,3-d)
 	    for(j = 0; j<3; j++ )
 	      {
-		switch (j)
-		{
-		case 0:
-		  {
-		    significancecompare =  fabs((*iTrack)->significance(RPhi));
-		    break;
-		  }
-		case 1:
-		  {
-		    significancecompare =  fabs((*iTrack)->significance( Z/*,MyJet->momentum()*/  ));
-
-		    break;
-		  }
-		case 2:
-		  {
-		   significancecompare = fabs((*iTrack)->significance(ThreeD));
-		   break;
-		  }
-		} 
+		significancecompare =  fabs((*iTrack)->significance(projections[j]));
 			  
 		if( significancecompare < maxd0sig )
-		  {
-		    
-		    //calculate vertex parameter probability and multiply them, notice the normalization function
-		    totalprod[j] *=  probparam( significancecompare  ,j , maxd0sig )/ probparam( 0  , j, maxd0sig  );
-		    
-
-		    ntraks[j]++;
-		  }
+		  passed[j].push_back(significancecompare);
 	      }
 	  }
       }
     
-
-    
     for( j = 0; j<3; j++ )
-      {
-	
-	if( ntraks[j]>0 )
-	  {
-	    fact =1;
-	    sigma = 0;
+      ResultMap[projections[j]] = this->jointProbability(projections[j], passed[j]);
+    
+    return ResultMap;
+  }
+
+  bool JointProb::passesD0andZ0Cut(const Track* MyTrack) const
+  {
+    double maxdz = _MaxD0andZ0; // maximum cuts for d0 and z0
+    return fabs( MyTrack->helixRep().d0() )< maxdz  && fabs( MyTrack->helixRep().z0() ) < maxdz;
+  }
+
+  double JointProb::jointProbability(Projection Proj, const std::vector<double> & Significances) const
+  {
+    //kernels are in the order (d0,z0,3-d)
+    const ResolutionKernel & Kernel = _Kernels[Proj == RPhi ? 0 : (Proj == Z ? 1 : 2)];
+    int ntraks = Significances.size();
+    double totalprod = 1;
+    float sigma = 0 ; 
+    float fact =0;
+    int k= 0;
+
+    if( ntraks == 0 )
+      return -1; //default no chance value
+
+    //calculate vertex parameter probability and multiply them, notice the normalization function
+    std::vector<double> prob(ntraks);
+    Kernel.probabilities(&Significances[0], ntraks, &prob[0]);
+    for( k = 0; k < ntraks; k++ )
+      totalprod *= prob[k] / Kernel.Norm;
+
+    fact =1;
+    sigma = 0;
 	    
-	    for( k =0; k <  ntraks[j]; k++ ) 
-	      {
+    for( k =0; k <  ntraks; k++ ) 
+      {
 		
-		if( k > 0 ) fact *= k;
-		else	  fact = 1 ;
+	if( k > 0 ) fact *= k;
+	else	  fact = 1 ;
 		
-		//the summation over the tracks
+	//the summation over the tracks
 		
-		sigma += pow( ( -log( totalprod[j] ) ), k ) / fact;
+	sigma += pow( ( -log( totalprod ) ), k ) / fact;
 		
-	      }
-	    //and here we combine everything in the final probability
-	    jprob[j] = totalprod[j] * sigma;
-	  }
-	
-	else jprob [j] = -1; //default no chance value
       }
-
-    ResultMap[RPhi] = jprob[0];
-    ResultMap[Z] = jprob[1];
-    ResultMap[ThreeD] = jprob[2];
-    
-    return ResultMap;
+    //and here we combine everything in the final probability
+    return totalprod * sigma;
   }
   
-  double JointProb::probparam(double parameter, int thecoord, double maxd0sig   ) const
+  void JointProb::_buildKernels()
   {
-    
-    double prob = 0;
-    double resolutionparameters[3][5];
-    if (_ResolutionParameterRphi.size() != 5 || _ResolutionParameterZ.size() != 5 || _ResolutionParameter3D.size() != 5) 
-    std::cerr << "Warning jointprob.cpp:229 Parameters of wrong length" << std::endl;
+    _Kernels[0].build(_ResolutionParameterRphi, false, _MaxD0Significance);
+    _Kernels[1].build(_ResolutionParameterZ, false, _MaxD0Significance);
+    _Kernels[2].build(_ResolutionParameter3D, true, _MaxD0Significance);
+  }
+
+  void JointProb::ResolutionKernel::build(const std::vector<double> & Parameters, bool IsThreeD, double MaxSignificance)
+  {
+    if (Parameters.size() != 5)
+      std::cerr << "Warning jointprob.cpp:229 Parameters of wrong length" << std::endl;
     for( int iii=0; iii<5; iii++)
-    {
-	resolutionparameters[0][iii] = _ResolutionParameterRphi[iii];
-	resolutionparameters[1][iii] = _ResolutionParameterZ[iii];
-	resolutionparameters[2][iii] = _ResolutionParameter3D[iii];
-    }
+      Param[iii] = (iii < int(Parameters.size())) ? Parameters[iii] : 0.0;
+    ThreeD = IsThreeD;
     
     // The if statement takes into account a different parametrization for different coordinates. 
-    if ( thecoord < 2 )
+    if ( !ThreeD )
       {
 	// part one is the gaussian part
 	// to understand this part better one should look at the meaning of the complementary error function
-	prob = erfc( parameter / (sqrt( double(2) ) * resolutionparameters[thecoord][0] ))
-	  -erfc( maxd0sig / ( sqrt( double(2) ) *  resolutionparameters[thecoord][0] ) );
-	
+	GaussDenominator = sqrt( double(2) ) * Param[0];
+	GaussAtMax = erfc( MaxSignificance / GaussDenominator );
 	// part 2 is the added exponential tails
-      
-      prob += resolutionparameters[thecoord][1]* ( exp(- resolutionparameters[thecoord][2] * parameter )
-						   -exp(- resolutionparameters[thecoord][2] * maxd0sig ) )
-	+resolutionparameters[thecoord][3]* ( exp(- resolutionparameters[thecoord][4] * parameter )
-					      -exp(- resolutionparameters[thecoord][4] * maxd0sig ) );
-      
-      
+	Tail1AtMax = exp(- Param[2] * MaxSignificance );
+	Tail2AtMax = exp(- Param[4] * MaxSignificance );
       }
     else
       {
-	
 	//in this view the gaussian part is just squared. 
-	
-	prob = exp(- ( parameter * parameter ) /  ( resolutionparameters[thecoord][0] * resolutionparameters[thecoord][0] * double ( 2 ) ) ) 
-	  -exp(- ( maxd0sig * maxd0sig )  /  ( resolutionparameters[thecoord][0] * resolutionparameters[thecoord][0] * double ( 2 ) ) );
-
-	prob +=  resolutionparameters[thecoord][1]* ( ( 1 + resolutionparameters[thecoord][2] * parameter )
-						      *exp ( - resolutionparameters[thecoord][2] * parameter )
-						      - ( 1 + resolutionparameters[thecoord][2] * maxd0sig )
-						      *exp ( - resolutionparameters[thecoord][2] * maxd0sig ))
-	  +resolutionparameters[thecoord][3]* ( ( 1 + resolutionparameters[thecoord][4] * parameter )
-						*exp ( - resolutionparameters[thecoord][4] * parameter )
-						- ( 1 + resolutionparameters[thecoord][4] * maxd0sig )
-						*exp ( - resolutionparameters[thecoord][4] * maxd0sig ));
-	
+	GaussDenominator = Param[0] * Param[0] * double ( 2 );
+	GaussAtMax = exp(- ( MaxSignificance * MaxSignificance ) / GaussDenominator );
+	Tail1AtMax = ( 1 + Param[2] * MaxSignificance ) * exp ( - Param[2] * MaxSignificance );
+	Tail2AtMax = ( 1 + Param[4] * MaxSignificance ) * exp ( - Param[4] * MaxSignificance );
       }
+    Norm = this->probability(0);
+  }
 
+  double JointProb::ResolutionKernel::probability(double Significance) const
+  {
+    double prob;
+    if ( !ThreeD )
+      {
+	prob = erfc( Significance / GaussDenominator ) - GaussAtMax;
+	prob += Param[1] * ( exp(- Param[2] * Significance ) - Tail1AtMax )
+	  + Param[3] * ( exp(- Param[4] * Significance ) - Tail2AtMax );
+      }
+    else
+      {
+	prob = exp(- ( Significance * Significance ) / GaussDenominator ) - GaussAtMax;
+	prob += Param[1] * ( ( 1 + Param[2] * Significance ) * exp ( - Param[2] * Significance ) - Tail1AtMax )
+	  + Param[3] * ( ( 1 + Param[4] * Significance ) * exp ( - Param[4] * Significance ) - Tail2AtMax );
+      }
     return prob;
-    
+  }
+
+  void JointProb::ResolutionKernel::probabilities(const double* Significances, size_t N, double* Probabilities) const
+  {
+    for (size_t i = 0; i < N; ++i)
+      Probabilities[i] = this->probability(Significances[i]);
   }
   
   
@@ -89,23 +89,15 @@ namespace vertex_lcfi
   
   std::map<SignificanceType ,double> ParameterSignificance::calculateFor(Jet* MyJet) const
   {
-    double maxsig = -100;
-    double maxsig2 = -100;
     double momentum = 0;
-    double maxmom = 0;
-    double maxmom2 = 0;
-    double maxz0 = -100;
-    double maxz02 = -100;
-    
-    double mommin4 = _AllbutOneLayersMomentumCut;
-    double mommin5 = _AllLayersMomentumCut;
+    MostSignificant Most;
     std::map<SignificanceType,double> ResultMap;
  
     for (std::vector<Track*>::const_iterator iTrack= (MyJet->tracks().begin()); iTrack != (MyJet->tracks().end()) ;++iTrack)
       {
 	momentum =  (*iTrack)->momentum().mag();
 	
-	if ( (momentum > mommin4 && (*iTrack)->hitsInSubDetectors()[0] == (_LayersHit-1))|| (momentum > mommin5 && (*iTrack)->hitsInSubDetectors()[0] >= _LayersHit )) 
+	if ( this->passesMomentumCut(*iTrack, momentum) ) 
 	  {
 
 	    //check that we have not assigned this track to a gamma or to a Ks
@@ -118,37 +110,47 @@ namespace vertex_lcfi
 	      {
 		double d0significance =  (*iTrack)->signedSignificance(RPhi,MyJet);
 		double z0significance =  (*iTrack)->signedSignificance(Z,MyJet);
-	
-		if (d0significance > maxsig)
-		  {
-		    maxsig2 = maxsig;
-		    maxmom2 = maxmom;
-		    maxz02  = maxz0;
-		    maxsig = d0significance;
-		    maxmom = momentum;
-		    maxz0  = z0significance;
-		  }
-		else if(d0significance > maxsig2)
-		  {
-		    maxsig2 = d0significance;
-		    maxmom2 = momentum;
-		    maxz02  = z0significance;
-		  }
-		
+		Most.add(d0significance, z0significance, momentum);
 	      }
 	    
 	  } 
       }
     
-    ResultMap[D0SigTrack1] =  maxsig;
-    ResultMap[D0SigTrack2] =  maxsig2;
-    ResultMap[Z0SigTrack1] =  maxz0;
-    ResultMap[Z0SigTrack2] =  maxz02;
-    ResultMap[MomentumTrack1] =  maxmom;
-    ResultMap[MomentumTrack2] =  maxmom2;
+    ResultMap[D0SigTrack1] =  Most.D0Significance[0];
+    ResultMap[D0SigTrack2] =  Most.D0Significance[1];
+    ResultMap[Z0SigTrack1] =  Most.Z0Significance[0];
+    ResultMap[Z0SigTrack2] =  Most.Z0Significance[1];
+    ResultMap[MomentumTrack1] =  Most.Momentum[0];
+    ResultMap[MomentumTrack2] =  Most.Momentum[1];
     
     //return distance
     return ResultMap;
   }
+
+  bool ParameterSignificance::passesMomentumCut(const Track* MyTrack, double Momentum) const
+  {
+    double mommin4 = _AllbutOneLayersMomentumCut;
+    double mommin5 = _AllLayersMomentumCut;
+    return (Momentum > mommin4 && MyTrack->hitsInSubDetectors()[0] == (_LayersHit-1))|| (Momentum > mommin5 && MyTrack->hitsInSubDetectors()[0] >= _LayersHit );
+  }
+
+  void ParameterSignificance::MostSignificant::add(double TrackD0Significance, double TrackZ0Significance, double TrackMomentum)
+  {
+    if (TrackD0Significance > D0Significance[0])
+      {
+	D0Significance[1] = D0Significance[0];
+	Momentum[1] = Momentum[0];
+	Z0Significance[1]  = Z0Significance[0];
+	D0Significance[0] = TrackD0Significance;
+	Momentum[0] = TrackMomentum;
+	Z0Significance[0]  = TrackZ0Significance;
+      }
+    else if(TrackD0Significance > D0Significance[1])
+      {
+	D0Significance[1] = TrackD0Significance;
+	Momentum[1] = TrackMomentum;
+	Z0Significance[1]  = TrackZ0Significance;
+      }
+  }
   
 }
@@ -3,9 +3,6 @@
 #include <inc/decaychain.h>
 #include <inc/jet.h>
 #include <inc/track.h>
-#include <inc/trackstate.h>
-#include <zvtop/include/interactionpoint.h>
-#include <zvtop/include/vertexfitterlsm.h>
 #include <util/inc/util.h>
 #include <util/inc/string.h>
 #include <vector>
@@ -20,7 +17,6 @@ namespace vertex_lcfi
 {
 
   using std::string;
-  using namespace ZVTOP;
   
   SecVertexProb::SecVertexProb()
   {
@@ -82,16 +78,9 @@ namespace vertex_lcfi
     double chi2;
     double ndf;
     double ntrk;
-    InteractionPoint* IP = 0;
-    std::vector< TrackState* > AllTrackStates;
 
-    for (std::vector<Track*>::const_iterator iTrack = (MyDecayChain->allTracks().begin()); iTrack != MyDecayChain->allTracks().end() ;++iTrack)
-      {
-	AllTrackStates.push_back( (**iTrack).makeState() );
-      }
-    // fit vertex
-    VertexFitterLSM Fitter;
-    Fitter.fitVertex( AllTrackStates, IP,  Position, chi2  );
+    // fit vertex, kept in the decay chain for any other algorithm wanting it
+    MyDecayChain->allTracksFit( Position, chi2 );
     ntrk = MyDecayChain->allTracks().size();
 
     //also this comes down from the cern libraries, known propriety of gamma distribution. 
@@ -100,33 +100,19 @@ namespace vertex_lcfi
     dummy.clear();
     double closeapproach;
     double LoD;
-    int numberoftracks = 0;
-    int  vertexcounter = 0;
-    int tempvertex =0;
     DecayChain* DecaywithAtTracks = new DecayChain(*MyDecayChain);
     MemoryManager<DecayChain> ::Event()->registerObject(DecaywithAtTracks);
     std::vector<vertex_lcfi::Track > AttachedTracks;
     std::vector<Track*> Innertracks;
     
-    for (std::vector<Vertex*>::const_iterator iVertex = (MyDecayChain->vertices().begin()); iVertex != MyDecayChain->vertices().end() ;++iVertex)
-      {
-
-	numberoftracks = (*iVertex)->tracks( ).size();
-
-	if ( numberoftracks > 1 || vertexcounter > 0 )
-	  {
-	    tempvertex = vertexcounter;
-	  }
-	vertexcounter++;
-      }
-    
-    tempvertex = (MyDecayChain->vertices().size()-1);
+    //the seed is the last vertex
+    Vertex* SeedVertex = MyDecayChain->seedVertex();
     
     if (MyDecayChain->vertices().empty())
 	    std::cerr << "Empty Decay Chain - trackattach.cpp:119" << std::endl;
 
 
-    VertexPos = (MyDecayChain->vertices()[tempvertex]->position()).subtract( (MyDecayChain->vertices()[0])->position() );
+    VertexPos = (SeedVertex->position()).subtract( (MyDecayChain->vertices()[0])->position() );
 
     distance =  VertexPos.mag();
 
@@ -183,7 +169,7 @@ namespace vertex_lcfi
 	    // we swim near to the vertex since the cut is then perfomed at the vertex.
 	    //so if we have too many iterations we can cut the track
 
-	    TSLin->swimToStateNearest( MyDecayChain->vertices()[tempvertex]->position() );
+	    TSLin->swimToStateNearest( SeedVertex->position() );
 
        	    TSLin->swimToStateNearest( TSHel );
 	    TSHel->swimToStateNearest( TSLin );
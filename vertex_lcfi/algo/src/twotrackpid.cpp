@@ -4,10 +4,14 @@
 #include <inc/jet.h>
 #include <inc/track.h>
 #include <inc/trackstate.h>
+#include <inc/trackpath.h>
 #include <zvtop/include/interactionpoint.h>
 #include <zvtop/include/vertexfitterlsm.h>
 #include <util/inc/string.h>
 #include <util/inc/memorymanager.h>
+#include <util/inc/helixcircle.h>
+#include <algorithm>
+#include <cmath>
 
 using std::string;
 using namespace vertex_lcfi::util;
@@ -16,6 +20,22 @@ namespace vertex_lcfi
 {
         using namespace ZVTOP;
 
+	namespace
+	{
+		//What the pair tests need of a track, found once rather than for every pair it is in
+		struct PairTrack
+		{
+			explicit PairTrack(Track* ATrack)
+			: MyTrack(ATrack),Momentum2(ATrack->momentum().mag2()),
+			  D0Variance(ATrack->positionCovarianceAt(0)(0,0)),Circle(ATrack->helixRep())
+			{}
+			Track* MyTrack;
+			double Momentum2;
+			double D0Variance;
+			HelixCircle Circle;
+		};
+	}
+
   TwoTrackPid::TwoTrackPid()
 	{
 	  _MaxGammaMass = 0.02;
@@ -101,6 +121,28 @@ namespace vertex_lcfi
 	}
 	
         std::map< PidCutType,std::vector<Track*> > TwoTrackPid::calculateFor(Jet* MyJet) const
+	{
+	  //just a dummy for initialization
+	  std::vector<Track*> Dummy;
+	  std::map<PidCutType,std::vector<Track*> > ResultMap;
+
+	  ResultMap[Gamma] = Dummy;
+	  ResultMap[KShort] = Dummy;
+
+	  //tracks passing the d0 significance cut, kept in jet order so pairs are taken in the same order as over all tracks
+	  std::vector<Track*> Selected;
+	  for(std::vector<Track*>::const_iterator iTrack= MyJet->tracks().begin(); iTrack != MyJet->tracks().end() ;++iTrack)
+	    {
+	      if( (*iTrack)->significance(RPhi) > _SignificanceCut  )
+		Selected.push_back(*iTrack);
+	    }
+
+	  this->findPairs(Selected, ResultMap[Gamma], ResultMap[KShort]);
+	  return ResultMap;
+	  
+	}
+
+	void TwoTrackPid::findPairs(const std::vector<Track*> & Tracks, std::vector<Track*> & Gammas, std::vector<Track*> & KShorts) const
 	{
 	  
 	  Vector3 Position;
@@ -110,7 +152,6 @@ namespace vertex_lcfi
 	  double RPhiProjection;
 	  InteractionPoint* IP = 0;
 	  double momentummagnitude;
-	  std::vector< TrackState* > AllTrackStates;
 	  VertexFitterLSM Fitter;
 	  double eeCalculatedM = 0;
 	  double pipiCalculatedM = 0;
@@ -122,130 +163,84 @@ namespace vertex_lcfi
 	  double MaxKsMass = _MaxKsMass;
 	  double Chi2Cut = _Chi2Cut;
 	  double RPhiCut = _RPhiCut;
-	  double significancecut = _SignificanceCut;
 
-	  //just a dummy for initialization
-	  std::vector<Track*> Dummy;
-	  std::map<PidCutType,std::vector<Track*> > ResultMap;
+	  std::vector<PairTrack> Selected(Tracks.begin(), Tracks.end());
 
-	  ResultMap[Gamma] = Dummy;
-	  ResultMap[KShort] = Dummy;
+	  //loop over pairs of selected tracks, the cheap tests first and the vertex fit only for pairs left
+	  for(std::vector<PairTrack>::const_iterator iPair= Selected.begin(); iPair != Selected.end() ;++iPair)
+	    {
+	      for(std::vector<PairTrack>::const_iterator iPair2 = iPair+1 ; iPair2 != Selected.end() ;++iPair2)
+		{
+		  //chack that the charge of the tracks is opposite)
+		  if ((iPair->MyTrack->charge() + iPair2->MyTrack->charge()) != 0)
+		    continue;
+
+		  //the masses only need the momenta, so are found before the fit
+		  Vector3 Totalmomentum;
+		  Totalmomentum = Totalmomentum.add(iPair2->MyTrack->momentum());
+		  Totalmomentum = Totalmomentum.add(iPair->MyTrack->momentum());
+		  momentummagnitude = Totalmomentum.mag2();
+
+		  //here we are just using the standard e^2 =m^2 +p^2s
+		  //first with the electron mass
+		  eeCalculatedM = pow(sqrt(iPair2->Momentum2+electronmass2)+
+				      sqrt(iPair->Momentum2+electronmass2),2)-  momentummagnitude;
+		  if (eeCalculatedM >0)
+		    eeCalculatedM = sqrt(eeCalculatedM);
+		  else
+		    eeCalculatedM = 0;
+
+		  //then assume pion mass
+		  pipiCalculatedM = pow(sqrt(iPair2->Momentum2+pionmass2)+
+					sqrt(iPair->Momentum2+pionmass2),2)-  momentummagnitude;
+		  if (pipiCalculatedM >0)
+		    pipiCalculatedM = sqrt(pipiCalculatedM);
+		  else
+		    pipiCalculatedM = 0;
+
+		  //here we assume that a track will never end up in both
+		  //given the different mass I think it is a fair assumption
+		  std::vector<Track*>* Flagged = 0;
+		  if(eeCalculatedM < MaxGammaMass)
+		    Flagged = &Gammas;
+		  else if( MinKsMass < pipiCalculatedM && pipiCalculatedM < MaxKsMass )
+		    Flagged = &KShorts;
+		  if (!Flagged)
+		    continue;
+
+		  //the chi squared of the fit is at least the gap between the circles of the tracks in the XY plane
+		  //squared over the sum of their d0 variances, so pairs that could not pass the cut are not fitted.
+		  //The gap is taken a little small to allow for the precision of the distances in the fit.
+		  if (iPair->MyTrack->charge() != 0)
+		    {
+		      const double Gap = iPair->Circle.gapTo(iPair2->Circle) - 2*TrackPath::Precision;
+		      if (Gap > 0 && Gap*Gap >= Chi2Cut*(iPair->D0Variance + iPair2->D0Variance))
+			continue;
+		    }
 
-	  //nested loop running over pairs of tracks. 
+		  //vertex the tracks and see what happens. 
+		  TrackState State(iPair->MyTrack);
+		  TrackState State2(iPair2->MyTrack);
+		  std::vector< TrackState* > PairStates;
+		  PairStates.push_back(&State);
+		  PairStates.push_back(&State2);
 
+		  Fitter.fitVertex( PairStates, IP,  Position, chi2  );
 
-	  if( MyJet->tracks().size()>0)
-	    {
-	      for(std::vector<Track*>::const_iterator iTrack= (MyJet->tracks().begin()); iTrack != --(MyJet->tracks().end()) ;++iTrack)
-		{
-		  
-		  for(std::vector<Track*>::const_iterator iTrack2 =  iTrack+1 ; iTrack2 != (MyJet->tracks().end()) ;++iTrack2)
+		  //the rphi projection
+		  RPhiProjection = Position.mag(RPhi);
+
+		  //cuts on position of the vertecs and its significance. 
+		  if( RPhiProjection < RPhiCut && chi2< Chi2Cut  )
 		    {
-		      //check first track d0 significance
-
-		      if( (*iTrack)->significance(RPhi) > significancecut  )
-			{
-			  
-			  AllTrackStates.push_back( (**iTrack).makeState() );
-			  
-			  //check second track d0 significance
-			  if( (*iTrack2)->significance(RPhi) > significancecut  )      
-			    {
-			      
-			      //chack that the charge of the tracks is opposite)
-			   if (((*iTrack)->charge() + (*iTrack2)->charge()) == 0)
-			     {
-			       //vertex the tracks and see what happens. 
-			       AllTrackStates.push_back( (**iTrack2).makeState() );
-			       
-			       Fitter.fitVertex( AllTrackStates, IP,  Position, chi2  );
-			       
-			       //the rphi projection
-			       RPhiProjection = Position.mag(RPhi);
-			       
-			       //cuts on position of the vertecs and its significance. 
-			       if( RPhiProjection < RPhiCut && chi2< Chi2Cut  )
-				 {
-				   Vector3 Totalmomentum;
-				   Totalmomentum = Totalmomentum.add((**iTrack2).momentum());
-				   Totalmomentum = Totalmomentum.add((**iTrack).momentum());
-				   momentummagnitude = Totalmomentum.mag2();
-				   
-				   //here we are just using the standard e^2 =m^2 +p^2s
-				   //first with the electron mass
-
-				   eeCalculatedM = pow(sqrt((**iTrack2).momentum().mag2()+electronmass2)+
-						       sqrt((**iTrack).momentum().mag2()+electronmass2),2)-  momentummagnitude;
-				   if (eeCalculatedM >0)
-				     {
-				       eeCalculatedM = sqrt(eeCalculatedM);
-				       
-				     }
-				   else
-				     {
-				       eeCalculatedM = 0;
-				     }
-
-				  //then assume pion mass
-				   
-				   pipiCalculatedM = pow(sqrt((**iTrack2).momentum().mag2()+pionmass2)+
-							 sqrt((**iTrack).momentum().mag2()+pionmass2),2)-  momentummagnitude;
-				   if (pipiCalculatedM >0)
-				     {
-				       pipiCalculatedM = sqrt(pipiCalculatedM);
-				     }
-				   else
-				     {
-				       pipiCalculatedM = 0;
-				     }
-				   
-
-				   //here we assume that a track will never end up in both
-				   //given the different mass I think it is a fair assumption
-				   if(eeCalculatedM < MaxGammaMass)
-				     {
-
-				       //these algorithms basically put the tracks into the map in the case that they are not there already!
-				       std::vector<Track*>::const_iterator iTrack3 = find(ResultMap[Gamma].begin(),ResultMap[Gamma].end(), (*iTrack));
-				       if(iTrack3 == ResultMap[Gamma].end() )
-					 {
-					   ResultMap[Gamma].push_back(*iTrack);
-					 }
-				       
-				       
-				       std::vector<Track*>::const_iterator iTrack4 = find(ResultMap[Gamma].begin(),ResultMap[Gamma].end(), (*iTrack2)); 
-				       if(iTrack4 == ResultMap[Gamma].end() )
-					 {
-					   ResultMap[Gamma].push_back(*iTrack2);
-					 }
-				     }
-				   else if( MinKsMass < pipiCalculatedM && pipiCalculatedM < MaxKsMass )
-				     { 
-				       std::vector<Track*>::const_iterator iTrack3 = find(ResultMap[KShort].begin(),ResultMap[KShort].end(), (*iTrack));
-				       if(iTrack3 == ResultMap[KShort].end() )
-					 {
-					   ResultMap[KShort].push_back(*iTrack);
-
-					 }
-				       std::vector<Track*>::const_iterator iTrack4 = find(ResultMap[KShort].begin(),ResultMap[KShort].end(), (*iTrack2));
-				       if(iTrack4 == ResultMap[KShort].end() )
-					 {
-					   ResultMap[KShort].push_back(*iTrack2);
-
-					 }
-				     }
-				 }
-			       
-			     }
-			    }
-			}
-		      
-		      AllTrackStates.clear();
-		    } 
+		      //these algorithms basically put the tracks into the map in the case that they are not there already!
+		      if(find(Flagged->begin(),Flagged->end(), iPair->MyTrack) == Flagged->end() )
+			Flagged->push_back(iPair->MyTrack);
+		      if(find(Flagged->begin(),Flagged->end(), iPair2->MyTrack) == Flagged->end() )
+			Flagged->push_back(iPair2->MyTrack);
+		    }
 		}
 	    }
-	  return ResultMap;
-	  
 	}
   
 }
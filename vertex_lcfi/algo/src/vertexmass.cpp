@@ -98,7 +98,6 @@ namespace vertex_lcfi
     int totaltracks = 0;
     double totalenergy = 0;
     double Rmass = 0;
-    int vertexcounter = 0;
     int tempvertex =0;
     int numberoftracks =0;
     double MomentumCorr = 0;
@@ -106,32 +105,15 @@ namespace vertex_lcfi
     double PtVertexCons = 0;
 
 
-    Vector3 totalmom(0,0,0);
+    //The seed is the last vertex (see DecayChain::seedVertex), numberoftracks is its number of tracks
+    tempvertex = MyDecayChain->vertices().size()-1;
+    numberoftracks = MyDecayChain->seedVertex()->tracks( ).size();
 
-    //Count tracks in vertices and decide the seed this is redundant if we have the track attach class algorithm preceding it,
-    //but it is still here in case we use something else.
-    for (std::vector<Vertex*>::const_iterator iVertex = (MyDecayChain->vertices().begin()); iVertex != MyDecayChain->vertices().end() ;++iVertex)
-      {
-
-	numberoftracks = (*iVertex)->tracks( ).size();
-	if ( numberoftracks > 1 || vertexcounter > 0 )
-	  {
-	    tempvertex = vertexcounter;
-	  }
-	vertexcounter++;
-      }
-    
-
-    // calculate the total energy and momentum using all tracks ( note that in this case we are effectively using the track attachment before,
-    // which makes it so that these are tracks in the seed vertex + attached tracks 
-    for(std::vector<Track*>::const_iterator iTrack = (MyDecayChain->allTracks().begin()); iTrack != MyDecayChain->allTracks().end() ;++iTrack)
-      {
-
-	totalmom = totalmom.add( (*iTrack)->momentum());	
-	totalenergy += sqrt((*iTrack)->momentum().mag2() + 0.139567*0.139567);	//momentum + pion mass	           
-
-	totaltracks++;
-      }
+    // the total energy and momentum using all tracks ( note that in this case we are effectively using the track attachment before,
+    // which makes it so that these are tracks in the seed vertex + attached tracks. The sums are kept in the decay chain
+    Vector3 totalmom = MyDecayChain->allTracksMomentum();
+    totalenergy = MyDecayChain->allTracksEnergy(0.139567);	//momentum + pion mass
+    totaltracks = MyDecayChain->allTracks().size();
 
   // Calculate the mass    
     Rmass = totalenergy*totalenergy - totalmom.mag2();
@@ -44,13 +44,9 @@ namespace vertex_lcfi
   double VertexMomentum::calculateFor(DecayChain* MyDecayChain ) const
   {
     double momentumreturn = 0; 
-    Vector3 totalmom(0,0,0);
  
-    for (std::vector<Track*>::const_iterator iTrack = (MyDecayChain->allTracks().begin()); iTrack != MyDecayChain->allTracks().end() ;++iTrack)
-      {
-	totalmom = totalmom.add( (*iTrack)->momentum());
-      }    
-    momentumreturn = totalmom.mag();
+    //sum over all tracks, kept in the decay chain
+    momentumreturn = MyDecayChain->allTracksMomentum().mag();
     return momentumreturn;
           
     // old keep it here just in case. 
@@ -46,6 +46,8 @@ namespace vertex_lcfi
 			paramNames.push_back("JetAxisX");
 			paramNames.push_back("JetAxisY");
 			paramNames.push_back("JetAxisZ");
+			paramNames.push_back("NumberOfThreads");
+			paramNames.push_back("FitGhostToTracks");
 			return paramNames;
 		}
 		
@@ -60,6 +62,8 @@ namespace vertex_lcfi
 			paramValues.push_back(makeString(_JetAxis.x()));
 			paramValues.push_back(makeString(_JetAxis.y()));
 			paramValues.push_back(makeString(_JetAxis.z()));
+			paramValues.push_back(makeString(double(_NumberOfThreads)));
+			paramValues.push_back(_FitGhostToTracks ? "TRUE" : "FALSE");
 			return paramValues;
 		}
 		
@@ -93,6 +97,19 @@ namespace vertex_lcfi
 				}
 				//TODO Throw Something
 			}
+			if (Parameter == "FitGhostToTracks")
+			{
+				if (Value == "TRUE")
+				{
+					_FitGhostToTracks = 1;
+					return;
+				}
+				if (Value == "FALSE")
+				{
+					_FitGhostToTracks = 0;
+					return;
+				}
+			}
 			this->badParameter(Parameter);
 		}
 		
@@ -128,6 +145,11 @@ namespace vertex_lcfi
 				_JetAxis.z() = Value;
 				return;
 			}
+			if (Parameter == "NumberOfThreads")
+			{
+				_NumberOfThreads = (Value < 1.0) ? 1 : int(Value);
+				return;
+			}
 			this->badParameter(Parameter);
 		}
 		
@@ -142,8 +164,7 @@ namespace vertex_lcfi
 			//Make the IP object for zvtop
 			if (_UseEventIP == 1)
 			{
-				IP = new InteractionPoint(MyJet->event()->interactionPoint(),MyJet->event()->interactionPointError());
-				MemoryManager<InteractionPoint>::Event()->registerObject(IP);
+				IP = MemoryManager<InteractionPoint>::Event()->create(MyJet->event()->interactionPoint(),MyJet->event()->interactionPointError());
 			}
 			else
 			{
@@ -159,8 +180,7 @@ namespace vertex_lcfi
 				ipcov(2,2)=0.002*0.002;
 				*/
 				//TODO Make these parameters of this class (not hard wired)
-				IP = new InteractionPoint(Vector3(0,0,0),ipcov);
-				MemoryManager<InteractionPoint>::Event()->registerObject(IP);
+				IP = MemoryManager<InteractionPoint>::Event()->create(Vector3(0,0,0),ipcov);
 			}
 			
 			//Make the jet axis parameter
@@ -188,6 +208,8 @@ namespace vertex_lcfi
 			VFinder.minimumProbability() = _MinimumProbability;
 			VFinder.initialGhostWidth() = _InitialGhostWidth;
 			VFinder.maxChi2Allowed() = _MaxChi2Allowed;
+			VFinder.numberOfThreads() = _NumberOfThreads;
+			VFinder.fitGhostToTracks() = _FitGhostToTracks;
 			std::list<CandidateVertex*> CVResult = VFinder.findVertices();
 			Track* GhostTrack = VFinder.lastGhost();
 			//Make Vertex objects from CandidateVertices
@@ -3,6 +3,10 @@
 #include <zvtop/include/vertexfinderclassic.h>
 #include <zvtop/include/candidatevertex.h>
 #include <zvtop/include/interactionpoint.h>
+#include <zvtop/include/vertexfuncmaxfindernewton.h>
+#include <zvtop/include/vertexresolvergoldensection.h>
+#include <zvtop/include/vertexfitterlsm.h>
+#include <zvtop/include/strategyprovider.h>
 #include <inc/vertex.h>
 #include <inc/jet.h>
 #include <inc/event.h>
@@ -33,7 +37,14 @@ namespace vertex_lcfi
 			_TrackTrimCut ( 10.0 ),
 			_ResolverCut ( 0.6 ),
 			_AutoJetAxis ( 1 ),
-			_UseEventIP ( 0 )
+			_UseEventIP ( 0 ),
+			_NumberOfThreads ( 1 ),
+			_PairCutSigmas ( 0.0 ),
+			_TubeCutSigmas ( 0.0 ),
+			_NewtonMaxFinder ( 0 ),
+			_GoldenSectionResolver ( 0 ),
+			_IncrementalFit ( 0 ),
+			_LinearFitterSeed ( 0 )
 		{ }
 	
 		string ZVRES::name() const
@@ -54,6 +65,13 @@ namespace vertex_lcfi
 			paramNames.push_back("JetAxisY");
 			paramNames.push_back("JetAxisZ");
 			paramNames.push_back("UseEventIP");
+			paramNames.push_back("NumberOfThreads");
+			paramNames.push_back("PairCutSigmas");
+			paramNames.push_back("TubeCutSigmas");
+			paramNames.push_back("VertexFuncMaxFinder");
+			paramNames.push_back("VertexResolver");
+			paramNames.push_back("IncrementalFit");
+			paramNames.push_back("VertexFitterSeed");
 			return paramNames;
 		}
 		
@@ -70,6 +88,13 @@ namespace vertex_lcfi
 			paramValues.push_back(makeString(_JetAxis.y()));
 			paramValues.push_back(makeString(_JetAxis.z()));
 			paramValues.push_back(makeString(_UseEventIP));
+			paramValues.push_back(makeString(double(_NumberOfThreads)));
+			paramValues.push_back(makeString(_PairCutSigmas));
+			paramValues.push_back(makeString(_TubeCutSigmas));
+			paramValues.push_back(_NewtonMaxFinder ? "Newton" : "ClassicStepper");
+			paramValues.push_back(_GoldenSectionResolver ? "GoldenSection" : "EqualSteps");
+			paramValues.push_back(_IncrementalFit ? "TRUE" : "FALSE");
+			paramValues.push_back(_LinearFitterSeed ? "Linear" : "Pairwise");
 			return paramValues;
 		}
 		
@@ -103,6 +128,58 @@ namespace vertex_lcfi
 				}
 				//TODO Throw Something
 			}
+			if (Parameter == "IncrementalFit")
+			{
+				if (Value == "TRUE")
+				{
+					_IncrementalFit = 1;
+					return;
+				}
+				if (Value == "FALSE")
+				{
+					_IncrementalFit = 0;
+					return;
+				}
+			}
+			if (Parameter == "VertexFuncMaxFinder")
+			{
+				if (Value == "ClassicStepper")
+				{
+					_NewtonMaxFinder = 0;
+					return;
+				}
+				if (Value == "Newton")
+				{
+					_NewtonMaxFinder = 1;
+					return;
+				}
+			}
+			if (Parameter == "VertexResolver")
+			{
+				if (Value == "EqualSteps")
+				{
+					_GoldenSectionResolver = 0;
+					return;
+				}
+				if (Value == "GoldenSection")
+				{
+					_GoldenSectionResolver = 1;
+					return;
+				}
+			}
+			if (Parameter == "VertexFitterSeed")
+			{
+				if (Value == "Pairwise")
+				{
+					_LinearFitterSeed = 0;
+					return;
+				}
+				if (Value == "Linear")
+				{
+					_LinearFitterSeed = 1;
+					return;
+				}
+			}
 			this->badParameter(Parameter);
 		}
 		
@@ -148,6 +225,21 @@ namespace vertex_lcfi
 				_JetAxis.z() = Value;
 				return;
 			}
+			if (Parameter == "NumberOfThreads")
+			{
+				_NumberOfThreads = (Value < 1.0) ? 1 : int(Value);
+				return;
+			}
+			if (Parameter == "PairCutSigmas")
+			{
+				_PairCutSigmas = Value;
+				return;
+			}
+			if (Parameter == "TubeCutSigmas")
+			{
+				_TubeCutSigmas = Value;
+				return;
+			}
 			this->badParameter(Parameter);
 		}
 		
@@ -162,8 +254,7 @@ namespace vertex_lcfi
 			//Make the IP object for zvtop
 			if (_UseEventIP == 1)
 			{
-				IP = new InteractionPoint(MyJet->event()->interactionPoint(),MyJet->event()->interactionPointError());
-				MemoryManager<InteractionPoint>::Event()->registerObject(IP);
+				IP = MemoryManager<InteractionPoint>::Event()->create(MyJet->event()->interactionPoint(),MyJet->event()->interactionPointError());
 			}
 			else
 			{
@@ -178,8 +269,7 @@ namespace vertex_lcfi
 				ipcov(2,2) = pow(20.0/1000.0,2);
 				
 				//TODO Make these parameters of this class (not hard wired)
-				IP = new InteractionPoint(Vector3(0,0,0),ipcov);
-				MemoryManager<InteractionPoint>::Event()->registerObject(IP);
+				IP = MemoryManager<InteractionPoint>::Event()->create(Vector3(0,0,0),ipcov);
 			}
 			
 			//Make the jet axis parameter
@@ -203,7 +293,35 @@ namespace vertex_lcfi
 			
 			//Run ZVTOP - result is in order of 3D distance from IP
 			VertexFinderClassic VFinder(MyJet->tracks(),IP,JetAxis,_Kip,_Kalpha,_TwoProngCut,_TrackTrimCut,_ResolverCut);
+			VFinder.numberOfThreads() = _NumberOfThreads;
+			VFinder.pairCutSigmas() = _PairCutSigmas;
+			VFinder.tubeCutSigmas() = _TubeCutSigmas;
+			VFinder.incrementalFit() = _IncrementalFit;
+			//Each jet gets its own provider, as the resolver keeps its decisions for the jet, and the
+			//provider gives each thread working on the jet its own objects. It lasts as long as the vertices.
+			if (_NewtonMaxFinder || _GoldenSectionResolver || _LinearFitterSeed)
+			{
+				ThreadStrategyProvider::FitterMaker MakeFitter;
+				ThreadStrategyProvider::ResolverMaker MakeResolver;
+				ThreadStrategyProvider::MaxFinderMaker MakeMaxFinder;
+				if (_LinearFitterSeed)
+					MakeFitter = []()
+					{
+						VertexFitterLSM* Fitter = new VertexFitterLSM();
+						Fitter->setSeedType(VertexFitterLSM::LinearSeed);
+						return Fitter;
+					};
+				if (_GoldenSectionResolver)
+					MakeResolver = [](){return new VertexResolverGoldenSection();};
+				if (_NewtonMaxFinder)
+					MakeMaxFinder = [](){return new VertexFuncMaxFinderNewton();};
+				VFinder.strategies() = MemoryManager<ThreadStrategyProvider>::Event()->create(MakeFitter, MakeResolver, MakeMaxFinder);
+			}
 			std::list<CandidateVertex*> CVResult = VFinder.findVertices();
+			_NumPairsTried += VFinder.numPairsTried();
+			_NumPairsCut += VFinder.numPairsCut();
+			_NumVertexFuncValues += VFinder.numVertexFuncValues();
+			_NumVertexFuncDerivatives += VFinder.numVertexFuncDerivatives();
 			
 			//Make Vertex objects from CandidateVertices
 			std::vector<Vertex*> VResult;
@@ -80,6 +80,20 @@ namespace vertex_lcfi
 		*/
 		virtual OUTTYPE calculateFor(INTYPE Input) const =0;
 		
+		//! Run the algorithm with its event objects held by Context
+		/*!
+		Calculate the Output of the Algo, objects made for the lifetime of the event 
+		are registered with Context rather than the event context of the calling thread.
+		\param Input Pointer to object to be analysed
+		\param Context EventContext to hold the objects made (null for the current context)
+		\return Output of the algorithm 
+		*/
+		OUTTYPE calculateFor(INTYPE Input, EventContext* Context) const
+		{
+			EventContext::Scope InContext(Context);
+			return this->calculateFor(Input);
+		}
+		
 	protected:
 		void badParameter(std::string Parameter)
 		{
@@ -13,6 +13,10 @@ namespace vertex_lcfi
 	//!Decay Chain
 	/*!
 	Description
+	<br>Results worked out from the tracks (allTracks, charge, the momentum and energy sums and
+	the fit of all tracks) are kept until the tracks change, either through the DecayChain or in
+	one of its vertices (see Vertex::trackChanges), so the flavour tag algorithms given the same
+	chain share them. As they are kept in the chain it should not be used from several threads at once.
 	\author Ben Jeffery (b.jeffery1@physics.ox.ac.uk)
 	*/
 	
@@ -78,6 +82,35 @@ namespace vertex_lcfi
 		*/
 		const util::Vector3 & momentum() const;
 		
+		//! Seed Vertex
+		/*!
+		The vertex furthest out, taken as the seed of the decay by TrackAttach, VertexMass and SecVertexProb
+		\return Pointer to the last vertex, 0 if there are none
+		*/
+		Vertex* seedVertex() const;
+		
+		//! Momentum sum of allTracks
+		/*!
+		Unlike momentum() a track in more than one vertex is counted once for each
+		\return Vector3 of momentum
+		*/
+		const util::Vector3 & allTracksMomentum() const;
+		
+		//! Energy sum of allTracks
+		/*!
+		\param Mass Mass taken for every track
+		\return Sum of the energies, counted as for allTracksMomentum
+		*/
+		double allTracksEnergy(double Mass) const;
+		
+		//! Fit of allTracks to a single vertex
+		/*!
+		Least squares fit (ZVTOP::VertexFitterLSM) without the IP
+		\param Position Filled with the fitted position
+		\param ChiSquared Filled with the chi squared of the fit
+		*/
+		void allTracksFit(util::Vector3 & Position, double & ChiSquared) const;
+		
 		//! Add Track
 		/*!
 		Add a track to the DecayChain as an attached track
@@ -143,9 +176,21 @@ namespace vertex_lcfi
 		mutable double _Charge=0.0;
 		mutable bool _AllTracksValid=false;
 		mutable std::vector<Track*> _AllTracks{};
+		mutable bool _AllTracksMomentumValid=false;
+		mutable util::Vector3 _AllTracksMomentum{};
+		mutable bool _AllTracksEnergyValid=false;
+		mutable double _AllTracksEnergyMass=0.0;
+		mutable double _AllTracksEnergy=0.0;
+		mutable bool _FitValid=false;
+		mutable util::Vector3 _FitPosition{};
+		mutable double _FitChiSquared=0.0;
+		//Sum of Vertex::trackChanges over the vertices when the cache was last checked
+		mutable unsigned long _VertexTrackChanges=0;
 		
 		//Wipe cache (for when track content has changed)
 		void _invalidateCache() const;
+		//Wipe cache if the tracks of a vertex have changed since the last check
+		void _checkVertexTracks() const;
 	};
 
 	}
@@ -12,18 +12,20 @@
 #include <inc/jet.h>
 #include <inc/event.h>
 #include <inc/vertex.h>
+#include <util/inc/memorymanager.h>
 
 using namespace lcio;
 using namespace vertex_lcfi;
 
 namespace vertex_lcfi{
-	
-vertex_lcfi::Track* trackFromLCIORP(Event* MyEvent,lcio::ReconstructedParticle* RP);
-vertex_lcfi::Jet* jetFromLCIORP(Event* MyEvent,lcio::ReconstructedParticle* RP);
+
+//Objects made by these are registered with Context, or the current event context of the thread if null
+vertex_lcfi::Track* trackFromLCIORP(Event* MyEvent,lcio::ReconstructedParticle* RP, EventContext* Context=0);
+vertex_lcfi::Jet* jetFromLCIORP(Event* MyEvent,lcio::ReconstructedParticle* RP, EventContext* Context=0);
 ReconstructedParticle* addDecayChainToLCIOEvent(LCEvent* MyLCIOEvent, DecayChain* MyDecayChain, std::string VertexCollectionName, std::string TrackRPCollectionName, bool StoreTrackChiSquareds=false);
-DecayChain* decayChainFromLCIORP(Jet* MyJet, ReconstructedParticle* DecayChainRP);
+DecayChain* decayChainFromLCIORP(Jet* MyJet, ReconstructedParticle* DecayChainRP, EventContext* Context=0);
 lcio::Vertex* vertexFromLCFIVertex(vertex_lcfi::Vertex* MyLCFIVertex);
-vertex_lcfi::Vertex* vertexFromLCIOVertex(lcio::Vertex* LCIOVertex, Event* MyEvent);
+vertex_lcfi::Vertex* vertexFromLCIOVertex(lcio::Vertex* LCIOVertex, Event* MyEvent, EventContext* Context=0);
 
 class ReconstructedParticleLCFI : private IMPL::ReconstructedParticleImpl 
 {
@@ -5,6 +5,7 @@
 #include "../util/inc/matrix.h"
 #include "../util/inc/vector3.h"
 #include "../util/inc/projection.h"
+#include "trackpath.h"
 #include "jet.h"
 
 
@@ -79,8 +80,54 @@ namespace vertex_lcfi
 		*/
 		const SymMatrix5x5 & covarianceMatrix() const; 
 		
+		//! Path of the track in space
+		/*!
+		For finding points on the track without swimming a TrackState. Take it once for many points,
+		the terms of the helix are worked out when it is made.
+		\return The path of this tracks helix
+		*/
+		TrackPath path() const;
+
+		//! Position at distance s swum from the reference point
+		/*!
+		As a TrackState swum to s, without one. For many points take path() once.
+		*/
+		Vector3 positionAt(double s) const;
+
+		//! Distance swum to the point of closest approach to Point
+		/*!
+		As TrackState::swimToStateNearest, without a TrackState. For many points take path() once.
+		*/
+		double pcaTo(const Vector3 & Point) const;
+
+		//! Distance swum to the point of closest approach to Point in the XY plane
+		/*!
+		As TrackState::swimToStateNearestXY, without a TrackState. For many points take path() once.
+		*/
+		double xyPCATo(const Vector3 & Point) const;
+
+		//! Position covariance matrix (d0,z0) at distance s swum
+		/*!
+		The covariance is not propagated along the track, so this is the same for every s.
+		*/
+		inline const SymMatrix2x2 & positionCovarianceAt(double /*s*/) const
+		{return _PositionCovariance;}
+
+		//! Inverse position covariance matrix (d0,z0) at distance s swum
+		/*!
+		Zero if the covariance is singular, as for a default constructed track.
+		*/
+		inline const SymMatrix2x2 & inversePositionCovarianceAt(double /*s*/) const
+		{return _InversePositionCovariance;}
+		
 		//! Significance of the track
 		/*!
+		Found relative to the events IP when first asked for and kept, until the IP (position or
+		error) or the helix of the track is changed. RPhi and Z are found together from the XY
+		point of closest approach, ThreeD from the 3D one.
+		<br>Not thread safe, although const: a call with nothing kept writes the kept values without
+		a lock, so significance and signedSignificance must not be called on the same Track from
+		several threads at once. To use them in a parallel loop, call them for every track first.
 		\param Proj Projection to take the significance in
 		\return double of the significance of the track
 		*/
@@ -88,6 +135,8 @@ namespace vertex_lcfi
 
 		//! Signed significance of the track
 		/*!
+		From the kept significance and point of closest approach, see significance, and as that
+		must not be called on the same Track from several threads at once.
 		\param Proj Projection to take the significance in
 		\param Jet  Jet from which to take the momentum to seed the significance
 		\return double of the significance of the track
@@ -116,6 +165,25 @@ namespace vertex_lcfi
 		SymMatrix5x5		_CovarianceMatrix{};
 		std::vector<int>	_NumHitsSubDetector{};
 		void*			_TrackingNum=nullptr;
+		//Fixed for the track, from _CovarianceMatrix
+		SymMatrix2x2		_PositionCovariance{};
+		SymMatrix2x2		_InversePositionCovariance{};
+		void			_setPositionCovariance();
+		
+		//Significances to the IP, kept with the IP and helix they were found for
+		mutable Vector3		_SignificanceIP{};
+		mutable SymMatrix3x3	_SignificanceIPError{};
+		mutable HelixRep	_SignificanceHelix{};
+		mutable bool		_XYSignificanceValid=false;
+		mutable Vector3		_XYPOCAVector{};
+		mutable double		_RPhiSignificance=0.0;
+		mutable double		_ZSignificance=0.0;
+		mutable bool		_ThreeDSignificanceValid=false;
+		mutable double		_ThreeDSignificance=0.0;
+		//Drop the significances if the IP or helix has changed since they were found
+		void			_checkSignificances() const;
+		void			_findXYSignificances() const;
+		void			_findThreeDSignificance() const;
 	};
 	
 	template <class charT, class traits> inline
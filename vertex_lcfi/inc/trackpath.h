@@ -0,0 +1,128 @@
+#ifndef TRACKPATH_H
+#define TRACKPATH_H
+
+#include "../util/inc/vector3.h"
+#include "../util/inc/matrix.h"
+#include "../util/inc/helixrep.h"
+#include <cstddef>
+
+namespace vertex_lcfi
+{
+	using namespace util;
+
+//!Path of a track in space, for finding points on it without swimming a TrackState
+/*!
+Holds the helix of a track (or the line of a neutral one) with the terms that don't depend on
+the point, worked out once at construction. Nothing is changed by any method, so a path can be
+used by several threads at once and finding one point has no effect on finding another.
+<br>Distances swum are along the track from its reference point, as for TrackState, which swims
+by keeping a distance on its path. See Track for the parameterisation.
+*/
+	class TrackPath
+	{
+	public:
+		//!Empty path, only for assigning to
+		TrackPath() {}
+
+		//!Path of the helix (or line if Charge is zero)
+		TrackPath(const HelixRep & Helix, double Charge);
+
+		//!Helix of the path
+		inline const HelixRep & helixRep() const
+		{return _Helix;}
+
+		//!Charge
+		inline double charge() const
+		{return _Charge;}
+
+		//!Is this track charged
+		inline bool isCharged() const
+		{return _Charged;}
+
+		//!X of the centre of the circle in the XY plane, charged only
+		inline double centreX() const
+		{return _CentreX;}
+
+		//!Y of the centre of the circle in the XY plane, charged only
+		inline double centreY() const
+		{return _CentreY;}
+
+		//!Position at distance s swum
+		Vector3 positionAt(double s) const;
+
+		//!Position at distance s swum, with its first and second derivatives with respect to s
+		void positionAt(double s, Vector3 & Position, Vector3 & First, Vector3 & Second) const;
+
+		//!Distance swum to the point of closest approach to Point
+		double pcaTo(const Vector3 & Point) const;
+
+		//!Distance swum to the point of closest approach to each of a batch of points, as pcaTo
+		/*!
+		The Newton/Halley solve is done as one sweep over the points at a time, which the compiler
+		can vectorise, so this is the faster way to find many points on one path.
+		\param X Array of NumPoints x coordinates, Y and Z likewise
+		\param S Array of NumPoints, filled with the distance swum for each point
+		\param Distance2 Array of NumPoints, filled with the squared distance of each point from
+		its closest approach, exactly as positionAt(S).subtract(Point).mag2()
+		*/
+		void pcasTo(const double* X, const double* Y, const double* Z, size_t NumPoints, double* S, double* Distance2) const;
+
+		//!Distance swum to the point of closest approach to a line
+		/*!
+		Newton steps from the reference point on the distance from the line. One step is exact for a
+		neutral track, where a track is parallel to the line the reference point is kept.
+		\param Origin Point on the line
+		\param Direction Unit direction of the line
+		*/
+		double pcaToLine(const Vector3 & Origin, const Vector3 & Direction) const;
+
+		//!Distance swum to the point of closest approach to Point in the XY plane, in the helix cycle nearest in z
+		double xyPCATo(const Vector3 & Point) const;
+
+		//!Residuals of Point from the path
+		/*!
+		\param Point Point to find the residuals of
+		\param XY Filled with the distance in the XY plane from the XY closest approach
+		\param Z Filled with the distance along z from the 3D closest approach (as over sin theta), 0 if that is no further than XY
+		\return false if the 3D closest approach was nearer than the XY one by more than the swim precision
+		*/
+		bool residualsTo(const Vector3 & Point, double & XY, double & Z) const;
+
+		//!Chi squared of Point given the inverse position covariance (d0,z0) of the track
+		double chi2(const Vector3 & Point, const SymMatrix2x2 & Inverse) const;
+
+		//!As chi2(Point, Inverse), also giving the gradient of the chi squared with respect to Point
+		double chi2(const Vector3 & Point, const SymMatrix2x2 & Inverse, Vector3 & Gradient) const;
+
+		//!Distances closer than this are taken as the same, 0.1 micron
+		static const double Precision;
+
+	private:
+		//Newton/Halley solve for the distance swum to the 3D POCA of each point (charged only), sweeping
+		//over the points until they all converge. Converged is false for points that don't. At most _BlockSize points.
+		void _helixPCAs(const double* X, const double* Y, const double* Z, size_t NumPoints, double* S, bool* Converged) const;
+		//Distance swum to the XY POCA, as xyPCATo (charged only)
+		double _xyPCA(double X, double Y, double Z) const;
+		//Taylor expansion stepper, used if _helixPCA fails
+		double _iterativePCA(const Vector3 & Point) const;
+
+		HelixRep _Helix{};
+		double _Charge=0.0;
+		bool _Charged=false;
+		double _SinPhi0=0.0;
+		double _CosPhi0=0.0;
+		//Centre of the circle in the XY plane (charged only)
+		double _CentreX=0.0;
+		double _CentreY=0.0;
+		//Taken from the helix here as its lazily worked out terms are not safe to read from several threads
+		double _Circumference=0.0;
+		double _ZLength=0.0;
+
+		static const short _MaxPOCAIterations;
+		//Step at which pcaToLine stops, well inside Precision as the ghost search minimises over the line direction
+		static const double _LinePrecision;
+		//pcasTo does the points in blocks of this size on the stack
+		static const size_t _BlockSize = 16;
+	};
+}
+#endif //TRACKPATH_H
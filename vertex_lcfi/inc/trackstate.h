@@ -5,6 +5,8 @@
 #include "../util/inc/matrix.h"
 #include "../util/inc/helixrep.h"
 #include "../inc/track.h"
+#include "../inc/trackpath.h"
+#include <memory>
 #include <ostream>
 
 namespace vertex_lcfi
@@ -18,6 +20,8 @@ namespace vertex_lcfi
 Tracks in detector space have one Track object, but many TrackState objects. 
 <br>TrackState objects define a point in space on the track, movement along the path of the track is performed by the swimming methods of TrackState.
 For details of the parameterisation see Track
+<br>A TrackState is a distance swum along the TrackPath of its track, points are found with the path. To find a point
+without changing a TrackState (as the chi squared does) use the path directly, see Track::path.
  \author Ben Jeffery (b.jeffery1@physics.ox.ac.uk)
  \version 0.2
  \date    20/09/05
@@ -39,7 +43,8 @@ For details of the parameterisation see Track
 		//!Construct from track parameters
 		/*!
 		Constructs a track state given parameters, with inital position distance swum=0 
-		(usually the perigee to the ref point)
+		(usually the perigee to the ref point). The state (and its copies) keeps the parameters,
+		the given Track is only that returned by parentTrack() and may be null.
 		*/ 	
 		TrackState(const HelixRep & init,const double & cha, const SymMatrix5x5 & cov, Track* tra);
 		
@@ -81,10 +86,18 @@ For details of the parameterisation see Track
 		{return this->position().subtract(Point).mag(RPhi);}
 		
 		//!Calculate this tracks minimum chi squared to Point
-		double chi2(const Vector3 &Point);
+		/*!
+		Found on the path of the track, the TrackState is not swum. Note this changed, chi2 used to swim
+		the state to the closest approach to Point, so position() after chi2 no longer gives that point,
+		swimToStateNearest(Point) does.
+		*/
+		double chi2(const Vector3 &Point) const;
+
+		//!As chi2(Point), also giving the gradient of the chi squared with respect to Point
+		double chi2(const Vector3 &Point, Vector3 & Gradient) const;
 		
 		//!Calculate this tracks chi squared to Point at the TrackStates current position
-		double chi2_nomove(const Vector3 &Point);
+		double chi2_nomove(const Vector3 &Point) const;
 		
 		//const Vector3 &	momentum() const;
 		
@@ -93,28 +106,33 @@ For details of the parameterisation see Track
 		
 		//!Current phi of the trackstate
 		inline double phi() const
-		{return std::fmod(_Init.phi()+(_DistanceSwum*(_Init.invR())), 2.0*3.141592654);}
+		{return std::fmod(_Path.helixRep().phi()+(_DistanceSwum*(_Path.helixRep().invR())), 2.0*3.141592654);}
 		
 		//!Charge
 		inline double charge() const
-		{return _Charge;}
+		{return _Path.charge();}
 		
 		//!Is this track neutral
 		inline bool isNeutral() const
-		{return (fabs(_Charge)<0.000001);} //Floating point, hence no comparison to zero
+		{return !_Path.isCharged();}
 		
 		//!Is this track charged
 		inline bool isCharged() const
-		{return !this->isNeutral();}
+		{return _Path.isCharged();}
 		
 		//!Current position covariance matrix of the trackstate (d0,z0)
-		const SymMatrix2x2&	positionCovarMatrix() const;
+		inline const SymMatrix2x2&	positionCovarMatrix() const
+		{return _Parameters->positionCovarianceAt(_DistanceSwum);}
 		
 		//!Current inverse position covariance matrix of the trackstate (d0,z0)
-		const SymMatrix2x2&	inversePositionCovarMatrix() const;
+		inline const SymMatrix2x2&	inversePositionCovarMatrix() const
+		{return _Parameters->inversePositionCovarianceAt(_DistanceSwum);}
 		
 		//!The error contribution of this trackstate to a vertex at point
 		const Matrix3x3         vertexErrorContribution(Vector3 point) const;
+
+		//!As vertexErrorContribution, but for the track direction at the current position rather than at the reference point
+		const Matrix3x3         localVertexErrorContribution() const;
 		
 		//!Current position covariance matrix of the trackstate (x,y,z)
 		const SymMatrix3x3&	positionCovarMatrixXYZ() const;
@@ -126,6 +144,10 @@ For details of the parameterisation see Track
 		inline Track*			parentTrack() const
 		{return _ParentTrack;}
 
+		//!Path of the track the TrackState swims along
+		inline const TrackPath &	path() const
+		{return _Path;}
+
 		//!Print some info to std::cout
 		void			debugOut();
 		
@@ -135,37 +157,24 @@ For details of the parameterisation see Track
 		TrackState()
 		{}
 		
-		double 			_Charge=0.0;
-	
-		HelixRep		_Init{};
-		//Order tsi,eta,theta,phi,invr
-		SymMatrix5x5		_InitCovarMatrix{};
+		//Helix and charge of the parent track, as at the last resetToRef
+		TrackPath		_Path{};
 		
 		mutable Vector3		_Position{};
 		mutable bool		_PosValid{};
-		
-		mutable Vector3		_Momentum{};
-		mutable bool		_MomValid{};
-				
-		mutable SymMatrix2x2	_PositionCovarMatrix{};
-		mutable bool		_PositionCovarValid{};
-				
-		mutable SymMatrix2x2	_InversePositionCovarMatrix{};
-		mutable bool		_InversePositionCovarValid{};
-		
-		mutable SymMatrix3x3	_PositionCovarMatrixXYZ{};
-		mutable bool		_PositionCovarValidXYZ{};
-				
-		mutable SymMatrix3x3	_InversePositionCovarMatrixXYZ{};
-		mutable bool		_InversePositionCovarValidXYZ{};
 				
 		double 			_DistanceSwum=0.0;
 		
 		//Pointer to Track that created this state
 		Track*			_ParentTrack=nullptr;
+		//Track the helix and errors are taken from, the parent or the parameters given on construction
+		const Track*		_Parameters=nullptr;
+		std::shared_ptr<const Track>	_OwnParameters{};
 
-		//Swimmer to use if none specified
 		static const double 	_swimprecision; //Set in CPP file
+		
+		//Set the distance swum absolutely
+		void			_swimTo(const double s);
 	};
 
 	template <class charT, class traits> inline
@@ -3,6 +3,7 @@
 
 #include "../util/inc/vector3.h"
 #include "../util/inc/matrix.h"
+#include "../util/inc/smallvector.h"
 #include <vector>
 #include <map>
 
@@ -39,9 +40,16 @@ namespace vertex_lcfi
 		\param Tracks Vector of pointers to tracks that form the vertex
 		\param Position Vector3 of the vertices positon
 		\param PosError SymMatrix3x3 of the vertices error
+		\param ChiTrack Chi squared contribution of every track to the vertex, in the order of Tracks
+		*/
+		Vertex(Event* Event, const std::vector<Track*> & Tracks, const Vector3 & Position, const SymMatrix3x3 & PosError, bool IsPrimary, double Chi2, double Probability, const SmallVector<double> & ChiTrack);
+		
+		//! Full Constructor with the chi squareds in a map
+		/*!
+		As above, tracks of Tracks not in ChiTrack are taken as not fitted (-1)
 		\param ChiTrack map of doubles with Track* key holding the chi squared contribution of every track to the vertex
 		*/
-		Vertex(Event* Event, const std::vector<Track*> & Tracks, const Vector3 & Position, const SymMatrix3x3 & PosError, bool IsPrimary, double Chi2, double Probability, std::map<Track*,double> ChiTrack);
+		Vertex(Event* Event, const std::vector<Track*> & Tracks, const Vector3 & Position, const SymMatrix3x3 & PosError, bool IsPrimary, double Chi2, double Probability, const std::map<Track*,double> & ChiTrack);
 		
 		//! Almost Full Constructor
 		/*!
@@ -84,10 +92,16 @@ namespace vertex_lcfi
 
 		//! Add Track
 		/*!
-		Add a track to the vertex. Does not affect fit. Will not be added if duplicate
+		Add a track to the vertex. Does not affect fit, so the chi squared of the track is -1 if chi2OfTracksInOrder is filled. Will not be added if duplicate
 		\param AddTrack Pointer to track to add to vertex
 		*/
-		inline void addTrack(Track* AddTrack) {_Tracks.push_back(AddTrack);}
+		inline void addTrack(Track* AddTrack)
+		{
+			_Tracks.push_back(AddTrack);
+			if (!_ChiSquaredOfTrack.empty())
+				_ChiSquaredOfTrack.push_back(-1);
+			++_TrackChanges;
+		}
 		
 		//! Remove Track
 		/*!
@@ -104,6 +118,14 @@ namespace vertex_lcfi
 		*/
 		bool hasTrack(Track* HTrack) const;
 		
+		//! Track Changes
+		/*!
+		Number of times a track has been added to or removed from the vertex, so that holders of
+		results worked out from its tracks (as DecayChain) can tell when they are out of date
+		\return Count of changes, never decreases
+		*/
+		inline unsigned long trackChanges() const {return _TrackChanges;}
+		
 		//! Charge
 		/*!
 		Sum charge of tracks in the vertex
@@ -140,9 +162,16 @@ namespace vertex_lcfi
 		
 		//! Chi Squared Of Tracks
 		/*!
-		\return map of doubles with Track* key of each tracks chi^2 contribution
+		Made from chi2OfTracksInOrder, which saves building a map where the order of tracks() will do
+		\return map of doubles with Track* key holding the chi^2 contribution of each track, tracks added since the fit are left out
+		*/
+		std::map<Track*,double> chi2OfTracks() const;
+		
+		//! Chi Squared Of Tracks In Order
+		/*!
+		\return Chi^2 contribution of each track, in the order of tracks(), -1 for tracks added since the fit, empty if not known
 		*/
-		inline std::map<Track*,double> chi2OfTracks() const {return _ChiSquaredOfTrack;}
+		inline const SmallVector<double> & chi2OfTracksInOrder() const {return _ChiSquaredOfTrack;}
 		
 		//! Probability
 		/*!
@@ -193,7 +222,9 @@ namespace vertex_lcfi
 		bool _IsPrimary=false;
 		double _Chi2=0.0;
 		double _Probability=0.0;
-		std::map<Track*,double> _ChiSquaredOfTrack{};
+		//In the order of _Tracks, or empty
+		SmallVector<double> _ChiSquaredOfTrack{};
+		unsigned long _TrackChanges=0;
 	};
 
 	}
@@ -1,8 +1,11 @@
 #include "../inc/decaychain.h"
 #include "../inc/vertex.h"
 #include "../inc/track.h"
+#include "../inc/trackstate.h"
+#include "../zvtop/include/vertexfitterlsm.h"
 #include <vector>
 #include <algorithm>
+#include <cmath>
 
 namespace vertex_lcfi
 {
@@ -52,6 +55,7 @@ namespace vertex_lcfi
 	const std::vector<Track*> & DecayChain::allTracks() const
 	{
 		//Chached variable check the status of the cache
+		this->_checkVertexTracks();
 		if (_AllTracksValid)
 			{/*no op*/}
 		else
@@ -68,6 +72,7 @@ namespace vertex_lcfi
 					_AllTracks.push_back(*iTrack);
 			}
 			std::sort(_AllTracks.begin(),_AllTracks.end(),Trackd0Ascending);
+			_AllTracksValid=1;
 		}
 		return _AllTracks;
 	}
@@ -85,12 +90,13 @@ namespace vertex_lcfi
 	double DecayChain::charge() const
 	{
 		//Chached variable check the status of the cache
+		this->_checkVertexTracks();
 		if (_ChargeValid)
 			{/*no op*/}
 		else
 		{
 			_Charge=0.0;
-			std::vector<Track*> allTracks = this->allTracks();
+			const std::vector<Track*> & allTracks = this->allTracks();
 			for (std::vector<Track*>::const_iterator iTrack = allTracks.begin();iTrack!=allTracks.end();++iTrack)
 			{
 				//So that we only count the external legs of the decay chain check that the track is only in one vertex
@@ -102,6 +108,7 @@ namespace vertex_lcfi
 				}
 				if (numVertsWithTrack < 2) _Charge += (*iTrack)->charge();
 			}
+			_ChargeValid=1;
 		}
 		return _Charge;
 	}
@@ -109,12 +116,13 @@ namespace vertex_lcfi
 	const Vector3 & DecayChain::momentum() const
 	{
 		//Chached variable check the status of the cache
+		this->_checkVertexTracks();
 		if (_MomValid)
 			{/*no op*/}
 		else
 		{
 			_Momentum.clear();
-			std::vector<Track*> allTracks = this->allTracks();
+			const std::vector<Track*> & allTracks = this->allTracks();
 			for (std::vector<Track*>::const_iterator iTrack = allTracks.begin();iTrack!=allTracks.end();++iTrack)
 			{
 				//So that we only count the external legs of the decay chain check that the track is only in one vertex
@@ -126,10 +134,69 @@ namespace vertex_lcfi
 				}
 				if (numVertsWithTrack < 2) _Momentum += (*iTrack)->momentum();
 			}
+			_MomValid=1;
 		}
 		return _Momentum;
 	}
 	
+	Vertex* DecayChain::seedVertex() const
+	{
+		if (_Vertices.empty())
+			return 0;
+		return _Vertices.back();
+	}
+	
+	const Vector3 & DecayChain::allTracksMomentum() const
+	{
+		this->_checkVertexTracks();
+		if (!_AllTracksMomentumValid)
+		{
+			_AllTracksMomentum = Vector3(0,0,0);
+			const std::vector<Track*> & allTracks = this->allTracks();
+			for (std::vector<Track*>::const_iterator iTrack = allTracks.begin();iTrack!=allTracks.end();++iTrack)
+				_AllTracksMomentum = _AllTracksMomentum.add((*iTrack)->momentum());
+			_AllTracksMomentumValid=1;
+		}
+		return _AllTracksMomentum;
+	}
+	
+	double DecayChain::allTracksEnergy(double Mass) const
+	{
+		this->_checkVertexTracks();
+		if (!_AllTracksEnergyValid || _AllTracksEnergyMass != Mass)
+		{
+			_AllTracksEnergy = 0;
+			const std::vector<Track*> & allTracks = this->allTracks();
+			for (std::vector<Track*>::const_iterator iTrack = allTracks.begin();iTrack!=allTracks.end();++iTrack)
+				_AllTracksEnergy += sqrt((*iTrack)->momentum().mag2() + Mass*Mass);
+			_AllTracksEnergyMass = Mass;
+			_AllTracksEnergyValid=1;
+		}
+		return _AllTracksEnergy;
+	}
+	
+	void DecayChain::allTracksFit(Vector3 & Position, double & ChiSquared) const
+	{
+		this->_checkVertexTracks();
+		if (!_FitValid)
+		{
+			const std::vector<Track*> & allTracks = this->allTracks();
+			std::vector<TrackState> States;
+			States.reserve(allTracks.size());
+			std::vector<TrackState*> StatePointers;
+			for (std::vector<Track*>::const_iterator iTrack = allTracks.begin();iTrack!=allTracks.end();++iTrack)
+			{
+				States.push_back(TrackState(*iTrack));
+				StatePointers.push_back(&States.back());
+			}
+			ZVTOP::VertexFitterLSM Fitter;
+			Fitter.fitVertex(StatePointers, 0, _FitPosition, _FitChiSquared);
+			_FitValid=1;
+		}
+		Position = _FitPosition;
+		ChiSquared = _FitChiSquared;
+	}
+	
 	void DecayChain::addTrack(Track* ATrack)
 	{
 		_AttachedTracks.push_back(ATrack);
@@ -213,6 +280,21 @@ namespace vertex_lcfi
 		_MomValid=0;
 		_ChargeValid=0;
 		_AllTracksValid=0;
+		_AllTracksMomentumValid=0;
+		_AllTracksEnergyValid=0;
+		_FitValid=0;
+	}
+	
+	void DecayChain::_checkVertexTracks() const
+	{
+		unsigned long Changes = 0;
+		for (std::vector<Vertex*>::const_iterator iVertex = _Vertices.begin();iVertex!=_Vertices.end();++iVertex)
+			Changes += (*iVertex)->trackChanges();
+		if (Changes != _VertexTrackChanges)
+		{
+			this->_invalidateCache();
+			_VertexTrackChanges = Changes;
+		}
 	}
 
 }
@@ -24,8 +24,9 @@ using std::vector;
 using std::map;
 namespace vertex_lcfi{
 	
-vertex_lcfi::Track* trackFromLCIORP(Event* MyEvent, lcio::ReconstructedParticle* RP)
+vertex_lcfi::Track* trackFromLCIORP(Event* MyEvent, lcio::ReconstructedParticle* RP, EventContext* Context)
 {
+	EventContext::Scope InContext(Context);
 	//Get the track from the RP
 	lcio::Track* RPTrack = *(RP->getTracks().begin());
 	
@@ -93,14 +94,13 @@ vertex_lcfi::Track* trackFromLCIORP(Event* MyEvent, lcio::ReconstructedParticle*
 	*/
 	
 	//std::cout << "Track cov:" << sqrt(Cov(0,0))*1000.0 << " " << sqrt(Cov(3,0))*1000.0 << " " << sqrt(Cov(3,3))*1000.0 << std::endl;
-	Track* MyTrack = new vertex_lcfi::Track(MyEvent, 
+	Track* MyTrack = MemoryManager<vertex_lcfi::Track>::Event()->create(MyEvent, 
 						H, 
 						Mom, 
 						RP->getCharge(),
 						Cov,
 						RPTrack->getSubdetectorHitNumbers(),
 						(void *)RP);
-	MemoryManager<vertex_lcfi::Track>::Event()->registerObject(MyTrack);
 	
 	//Commented Out as unneeded.
 	/*//LCIO Tracks have non origin PCA, correct for this
@@ -145,8 +145,9 @@ vertex_lcfi::Track* trackFromLCIORP(Event* MyEvent, lcio::ReconstructedParticle*
 	return MyTrack;
 }
 
-vertex_lcfi::Jet* jetFromLCIORP(Event* MyEvent,lcio::ReconstructedParticle* RP)
+vertex_lcfi::Jet* jetFromLCIORP(Event* MyEvent,lcio::ReconstructedParticle* RP, EventContext* Context)
 {
+	EventContext::Scope InContext(Context);
 	//Make Jet
 	Jet* MyJet = new Jet(MyEvent, vector<vertex_lcfi::Track*>(),RP->getEnergy(),Vector3(RP->getMomentum()[0],RP->getMomentum()[1],RP->getMomentum()[2]),(void*)RP); //Empty Jet
 	MemoryManager<Jet>::Event()->registerObject(MyJet);
@@ -188,8 +189,9 @@ lcio::Vertex* vertexFromLCFIVertex(vertex_lcfi::Vertex* MyLCFIVertex)
 	return MyLCIOVertex;
 }
 
-vertex_lcfi::Vertex* vertexFromLCIOVertex(lcio::Vertex* LCIOVertex, Event* MyEvent)
+vertex_lcfi::Vertex* vertexFromLCIOVertex(lcio::Vertex* LCIOVertex, Event* MyEvent, EventContext* Context)
 {
+	EventContext::Scope InContext(Context);
 	Vector3 Pos(LCIOVertex->getPosition()[0],LCIOVertex->getPosition()[1],LCIOVertex->getPosition()[2]);
 	SymMatrix3x3 PosErr;
 	PosErr(0,0)=LCIOVertex->getCovMatrix()[0];
@@ -206,8 +208,9 @@ vertex_lcfi::Vertex* vertexFromLCIOVertex(lcio::Vertex* LCIOVertex, Event* MyEve
 }	
 
 //TODO NB - Does nto support a deacy chain that has tracks not in the jet
-DecayChain* decayChainFromLCIORP(Jet* LCFIJet, ReconstructedParticle* DecayChainRP)
+DecayChain* decayChainFromLCIORP(Jet* LCFIJet, ReconstructedParticle* DecayChainRP, EventContext* Context)
 {
+	EventContext::Scope InContext(Context);
 	//First make a map associating LCFI tracks to LCIO Reconstructed particles
 	map<ReconstructedParticle*,Track*> LCFITrack;
 	vector<Track*> LCFITracks = LCFIJet->tracks();
@@ -338,7 +341,12 @@ ReconstructedParticle* addDecayChainToLCIOEvent(LCEvent* MyLCIOEvent, DecayChain
 		//Loop over vertices adding chi squareds of each track to the map
 		for (vector<vertex_lcfi::Vertex*>::const_iterator iVertex = MyDecayChain->vertices().begin();iVertex < MyDecayChain->vertices().end();++iVertex)
 		{
-			ChiSquaredOf.insert((*iVertex)->chi2OfTracks().begin(),(*iVertex)->chi2OfTracks().end());
+			const vector<Track*> & Tracks = (*iVertex)->tracks();
+			const SmallVector<double> & ChiSquareds = (*iVertex)->chi2OfTracksInOrder();
+			//Tracks added after the fit have -1, as if they were not there
+			for (size_t i = 0;i < ChiSquareds.size();++i)
+				if (ChiSquareds[i] != -1)
+					ChiSquaredOf.insert(std::make_pair(Tracks[i],ChiSquareds[i]));
 		}
 	}
 
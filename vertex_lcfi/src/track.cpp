@@ -12,11 +12,34 @@ namespace vertex_lcfi
 	using namespace vertex_lcfi::util;
 	
 	Track::Track()
-	{}
+	{
+		//No covariance to take the position part of yet
+		_PositionCovariance.clear();
+		_InversePositionCovariance.clear();
+	}
 	
 	Track::Track(Event* Event, const HelixRep & H,const Vector3 & Momentum,const double & cha, const SymMatrix5x5 & cov, std::vector<int> hits, void* trackNum)
 	: _Event(Event),_H(H),_PMomentum(Momentum),_Charge(cha),_CovarianceMatrix(cov),_NumHitsSubDetector(hits),_TrackingNum(trackNum)
 	{
+		this->_setPositionCovariance();
+	}
+
+	void Track::_setPositionCovariance()
+	{
+		//No propogation, the d0,z0 part of the covariance
+		_PositionCovariance(0,0) = _CovarianceMatrix(0,0);
+		_PositionCovariance(0,1) = _CovarianceMatrix(0,3);
+		_PositionCovariance(1,1) = _CovarianceMatrix(3,3);
+		double factor = pow(_PositionCovariance(0,1),2) - _PositionCovariance(0,0)*_PositionCovariance(1,1);
+		//A singular covariance (e.g. all zero) has no inverse, leave it zero rather than NaN
+		if (factor == 0.0)
+		{
+			_InversePositionCovariance.clear();
+			return;
+		}
+		_InversePositionCovariance(0,0) = _PositionCovariance(1,1)/-factor;
+		_InversePositionCovariance(0,1) = _PositionCovariance(0,1)/factor;
+		_InversePositionCovariance(1,1) = _PositionCovariance(0,0)/-factor;
 	}
 
 	Event* Track::event() const
@@ -26,11 +49,28 @@ namespace vertex_lcfi
 	
 	TrackState* Track::makeState() const
 	{
-		TrackState* ts = new TrackState(_H,_Charge,_CovarianceMatrix, (Track*)this); 
-		MemoryManager<TrackState>::Event()->registerObject(ts);
-		return ts;
+		return MemoryManager<TrackState>::Event()->create((Track*)this);
+	}
+
+	TrackPath Track::path() const
+	{
+		return TrackPath(_H,_Charge);
+	}
+
+	Vector3 Track::positionAt(double s) const
+	{
+		return this->path().positionAt(s);
+	}
+
+	double Track::pcaTo(const Vector3 & Point) const
+	{
+		return this->path().pcaTo(Point);
+	}
+
+	double Track::xyPCATo(const Vector3 & Point) const
+	{
+		return this->path().xyPCATo(Point);
 	}
-	//Make TrackState at reference point with specified swimmer
 	
 	const HelixRep & Track::helixRep() const 
 	{
@@ -56,61 +96,103 @@ namespace vertex_lcfi
 		return _CovarianceMatrix;
 	}
 	
-	double Track::significance(Projection Proj) const
+	void Track::_checkSignificances() const
+	{
+		const Vector3 & IP = this->event()->interactionPoint();
+		const SymMatrix3x3 & IPErr = this->event()->interactionPointError();
+		bool Same = true;
+		for (int i = 0; i < 3 && Same; ++i)
+		{
+			Same = (_SignificanceIP(i) == IP(i));
+			for (int j = 0; j <= i && Same; ++j)
+				Same = (_SignificanceIPError(i,j) == IPErr(i,j));
+		}
+		Same = Same && _SignificanceHelix.d0() == _H.d0() && _SignificanceHelix.z0() == _H.z0()
+			&& _SignificanceHelix.phi() == _H.phi() && _SignificanceHelix.invR() == _H.invR()
+			&& _SignificanceHelix.tanLambda() == _H.tanLambda();
+		if (!Same)
+		{
+			_XYSignificanceValid = false;
+			_ThreeDSignificanceValid = false;
+			_SignificanceIP = IP;
+			_SignificanceIPError = IPErr;
+			_SignificanceHelix = _H;
+		}
+	}
+	
+	void Track::_findXYSignificances() const
 	{
 		//define some nice index numbers
 		short x=0;short y=1;//short z=2;
-		//Swim a trackstate to the point of closest approach to the events IP
-		TrackState* track = this->makeState();
-		const SymMatrix3x3 & IPErr =this->event()->interactionPointError();
+		//Point of closest approach to the events IP, without making a trackstate
+		const Vector3 & IP = _SignificanceIP;
+		const SymMatrix3x3 & IPErr = _SignificanceIPError;
 		//TODO Cope with case where track is used in IP fit?
+		_XYPOCAVector = this->positionAt(this->xyPCATo(IP)) - IP;
+		const Vector3 & POCAVector = _XYPOCAVector;
+		
+		//RPhi
+		double ErrorIP = (IPErr(x,x)*pow(POCAVector.x(),2.0) + 2.0*IPErr(x,y)*POCAVector.x()*POCAVector.y() + IPErr(y,y)*pow(POCAVector.y(),2.0)) / POCAVector.mag2(RPhi); 
+		double ErrorTrack = this->covarianceMatrix()(0,0);
+		if (ErrorIP <= 0.0)
+		  std::cerr << "-ve IP Error of " << ErrorIP << ": Track.cpp:77" << std::endl;
+		if (ErrorTrack <= 0.0)
+		  std::cerr << "-ve Track Error of " << ErrorTrack << ": Track.cpp:79" << std::endl;
+		_RPhiSignificance = POCAVector.mag(RPhi)/sqrt(ErrorIP+ErrorTrack);
+		
+		//Z
+		ErrorIP = determinant(IPErr)/(IPErr(x,x)*IPErr(y,y)-IPErr(x,y)*IPErr(x,y));//IPErr(z,z);
+		ErrorTrack = this->covarianceMatrix()(3,3);
+		if (ErrorIP <= 0.0)
+		  std::cerr << "-ve IP Error of " << ErrorIP << ": Track.cpp:91" << std::endl;
+		if (ErrorTrack <= 0.0)
+		  std::cerr << "-ve Track Error of " << ErrorTrack << ": Track.cpp:93" << std::endl;
+		_ZSignificance = POCAVector.mag(Z)/sqrt(ErrorIP+ErrorTrack);
+		_XYSignificanceValid = true;
+	}
+	
+	void Track::_findThreeDSignificance() const
+	{
+		const Vector3 & IP = _SignificanceIP;
+		Vector3 POCAVector = this->positionAt(this->pcaTo(IP)) - IP;
+		double ErrorIP = quadraticForm3(_SignificanceIPError,POCAVector);
+		//double ErrorIP = (IPErr(x,x)*pow(POCAVector.x(),2.0) + 2*IPErr(x,y)*POCAVector.x()*POCAVector.y() + IPErr(y,y)*pow(POCAVector.y(),2.0)  + IPErr(z,z)*pow(POCAVector.z(),2.0)+ 2*IPErr(x,z)*POCAVector.x()*POCAVector.z() +2*IPErr(z,y)*POCAVector.z()*POCAVector.y())/ POCAVector.mag2(ThreeD) ; 
+		//this should probably be only 0,0+3,3 given the definition of the POCAVector in the Rphi case.
+		//ignore cross terms? 
+		double ErrorTrack = this->covarianceMatrix()(0,0)+this->covarianceMatrix()(3,3)+ 2 * this->covarianceMatrix()(0,3) ;
+		
+		if (ErrorIP <= 0.0)
+		 std::cerr << "-ve IP Error of " << ErrorIP << ": Track.cpp:108" << std::endl;
+		
+		if (ErrorTrack <= 0.0)
+		  std::cerr << "-ve Track Error of " << ErrorTrack << ": Track.cpp:111" << std::endl;
+		
+		_ThreeDSignificance = POCAVector.mag(ThreeD)/sqrt(ErrorIP+ErrorTrack);
+		_ThreeDSignificanceValid = true;
+	}
+	
+	double Track::significance(Projection Proj) const
+	{
+		this->_checkSignificances();
 		switch (Proj)
 		{
 		case RPhi:
 		  {
-		    track->swimToStateNearestXY(this->event()->interactionPoint());
-		    Vector3 POCAVector = track->position() - this->event()->interactionPoint();
-		    double ErrorIP = (IPErr(x,x)*pow(POCAVector.x(),2.0) + 2.0*IPErr(x,y)*POCAVector.x()*POCAVector.y() + IPErr(y,y)*pow(POCAVector.y(),2.0)) / POCAVector.mag2(RPhi); 
-		    double ErrorTrack = this->covarianceMatrix()(0,0);
-		    if (ErrorIP <= 0.0)
-		      std::cerr << "-ve IP Error of " << ErrorIP << ": Track.cpp:77" << std::endl;
-		    if (ErrorTrack <= 0.0)
-		      std::cerr << "-ve Track Error of " << ErrorTrack << ": Track.cpp:79" << std::endl;
-		   //std::cout <<  POCAVector.mag(RPhi)*1000.0 << " " << sqrt(ErrorIP)*1000.0 << " " << sqrt(ErrorTrack)*1000.0 << " " << POCAVector.mag(RPhi)/sqrt(ErrorIP+ErrorTrack) << " ";
-		   return POCAVector.mag(RPhi)/sqrt(ErrorIP+ErrorTrack);
-		    break;
+		    if (!_XYSignificanceValid)
+		      this->_findXYSignificances();
+		    return _RPhiSignificance;
 		  }
 		case Z:
 		  {
-		    track->swimToStateNearestXY(this->event()->interactionPoint());
-		    Vector3 POCAVector = track->position() - this->event()->interactionPoint();
-		    double ErrorIP = determinant(IPErr)/(IPErr(x,x)*IPErr(y,y)-IPErr(x,y)*IPErr(x,y));//IPErr(z,z);
-		    double ErrorTrack = this->covarianceMatrix()(3,3);
- 		    if (ErrorIP <= 0.0)
-		      std::cerr << "-ve IP Error of " << ErrorIP << ": Track.cpp:91" << std::endl;
-		    if (ErrorTrack <= 0.0)
-		      std::cerr << "-ve Track Error of " << ErrorTrack << ": Track.cpp:93" << std::endl;
-		    return POCAVector.mag(Z)/sqrt(ErrorIP+ErrorTrack);
-		    break;
+		    if (!_XYSignificanceValid)
+		      this->_findXYSignificances();
+		    return _ZSignificance;
 		  }
 		case ThreeD:
 		  {
-		    track->swimToStateNearest(this->event()->interactionPoint());
-		    Vector3 POCAVector = track->position() - this->event()->interactionPoint();
-		    double ErrorIP = prec_inner_prod(prec_prod(IPErr,POCAVector),POCAVector);
-		    //double ErrorIP = (IPErr(x,x)*pow(POCAVector.x(),2.0) + 2*IPErr(x,y)*POCAVector.x()*POCAVector.y() + IPErr(y,y)*pow(POCAVector.y(),2.0)  + IPErr(z,z)*pow(POCAVector.z(),2.0)+ 2*IPErr(x,z)*POCAVector.x()*POCAVector.z() +2*IPErr(z,y)*POCAVector.z()*POCAVector.y())/ POCAVector.mag2(ThreeD) ; 
-		    //this should probably be only 0,0+3,3 given the definition of the POCAVector in the Rphi case.
-		    //ignore cross terms? 
-		    double ErrorTrack = this->covarianceMatrix()(0,0)+this->covarianceMatrix()(3,3)+ 2 * this->covarianceMatrix()(0,3) ;
-		    
-		    if (ErrorIP <= 0.0)
-		     std::cerr << "-ve IP Error of " << ErrorIP << ": Track.cpp:108" << std::endl;
-		    
-		    if (ErrorTrack <= 0.0)
-		      std::cerr << "-ve Track Error of " << ErrorTrack << ": Track.cpp:111" << std::endl;
-		    
-		    return POCAVector.mag(ThreeD)/sqrt(ErrorIP+ErrorTrack);
-		    break;
+		    if (!_ThreeDSignificanceValid)
+		      this->_findThreeDSignificance();
+		    return _ThreeDSignificance;
 		  }
 		}
 		std::cerr << "Unsupported Significance: Track.cpp:117" << std::endl;
@@ -118,15 +200,12 @@ namespace vertex_lcfi
 	}
   double Track::signedSignificance(Projection Proj, Jet *MyJet) const
   {
-
-    TrackState* track = this->makeState();
-    track->swimToStateNearestXY(this->event()->interactionPoint());
-    Vector3 POCAVector = track->position() - this->event()->interactionPoint();    
     switch (Proj)
       {
 		case RPhi:
 		  {	//Sign the significances relative to the jet so if the track and jet cross in front of IP the significance is positive    
 		    double d0significance =  this->significance(RPhi);
+		    const Vector3 & POCAVector = _XYPOCAVector;
 
 		    if (((POCAVector.x()*MyJet->momentum().x())+(POCAVector.y()*MyJet->momentum().y())) < 0) 
 		      {
@@ -140,6 +219,7 @@ namespace vertex_lcfi
       case Z:
 	{
 		double z0significance =  this->significance(Z);
+		const Vector3 & POCAVector = _XYPOCAVector;
 		double TanlambdaJet =  MyJet->momentum().z()/sqrt(pow(MyJet->momentum().x(),2.0)+pow(MyJet->momentum().y(),2.0));
 
 		if(POCAVector.z()*(TanlambdaJet - this->helixRep().tanLambda()) < 0) 
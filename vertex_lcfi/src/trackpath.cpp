@@ -0,0 +1,388 @@
+#include "../inc/trackpath.h"
+
+#include <cmath>
+#include <limits>
+#include <iostream>
+
+namespace vertex_lcfi
+{
+	const double TrackPath::Precision = 0.0001; //.1 Micron
+	const short TrackPath::_MaxPOCAIterations = 20;
+	const double TrackPath::_LinePrecision = 1.0e-7;
+
+	TrackPath::TrackPath(const HelixRep & Helix, double Charge)
+	: _Helix(Helix),_Charge(Charge),_Charged(!(fabs(Charge)<0.000001)) //Floating point, hence no comparison to zero
+	{
+		_SinPhi0 = sin(_Helix.phi());
+		_CosPhi0 = cos(_Helix.phi());
+		if (_Charged)
+		{
+			_CentreX = -_Helix.d0()*_SinPhi0 + _SinPhi0/_Helix.invR();
+			_CentreY = _Helix.d0()*_CosPhi0 - _CosPhi0/_Helix.invR();
+		}
+		//Also leaves the helix copy with its terms worked out, so reading them changes nothing
+		_Circumference = _Helix.circum();
+		_ZLength = _Helix.zLength();
+	}
+
+	Vector3 TrackPath::positionAt(double s) const
+	{
+		if (_Charged)
+		{
+			const double Psi = _Helix.phi()-_Helix.invR()*s;
+			return Vector3(-_Helix.d0()*_SinPhi0 + (_SinPhi0-sin(Psi))/_Helix.invR(),
+				_Helix.d0()*_CosPhi0 + (-_CosPhi0+cos(Psi))/_Helix.invR(),
+				(s*_Helix.tanLambda()) + _Helix.z0());
+		}
+		return Vector3((_Helix.d0()*_SinPhi0) + (s*_CosPhi0),
+			(-_Helix.d0()*_CosPhi0) + (s*_SinPhi0),
+			(s*_Helix.tanLambda()) + _Helix.z0());
+	}
+
+	void TrackPath::positionAt(double s, Vector3 & Position, Vector3 & First, Vector3 & Second) const
+	{
+		Position = this->positionAt(s);
+		if (_Charged)
+		{
+			const double Psi = _Helix.phi()-_Helix.invR()*s;
+			First = Vector3(cos(Psi), sin(Psi), _Helix.tanLambda());
+			Second = Vector3(_Helix.invR()*sin(Psi), -_Helix.invR()*cos(Psi), 0.0);
+		}
+		else
+		{
+			First = Vector3(_CosPhi0, _SinPhi0, _Helix.tanLambda());
+			Second = Vector3(0.0, 0.0, 0.0);
+		}
+	}
+
+	double TrackPath::pcaTo(const Vector3 & Point) const
+	{
+		if (!_Charged)
+		{
+			//P1 and P2 are points on the line (P2 in forward direction)
+			const Vector3 P1 = this->positionAt(0);
+			const Vector3 P2 = this->positionAt(1);
+			const Vector3 & P3 = Point;
+			//Parametric distance along line to perp to point
+			return (((P3.x()-P1.x())*(P2.x()-P1.x())) + ((P3.y()-P1.y())*(P2.y()-P1.y())) + ((P3.z()-P1.z())*(P2.z()-P1.z()))) / (P2.subtract(P1)).mag2();
+		}
+		//Solve directly on the helix, only fall back to the Taylor expansion stepper if Newton/Halley fails
+		const double X = Point.x();
+		const double Y = Point.y();
+		const double Z = Point.z();
+		double s;
+		bool Converged;
+		this->_helixPCAs(&X, &Y, &Z, 1, &s, &Converged);
+		if (Converged)
+			return s;
+		return this->_iterativePCA(Point);
+	}
+
+	void TrackPath::pcasTo(const double* X, const double* Y, const double* Z, size_t NumPoints, double* S, double* Distance2) const
+	{
+		if (!_Charged)
+		{
+			for (size_t k = 0; k < NumPoints; ++k)
+			{
+				const Vector3 Point(X[k], Y[k], Z[k]);
+				S[k] = this->pcaTo(Point);
+				Distance2[k] = this->positionAt(S[k]).subtract(Point).mag2();
+			}
+			return;
+		}
+		const double invR = _Helix.invR();
+		const double d0 = _Helix.d0();
+		for (size_t BlockStart = 0; BlockStart < NumPoints; BlockStart += _BlockSize)
+		{
+			const size_t m = (NumPoints-BlockStart < _BlockSize) ? NumPoints-BlockStart : _BlockSize;
+			bool Converged[_BlockSize];
+			this->_helixPCAs(X+BlockStart, Y+BlockStart, Z+BlockStart, m, S+BlockStart, Converged);
+			for (size_t k = BlockStart; k < BlockStart+m; ++k)
+			{
+				if (!Converged[k-BlockStart])
+					S[k] = this->_iterativePCA(Vector3(X[k], Y[k], Z[k]));
+				//As positionAt(S).subtract(Point).mag2()
+				const double Psi = _Helix.phi()-invR*S[k];
+				const double dx = -d0*_SinPhi0 + (_SinPhi0-sin(Psi))/invR - X[k];
+				const double dy = d0*_CosPhi0 + (-_CosPhi0+cos(Psi))/invR - Y[k];
+				const double dz = (S[k]*_Helix.tanLambda()) + _Helix.z0() - Z[k];
+				Distance2[k] = dx*dx + dy*dy + dz*dz;
+			}
+		}
+	}
+
+	double TrackPath::pcaToLine(const Vector3 & Origin, const Vector3 & Direction) const
+	{
+		//Newton steps on half the squared distance from the line, (T.T-(T.G)^2)/2 with T the
+		//position relative to Origin and G the direction
+		const Vector3 & G = Direction;
+		double s = 0.0;
+		Vector3 T,T1,T2;
+		this->positionAt(s, T, T1, T2);
+		T = T.subtract(Origin);
+		for (short iteration = 0; iteration < _MaxPOCAIterations; ++iteration)
+		{
+			const double TG = T.dot(G);
+			const double T1G = T1.dot(G);
+			const double First = T.dot(T1) - TG*T1G;
+			const double Second = T1.mag2() + T.dot(T2) - T1G*T1G - TG*T2.dot(G);
+			//Parallel to the line, or not near a minimum, stay where we are
+			if (Second <= 1.0e-12)
+				break;
+			double step = -First/Second;
+			if (_Charged)
+			{
+				//Never more than a quarter turn, Newton is only good locally
+				const double maxStep = fabs(0.5*3.141592654/_Helix.invR());
+				if (step > maxStep) step = maxStep;
+				if (step < -maxStep) step = -maxStep;
+			}
+			s += step;
+			this->positionAt(s, T, T1, T2);
+			T = T.subtract(Origin);
+			if (!_Charged || fabs(step) < _LinePrecision)
+				break;
+		}
+		return s;
+	}
+
+	double TrackPath::xyPCATo(const Vector3 & Point) const
+	{
+		if (!_Charged)
+		{
+			const Vector3 P1 = this->positionAt(0);
+			const Vector3 P2 = this->positionAt(1);
+			const Vector3 & P3 = Point;
+			//Parametric distance along line to perp to point in xy plane
+			return (((P3.x()-P1.x())*(P2.x()-P1.x())) + ((P3.y()-P1.y())*(P2.y()-P1.y()))) / (((P2.x()-P1.x())*(P2.x()-P1.x()))+((P2.y()-P1.y())*(P2.y()-P1.y())));
+		}
+		return this->_xyPCA(Point.x(), Point.y(), Point.z());
+	}
+
+	double TrackPath::_xyPCA(double X, double Y, double Z) const
+	{
+		const double invR = _Helix.invR();
+		//Phase at which the circle is nearest to Point in the XY plane
+		const double psi = atan2(-invR*(X-_CentreX), invR*(Y-_CentreY));
+		//Take the solution nearest the refpoint
+		double s = std::remainder(_Helix.phi()-psi, 2.0*3.141592654)/invR;
+
+		//Some procedures use a z measurement from the XY POCA
+		//So we should be in the helix cycle nearest in z
+		if (fabs(_ZLength) > std::numeric_limits<double>::epsilon())
+			s -= _Circumference * round((s*_Helix.tanLambda() + _Helix.z0() - Z) / _ZLength);
+		return s;
+	}
+
+	void TrackPath::_helixPCAs(const double* X, const double* Y, const double* Z, size_t NumPoints, double* S, bool* Converged) const
+	{
+		const double invR = _Helix.invR();
+		const double tanL = _Helix.tanLambda();
+		const double d0 = _Helix.d0();
+		const double z0 = _Helix.z0();
+		const double phi = _Helix.phi();
+		//Convert a step in s to a step in space
+		const double stepToDistance = sqrt(1.0+tanL*tanL);
+		//Never step more than a quarter turn, Halley is only good locally
+		const double maxStep = fabs(0.5*3.141592654/invR);
+
+		//Start from the XY POCA in the helix cycle nearest in z, done marks points that have
+		//converged or failed
+		bool done[_BlockSize];
+		for (size_t k = 0; k < NumPoints; ++k)
+		{
+			S[k] = this->_xyPCA(X[k], Y[k], Z[k]);
+			Converged[k] = false;
+			done[k] = false;
+		}
+
+		size_t remaining = NumPoints;
+		for (short iteration = 0; iteration < _MaxPOCAIterations && remaining > 0; ++iteration)
+		{
+			remaining = 0;
+			for (size_t k = 0; k < NumPoints; ++k)
+			{
+				if (done[k]) continue;
+				double psi = phi-invR*S[k];
+				double sinPsi = sin(psi);
+				double cosPsi = cos(psi);
+
+				//Residual from the point to the helix at s
+				double dx = -d0*_SinPhi0 + (_SinPhi0-sinPsi)/invR - X[k];
+				double dy = d0*_CosPhi0 + (-_CosPhi0+cosPsi)/invR - Y[k];
+				double dz = S[k]*tanL + z0 - Z[k];
+
+				//First three derivatives of half the distance squared wrt s
+				double f1 = dx*cosPsi + dy*sinPsi + dz*tanL;
+				double f2 = 1.0 + tanL*tanL + invR*(dx*sinPsi - dy*cosPsi);
+				double f3 = -invR*invR*(dx*cosPsi + dy*sinPsi);
+
+				//Sitting on a maximum or a saddle, leave it to the stepper
+				if (f2 <= 0.0)
+				{
+					done[k] = true;
+					continue;
+				}
+
+				double step;
+				double denom = 2.0*f2*f2 - f1*f3;
+				if (denom > 0.0)
+					step = -2.0*f1*f2/denom;
+				else
+					step = -f1/f2;
+				if (step > maxStep) step = maxStep;
+				if (step < -maxStep) step = -maxStep;
+
+				S[k] += step;
+				if (fabs(step)*stepToDistance < Precision)
+				{
+					done[k] = true;
+#ifdef WIN32
+					Converged[k] = _finite(S[k]);
+#else
+					Converged[k] = std::isfinite(S[k]);
+#endif
+				}
+				else
+					++remaining;
+			}
+		}
+	}
+
+	double TrackPath::_iterativePCA(const Vector3 & Point) const
+	{
+		//Use XY Nearest as starting point
+		double s = this->xyPCATo(Point);
+		//Check we're not sitting on the point
+		if (this->positionAt(s).distanceTo(Point)<Precision) return s;
+
+		const double invrval = -_Helix.invR();
+		const double d0 = _Helix.d0();
+		const double z0 = _Helix.z0();
+		const double phi = _Helix.phi();
+		const double tanL = _Helix.tanLambda();
+		bool done;
+		short loopcount = 0;
+		do
+		{
+			const double s0 = s;
+			const Vector3 & P = Point;
+			const Vector3 initPos = this->positionAt(s);
+			//Taylor expansion of d(Distancetopoint)/ds - finding roots finds minima and maxima
+			double c = (-2*(-(invrval*tanL*(z0 - P.z() + s0*tanL)) + invrval*P.x()*cos(phi + invrval*s0) + (-1.0 + invrval*-d0)*sin(invrval*s0) + invrval*P.y()*sin(phi + invrval*s0)))/invrval;
+			double b = 2*(pow(tanL,2) + (1.0 - invrval*-d0)*cos(invrval*s0) - invrval*P.y()*cos(phi + invrval*s0) + invrval*P.x()*sin(phi + invrval*s0));
+			double a = invrval*(invrval*P.x()*cos(phi + invrval*s0) + (-1.0 + invrval*-d0)*sin(invrval*s0) + invrval*P.y()*sin(phi + invrval*s0));
+
+			//Get two solutions for s:
+			double s1,s2;
+			//Check a != 0
+			if (fabs(a)>std::numeric_limits<double>::epsilon())
+			{
+				double root = sqrt((b*b)-(4*a*c));
+				s1 = (-b + root)/(2*a);
+				s2 = (-b - root)/(2*a);
+			}
+			else
+			{
+				s1 = -c/b;
+				s2 = -c/b;
+			}
+			//Distance to the point from each, infinite if the step is unusable
+			double s1ToPoint = std::numeric_limits<double>::infinity();
+			double s2ToPoint = std::numeric_limits<double>::infinity();
+#ifdef WIN32
+			if (_finite(s1) && fabs(s1) < 10000)
+#else
+			if (std::isfinite(s1) && fabs(s1) < 10000)
+#endif
+				s1ToPoint = this->positionAt(s+s1).distanceTo2(Point);
+#ifdef WIN32
+			if (_finite(s2) && fabs(s2) < 10000)
+#else
+			if (std::isfinite(s2) && fabs(s2) < 10000)
+#endif
+				s2ToPoint = this->positionAt(s+s2).distanceTo2(Point);
+
+			if (std::isfinite(s1ToPoint) && std::isfinite(s2ToPoint))
+				s += (s1ToPoint < s2ToPoint) ? s1 : s2;
+			else if (std::isfinite(s1ToPoint))
+				s += s1;
+			else if (std::isfinite(s2ToPoint))
+				s += s2;
+			//Both infinite we stay put, so stop below
+
+			//If we moved a shorter distance than the precison so stop
+			done = (this->positionAt(s).distanceTo(initPos) < Precision);
+
+			++loopcount;
+		} while (!done && loopcount < 100);
+		if (loopcount == 100)
+		{
+			std::cerr << "Warning: TrackPath.cpp:pcaTo Max Iterations reached" << std::endl;
+			std::cerr << "Point " << Point << " Helix:" << _Helix << std::endl;
+		}
+		return s;
+	}
+
+	bool TrackPath::residualsTo(const Vector3 & Point, double & XY, double & Z) const
+	{
+		//XY Dist in 2D
+		XY = this->positionAt(this->xyPCATo(Point)).subtract(Point).mag(RPhi);
+		//Z in 3D
+		const Vector3 Nearest = this->positionAt(this->pcaTo(Point));
+		//The 3Ddist , 2Ddist and distance on z plane form a right triangle, convert to zaxis by dividing by sin theta
+		//Our 2d might be shorter as it analytical and 3d is iterative so check within swim precision
+		const double Distance = Nearest.distanceTo(Point);
+		if (Distance <= XY)
+		{
+			Z = 0;
+			return (fabs(Distance-XY) < Precision);
+		}
+		Z = sqrt(Nearest.distanceTo2(Point)-pow(XY,2))*sqrt(pow(_Helix.tanLambda(),2)+1.0);
+		return true;
+	}
+
+	double TrackPath::chi2(const Vector3 & Point, const SymMatrix2x2 & Inverse) const
+	{
+		double XY, Z;
+		if (!this->residualsTo(Point, XY, Z))
+			std::cerr << "Warning trackpath.cpp:chi2 2D Distance to track was longer than 3D - swimming problem?" << std::endl;
+
+		const double chi2 = quadraticForm2(Inverse, XY, Z);
+		if (std::isnan(chi2))
+		{
+			std::cerr << "Warning trackpath.cpp:chi2 Chi2 is NAN, are your cov matrices ok?" << std::endl;
+			std::cerr << "2D: " << XY << " Z: " << Z << std::endl;
+			std::cerr << "Q: " << _Charged << std::endl;
+			std::cerr << "Err: " << Inverse << std::endl << std::endl;
+		}
+		return chi2;
+	}
+
+	double TrackPath::chi2(const Vector3 & Point, const SymMatrix2x2 & Inverse, Vector3 & Gradient) const
+	{
+		//Residuals as chi2(Point). Both are distances to points of closest approach, which are
+		//minima over the distance swum, so to first order only Point moves them
+		const Vector3 XYNearest = this->positionAt(this->xyPCATo(Point));
+		const Vector3 XYOffset(Point.x()-XYNearest.x(), Point.y()-XYNearest.y(), 0.0);
+		const double XYDistance = XYOffset.mag();
+		const Vector3 Offset = Point.subtract(this->positionAt(this->pcaTo(Point)));
+		//Square of the distance along z of the 3D closest approach, zero if it is within the swim precision
+		const double Along2 = Offset.mag2()-(XYDistance*XYDistance);
+		const double Secant = sqrt(pow(_Helix.tanLambda(),2)+1.0);
+		const double ZDistance = (Along2 > 0.0) ? sqrt(Along2)*Secant : 0.0;
+
+		//Gradient of XYDistance is XYOffset/XYDistance and of ZDistance is Secant*(Offset-XYOffset)/sqrt(Along2),
+		//the square terms are written so neither is divided by a distance that may be zero
+		const Vector3 ZOffset = Offset.subtract(XYOffset);
+		Gradient = XYOffset.mult(2.0*Inverse(0,0)).add(ZOffset.mult(2.0*Inverse(1,1)*Secant*Secant));
+		if (Inverse(0,1) != 0.0)
+		{
+			if (XYDistance > 0.0)
+				Gradient = Gradient.add(XYOffset.mult(2.0*Inverse(0,1)*ZDistance/XYDistance));
+			if (Along2 > 0.0)
+				Gradient = Gradient.add(ZOffset.mult(2.0*Inverse(0,1)*XYDistance*Secant/sqrt(Along2)));
+		}
+		return quadraticForm2(Inverse, XYDistance, ZDistance);
+	}
+}
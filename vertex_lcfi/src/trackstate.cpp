@@ -12,7 +12,7 @@
 namespace vertex_lcfi
 {
 
-	const double TrackState::_swimprecision = 0.0001; //.1 Micron
+	const double TrackState::_swimprecision = TrackPath::Precision;
 
 	TrackState::TrackState(Track* TTrack)
 	{
@@ -20,6 +20,7 @@ namespace vertex_lcfi
 		if (TTrack != 0)
 		{
 			_ParentTrack=TTrack;
+			_Parameters=TTrack;
 			//Everything gets initalised by this call
 			this->resetToRef();
 		}
@@ -28,163 +29,49 @@ namespace vertex_lcfi
 	}
 
 	TrackState::TrackState(const HelixRep & init,const double & cha, const SymMatrix5x5 & cov, Track* const tra)
-	: _Charge(cha),_Init(init),_InitCovarMatrix(cov),_PosValid(0),_MomValid(0),_PositionCovarValid(0),_InversePositionCovarValid(0),_ParentTrack(tra)
+	: _ParentTrack(tra),_OwnParameters(std::make_shared<const Track>((Event*)0,init,Vector3(),cha,cov,std::vector<int>()))
 	{
 		//TODO Check for invr==0?
+		_Parameters=_OwnParameters.get();
+		this->resetToRef();
 	}
 
 	void TrackState::swimDistance(const double s)
 	{
 		_DistanceSwum += s;
-		//std::cout << "Swum: " << s << " to " << _DistanceSwum << std::endl;
+		//The covariance is not propagated, so only the position changes
+		_PosValid = 0;
+	}
+
+	void TrackState::_swimTo(const double s)
+	{
+		_DistanceSwum = s;
 		_PosValid = 0;
-		_MomValid = 0;
-		_InversePositionCovarValid = 0;
-		_PositionCovarValid = 0;
 	}
 
 	void TrackState::swimToStateNearest(const Vector3 & Point)
 	{
-	if (this->isNeutral())
-		{
-			//P1 and P2 are points on the line (P2 in forward direction)
-			Vector3 P1 = this->position();
-			this->swimDistance(1);
-			Vector3 P2 = this->position();
-			this->swimDistance(-1);
-			Vector3 P3 = Point;
-			
-			//Parametric distance along line to perp to point
-			double u = (((P3.x()-P1.x())*(P2.x()-P1.x())) + ((P3.y()-P1.y())*(P2.y()-P1.y())) + ((P3.z()-P1.z())*(P2.z()-P1.z()))) / (P2.subtract(P1)).mag2();
-			this->swimDistance(u);
-		}
+		//Found from the refpoint, so the result doesn't depend on earlier swims
+		this->_swimTo(_Path.pcaTo(Point));
+	}
 	
-	if (this->isCharged())
-		{
-			//Use XY Nearest as starting point
-			this->swimToStateNearestXY(Point);
-			//Check we're not sitting on the point
-			if (this->distanceTo(Point)<_swimprecision) return;
-			
-			bool done;
-			short loopcount =0;
-			do
-			{
-				double s0 = _DistanceSwum;
-				Vector3 P = Point;
-				Vector3 initPos = this->position();
-				//Shift frame to the origin in xy plane
-				//Taylor expansion of d(Distancetopoint)/ds - finding roots finds minima and maxima
-				double invrval = -_Init.invR();
-				double c = (-2*(-(invrval*_Init.tanLambda()*(_Init.z0() - P.z() + s0*_Init.tanLambda())) + invrval*P.x()*cos(_Init.phi() + invrval*s0) + (-1.0 + invrval*-_Init.d0())*sin(invrval*s0) + invrval*P.y()*sin(_Init.phi() + invrval*s0)))/invrval;
-				double b = 2*(pow(_Init.tanLambda(),2) + (1.0 - invrval*-_Init.d0())*cos(invrval*s0) - invrval*P.y()*cos(_Init.phi() + invrval*s0) + invrval*P.x()*sin(_Init.phi() + invrval*s0));
-				double a = invrval*(invrval*P.x()*cos(_Init.phi() + invrval*s0) + (-1.0 + invrval*-_Init.d0())*sin(invrval*s0) + invrval*P.y()*sin(_Init.phi() + invrval*s0));
-			
-				//Get two solutions for s:
-				double s1,s2;
-				//Check a != 0
-				if (fabs(a)>std::numeric_limits<double>::epsilon())
-				{
-					double root = sqrt((b*b)-(4*a*c));
-					s1 = (-b + root)/(2*a);
-					s2 = (-b - root)/(2*a);
-				}
-				else
-				{
-					s1 = -c/b;
-					s2 = -c/b;
-				}					
-				//std::cout << "s12: " << s1 <<" " <<s2<<std::endl; 
-				double s1ToPoint,s2ToPoint;
-				//Swim to s1
-#ifdef WIN32
-				if (_finite(s1) && fabs(s1) < 10000)
-#else
-				if (std::isfinite(s1) && fabs(s1) < 10000)
-#endif
-				{
-					this->swimDistance(s1);
-					s1ToPoint = this->distanceTo2(Point);
-					this->swimDistance(-s1);
-				}
-				else
-				{
-#ifdef WIN32	//this template version could probably be used for both, but need to check first
-					s1ToPoint = std::numeric_limits<double>::infinity();
-#else
-					s1ToPoint = INFINITY;
-#endif
-				}
-				
-#ifdef WIN32
-				if (_finite(s2) && fabs(s2) < 10000)
-#else
-				if (std::isfinite(s2) && fabs(s2) < 10000)
-#endif
-				{
-					this->swimDistance(s2);
-					s2ToPoint = this->distanceTo2(Point);
-					this->swimDistance(-s2);
-				}
-				else
-				{
-#ifdef WIN32	//this template version could probably be used for both, but need to check first
-					s2ToPoint = std::numeric_limits<double>::infinity();
-#else
-					s2ToPoint = INFINITY;
-#endif
-				}
-				
-				if (std::isfinite(s1ToPoint) && std::isfinite(s2ToPoint))
-				{
-					if (s1ToPoint < s2ToPoint)
-						this->swimDistance(s1);
-					else
-						this->swimDistance(s2);
-				}
-				else
-				{
-					if (std::isfinite(s1ToPoint))
-						this->swimDistance(s1);
-					else
-					{
-						if (std::isfinite(s2ToPoint))
-							this->swimDistance(s1);
-						else
-							//Both Infinite give up
-							done = true;
-					}
-				}
-							
-				//If we moved a shorter distance than the precison so stop
-				done = (this->distanceTo(initPos) < _swimprecision);
-				
-				++loopcount;
-			} while (!done && loopcount < 100);
-			if (loopcount == 100) 
-			{
-				std::cerr << "Warning: TrackState.cpp:167:swimToStateNearest Max Iterations reached" << std::endl;
-				std::cerr << "Point " << Point << " Track:" << *this << std::endl;
-			}  
-		}
-		//TODO Iterative fallback for non helical?
-		}
-		
-
 	void TrackState::swimToStateNearest(TrackState* const TrackToSwimTo)
 	{
 		if (this->isNeutral() && TrackToSwimTo->isNeutral())	
 		{
 			// Code for linear-linear PCA nicked from http://astronomy.swin.edu.au/~pbourke/geometry/lineline3d/
+			//Work from the refpoints so the result doesn't depend on earlier swims
+			this->_swimTo(0);
+			TrackState Other = *TrackToSwimTo;
+			Other._swimTo(0);
 			Vector3 p1 = this->position();
 			this->swimDistance(1);
 			Vector3 p2 = this->position();
 			this->swimDistance(-1);
 			
-			Vector3 p3 = TrackToSwimTo->position();
-			TrackToSwimTo->swimDistance(1);
-			Vector3 p4 = TrackToSwimTo->position();
-			TrackToSwimTo->swimDistance(-1);
+			Vector3 p3 = Other.position();
+			Other.swimDistance(1);
+			Vector3 p4 = Other.position();
 			
 			Vector3 p13,p43,p21;
 			double d1343,d4321,d1321,d4343,d2121;
@@ -279,113 +166,20 @@ namespace vertex_lcfi
 
 	void TrackState::swimToStateNearestXY(const Vector3 & Point)
 	{
-		if (this->isNeutral())
-		{
-			{	
-			//P1 and P2 are points on the line (P2 in forward direction)
-			Vector3 P1 = this->position();
-			this->swimDistance(1);
-			Vector3 P2 = this->position();
-			this->swimDistance(-1);
-			Vector3 P3 = Point;
-			
-			//Parametric distance along line to perp to point in xy plane 
-			double u = (((P3.x()-P1.x())*(P2.x()-P1.x())) + ((P3.y()-P1.y())*(P2.y()-P1.y()))) / (((P2.x()-P1.x())*(P2.x()-P1.x()))+((P2.y()-P1.y())*(P2.y()-P1.y())));
-			//In 3D
-			//u = u/sin(_Init.theta());
-			//std::cout << "u:" << u << std::endl;
-		
-			this->swimDistance(u);
-			}
-		}
+		this->_swimTo(_Path.xyPCATo(Point));
+	}
 	
-		if (this->isCharged())
-		{
-			//std::cout << "XY POCA" << std::endl;
-			this->resetToRef();
-			if (this->xyDistanceTo(Point)<_swimprecision) return;
-				
-			//So first find center of the circle in the XY plane
-			Vector3 center = Vector3(this->position().x()+ (sin(_Init.phi())/_Init.invR()) , this->position().y()- (cos(_Init.phi())/_Init.invR()),0);
-			
-			//Get the points vector from this circle center
-			Vector3 P2 = Point - center;
-			
-			//d distance to point on circle / ds solved for zero points gives:
-			double distanceRoundCircle = atan(P2.x()/P2.y())/_Init.invR();
-			
-			//This distance is relative to the top of the circle, wheras our refpoint is phi dependant
-			distanceRoundCircle = distanceRoundCircle + (_Init.phi()/_Init.invR());
-			
-			//Thats one of two possible minima, check which one we want, we reset earlier so we're swimming relative to the refpoint
-			this->swimDistance(distanceRoundCircle);
-			double dist1 = this->xyDistanceTo(Point);
-			
-			//Swim to the second point 180 degrees away
-			//where we started
-			this->swimDistance(_Init.halfCircum());
-			double dist2 = this->xyDistanceTo(Point);
-			
-			//If the first one was the best swim back to it.
-			if (dist1 < dist2) this->swimDistance(-_Init.halfCircum());
-			
-			//Some procedures use a z measurement from the XY POCA
-			//So we should be in the helix cycle nearest in z
-			//Work out how many cycles away we are and swim back the opposite
-			this->swimDistance(-_Init.circum() * round(this->position().subtract(Point).z() / _Init.zLength()));
-			
-			//std::cout << "Done - XY POCA" << std::endl;
-			//We're done
-		} 
+	double TrackState::chi2(const Vector3 &Point) const
+	{
+		return _Path.chi2(Point, this->inversePositionCovarMatrix());
 	}
 	
-	double TrackState::chi2(const Vector3 &Point)
+	double TrackState::chi2(const Vector3 &Point, Vector3 & Gradient) const
 	{
-		boost::numeric::ublas::bounded_vector<double,2> Residual;
-		//XY Dist in 2D
-		this->swimToStateNearestXY(Point);
-		Residual(0) = this->xyDistanceTo(Point);
-		//Z in 3D
-		this->swimToStateNearest(Point);
-		//The 3Ddist , 2Ddist and distance on z plane form a right triangle, convert to zaxis by dividing by sin theta 
-		//Double check 3d is hypotenuse
-		//Our 2d might be shorter as it analytical and 3d is iterative so check within swimPrecision
-		if (this->distanceTo(Point) <= Residual(0)) 
-		{
-			if (fabs(this->distanceTo(Point)-Residual(0)) < _swimprecision) 
-			{
-				//2D bigger than 3D, but within precison so set z = 0 
-				Residual(1) = 0;
-					
-			}
-			else
-			{
-				std::cerr << "Warning trackstate.cpp:364:chi2 2D Distance to track was longer than 3D - swimming problem?" << std::endl;
-			}
-		}
-		else //Everything normal 3D>2D
-		{	
-			//Residual(1) = (sqrt(this->distanceTo2(Point)-pow(Residual(0),2)))/(1.0/sqrt(1.0+pow(_Init.tanLambda(),2)));
-   			 Residual(1) = sqrt(this->distanceTo2(Point)-pow(Residual(0),2))*sqrt(pow(_Init.tanLambda(),2)+1.0); 
-		}
-		
-		double chi2 = prec_inner_prod(trans(Residual),prec_prod(this->inversePositionCovarMatrix(), Residual));
-		
-		if (std::isnan(chi2))
-		{
-			std::cerr << "Warning trackstate.cpp:377 Chi2 is NAN, are your cov matrices ok?" << std::endl;
-			std::cerr << "3D: " << this->distanceTo(Point) << std::endl ;
-			std::cerr << "2D: " << Residual(0) << std::endl ;
-			std::cerr << "Res: " << Residual << std::endl ;
-			std::cerr << "Q: " << this->isCharged() << std::endl ;
-			std::cerr << "Err: " << this->inversePositionCovarMatrix()<< std::endl;
-			std::cerr << "Chi2: " << prec_inner_prod(trans(Residual),prec_prod(this->inversePositionCovarMatrix(), Residual))<< std::endl<< std::endl;
-		}
-			 
-		return chi2;
+		return _Path.chi2(Point, this->inversePositionCovarMatrix(), Gradient);
 	}
 	
-	double TrackState::chi2_nomove(const Vector3 &Point)
+	double TrackState::chi2_nomove(const Vector3 &Point) const
 	{
 		boost::numeric::ublas::bounded_vector<double,2> Residual;
 		//XY Dist in 2D
@@ -400,7 +194,7 @@ namespace vertex_lcfi
 		else
 		{	
 			//Residual(1) = (sqrt(this->distanceTo2(Point)-pow(Residual(0),2)))/(1.0/sqrt(1.0+pow(_Init.tanLambda(),2)));
-   			 Residual(1) = sqrt(this->distanceTo2(Point)-pow(Residual(0),2))*sqrt(pow(_Init.tanLambda(),2)+1.0); 
+   			 Residual(1) = sqrt(this->distanceTo2(Point)-pow(Residual(0),2))*sqrt(pow(_Path.helixRep().tanLambda(),2)+1.0); 
 			 
 			 //std::cout << "3D: " << this->distanceTo(Point) << std::endl ;
 			 //std::cout << "2D: " << Residual(0) << std::endl ;
@@ -409,7 +203,7 @@ namespace vertex_lcfi
 			 //std::cout << "Chi2: " << prec_inner_prod(trans(Residual),prec_prod(this->inversePositionCovarMatrix(), Residual))<< std::endl<< std::endl;
 			 
 		}
-		return prec_inner_prod(trans(Residual),prec_prod(this->inversePositionCovarMatrix(), Residual));
+		return quadraticForm2(this->inversePositionCovarMatrix(), Residual(0), Residual(1));
 	}
 	/*const Vector3 & TrackState::momentum() const 
 	{
@@ -441,29 +235,7 @@ namespace vertex_lcfi
 	{
 		if (!_PosValid)
 		{
-			if (this->isCharged())
-			{
-				double phival = _Init.phi();
-				_Position.x() = -_Init.d0()*sin(phival) + (sin(phival)-sin(phival-_Init.invR()*_DistanceSwum))/_Init.invR();
-				// 		-d0        *Sin(phi)    + (Sin(phi)   -Sin(phi   -invr        *s            ))/invr
-				_Position.y() = _Init.d0()*cos(phival) + (-cos(phival)+cos(phival-_Init.invR()*_DistanceSwum))/_Init.invR();
-				//		d0        *Cos(phi)    + (-Cos(phi)   +Cos(phi   -invr        *s            ))/invr
-				//_Position.x() = (_Init.d0()*sin(phival)) + ((sin(phival)-sin(phival-(_DistanceSwum*(-_Init.invR()))))/(-_Init.invR()));
-				//_Position.y() = (-_Init.d0()*cos(phival)) + ((cos(phival-(_DistanceSwum*(-_Init.invR())))-cos(phival))/(-_Init.invR()));
-				_Position.z() = (_DistanceSwum*_Init.tanLambda()) + _Init.z0();
-				//std::cout << "Cswim " << _DistanceSwum << " to " <<_Position << std::endl;
-				
-				//_Position.x() = (_Init.d0()*sin(phival)) + ((sin(phival)-sin(phival-(_DistanceSwum*_Init.invR())))/_Init.invR());
-				//_Position.y() = (-_Init.d0()*cos(phival)) + ((cos(phival-(_DistanceSwum*_Init.invR()))-cos(phival))/_Init.invR());
-				//_Position.z() = (_DistanceSwum/tan(_Init.theta())) + _Init.z0();
-			}
-			if (this->isNeutral()) //TODO Check z
-			{
-				_Position.x() = (_Init.d0()*sin(_Init.phi())) + (_DistanceSwum*cos(_Init.phi()));
-				_Position.y() = (-_Init.d0()*cos(_Init.phi())) + (_DistanceSwum*sin(_Init.phi()));
-				_Position.z() = (_DistanceSwum*_Init.tanLambda()) + _Init.z0();
-				//std::cout << "Nswim " << _DistanceSwum << " to " <<_Position << std::endl;
-			}
+			_Position = _Path.positionAt(_DistanceSwum);
 			_PosValid = 1;
 		}
 		return _Position;
@@ -473,6 +245,7 @@ namespace vertex_lcfi
 	{
 		//std::cout << "*";std::cout.flush();
 		//Copy from fortran for now
+		const HelixRep & Helix = _Path.helixRep();
 		
 		//*  calculate xy PCA in this system.
 		//Vector3 PCA;
@@ -480,8 +253,8 @@ namespace vertex_lcfi
 		//PCA(2) =  PARK(3)*CPHI
 		//PCA(3) =  PARK(5)
 		//TL   = PARK(4)
-		double STHE = 1.0/sqrt(1.0+pow(_Init.tanLambda(),2));
-		double CTHE = STHE*_Init.tanLambda();
+		double STHE = 1.0/sqrt(1.0+pow(Helix.tanLambda(),2));
+		double CTHE = STHE*Helix.tanLambda();
 		//std::cout << STHE << " " << CTHE << std::endl;
 		//*  calculate 3d PCA in this system.
 		//SS      =-PCA(3)*CTHE
@@ -501,10 +274,10 @@ namespace vertex_lcfi
 		//* ty = sin(theta)*sin(phi), and tz = cos(theta).
 		//* We use the fact that d0 and z0 are zero after the OUMOVE call.
 		//*
-		double DXDD = -sin(_Init.phi());
-		double DXDZ = -cos(_Init.phi())*STHE*CTHE;
-		double DYDD =  cos(_Init.phi());
-		double DYDZ = -sin(_Init.phi())*STHE*CTHE;
+		double DXDD = -sin(Helix.phi());
+		double DXDZ = -cos(Helix.phi())*STHE*CTHE;
+		double DYDD =  cos(Helix.phi());
+		double DYDZ = -sin(Helix.phi())*STHE*CTHE;
 		double DZDZ = pow(STHE,2);
 		//*	
 		//* calculate error matrix for this point.  Must transform from track
@@ -527,14 +300,14 @@ namespace vertex_lcfi
 		//*  set up rotation matrix to take track into w direction by matrix
 		//*  multiplication, vecnew_i = rot(i,j)vecold_j
 		Matrix3x3 ROTAT;
-		ROTAT(0,0)= CTHE*cos(_Init.phi());
-		ROTAT(0,1)= CTHE*sin(_Init.phi());
+		ROTAT(0,0)= CTHE*cos(Helix.phi());
+		ROTAT(0,1)= CTHE*sin(Helix.phi());
 		ROTAT(0,2)= -STHE;
-		ROTAT(1,0)= -sin(_Init.phi());
-		ROTAT(1,1)= cos(_Init.phi());
+		ROTAT(1,0)= -sin(Helix.phi());
+		ROTAT(1,1)= cos(Helix.phi());
 		ROTAT(1,2)= 0.0;
-		ROTAT(2,0)= STHE*cos(_Init.phi());
-		ROTAT(2,1)= STHE*sin(_Init.phi());
+		ROTAT(2,0)= STHE*cos(Helix.phi());
+		ROTAT(2,1)= STHE*sin(Helix.phi());
 		ROTAT(2,2)= CTHE;
 		//*  rotate track covariance into the new frame (uvw), where u and v are
 		//*  perpendicular to the track and w is along the track
@@ -604,50 +377,30 @@ namespace vertex_lcfi
 		return GG;
 	}
 		
-	const SymMatrix2x2& TrackState::positionCovarMatrix() const
-	{
-		if(!_PositionCovarValid)
-		{
-//			double s = _DistanceSwum;
-			/*double factor1 = -pow(_V(1,4),2) + _V(1,1)*_V(4,4) + s*sin(_Init.theta())*(2*_V(1,4)*_V(2,4) - 2*_V(1,2)*_V(4,4) + s*(-pow(_V(2,4),2) + _V(2,2)*_V(4,4))*sin(_Init.theta()));
-			double factor2 = pow(_V(1,4),2) - _V(1,1)*_V(4,4) + s*sin(_Init.theta())*(-2*_V(1,4)*_V(2,4) + 2*_V(1,2)*_V(4,4) + s*(pow(_V(2,4),2) - _V(2,2)*_V(4,4))*sin(_Init.theta()));
-			//std::cout << "V" << _V << std::endl;
-			//std::cout << "f1,2: " << factor1 << " " << factor2 << std::endl;
-			_InversePositionCovarMatrix(0,0) = (pow(_Init.invR(),4)*(_V(1,1) + s*sin(_Init.theta())*(-2*_V(1,2) + s*_V(2,2)*sin(_Init.theta()))))/factor1;
-			_InversePositionCovarMatrix(0,1) = (pow(_Init.invR(),2)*(-_V(1,4) + s*_V(2,4)*sin(_Init.theta())))/factor2;
-			//(1,0) filled by symmettry
-			_InversePositionCovarMatrix(1,1) = _V(4,4)/factor1;
-			*/
-			/*double factor = -pow(pow(_Init.invR(),2)*_V(0,1) - _V(1,4) + s*(-(pow(_Init.invR(),2)*_V(0,2)) + _V(2,4))*sin(_Init.theta()),2) + (pow(_Init.invR(),4)*_V(0,0) - 2*pow(_Init.invR(),2)*_V(0,4) + _V(4,4))*(_V(1,1) + s*sin(_Init.theta())*(-2*_V(1,2) + s*_V(2,2)*sin(_Init.theta())));
-			_InversePositionCovarMatrix(0,0) = (pow(_Init.invR(),4)*(_V(1,1) + s*sin(_Init.theta())*(-2*_V(1,2) + s*_V(2,2)*sin(_Init.theta()))))/factor;
-			_InversePositionCovarMatrix(0,1) = (pow(_Init.invR(),4)*(-_V(0,1) + _V(1,4)/pow(_Init.invR(),2) + s*(_V(0,2) - _V(2,4)/pow(_Init.invR(),2))*sin(_Init.theta())))/factor; 
-			//(1,0) filled by symmettry
-			_InversePositionCovarMatrix(1,1) = (pow(_Init.invR(),4)*(_V(0,0) + (-2*pow(_Init.invR(),2)*_V(0,4) + _V(4,4))/pow(_Init.invR(),4)))/factor;
-			*/
-			//No propogation below
-			_PositionCovarMatrix(0,0) = _InitCovarMatrix(0,0);
-			_PositionCovarMatrix(0,1) = _InitCovarMatrix(0,3);
-			_PositionCovarMatrix(1,1) = _InitCovarMatrix(3,3);
-			_PositionCovarValid = 1;
-		}
-		return _PositionCovarMatrix;
-	}
-	
-	const SymMatrix2x2& TrackState::inversePositionCovarMatrix() const
+	const Matrix3x3 TrackState::localVertexErrorContribution() const
 	{
-		if(!_InversePositionCovarValid)
+		//The errors are perpendicular to the track, so only turn about z with the track direction
+		const Matrix3x3 Reference = this->vertexErrorContribution(this->position());
+		if (this->isNeutral()) return Reference;
+		const double Turn = -_Path.helixRep().invR()*_DistanceSwum;
+		const double CosTurn = cos(Turn);
+		const double SinTurn = sin(Turn);
+		const double Rotation[3][3] = {{CosTurn,-SinTurn,0.0},{SinTurn,CosTurn,0.0},{0.0,0.0,1.0}};
+		Matrix3x3 Local;
+		for (short i = 0; i < 3; ++i)
 		{
-			if(!_PositionCovarValid) this->positionCovarMatrix();
-			
-			double factor = pow(_PositionCovarMatrix(0,1),2) - _PositionCovarMatrix(0,0)*_PositionCovarMatrix(1,1);
-			_InversePositionCovarMatrix(0,0) = _PositionCovarMatrix(1,1)/-factor;
-			_InversePositionCovarMatrix(0,1) = _PositionCovarMatrix(0,1)/factor;
-			_InversePositionCovarMatrix(1,1) = _PositionCovarMatrix(0,0)/-factor;
-			_InversePositionCovarValid = 1;
+			for (short j = 0; j < 3; ++j)
+			{
+				double Sum = 0.0;
+				for (short k = 0; k < 3; ++k)
+					for (short l = 0; l < 3; ++l)
+						Sum += Rotation[i][k]*Reference(k,l)*Rotation[j][l];
+				Local(i,j) = Sum;
+			}
 		}
-		return _InversePositionCovarMatrix;
+		return Local;
 	}
-	
+		
 	/*const SymMatrix3x3& TrackState::positionCovarMatrixXYZ() const
 	{
 		if(!_PositionCovarValidXYZ)
@@ -701,13 +454,7 @@ namespace vertex_lcfi
 	void TrackState::resetToRef()
 	{
 		_DistanceSwum = 0;
-		_Init=_ParentTrack->helixRep();
-		_Charge=_ParentTrack->charge();
-		_InitCovarMatrix=_ParentTrack->covarianceMatrix();
-		
+		_Path = _Parameters->path();
 		_PosValid = 0;
-		_MomValid = 0;
-		_InversePositionCovarValid = 0;
-		_PositionCovarValid = 0;
 	}
 }
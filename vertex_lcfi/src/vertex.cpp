@@ -8,10 +8,20 @@ namespace vertex_lcfi
 {
 using namespace util;
 
-	Vertex::Vertex(Event* Event, const std::vector<Track*> & Tracks, const Vector3 & Position, const SymMatrix3x3 & PosError,bool IsPrimary, double Chi2, double Probability, std::map<Track*,double> ChiTrack)
+	Vertex::Vertex(Event* Event, const std::vector<Track*> & Tracks, const Vector3 & Position, const SymMatrix3x3 & PosError,bool IsPrimary, double Chi2, double Probability, const SmallVector<double> & ChiTrack)
 	:_Event(Event),_Tracks(Tracks),_Position(Position),_PosError(PosError),_IsPrimary(IsPrimary), _Chi2(Chi2), _Probability(Probability),_ChiSquaredOfTrack(ChiTrack)
 	{}
 	
+	Vertex::Vertex(Event* Event, const std::vector<Track*> & Tracks, const Vector3 & Position, const SymMatrix3x3 & PosError,bool IsPrimary, double Chi2, double Probability, const std::map<Track*,double> & ChiTrack)
+	:_Event(Event),_Tracks(Tracks),_Position(Position),_PosError(PosError),_IsPrimary(IsPrimary), _Chi2(Chi2), _Probability(Probability)
+	{
+		for (std::vector<Track*>::const_iterator iTrack = _Tracks.begin();iTrack != _Tracks.end();++iTrack)
+		{
+			std::map<Track*,double>::const_iterator iChi = ChiTrack.find(*iTrack);
+			_ChiSquaredOfTrack.push_back(iChi != ChiTrack.end() ? iChi->second : -1);
+		}
+	}
+	
 	Vertex::Vertex(Event* Event, const std::vector<Track*> & Tracks, const Vector3 & Position, const SymMatrix3x3 & PosError,bool IsPrimary, double Chi2, double Probability)
 	:_Event(Event),_Tracks(Tracks),_Position(Position),_PosError(PosError),_IsPrimary(IsPrimary), _Chi2(Chi2), _Probability(Probability)
 	{}
@@ -23,8 +33,8 @@ using namespace util;
 			iTrack != CandidateVertex->trackStateList().end(); ++iTrack)
 			{
 				_Tracks.push_back((*iTrack)->parentTrack());
-				_ChiSquaredOfTrack[(*iTrack)->parentTrack()] = CandidateVertex->chiSquaredOfTrack(*iTrack);
 			}
+		_ChiSquaredOfTrack = CandidateVertex->chiSquaredOfAllTracks();
 		if (CandidateVertex->interactionPoint())
 			_IsPrimary = 1;
 		else
@@ -34,12 +44,26 @@ using namespace util;
 		
 	}
 	
+	std::map<Track*,double> Vertex::chi2OfTracks() const
+	{
+		std::map<Track*,double> Result;
+		for (size_t i = 0;i < _ChiSquaredOfTrack.size();++i)
+		{
+			if (_ChiSquaredOfTrack[i] != -1)
+				Result.insert(std::make_pair(_Tracks[i],_ChiSquaredOfTrack[i]));
+		}
+		return Result;
+	}
+	
 	bool Vertex::removeTrack(Track* RTrack)
 	{
 		std::vector<Track*>::iterator position = std::find(_Tracks.begin(), _Tracks.end(), RTrack);
 		if (position!=_Tracks.end()) //Found
 		{
+			if (!_ChiSquaredOfTrack.empty())
+				_ChiSquaredOfTrack.erase(_ChiSquaredOfTrack.begin() + (position - _Tracks.begin()));
 			_Tracks.erase(position);
+			++_TrackChanges;
 			return 1;
 		}
 		else
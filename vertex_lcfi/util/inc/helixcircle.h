@@ -0,0 +1,59 @@
+#ifndef HELIXCIRCLE_H
+#define HELIXCIRCLE_H
+
+namespace vertex_lcfi
+{
+namespace util
+{
+	class HelixRep;
+
+//!Circle of a helix in the XY plane
+/*!
+For quick two track tests, such as V0 and conversion finding, before anything is swum or fitted.
+The gap between two circles is found in closed form and no two points on the helices can be
+closer than it, so pairs further apart than a cut can be dropped without finding their distance
+of closest approach.
+<br>The parameters are those of HelixRep (as the LCIO track parameters, with InvR the LCIO
+omega), the centre is at (-d0 sin phi + sin phi/InvR, d0 cos phi - cos phi/InvR). An InvR of
+zero is a straight line, for which no gap is found.
+*/
+	class HelixCircle
+	{
+	public:
+		//!Circle of the helix with these parameters
+		HelixCircle(double D0, double Phi, double InvR);
+
+		//!Circle of Helix
+		explicit HelixCircle(const HelixRep & Helix);
+
+		//!Is this a straight line rather than a circle
+		inline bool isLine() const
+		{return _Line;}
+
+		//!Centre, x
+		inline double centreX() const
+		{return _CentreX;}
+
+		//!Centre, y
+		inline double centreY() const
+		{return _CentreY;}
+
+		//!Radius, 0 for a line
+		inline double radius() const
+		{return _Radius;}
+
+		//!Smallest distance in the XY plane between a point on this circle and one on Other
+		/*!
+		\return the gap, 0 if the circles cross or touch or either is a line
+		*/
+		double gapTo(const HelixCircle & Other) const;
+
+	private:
+		double _CentreX=0.0;
+		double _CentreY=0.0;
+		double _Radius=0.0;
+		bool _Line=false;
+	};
+}
+}
+#endif //HELIXCIRCLE_H
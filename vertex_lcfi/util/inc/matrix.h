@@ -18,6 +18,8 @@
 #include <boost/numeric/ublas/io.hpp>
 #include <boost/numeric/ublas/lu.hpp>
 
+#include "smallmatrix.h"
+
 #include <cmath>
 #include <complex>
 #include <limits>
@@ -216,6 +218,7 @@ namespace util
 
 double determinant(Matrix3x3 input);                                                                   
 SymMatrix5x5 InvertMatrix5x5(SymMatrix5x5 input);
+SymMatrix6x6 InvertMatrix6x6(SymMatrix6x6 input);
 Matrix3x3 InvertMatrix(Matrix3x3 input);//const ublas::matrix<T>& input, ublas::matrix<T>& inverse) 
 Matrix2x2 InvertMatrix2(Matrix2x2 input);//const ublas::matrix<T>& input, ublas::matrix<T>& inverse) 
 
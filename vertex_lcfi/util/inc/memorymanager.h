@@ -2,9 +2,199 @@
 #define LCFIMEMMANAGE_H
 
 #include <vector>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <cstddef>
 
 namespace vertex_lcfi
 {
+	//! Owner of a set of objects of any type, for deletion all at once
+	/*!
+	Objects registered with an EventContext are deleted, last registered first, when
+	delAllObjects is called or the context is destroyed. The order is that of registration
+	with the context as a whole, not per type, and objects taken from another context with
+	takeObjectsFrom count as registered when they were taken. Contexts are independent of
+	each other so two threads (or two jets) can each have their own without locking.
+	<br>To make code that uses MemoryManager<T>::Event() put its objects in a particular context
+	make an EventContext::Scope on the calling thread:
+	<br><pre>EventContext MyContext;</pre>
+	<br><pre>{</pre>
+	<br><pre>	EventContext::Scope InContext(&MyContext);</pre>
+	<br><pre>	DecayChain* Result = MyAlgo->calculateFor(MyJet); //Objects made go in MyContext</pre>
+	<br><pre>}</pre>
+	<br><pre>MyContext.delAllObjects();</pre>
+	<br>Without a Scope each thread has its own default event context. The run context
+	is shared by all threads and locks on registration.
+	*/
+	class EventContext
+	{
+	public:
+		EventContext(): _Shared(false)
+		{}
+		//! Destructor - deletes all held objects
+		~EventContext();
+		EventContext(const EventContext&) = delete;
+		EventContext& operator=(const EventContext&) = delete;
+
+		//! Register an object for deletion with this context
+		template <class T>
+		void registerObject(T* pointer);
+
+		//! Construct an object in this context's arena
+		/*!
+		The object is destroyed by this context like a registered one, never delete it.
+		\param args Arguments passed to the constructor of T
+		*/
+		template <class T, class... Args>
+		T* create(Args&&... args);
+
+		//! Delete all objects held by this context
+		/*!
+		Arena slabs used since the last call are kept for reuse, any others are freed.
+		*/
+		void delAllObjects();
+
+		//! Delete only the objects of type T held by this context
+		/*!
+		Objects are matched on the exact type they were registered or created as, so objects
+		registered as a base class pointer are not deleted here. They are deleted last
+		registered first, as in delAllObjects.
+		<br>Arena memory of the objects is not reused until the next delAllObjects.
+		*/
+		template <class T>
+		void delAllObjectsOfType();
+
+		//! Move all objects (and arena slabs) held by Other into this context
+		/*!
+		Used to collect objects made by worker threads, each with its own context, into
+		the context of the thread that started them. Other is left empty.
+		*/
+		void takeObjectsFrom(EventContext & Other);
+
+		//! Number of objects currently held
+		size_t numObjects() const;
+
+		//! Number of objects currently held that were made in the arena
+		size_t numArenaObjects() const;
+
+		//! Bytes of the arena used since the last delAllObjects
+		size_t arenaBytes() const;
+
+		//! Bytes of slab memory reserved by the arena
+		size_t arenaCapacity() const;
+
+		//! Number of objects held when delAllObjects was last called
+		inline size_t lastNumObjects() const
+		{return _LastNumObjects;}
+
+		//! Arena bytes used when delAllObjects was last called
+		inline size_t lastArenaBytes() const
+		{return _LastArenaBytes;}
+
+		//! The event context of the calling thread, innermost Scope or the thread default
+		static EventContext* current();
+
+		//! The run context, shared by all threads
+		static EventContext* run();
+
+		//! Makes a context the current event context of this thread for the lifetime of the Scope
+		/*!
+		A null context leaves the current context unchanged. Scopes may be nested.
+		*/
+		class Scope
+		{
+		public:
+			Scope(EventContext* Context);
+			~Scope();
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+		private:
+			EventContext* _Previous=nullptr;
+			bool _Active=false;
+		};
+
+	private:
+		struct Entry
+		{
+			void* Pointer;
+			void (*Deleter)(void*);
+			const void* Type;
+			bool InArena;
+		};
+
+		//The run context is the only shared one
+		EventContext(bool Shared): _Shared(Shared)
+		{}
+
+		struct Slab
+		{
+			char* Memory;
+			size_t Size;
+		};
+
+		template <class T>
+		static void _delete(void* pointer)
+		{delete static_cast<T*>(pointer);}
+
+		//Arena objects are only destroyed, their memory goes with the slab
+		template <class T>
+		static void _destroy(void* pointer)
+		{static_cast<T*>(pointer)->~T();}
+
+		//Key for the type T, unique to each type. Deleters can't be used as one as the
+		//linker may fold identical ones (e.g. the destructors of trivial types) together.
+		template <class T>
+		static const void* _typeKey()
+		{
+			static const char Key = 0;
+			return &Key;
+		}
+
+		void _add(const Entry & NewEntry);
+		void _delAllOfType(const void* Type);
+		void* _allocate(size_t Size, size_t Alignment);
+		void _addArenaObject(const Entry & NewEntry);
+
+		std::vector<Entry> _Objects{};
+		bool _Shared;
+		mutable std::mutex _Mutex{};
+
+		std::vector<Slab> _Slabs{};
+		size_t _CurrentSlab=0;
+		size_t _SlabUsed=0;
+		size_t _ArenaBytes=0;
+		size_t _ArenaObjects=0;
+		size_t _LastNumObjects=0;
+		size_t _LastArenaBytes=0;
+
+		//Size of a slab, larger objects get a slab to themselves
+		static const size_t _SlabSize = 65536;
+	};
+
+	template <class T>
+	void EventContext::registerObject(T* pointer)
+	{
+		Entry NewEntry = {pointer, &EventContext::_delete<T>, _typeKey<T>(), false};
+		this->_add(NewEntry);
+	}
+
+	template <class T, class... Args>
+	T* EventContext::create(Args&&... args)
+	{
+		static_assert(alignof(T) <= alignof(std::max_align_t), "EventContext arena can't align this type");
+		T* Object = new (this->_allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+		Entry NewEntry = {Object, &EventContext::_destroy<T>, _typeKey<T>(), true};
+		this->_addArenaObject(NewEntry);
+		return Object;
+	}
+
+	template <class T>
+	void EventContext::delAllObjectsOfType()
+	{
+		this->_delAllOfType(_typeKey<T>());
+	}
+
 	//! Base class for all MemoryManagers
 	class MemoryManagerType
 	{
@@ -15,33 +205,33 @@ namespace vertex_lcfi
 			//! Delete all objects that this MemoryManger has pointers to
 			virtual void delAll() =0;
 	};
-	
+
 	//! MemoryManager Controller - see MemoryManager
 	/*!
-	Keeps track of MemoryManagers for each type, and tells them to delete
-	their objects when delAllObjects is called.
+	Deletes all objects of all types in the current event context of the calling thread, or
+	the run context, when delAllObjects is called. Kept for the existing processors, see EventContext.
 	*/
 	class MetaMemoryManager
 	{
 	public:
-		//! Returns the Event duration singleton instance of the controller
+		//! Returns the Event duration instance of the controller
 		static MetaMemoryManager* Event();
-		//! Returns the Run duration singleton instance of the controller
+		//! Returns the Run duration instance of the controller
 		static MetaMemoryManager* Run();
 		//! Delete all objects of all types held by this instance
 		void delAllObjects();
-		//! Used by the MemoryManager of each type to alert the controller of its existance
+		//! No longer needed, types do not have to be registered
 		void registerType(MemoryManagerType* Type);
-		
+
 	protected:
 		//! Do not use
-		MetaMemoryManager();
+		MetaMemoryManager(bool Run);
 		//! Do not use
 		MetaMemoryManager(const MetaMemoryManager&);
 		//! Do not use
 		MetaMemoryManager& operator= (const MetaMemoryManager&);
 	private:
-		std::vector<MemoryManagerType*> _Types{};
+		bool _Run;
 	};
 
 	//!Memory management
@@ -53,77 +243,77 @@ namespace vertex_lcfi
 	<br>At the end of the event to free all objects of all types made using the above call:
 	<br><pre>MetaMemoryManager::Event()->delAllObjects();</pre>
 	<br>Similarly for run lifetime objects, replacing %Event with Run.
+<br>Objects made in bulk should instead use the arena of the context:
+<br><pre>myType* myObject = MemoryManager<myType>::Event()->create(construction parameters);</pre>
+	<br>This is a thin interface to EventContext, the objects are held by the current event
+	context of the calling thread (or the run context), so threads do not share event objects.
 	*/
 	template <class T>
 	class MemoryManager :
 	public MemoryManagerType
 	{
 	public:
-		//! Destructor - will delete all held objects
-		virtual ~MemoryManager();
-		//! Returns the Event duration singleton instance of the MemoryManager for type T
+		//! Destructor - objects are held by the context so nothing to do
+		virtual ~MemoryManager() {}
+		//! Returns the Event duration instance of the MemoryManager for type T
 		static MemoryManager<T>* Event();
-		//! Returns the Run duration singleton instance of the MemoryManager for type T
-		static MemoryManager<T>* Run();	
+		//! Returns the Run duration instance of the MemoryManager for type T
+		static MemoryManager<T>* Run();
 		//! Register an object for memory management
 		void registerObject(T* pointer);
-		//! Delete all objects held by this MemoryManager
+		//! Make an object in the context's arena, use instead of new and registerObject
+		template <class... Args>
+		T* create(Args&&... args);
+		//! Delete all objects of type T held by the context
 		void delAll();
-	//Protect the constructor, copy and assignment to prevent usage.		
+	//Protect the constructor, copy and assignment to prevent usage.
 	protected:
 		//! Do not use
-		MemoryManager<T>() {}
+		MemoryManager(bool Run) : _Run(Run) {}
 		//! Do not use
-		MemoryManager<T>(const MemoryManager<T>&) {}
+		MemoryManager(const MemoryManager<T>&) = delete;
 		//! Do not use
-		MemoryManager<T>& operator= (const MemoryManager<T>&) {return MemoryManager<T>();}
+		MemoryManager<T>& operator= (const MemoryManager<T>&) = delete;
 	private:
-		std::vector<T*> _Objects{};
-		
+		inline EventContext* _context() const
+		{return (_Run ? EventContext::run() : EventContext::current());}
+		bool _Run;
 	};
-	
-	template <class T>
-	MemoryManager<T>::~MemoryManager<T>()
-	{
-	//Delete all in case the user hasn't done so
-	this->delAll();
-	}
-	
+
 	template <class T>
 	MemoryManager<T>* MemoryManager<T>::Event()
 	{
-		static MemoryManager<T> eventInstance;
-		MetaMemoryManager::Event()->registerType(&eventInstance);
+		static MemoryManager<T> eventInstance(false);
 		return &eventInstance;
 	}
-	
+
 	template <class T>
 	MemoryManager<T>* MemoryManager<T>::Run()
 	{
-		static MemoryManager<T> runInstance;
-		MetaMemoryManager::Run()->registerType(&runInstance);
+		static MemoryManager<T> runInstance(true);
 		return &runInstance;
 	}
 
 	template <class T>
 	void MemoryManager<T>::registerObject(T* pointer)
 	{
-		_Objects.push_back(pointer);
+		this->_context()->registerObject(pointer);
 	}
-	
+
+	template <class T>
+	template <class... Args>
+	T* MemoryManager<T>::create(Args&&... args)
+	{
+		return this->_context()->template create<T>(std::forward<Args>(args)...);
+	}
+
 	template <class T>
 	void MemoryManager<T>::delAll()
 	{
-		for(typename std::vector<T*>::iterator iP = _Objects.begin();iP != _Objects.end();++iP)
-		{
-			//std::cout << "Delete object @" << (*iP) << std::endl;
-			delete (*iP);
-		}
-		_Objects.clear();
+		this->_context()->template delAllObjectsOfType<T>();
 	}
 
 
 }
 #endif //LCFIMEMMANAGE_H
 
-
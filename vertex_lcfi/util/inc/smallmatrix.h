@@ -0,0 +1,278 @@
+#ifndef SMALLMATRIX_H
+#define SMALLMATRIX_H
+
+#include <cmath>
+#include <cstddef>
+
+namespace vertex_lcfi
+{
+namespace util
+{
+//!Fixed size symmetric matrix held on the stack, for small dense kernels
+/*!
+Stores the lower triangle of an NxN symmetric matrix packed row by row in a plain
+array, all loops have a compile time length so are fully unrolled by the compiler.
+<br>This is used inside the hot loops (chi squared, tube values, inversions) in place
+of the uBLAS types, which at these sizes spend more time in expression templates and
+index checks than arithmetic. Convert to and from the uBLAS based types in matrix.h
+with the template constructor and copyTo, which only need operator()(i,j):
+<br><pre>SmallSymMatrix<5> Work(MyCovariance);</pre>
+<br><pre>if (Work.invert()) Work.copyTo(MyInverse);</pre>
+<br>2x2 and 3x3 are inverted in closed form, larger sizes by Cholesky decomposition.
+*/
+	template <size_t N>
+	class SmallSymMatrix
+	{
+	public:
+		//!Number of stored elements
+		static const size_t Size = N*(N+1)/2;
+
+		//!Zero matrix
+		SmallSymMatrix()
+		{
+			for (size_t k = 0; k < Size; ++k) _E[k] = 0.0;
+		}
+
+		//!Copy the lower triangle of any matrix type with operator()(i,j)
+		template <class M>
+		explicit SmallSymMatrix(const M & Matrix)
+		{
+			for (size_t i = 0; i < N; ++i)
+				for (size_t j = 0; j <= i; ++j)
+					_E[_index(i,j)] = Matrix(i,j);
+		}
+
+		//!Write all elements into any matrix type with operator()(i,j)
+		template <class M>
+		void copyTo(M & Matrix) const
+		{
+			for (size_t i = 0; i < N; ++i)
+				for (size_t j = 0; j < N; ++j)
+					Matrix(i,j) = (*this)(i,j);
+		}
+
+		//!Element access, either triangle
+		inline double operator()(size_t i, size_t j) const
+		{return (i >= j) ? _E[_index(i,j)] : _E[_index(j,i)];}
+
+		//!Element access, either triangle
+		inline double & operator()(size_t i, size_t j)
+		{return (i >= j) ? _E[_index(i,j)] : _E[_index(j,i)];}
+
+		//!Add another matrix element by element
+		inline SmallSymMatrix & operator+=(const SmallSymMatrix & Other)
+		{
+			for (size_t k = 0; k < Size; ++k) _E[k] += Other._E[k];
+			return *this;
+		}
+
+		//!Subtract another matrix element by element
+		inline SmallSymMatrix & operator-=(const SmallSymMatrix & Other)
+		{
+			for (size_t k = 0; k < Size; ++k) _E[k] -= Other._E[k];
+			return *this;
+		}
+
+		//!M.v for arrays v and Result of length N
+		inline void multiply(const double* v, double* Result) const
+		{
+			for (size_t i = 0; i < N; ++i)
+			{
+				double Sum = 0.0;
+				for (size_t j = 0; j < N; ++j)
+					Sum += (*this)(i,j)*v[j];
+				Result[i] = Sum;
+			}
+		}
+
+		//!v.M.v for an array v of length N
+		inline double quadraticForm(const double* v) const
+		{
+			double Result = 0.0;
+			for (size_t i = 0; i < N; ++i)
+			{
+				double Row = 0.0;
+				for (size_t j = 0; j < i; ++j)
+					Row += _E[_index(i,j)]*v[j];
+				Result += v[i]*(2.0*Row + _E[_index(i,i)]*v[i]);
+			}
+			return Result;
+		}
+
+		//!Invert in place
+		/*!
+		\return false, leaving the matrix unchanged, if it is singular
+		(or for N>3 not positive definite)
+		*/
+		bool invert();
+
+		//!Solve M.x = b by Cholesky decomposition
+		/*!
+		\param b Array of length N
+		\param x Array of length N, filled with the solution
+		\return false, leaving x unchanged, if the matrix is not positive definite
+		*/
+		bool solve(const double* b, double* x) const;
+
+	private:
+		static inline size_t _index(size_t i, size_t j)
+		{return i*(i+1)/2 + j;}
+
+		//Cholesky decomposition then inversion of the triangular factor
+		bool _invertCholesky();
+
+		double _E[Size];
+	};
+
+	template <size_t N>
+	bool SmallSymMatrix<N>::invert()
+	{
+		return this->_invertCholesky();
+	}
+
+	template <>
+	inline bool SmallSymMatrix<1>::invert()
+	{
+		if (_E[0] == 0.0) return false;
+		_E[0] = 1.0/_E[0];
+		return true;
+	}
+
+	template <>
+	inline bool SmallSymMatrix<2>::invert()
+	{
+		const double det = _E[0]*_E[2] - _E[1]*_E[1];
+		if (det == 0.0) return false;
+		const double a = _E[0];
+		_E[0] = _E[2]/det;
+		_E[1] = -_E[1]/det;
+		_E[2] = a/det;
+		return true;
+	}
+
+	template <>
+	inline bool SmallSymMatrix<3>::invert()
+	{
+		//Packed order 00,10,11,20,21,22
+		const double c00 = _E[2]*_E[5] - _E[4]*_E[4];
+		const double c10 = _E[4]*_E[3] - _E[1]*_E[5];
+		const double c20 = _E[1]*_E[4] - _E[2]*_E[3];
+		const double det = _E[0]*c00 + _E[1]*c10 + _E[3]*c20;
+		if (det == 0.0) return false;
+		const double c11 = _E[0]*_E[5] - _E[3]*_E[3];
+		const double c21 = _E[1]*_E[3] - _E[0]*_E[4];
+		const double c22 = _E[0]*_E[2] - _E[1]*_E[1];
+		_E[0] = c00/det;
+		_E[1] = c10/det;
+		_E[2] = c11/det;
+		_E[3] = c20/det;
+		_E[4] = c21/det;
+		_E[5] = c22/det;
+		return true;
+	}
+
+	template <size_t N>
+	bool SmallSymMatrix<N>::_invertCholesky()
+	{
+		//A = L.L^T
+		double L[Size];
+		for (size_t i = 0; i < N; ++i)
+		{
+			for (size_t j = 0; j <= i; ++j)
+			{
+				double Sum = _E[_index(i,j)];
+				for (size_t k = 0; k < j; ++k)
+					Sum -= L[_index(i,k)]*L[_index(j,k)];
+				if (i == j)
+				{
+					if (!(Sum > 0.0)) return false;
+					L[_index(i,i)] = std::sqrt(Sum);
+				}
+				else
+					L[_index(i,j)] = Sum/L[_index(j,j)];
+			}
+		}
+		//L^-1, lower triangular
+		for (size_t i = 0; i < N; ++i)
+		{
+			L[_index(i,i)] = 1.0/L[_index(i,i)];
+			for (size_t j = 0; j < i; ++j)
+			{
+				double Sum = 0.0;
+				for (size_t k = j; k < i; ++k)
+					Sum -= L[_index(i,k)]*L[_index(k,j)];
+				L[_index(i,j)] = Sum*L[_index(i,i)];
+			}
+		}
+		//A^-1 = L^-T.L^-1
+		for (size_t i = 0; i < N; ++i)
+		{
+			for (size_t j = 0; j <= i; ++j)
+			{
+				double Sum = 0.0;
+				for (size_t k = i; k < N; ++k)
+					Sum += L[_index(k,i)]*L[_index(k,j)];
+				_E[_index(i,j)] = Sum;
+			}
+		}
+		return true;
+	}
+
+	template <size_t N>
+	bool SmallSymMatrix<N>::solve(const double* b, double* x) const
+	{
+		double L[Size];
+		for (size_t i = 0; i < N; ++i)
+		{
+			for (size_t j = 0; j <= i; ++j)
+			{
+				double Sum = _E[_index(i,j)];
+				for (size_t k = 0; k < j; ++k)
+					Sum -= L[_index(i,k)]*L[_index(j,k)];
+				if (i == j)
+				{
+					if (!(Sum > 0.0)) return false;
+					L[_index(i,i)] = std::sqrt(Sum);
+				}
+				else
+					L[_index(i,j)] = Sum/L[_index(j,j)];
+			}
+		}
+		//L.y = b then L^T.x = y
+		double y[N];
+		for (size_t i = 0; i < N; ++i)
+		{
+			double Sum = b[i];
+			for (size_t k = 0; k < i; ++k)
+				Sum -= L[_index(i,k)]*y[k];
+			y[i] = Sum/L[_index(i,i)];
+		}
+		for (size_t i = N; i-- > 0;)
+		{
+			double Sum = y[i];
+			for (size_t k = i+1; k < N; ++k)
+				Sum -= L[_index(k,i)]*x[k];
+			x[i] = Sum/L[_index(i,i)];
+		}
+		return true;
+	}
+
+	//!r.M.r for a 2x2 matrix type with operator()(i,j), without temporaries
+	template <class M>
+	inline double quadraticForm2(const M & Matrix, const double r0, const double r1)
+	{
+		return Matrix(0,0)*r0*r0 + (Matrix(0,1)+Matrix(1,0))*r0*r1 + Matrix(1,1)*r1*r1;
+	}
+
+	//!r.M.r for a 3x3 matrix type and 3 vector type with operator(), without temporaries
+	template <class M, class V>
+	inline double quadraticForm3(const M & Matrix, const V & r)
+	{
+		const double r0 = r(0), r1 = r(1), r2 = r(2);
+		return r0*(Matrix(0,0)*r0 + Matrix(0,1)*r1 + Matrix(0,2)*r2)
+		     + r1*(Matrix(1,0)*r0 + Matrix(1,1)*r1 + Matrix(1,2)*r2)
+		     + r2*(Matrix(2,0)*r0 + Matrix(2,1)*r1 + Matrix(2,2)*r2);
+	}
+}
+}
+#endif //SMALLMATRIX_H
@@ -0,0 +1,202 @@
+#ifndef SMALLVECTOR_H
+#define SMALLVECTOR_H
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+//!Number of elements a SmallVector holds without the heap, unless given in the template
+/*!
+Set at build time with -DLCFI_SMALLVECTOR_SIZE=n, vertices with up to this many tracks
+are fitted without any heap allocation.
+*/
+#ifndef LCFI_SMALLVECTOR_SIZE
+#define LCFI_SMALLVECTOR_SIZE 16
+#endif
+
+namespace vertex_lcfi
+{
+namespace util
+{
+//!Vector of plain values with space for N of them inside the object
+/*!
+Behaves as a std::vector for the operations it has, but the first N elements are held
+in the object itself so a SmallVector that never grows beyond N makes no heap allocation,
+and copying one is a copy of its elements only. Past N the elements move to the heap
+as in std::vector.
+<br>Used for per-track results of vertex fits, which are made in the innermost loops
+of ZVTOP. Only for types that can be copied with memcpy, such as double.
+*/
+	template <class T, size_t N = LCFI_SMALLVECTOR_SIZE>
+	class SmallVector
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "SmallVector only holds types that can be copied with memcpy");
+		static_assert(N > 0, "SmallVector needs space for at least one element");
+	public:
+		typedef T value_type;
+		typedef size_t size_type;
+		typedef T* iterator;
+		typedef const T* const_iterator;
+
+		SmallVector()
+		: _Data(_Inline), _Size(0), _Capacity(N)
+		{}
+
+		//!Count copies of Value
+		explicit SmallVector(size_t Count, const T & Value = T())
+		: _Data(_Inline), _Size(0), _Capacity(N)
+		{
+			this->resize(Count, Value);
+		}
+
+		SmallVector(const SmallVector & Other)
+		: _Data(_Inline), _Size(0), _Capacity(N)
+		{
+			this->_assign(Other);
+		}
+
+		SmallVector(SmallVector && Other)
+		: _Data(_Inline), _Size(0), _Capacity(N)
+		{
+			this->_take(Other);
+		}
+
+		SmallVector & operator=(const SmallVector & Other)
+		{
+			if (this != &Other)
+				this->_assign(Other);
+			return *this;
+		}
+
+		SmallVector & operator=(SmallVector && Other)
+		{
+			if (this != &Other)
+			{
+				this->_release();
+				this->_take(Other);
+			}
+			return *this;
+		}
+
+		~SmallVector()
+		{
+			this->_release();
+		}
+
+		inline size_t size() const {return _Size;}
+		inline bool empty() const {return _Size == 0;}
+		inline size_t capacity() const {return _Capacity;}
+		//!True if the elements are held in the object, not on the heap
+		inline bool isInline() const {return _Data == _Inline;}
+
+		inline T & operator[](size_t i) {return _Data[i];}
+		inline const T & operator[](size_t i) const {return _Data[i];}
+		inline T & back() {return _Data[_Size-1];}
+		inline const T & back() const {return _Data[_Size-1];}
+
+		inline iterator begin() {return _Data;}
+		inline iterator end() {return _Data + _Size;}
+		inline const_iterator begin() const {return _Data;}
+		inline const_iterator end() const {return _Data + _Size;}
+
+		//!Remove all elements, keeping the memory
+		inline void clear() {_Size = 0;}
+
+		void reserve(size_t Capacity)
+		{
+			if (Capacity <= _Capacity)
+				return;
+			T* NewData = new T[Capacity];
+			if (_Size)
+				std::memcpy(NewData, _Data, _Size*sizeof(T));
+			this->_release();
+			_Data = NewData;
+			_Capacity = Capacity;
+		}
+
+		void push_back(const T & Value)
+		{
+			if (_Size == _Capacity)
+			{
+				//Value may be one of ours, so copy before growing
+				const T Copy = Value;
+				this->reserve(2*_Capacity);
+				_Data[_Size++] = Copy;
+			}
+			else
+				_Data[_Size++] = Value;
+		}
+
+		//!Resize, new elements are set to Value
+		void resize(size_t Size, const T & Value = T())
+		{
+			if (Size > _Capacity)
+			{
+				const T Copy = Value;
+				this->reserve(Size > 2*_Capacity ? Size : 2*_Capacity);
+				for (size_t i = _Size; i < Size; ++i) _Data[i] = Copy;
+			}
+			else
+				for (size_t i = _Size; i < Size; ++i) _Data[i] = Value;
+			_Size = Size;
+		}
+
+		//!Remove one element keeping the order of the rest
+		/*!
+		\return Iterator to the element after the one removed
+		*/
+		iterator erase(iterator Position)
+		{
+			std::memmove(Position, Position + 1, (end() - Position - 1)*sizeof(T));
+			--_Size;
+			return Position;
+		}
+
+	private:
+		void _assign(const SmallVector & Other)
+		{
+			_Size = 0;
+			this->reserve(Other._Size);
+			if (Other._Size)
+				std::memcpy(_Data, Other._Data, Other._Size*sizeof(T));
+			_Size = Other._Size;
+		}
+
+		//Take the heap memory of Other if it has any, else copy, leaving Other empty
+		void _take(SmallVector & Other)
+		{
+			if (Other.isInline())
+			{
+				_Data = _Inline;
+				_Capacity = N;
+				if (Other._Size)
+					std::memcpy(_Data, Other._Data, Other._Size*sizeof(T));
+			}
+			else
+			{
+				_Data = Other._Data;
+				_Capacity = Other._Capacity;
+				Other._Data = Other._Inline;
+				Other._Capacity = N;
+			}
+			_Size = Other._Size;
+			Other._Size = 0;
+		}
+
+		void _release()
+		{
+			if (!this->isInline())
+				delete [] _Data;
+			_Data = _Inline;
+			_Capacity = N;
+		}
+
+		T _Inline[N];
+		T* _Data;
+		size_t _Size;
+		size_t _Capacity;
+	};
+}
+}
+
+#endif //SMALLVECTOR_H
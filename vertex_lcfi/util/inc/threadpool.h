@@ -0,0 +1,77 @@
+#ifndef LCFITHREADPOOL_H
+#define LCFITHREADPOOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstddef>
+
+namespace vertex_lcfi
+{
+namespace util
+{
+//!Shared pool of worker threads for running independent tasks in parallel
+/*!
+There is one pool per process, see instance(). Threads are started the first time
+they are asked for and then reused.
+<br>parallelFor runs a body for a range of task numbers using up to a given number of
+threads, the calling thread included. The caller works on its own loop while it waits
+so nested calls (e.g. a parallel loop inside a task of another) can't deadlock.
+<br>Each thread working on a loop is given a slot number, no two threads have the same
+slot at the same time so the slot can be used to index per thread resources:
+<br><pre>std::vector<VertexFitterLSM> Fitters(NumThreads);</pre>
+<br><pre>ThreadPool::instance()->parallelFor(NumFits, NumThreads, [&](size_t Task, size_t Slot) {</pre>
+<br><pre>	Fitters[Slot].fitVertex(...);</pre>
+<br><pre>});</pre>
+<br>Tasks are started in increasing order but may finish in any order.
+*/
+	class ThreadPool
+	{
+	public:
+		//!Body of a parallel loop, called with the task number and the slot of the thread
+		typedef std::function<void(size_t Task, size_t Slot)> LoopBody;
+
+		//!The process wide pool
+		static ThreadPool* instance();
+
+		//!Stops and joins the workers
+		~ThreadPool();
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		//!Run Body for tasks 0 to NumTasks-1 on at most NumThreads threads
+		/*!
+		Returns once all tasks have finished. With NumThreads<2 the loop is run in order on
+		the calling thread. If a task throws no new tasks are started and the first exception
+		is rethrown here.
+		\param NumTasks Number of tasks
+		\param NumThreads Maximum number of threads, including the caller, slots are 0 to NumThreads-1
+		\param Body Called once for each task
+		*/
+		void parallelFor(size_t NumTasks, size_t NumThreads, const LoopBody & Body);
+
+		//!Number of worker threads started so far
+		size_t numWorkers() const;
+
+	private:
+		ThreadPool() {}
+
+		struct Loop;
+
+		void _startWorkers(size_t NumWorkers);
+		void _workerMain();
+		static void _work(Loop* MyLoop, size_t Slot);
+
+		mutable std::mutex _Mutex{};
+		std::condition_variable _LoopQueued{};
+		std::condition_variable _LoopLeft{};
+		std::deque<Loop*> _Loops{};
+		std::vector<std::thread> _Workers{};
+		bool _Stopping=false;
+	};
+}
+}
+#endif //LCFITHREADPOOL_H
@@ -0,0 +1,36 @@
+#include "../inc/helixcircle.h"
+#include "../inc/helixrep.h"
+#include <cmath>
+
+namespace vertex_lcfi { namespace util
+{
+	HelixCircle::HelixCircle(double D0, double Phi, double InvR)
+	{
+		_Line = (InvR == 0.0);
+		if (!_Line)
+		{
+			const double SinPhi = sin(Phi);
+			const double CosPhi = cos(Phi);
+			_CentreX = -D0*SinPhi + SinPhi/InvR;
+			_CentreY = D0*CosPhi - CosPhi/InvR;
+			_Radius = fabs(1.0/InvR);
+		}
+	}
+
+	HelixCircle::HelixCircle(const HelixRep & Helix)
+	: HelixCircle(Helix.d0(), Helix.phi(), Helix.invR())
+	{
+	}
+
+	double HelixCircle::gapTo(const HelixCircle & Other) const
+	{
+		if (_Line || Other._Line) return 0.0;
+		const double Separation = hypot(Other._CentreX-_CentreX, Other._CentreY-_CentreY);
+		//Apart, one inside the other, or crossing
+		const double Outside = Separation - _Radius - Other._Radius;
+		const double Inside = fabs(_Radius - Other._Radius) - Separation;
+		if (Outside > 0.0) return Outside;
+		if (Inside > 0.0) return Inside;
+		return 0.0;
+	}
+}}
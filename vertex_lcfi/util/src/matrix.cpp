@@ -13,11 +13,21 @@ namespace vertex_lcfi
 {
 namespace util
 {
-/* Matrix inversion routine.- only 3x3 for now - make sure input type is not symetric
-    Uses lu_factorize and lu_substitute in uBLAS to invert a matrix */
-//template<class T>
-SymMatrix5x5 InvertMatrix5x5(SymMatrix5x5 input)
+namespace
+{
+/* Symmetric inversion - Cholesky on the stack, falls back to lu_factorize
+    and lu_substitute in uBLAS if the input is not positive definite */
+template<class T, size_t N>
+T InvertSymmetric(const T & input)
 {
+	SmallSymMatrix<N> Work(input);
+	if (Work.invert())
+	{
+		T Result;
+		Work.copyTo(Result);
+		return Result;
+	}
+	
 	using namespace boost::numeric::ublas;
  	// create a working copy of the input
 	matrix<double>  A(input);
@@ -27,7 +37,7 @@ SymMatrix5x5 InvertMatrix5x5(SymMatrix5x5 input)
 	//std::cout << "A2: " << A << std::endl;
 	
  	// create identity matrix of "inverse"
-	matrix<double>  B(5,5);
+	matrix<double>  B(N,N);
 	B.clear();
 	for (unsigned int i = 0; i < A.size1(); i++)
 		B(i,i) = 1;
@@ -37,6 +47,17 @@ SymMatrix5x5 InvertMatrix5x5(SymMatrix5x5 input)
 	//std::cout << "B2: " << B << std::endl;
 	return B;
 }
+}
+
+SymMatrix5x5 InvertMatrix5x5(SymMatrix5x5 input)
+{
+	return InvertSymmetric<SymMatrix5x5,5>(input);
+}
+
+SymMatrix6x6 InvertMatrix6x6(SymMatrix6x6 input)
+{
+	return InvertSymmetric<SymMatrix6x6,6>(input);
+}
 
 double determinant(Matrix3x3 a)
 {
@@ -60,33 +81,16 @@ Matrix3x3 InvertMatrix(Matrix3x3 a)//const ublas::matrix<T>& input, ublas::matri
 	//std::cout << det << std::endl;
 	Matrix3x3 inverse;
 	
+	//Cofactors written out, rows and columns after i and j taken cyclically so no signs needed
 	for (short j=0;j<3;j++) 
 	{
+		const short j1 = (j+1)%3;
+		const short j2 = (j+2)%3;
 		for (short i=0;i<3;i++) 
 		{
-
-			//Form the adjoint a_ij */
-         		matrix<double> c(2,2);
-			short i1 = 0;
-			for (short ii=0;ii<3;ii++) 
-				{
-					if (ii == i)
-						continue;
-					short j1 = 0;
-					for (short jj=0;jj<3;jj++) 
-					{
-						if (jj == j)
-							continue;
-						c(i1,j1) = a(ii,jj);
-						j1++;
-					}
-					i1++;
-				}
-
-				/* Calculate the determinate */
-				double tempdet = (c(0,0)*c(1,1)) - (c(1,0)*c(0,1));
-				/* Fill in the elements of the cofactor */
-				inverse(j,i) = (pow(-1.0,i+j+2.0) * tempdet)/det; //Note inline transposition
+			const short i1 = (i+1)%3;
+			const short i2 = (i+2)%3;
+			inverse(j,i) = (a(i1,j1)*a(i2,j2) - a(i1,j2)*a(i2,j1))/det; //Note inline transposition
 		}
 	}
 	//std::cout << inverse <<std::endl<<std::endl;
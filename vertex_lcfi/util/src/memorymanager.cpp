@@ -2,33 +2,230 @@
 
 namespace vertex_lcfi
 {
-	
-	MetaMemoryManager::MetaMemoryManager()
+	namespace
+	{
+		//Innermost Scope on this thread, null if none
+		thread_local EventContext* currentContext = nullptr;
+	}
+
+	EventContext::~EventContext()
+	{
+		this->delAllObjects();
+		for(std::vector<Slab>::iterator iSlab = _Slabs.begin();iSlab != _Slabs.end();++iSlab)
+			::operator delete(iSlab->Memory);
+	}
+
+	void EventContext::_add(const Entry & NewEntry)
+	{
+		if (_Shared)
+		{
+			std::lock_guard<std::mutex> Lock(_Mutex);
+			_Objects.push_back(NewEntry);
+		}
+		else
+			_Objects.push_back(NewEntry);
+	}
+
+	void EventContext::_addArenaObject(const Entry & NewEntry)
+	{
+		std::unique_lock<std::mutex> Lock(_Mutex, std::defer_lock);
+		if (_Shared) Lock.lock();
+		_Objects.push_back(NewEntry);
+		++_ArenaObjects;
+	}
+
+	void* EventContext::_allocate(size_t Size, size_t Alignment)
+	{
+		std::unique_lock<std::mutex> Lock(_Mutex, std::defer_lock);
+		if (_Shared) Lock.lock();
+		//Carry on through the slabs kept from earlier events before making a new one
+		while (_CurrentSlab < _Slabs.size())
+		{
+			size_t Start = (_SlabUsed + Alignment - 1) & ~(Alignment - 1);
+			if (Start + Size <= _Slabs[_CurrentSlab].Size)
+			{
+				_SlabUsed = Start + Size;
+				_ArenaBytes += Size;
+				return _Slabs[_CurrentSlab].Memory + Start;
+			}
+			++_CurrentSlab;
+			_SlabUsed = 0;
+		}
+		Slab NewSlab;
+		NewSlab.Size = (Size > _SlabSize) ? Size : _SlabSize;
+		NewSlab.Memory = static_cast<char*>(::operator new(NewSlab.Size));
+		_Slabs.push_back(NewSlab);
+		_CurrentSlab = _Slabs.size() - 1;
+		_SlabUsed = Size;
+		_ArenaBytes += Size;
+		return NewSlab.Memory;
+	}
+
+	void EventContext::delAllObjects()
+	{
+		//Take the list first so that deletion can't see a half deleted list
+		std::vector<Entry> ToDelete;
+		{
+			std::unique_lock<std::mutex> Lock(_Mutex, std::defer_lock);
+			if (_Shared) Lock.lock();
+			ToDelete.swap(_Objects);
+			_LastNumObjects = ToDelete.size();
+			_LastArenaBytes = _ArenaBytes;
+		}
+		for(std::vector<Entry>::reverse_iterator iE = ToDelete.rbegin();iE != ToDelete.rend();++iE)
+			(iE->Deleter)(iE->Pointer);
+
+		//All arena objects are gone, so start the slabs again, unless another
+		//thread has added to the (shared) context in the meantime
+		std::unique_lock<std::mutex> Lock(_Mutex, std::defer_lock);
+		if (_Shared) Lock.lock();
+		if (_Objects.empty())
+		{
+			//Keep as many slabs as were used, the rest (e.g. from an earlier, larger
+			//event or taken from another context) would otherwise be kept for good
+			for (size_t iSlab = _CurrentSlab + 1; iSlab < _Slabs.size(); ++iSlab)
+				::operator delete(_Slabs[iSlab].Memory);
+			if (_CurrentSlab + 1 < _Slabs.size())
+				_Slabs.resize(_CurrentSlab + 1);
+			_CurrentSlab = 0;
+			_SlabUsed = 0;
+			_ArenaBytes = 0;
+			_ArenaObjects = 0;
+		}
+	}
+
+	void EventContext::_delAllOfType(const void* Type)
+	{
+		std::vector<Entry> ToDelete;
+		{
+			std::unique_lock<std::mutex> Lock(_Mutex, std::defer_lock);
+			if (_Shared) Lock.lock();
+			std::vector<Entry> Kept;
+			for(std::vector<Entry>::const_iterator iE = _Objects.begin();iE != _Objects.end();++iE)
+			{
+				if (iE->Type == Type)
+				{
+					ToDelete.push_back(*iE);
+					if (iE->InArena) --_ArenaObjects;
+				}
+				else
+					Kept.push_back(*iE);
+			}
+			_Objects.swap(Kept);
+		}
+		for(std::vector<Entry>::reverse_iterator iE = ToDelete.rbegin();iE != ToDelete.rend();++iE)
+			(iE->Deleter)(iE->Pointer);
+	}
+
+	void EventContext::takeObjectsFrom(EventContext & Other)
+	{
+		if (&Other == this) return;
+		std::unique_lock<std::mutex> Lock(_Mutex, std::defer_lock);
+		std::unique_lock<std::mutex> OtherLock(Other._Mutex, std::defer_lock);
+		if (_Shared && Other._Shared) std::lock(Lock, OtherLock);
+		else if (_Shared) Lock.lock();
+		else if (Other._Shared) OtherLock.lock();
+
+		_Objects.insert(_Objects.end(), Other._Objects.begin(), Other._Objects.end());
+		Other._Objects.clear();
+		//The slabs Other has used so far go in before our current slab, so they count as used
+		//until our next reset. Its unused ones are left with it.
+		size_t NumUsed = Other._Slabs.size();
+		if (Other._CurrentSlab < Other._Slabs.size())
+			NumUsed = Other._CurrentSlab + ((Other._SlabUsed > 0) ? 1 : 0);
+		_Slabs.insert(_Slabs.begin()+_CurrentSlab, Other._Slabs.begin(), Other._Slabs.begin()+NumUsed);
+		_CurrentSlab += NumUsed;
+		Other._Slabs.erase(Other._Slabs.begin(), Other._Slabs.begin()+NumUsed);
+		Other._CurrentSlab = 0;
+		Other._SlabUsed = 0;
+		_ArenaBytes += Other._ArenaBytes;
+		_ArenaObjects += Other._ArenaObjects;
+		Other._ArenaBytes = 0;
+		Other._ArenaObjects = 0;
+	}
+
+	size_t EventContext::numObjects() const
+	{
+		std::unique_lock<std::mutex> Lock(_Mutex, std::defer_lock);
+		if (_Shared) Lock.lock();
+		return _Objects.size();
+	}
+
+	size_t EventContext::numArenaObjects() const
+	{
+		std::unique_lock<std::mutex> Lock(_Mutex, std::defer_lock);
+		if (_Shared) Lock.lock();
+		return _ArenaObjects;
+	}
+
+	size_t EventContext::arenaBytes() const
+	{
+		std::unique_lock<std::mutex> Lock(_Mutex, std::defer_lock);
+		if (_Shared) Lock.lock();
+		return _ArenaBytes;
+	}
+
+	size_t EventContext::arenaCapacity() const
+	{
+		std::unique_lock<std::mutex> Lock(_Mutex, std::defer_lock);
+		if (_Shared) Lock.lock();
+		size_t Capacity = 0;
+		for(std::vector<Slab>::const_iterator iSlab = _Slabs.begin();iSlab != _Slabs.end();++iSlab)
+			Capacity += iSlab->Size;
+		return Capacity;
+	}
+
+	EventContext* EventContext::current()
+	{
+		if (currentContext) return currentContext;
+		static thread_local EventContext threadInstance;
+		return &threadInstance;
+	}
+
+	EventContext* EventContext::run()
+	{
+		static EventContext runInstance(true);
+		return &runInstance;
+	}
+
+	EventContext::Scope::Scope(EventContext* Context)
+	: _Previous(currentContext),_Active(Context!=nullptr)
+	{
+		if (_Active) currentContext = Context;
+	}
+
+	EventContext::Scope::~Scope()
+	{
+		if (_Active) currentContext = _Previous;
+	}
+
+	MetaMemoryManager::MetaMemoryManager(bool Run)
+	: _Run(Run)
 	{}
-	
-	MetaMemoryManager* MetaMemoryManager::Event() 
+
+	MetaMemoryManager* MetaMemoryManager::Event()
 	{
-		static MetaMemoryManager eventInstance;
+		static MetaMemoryManager eventInstance(false);
 		return &eventInstance;
 	}
-  
-	MetaMemoryManager* MetaMemoryManager::Run() 
+
+	MetaMemoryManager* MetaMemoryManager::Run()
 	{
-		static MetaMemoryManager runInstance;
+		static MetaMemoryManager runInstance(true);
 		return &runInstance;
 	}
-  
+
 	void MetaMemoryManager::delAllObjects()
 	{
-		for(std::vector<MemoryManagerType*>::iterator iMem = _Types.begin();iMem != _Types.end();++iMem)
-			(*iMem)->delAll();
+		if (_Run)
+			EventContext::run()->delAllObjects();
+		else
+			EventContext::current()->delAllObjects();
 	}
-	
-	void MetaMemoryManager::registerType(MemoryManagerType* Type)
+
+	void MetaMemoryManager::registerType(MemoryManagerType*)
 	{
-		_Types.push_back(Type);
 	}
-	
-}
 
+}
 
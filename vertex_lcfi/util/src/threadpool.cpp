@@ -0,0 +1,138 @@
+#include "../inc/threadpool.h"
+
+#include <atomic>
+#include <exception>
+#include <algorithm>
+
+namespace vertex_lcfi
+{
+namespace util
+{
+	struct ThreadPool::Loop
+	{
+		const LoopBody* Body;
+		size_t NumTasks;
+		size_t NumSlots;
+		std::atomic<size_t> NextTask;
+		//These are guarded by the pool mutex
+		size_t NextSlot;
+		size_t Working;
+		std::mutex ErrorMutex;
+		std::exception_ptr Error;
+	};
+
+	ThreadPool* ThreadPool::instance()
+	{
+		static ThreadPool pool;
+		return &pool;
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> Lock(_Mutex);
+			_Stopping = true;
+		}
+		_LoopQueued.notify_all();
+		for (std::vector<std::thread>::iterator iWorker = _Workers.begin();iWorker != _Workers.end();++iWorker)
+			iWorker->join();
+	}
+
+	size_t ThreadPool::numWorkers() const
+	{
+		std::lock_guard<std::mutex> Lock(_Mutex);
+		return _Workers.size();
+	}
+
+	void ThreadPool::parallelFor(size_t NumTasks, size_t NumThreads, const LoopBody & Body)
+	{
+		if (NumThreads < 2 || NumTasks < 2)
+		{
+			for (size_t Task = 0; Task < NumTasks; ++Task)
+				Body(Task, 0);
+			return;
+		}
+
+		Loop MyLoop;
+		MyLoop.Body = &Body;
+		MyLoop.NumTasks = NumTasks;
+		MyLoop.NumSlots = std::min(NumThreads, NumTasks);
+		MyLoop.NextTask = 0;
+		MyLoop.NextSlot = 1; //Slot 0 is the caller
+		MyLoop.Working = 0;
+		{
+			std::lock_guard<std::mutex> Lock(_Mutex);
+			this->_startWorkers(MyLoop.NumSlots-1);
+			_Loops.push_back(&MyLoop);
+		}
+		_LoopQueued.notify_all();
+
+		_work(&MyLoop, 0);
+
+		//All tasks are taken, wait for the ones still running on workers
+		{
+			std::unique_lock<std::mutex> Lock(_Mutex);
+			std::deque<Loop*>::iterator iLoop = std::find(_Loops.begin(), _Loops.end(), &MyLoop);
+			if (iLoop != _Loops.end())
+				_Loops.erase(iLoop);
+			_LoopLeft.wait(Lock, [&MyLoop]{return MyLoop.Working == 0;});
+		}
+		if (MyLoop.Error)
+			std::rethrow_exception(MyLoop.Error);
+	}
+
+	void ThreadPool::_startWorkers(size_t NumWorkers)
+	{
+		while (_Workers.size() < NumWorkers)
+			_Workers.push_back(std::thread(&ThreadPool::_workerMain, this));
+	}
+
+	void ThreadPool::_workerMain()
+	{
+		std::unique_lock<std::mutex> Lock(_Mutex);
+		while (1)
+		{
+			_LoopQueued.wait(Lock, [this]{return _Stopping || !_Loops.empty();});
+			if (_Stopping)
+				return;
+			Loop* MyLoop = _Loops.front();
+			//Nothing left to join in on, drop it from the queue, its caller is waiting on it
+			if (MyLoop->NextSlot >= MyLoop->NumSlots || MyLoop->NextTask >= MyLoop->NumTasks)
+			{
+				_Loops.pop_front();
+				continue;
+			}
+			size_t Slot = MyLoop->NextSlot++;
+			++MyLoop->Working;
+			Lock.unlock();
+			_work(MyLoop, Slot);
+			Lock.lock();
+			--MyLoop->Working;
+			if (MyLoop->Working == 0)
+				_LoopLeft.notify_all();
+		}
+	}
+
+	void ThreadPool::_work(Loop* MyLoop, size_t Slot)
+	{
+		while (1)
+		{
+			size_t Task = MyLoop->NextTask++;
+			if (Task >= MyLoop->NumTasks)
+				return;
+			try
+			{
+				(*MyLoop->Body)(Task, Slot);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> Lock(MyLoop->ErrorMutex);
+				if (!MyLoop->Error)
+					MyLoop->Error = std::current_exception();
+				//Stop handing out tasks
+				MyLoop->NextTask = MyLoop->NumTasks;
+			}
+		}
+	}
+}
+}
@@ -27,17 +27,8 @@ namespace vertex_lcfi
                      double & ChiSquaredOfFit);
       
       void fitVertex(const std::vector<TrackState*> & Tracks, 
-                     InteractionPoint* IP, Vector3 & Result, 
-                     double & ChiSquaredOfFit, 
-                     std::map<TrackState*,double> & ChiSquaredOfTrack,
-                     double & ChiSquaredOfIP);
-      
-      void fitVertex(const std::vector<TrackState*> & Tracks, 
-                     InteractionPoint* IP, Vector3 & Result, 
-                     Matrix3x3 & ResultError, 
-                     double & ChiSquaredOfFit, 
-                     std::map<TrackState*,double> & ChiSquaredOfTrack,
-                     double & ChiSquaredOfIP);
+                     InteractionPoint* IP, VertexFitResult & Result, 
+                     bool CalculateError);
 
       void fitVertex(const std::vector<TrackState*> & Tracks, 
                      InteractionPoint* IP, 
@@ -3,9 +3,10 @@
 
 #include "../../util/inc/vector3.h"
 #include "../../util/inc/matrix.h"
+#include "../../util/inc/smallmatrix.h"
+#include "vertexfitter.h"
 #include <vector>
 #include <list>
-#include <map>
 
 using namespace vertex_lcfi::util;
 
@@ -24,6 +25,7 @@ namespace ZVTOP
 	class VertexResolver;
 	class VertexFuncMaxFinder;
 	class VertexFunction;
+	class StrategyProvider;
 	
 	class VertexFitterLSM;
 	class VertexResolverEqualSteps;
@@ -37,6 +39,10 @@ Three external algorithm classes are used, VertexFitter,VertexResolver and Verte
 The perticular instance of these algorithms to be used by each candidate vertex is specified at construction, the constuctor
 defaults to fallback algorithms if none are specified. 
 <br>
+Where none is specified the vertex looks each algorithm up when it is used, first from its StrategyProvider (see strategies())
+and then from the fallbacks. The fallbacks hold working state, so each thread has its own, and a vertex made on one
+thread can be used on another.
+<br>
 In order to minimise the number of times a vertex is fitted, this only happens when needed.
 When a candidate vertex is created or its track content changed a flag is set (_FitIsValid) to 0,
 a function such as position() will check the status of this flag and fit the vertex if needed,
@@ -60,11 +66,11 @@ and then position().
 	
 	public:
 		
-		/*! This typedef determines the VertexFitter used if none is specified in the CandidateVertex constuctor. If changed you may need to change the includes in the cpp file*/
+		/*! This typedef determines the VertexFitter used if none is specified in the CandidateVertex constuctor or by its strategies(), one per thread. If changed you may need to change the includes in the cpp file*/
 		typedef VertexFitterLSM FallbackVertexFitter;
-		/*! This typedef determines the VertexResolver used if none is specified in the CandidateVertex constuctor. If changed you may need to change the includes in the cpp file*/
+		/*! This typedef determines the VertexResolver used if none is specified in the CandidateVertex constuctor or by its strategies(), one per thread. If changed you may need to change the includes in the cpp file*/
 		typedef VertexResolverEqualSteps FallbackVertexResolver;
-		/*! This typedef determines the VertexFuncMaxFinder used if none is specified in the CandidateVertex constuctor. If changed you may need to change the includes in the cpp file*/
+		/*! This typedef determines the VertexFuncMaxFinder used if none is specified in the CandidateVertex constuctor or by its strategies(), one per thread. If changed you may need to change the includes in the cpp file*/
 		typedef VertexFuncMaxFinderClassicStepper FallbackVertexFuncMaxFinder;
 		
 		//!Type of resolution to perform - vertex position or the nearest found maximum
@@ -77,11 +83,11 @@ and then position().
 		when needed. Note defaults for fitter, resolver and max finder.
 		\param Tracks A vector of pointers to the TrackState objects that form this CandidateVertex. The same TrackState can be given to multiple CandidateVertex objects, but this is may not desierable as the TrackState would then be swum back and forth between the vertices.
 		\param VertexFunction Pointer to the function which is explored for the nearest maxima to the fit vertex.
-		\param Fitter Pointer to the VertexFitter that the vertex uses to fit itself. Defaults to the typedef FallbackVertexFitter.
-		\param Resolver Pointer to the VertexResolver that the vertex uses to resolve itself from others. Defaults to the typedef FallbackVertexResolver.
-		\param MaxFinder Pointer to the VertexFuncMaxFinder that the vertex uses to find the nearest VertexFunction maximum. Defaults to the typedef FallbackVertexFuncMaxFinder.
+		\param Fitter Pointer to the VertexFitter that the vertex uses to fit itself. Defaults (null) to the FallbackVertexFitter of the thread using the vertex.
+		\param Resolver Pointer to the VertexResolver that the vertex uses to resolve itself from others. Defaults (null) to the FallbackVertexResolver of the thread using the vertex.
+		\param MaxFinder Pointer to the VertexFuncMaxFinder that the vertex uses to find the nearest VertexFunction maximum. Defaults (null) to the FallbackVertexFuncMaxFinder of the thread using the vertex.
 		*/
-		CandidateVertex(const std::vector<TrackState*>& Tracks, VertexFunction* VertexFunction, VertexFitter* Fitter=_getFallbackFitter(), VertexResolver* Resolver=_getFallbackResolver(), VertexFuncMaxFinder* MaxFinder=_getFallbackMaxFinder());
+		CandidateVertex(const std::vector<TrackState*>& Tracks, VertexFunction* VertexFunction, VertexFitter* Fitter=0, VertexResolver* Resolver=0, VertexFuncMaxFinder* MaxFinder=0);
 		
 		//! Constuct with Track list, InteractionPoint and VertexFunction
 		/*!
@@ -91,22 +97,20 @@ and then position().
 		\param Tracks A vector of pointers to the TrackState objects that form this CandidateVertex. The same TrackState can be given to multiple CandidateVertex objects, but this is may not desierable as the TrackState would then be swum back and forth between the vertices.
 		\param IP A pointer to the InteractionPoint associated with the vertex
 		\param VertexFunction Pointer to the function which is explored for the nearest maxima to the fit vertex.
-		\param Fitter Pointer to the VertexFitter that the vertex uses to fit itself. Defaults to the typedef FallbackVertexFitter.
-		\param Resolver Pointer to the VertexResolver that the vertex uses to resolve itself from others. Defaults to the typedef FallbackVertexResolver.
-		\param MaxFinder Pointer to the VertexFuncMaxFinder that the vertex uses to find the nearest VertexFunction maximum. Defaults to the typedef FallbackVertexFuncMaxFinder.
+		\param Fitter Pointer to the VertexFitter that the vertex uses to fit itself. Defaults (null) to the FallbackVertexFitter of the thread using the vertex.
+		\param Resolver Pointer to the VertexResolver that the vertex uses to resolve itself from others. Defaults (null) to the FallbackVertexResolver of the thread using the vertex.
+		\param MaxFinder Pointer to the VertexFuncMaxFinder that the vertex uses to find the nearest VertexFunction maximum. Defaults (null) to the FallbackVertexFuncMaxFinder of the thread using the vertex.
 		*/
-		CandidateVertex(const std::vector<TrackState*>& Tracks, InteractionPoint* IP, VertexFunction* VertexFunction, VertexFitter* Fitter=_getFallbackFitter(), VertexResolver* Resolver=_getFallbackResolver(), VertexFuncMaxFinder* MaxFinder=_getFallbackMaxFinder());
+		CandidateVertex(const std::vector<TrackState*>& Tracks, InteractionPoint* IP, VertexFunction* VertexFunction, VertexFitter* Fitter=0, VertexResolver* Resolver=0, VertexFuncMaxFinder* MaxFinder=0);
 		
 		//!Construct a CandidateVertex with fit information
 		/*!
 		Creates a CandidateVertex that contains fit information and in which the fit flag is set valid.
-		\param Position Position of the fitted vertex
-		\param PositionError ErrorMatrix of the fitted vertex
-		\param ChiSquaredOfFit Chi Squared of total fit
-		\param ChiSquaredOfTrack A std::map of track chi squareds indexed by trackstate pointer
-		\param ChiSquaredOfIP Chi squared contribution of IP object (if any)
+		\param Tracks A vector of pointers to the TrackState objects that form this CandidateVertex.
+		\param IP A pointer to the InteractionPoint associated with the vertex
+		\param Fit Result of fitting Tracks and IP, with the error of the position, the track chi squareds in the order of Tracks
 		*/
-		CandidateVertex(const Vector3 & Position, const Matrix3x3 & PositionError, double ChiSquaredOfFit, std::map<TrackState*,double> ChiSquaredOfTrack, double ChiSquaredOfIP);
+		CandidateVertex(const std::vector<TrackState*>& Tracks, InteractionPoint* IP, const VertexFitResult & Fit);
 
 		//!Construct a CandidateVertex by merging other CandidateVertices
 		/*!
@@ -114,12 +118,12 @@ and then position().
 		removed by checking if TrackStates have the same parent, if there is more than one IP object the IP from the last
 		vertex in the list is used. If the list is empty you get an empty vertex! Ignores vertex functions.
 		\param Vertices Position of the fitted vertex
-		\param Fitter Pointer to the VertexFitter that the vertex uses to fit itself. Defaults to the typedef FallbackVertexFitter.
-		\param Resolver Pointer to the VertexResolver that the vertex uses to resolve itself from others. Defaults to the typedef FallbackVertexResolver.
-		\param MaxFinder Pointer to the VertexFuncMaxFinder that the vertex uses to find the nearest VertexFunction maximum. Defaults to the typedef FallbackVertexFuncMaxFinder.
+		\param Fitter Pointer to the VertexFitter that the vertex uses to fit itself. Defaults (null) to the FallbackVertexFitter of the thread using the vertex.
+		\param Resolver Pointer to the VertexResolver that the vertex uses to resolve itself from others. Defaults (null) to the FallbackVertexResolver of the thread using the vertex.
+		\param MaxFinder Pointer to the VertexFuncMaxFinder that the vertex uses to find the nearest VertexFunction maximum. Defaults (null) to the FallbackVertexFuncMaxFinder of the thread using the vertex.
 
 		*/
-		CandidateVertex(const std::vector<CandidateVertex*> & Vertices, VertexFitter* Fitter=_getFallbackFitter(), VertexResolver* Resolver=_getFallbackResolver(), VertexFuncMaxFinder* MaxFinder=_getFallbackMaxFinder());
+		CandidateVertex(const std::vector<CandidateVertex*> & Vertices, VertexFitter* Fitter=0, VertexResolver* Resolver=0, VertexFuncMaxFinder* MaxFinder=0);
 		
 		//! Destructor
 		/*!
@@ -129,6 +133,16 @@ and then position().
 		{}
 		CandidateVertex(const CandidateVertex&) = delete;
 		CandidateVertex& operator=(const CandidateVertex&) = delete;
+
+		//!Provider of the algo classes, null for none
+		/*!
+		Where no fitter, resolver or max finder was given at construction the vertex asks the provider for one each
+		time it needs it, so that each thread can be given its own. If the provider gives none (or there is no
+		provider) the fallback of the calling thread is used. Not owned by the vertex.
+		*/
+		inline StrategyProvider* strategies() const {return _Strategies;}
+		inline StrategyProvider* &strategies() {return _Strategies;}
+
 		//! Remove the first reference to a TrackState from this vertices track list
 		/*!
 		This vertices TrackState list is searched for the first reference to TrackToRemove. If found it is removed and the fit invalidated via invalidateFit().
@@ -250,6 +264,12 @@ and then position().
 		*/
 		bool findVertexFuncMax() const;
 		
+		//!Find the nearest vertex function maximum using MaxFinder
+		/*!As findVertexFuncMax() but with a given VertexFuncMaxFinder, e.g. one per thread when
+		vertices are processed in parallel.
+		*/
+		bool findVertexFuncMax(VertexFuncMaxFinder* MaxFinder) const;
+		
 		
 		//!Resolve two vertices with this vertices resolver.
 		/*!	Uses the VertexResolver stored in _Resolver to resolve this vertex and the one specified.
@@ -265,11 +285,28 @@ and then position().
 		\param Vertex Vertex to resolve this one with.
 		\param Threshold Threshold for resolution, implementation depends on resolver.
 		\param Type Point to use for resolution, either FittedPosition or NearestMaximum
-		\param Resolver Pointer to VertexResolver to use.
+		\param Resolver Pointer to VertexResolver to use, e.g. a VertexResolverGoldenSection to compare with the vertex's own. Null uses the vertex's own.
 		\return 1 if the vertices are resolved, 0 otherwise.
 		*/
 		bool isResolvedFrom(CandidateVertex* const Vertex, const double Threshold, eResolveType Type, VertexResolver* Resolver) const;
 
+		//!Update the fit as tracks are added and removed rather than fitting again
+		/*!
+		If set, on the first change of tracks after a fit the vertex makes the information (weight matrix)
+		form of the fit: the sum over its tracks of the weight matrix W of each (TrackState::localVertexErrorContribution,
+		as used by VertexFitterLSM for the error but along the track at the vertex) and of W times the point of the
+		track nearest the fitted position.
+		Adding or removing a track then adds or subtracts its terms, merged tracks bring the terms of their source vertex,
+		and the new position is the solution of one 3x3 system rather than a new minimisation by the fitter.
+		The chi squared contributions are found at the new position as after a fit.
+		<br>The information form holds only the tracks, so a vertex holding the IP (see setIP()) or with fewer than two
+		tracks is still fitted by the fitter, which may use the IP. The terms are kept up to date meanwhile, so
+		the vertex is solved again once the IP is removed. refit(Fitter) always uses the fitter given, e.g. to check the result.
+		Off by default.
+		*/
+		bool incrementalFit() const {return _IncrementalFit;}
+		bool &incrementalFit() {return _IncrementalFit;}
+
 		//Query Methods
 		//!Return the TrackStates in this Vertex.
 		/*!\return A Vector of pointers to the TrackStates in the vertex
@@ -347,9 +384,9 @@ and then position().
     		
 		//!Return the chi squared contribution of all the trackstates in this vertex.
 		/*!Note this may cause the vertex to be fit if needed.
-		\return A std::map of chi squared vlaues with TrackState pointers as the key
+		\return Chi squared values in the order of trackStateList()
 		*/
-		const std::map<TrackState*, double> & chiSquaredOfAllTracks() const;
+		const SmallVector<double> & chiSquaredOfAllTracks() const;
 		
 		//!Return the chi squared of the fit.
 		/*!Note this may cause the vertex to be fit if needed.
@@ -365,17 +402,42 @@ and then position().
 
 	private:
 		
-		//Fallback Algo Classes
-		static VertexFitter* _FallbackFitter;
-		static VertexResolver* _FallbackResolver;
-		static VertexFuncMaxFinder* _FallbackMaxFinder;
+		//Fallback Algo Classes, one of each per thread as they hold working state
 		static VertexFitter* _getFallbackFitter();
 		static VertexResolver* _getFallbackResolver();
 		static VertexFuncMaxFinder* _getFallbackMaxFinder();
+		
+		//The given algo classes, else those of the strategy provider, else the fallbacks of the calling thread
+		VertexFitter* _fitter() const;
+		VertexResolver* _resolver() const;
+		VertexFuncMaxFinder* _maxFinder() const;
+
+		//The terms of one track in the information form of the fit
+		struct FitTerms
+		{
+			SmallSymMatrix<3> Weight;
+			double WeightedPoint[3];
+		};
+
+		//Terms of a track, taking the point of the track nearest Near
+		static void _makeFitTerms(TrackState* Track, const Vector3 & Near, FitTerms & Terms);
+		//Make the information form from the current tracks if set to and there is a fit
+		void _beforeTrackChange() const;
+		void _addTerms(const FitTerms & Terms) const;
+		void _subtractTerms(const FitTerms & Terms) const;
+		//Add a track with its terms if known (else null)
+		void _addTrackState(TrackState* TrackToAdd, const FitTerms* Terms);
+		void _eraseTrackState(std::vector<TrackState*>::iterator iTrack);
+		//Position, chi squared and error from the information form for a vertex without the IP, false if it can't be solved
+		bool _solveInformation(bool CalculateError) const;
+		void _fitWith(VertexFitter* Fitter, bool CalculateError) const;
+		//Index of the track with the highest chi squared (which is set), the number of tracks if none, fits if needed
+		size_t _highestChiSquaredTrack(double & HighChiSquared) const;
 			
 		VertexFitter*	     _Fitter=nullptr;
 		VertexResolver*		 _Resolver=nullptr;
 		VertexFuncMaxFinder* _MaxFinder=nullptr;
+		StrategyProvider*	 _Strategies=nullptr;
 		
 
 		//Tracks and IP
@@ -388,14 +450,17 @@ and then position().
 		mutable Vector3 _VertexFuncMaxPosition{};
 		mutable bool _VertexFuncMaxIsValid=false;
 
-		//Fit
-		mutable Vector3 _Position{};
-		mutable Matrix3x3 _PositionError{};
-		mutable double _ChiSquaredOfFit=0.0;
-		mutable std::map<vertex_lcfi::TrackState*,double> _ChiSquaredOfTrack{};
-		mutable double _ChiSquaredOfIP=0.0;
+		//Fit, the track chi squareds are in the order of _TrackStates
+		mutable VertexFitResult _Fit{};
 		mutable bool _FitIsValid=false;
 		mutable bool _ErrorOfFitIsValid=false;
+
+		//Information form of the fit, the terms are in the order of _TrackStates
+		bool _IncrementalFit=false;
+		mutable bool _InformationIsValid=false;
+		mutable std::vector<FitTerms> _TrackTerms{};
+		mutable SmallSymMatrix<3> _Information{};
+		mutable double _WeightedSum[3]={0.0,0.0,0.0};
 				     
 	template <class charT, class traits> inline
 	friend std::basic_ostream<charT,traits>& operator<<(std::basic_ostream<charT,traits>&os,const CandidateVertex& cv);
@@ -48,6 +48,12 @@ covariance matrix. (Both in x,y,z space)
 		\return Value of ellipsoid at point.
 		*/
 		double valueAt(const Vector3 & Point) const;
+		//!Calculate the value of the ellipsoid and its derivatives at a point
+		/*!
+		\param Point Vector3 of the spatial point
+		\return Value, gradient and second derivatives of the ellipsoid at point.
+		*/
+		ValueAndDerivatives derivativesAt(const Vector3 & Point) const;
 
 		//!InteractionPoint object used
 		/*!
@@ -2,12 +2,12 @@
 #define GAUSSTUBE_H
 
 #include "../../util/inc/vector3.h"
+#include "../../inc/trackpath.h"
 #include "../include/vertexfunctionelement.h"
 
 namespace vertex_lcfi
 {
 	class Track;
-	class TrackState;
 namespace ZVTOP
 {
 //!Gaussian tube component of the vertex function
@@ -22,8 +22,9 @@ where r is the vector from to query point to the closest point on the track
 and V is the covariance matrix of the track. (Both in rPhi,z space)
 <br>Note this is a deliberatly unnormalised gaussian.
 <br>The Track is not modified at any point by this class
-<br>This guassian tube makes its own trackstate object from the track given 
-at construction which it uses to perform the calculation.
+<br>This guassian tube holds its own TrackPath and inverse covariance taken from the track given
+at construction, which it uses to perform the calculation. Nothing is swum, so a tube can be
+evaluated from several threads at once.
 \author Ben Jeffery (b.jeffery1@physics.ox.ac.uk)
  \version 0.1
  \date    20/09/05
@@ -32,9 +33,9 @@ at construction which it uses to perform the calculation.
 		public VertexFunctionElement
 	{
 	public:
-		//!Construct from a Track, makes a trackstate for its own use.
+		//!Construct from a Track, takes its path for its own use.
 		/*!
-		As a trackstate is made from the track, note that any changes to the track will not
+		As the path is taken from the track, note that any changes to the track will not
 		propogate to the tube.
 		\param Track Track that forms the guassian tube
 		*/
@@ -42,18 +43,44 @@ at construction which it uses to perform the calculation.
 		GaussTube(const GaussTube&) = delete;
 		GaussTube& operator=(const GaussTube&) = delete;
 	
-		//! Delete tube and trackstate used
-		~GaussTube();
+		//!Destructor
+		~GaussTube() {}
 				
 		//!Calculate the value of the tube at point
 		/*!
-		Swims the track to the point of closest approach and calculate the tube value.
+		Finds the point of closest approach on the track path and calculates the tube value.
 		\param Point Vector3 of the spacial point
 		\return Value of tube at point
 		*/
 		double valueAt(const Vector3 & Point) const;
+
+		//!Calculate the value of the tube and its derivatives at point
+		/*!
+		The tube is differentiated through its XY and z residuals. The point of closest approach
+		makes the distance to the path stationary, so it moves with the point only to first order.
+		The value is identical to valueAt.
+		\param Point Vector3 of the spacial point
+		\return Value, gradient and second derivatives of tube at point
+		*/
+		ValueAndDerivatives derivativesAt(const Vector3 & Point) const;
+
+		//!Path of the tube
+		inline const TrackPath & path() const
+		{return _Path;}
+
+		//!Inverse of the (d0,z0) position covariance of the tube
+		inline const SymMatrix2x2 & inverseCovariance() const
+		{return _InverseCovariance;}
 	private:
-		TrackState* _TrackState=nullptr;
+		TrackPath _Path;
+		SymMatrix2x2 _InverseCovariance;
+		double _SecLambda;
+		//Residual from the path in XY, with its unit gradient u and the curvature of its contours
+		void _xyResidual(const Vector3 & Point, double & Residual, double u[3], double & Curvature) const;
+		//Exponent of the tube given the XY residual and w, the squared 3D distance less the squared XY residual
+		double _exponent(const double XY, const double w) const;
+		//Floor on the z residual (over sec lambda) in the derivatives, the cross term has a cusp at zero
+		static const double _MinZResidual;
 	};
 }
 }
@@ -0,0 +1,119 @@
+#ifndef GAUSSTUBEARRAY_H
+#define GAUSSTUBEARRAY_H
+
+#include "../../util/inc/vector3.h"
+#include "vertexfunctionelement.h"
+#include <vector>
+#include <cstddef>
+
+namespace vertex_lcfi
+{
+	class Track;
+namespace ZVTOP
+{
+	using vertex_lcfi::util::Vector3;
+	class GaussTube;
+
+//!Packed set of GaussTube objects for evaluating many points at once
+/*!
+Holds the circle and inverse position covariance of each tube in contiguous
+arrays (one array per parameter) so that the sum of tube values, and squared
+values, can be found for a batch of points with simple loops over the points.
+<br>Evaluation is identical to GaussTube::valueAt, the points of closest approach of
+a block of points are found together by TrackPath::pcasTo on the path of the tube.
+Neutral tracks are passed to the GaussTube given with the track.
+<br>derivativesAt gives the analytic gradient and second derivatives of the sums at
+a point, from GaussTube::derivativesAt of the tubes that pass the cut.
+<br>buildIndex sets a cut, in sigmas, below which a charged tube is taken as zero, and
+indexes the tubes on a grid in XY so that a point only visits the tubes that can pass it.
+A tube is cut at points further from its circle in XY than CutSigmas over the square root
+of the smallest eigenvalue of its inverse position covariance. As the z residual only adds
+to the exponent, a cut tube has value below exp(-CutSigmas^2/2) (see maxNeglected). The
+grid only narrows the tubes to test, the cut itself is the same for any point.
+<br>The tubes are not owned by this class.
+*/
+	class GaussTubeArray
+	{
+	public:
+		GaussTubeArray() {}
+
+		//!Add a tube for Track, Tube is used for evaluation that can't be done in batch
+		/*!
+		Any index is dropped, so that all tubes are evaluated until buildIndex is called again.
+		*/
+		void addTube(Track* Track, GaussTube* Tube);
+
+		//!Cut tubes beyond CutSigmas of a point and index them for finding those that aren't
+		/*!
+		Call once all tubes are added. Not positive evaluates every tube, as without an index.
+		\param CutSigmas Number of sigmas (in the tubes smallest direction) beyond which a tube is zero
+		*/
+		void buildIndex(double CutSigmas);
+
+		//!Cut of the index, 0 if all tubes are evaluated
+		inline double cutSigmas() const
+		{return _CutSigmas;}
+
+		//!Most the sum of tube values at any point is reduced by the cut, the sum of squares by at most this squared
+		double maxNeglected() const;
+
+		//!Number of tubes
+		inline size_t size() const
+		{return _ChargedTubes.size()+_NeutralTubes.size();}
+
+		//!Find sum and sum of squares of the tube values at each point
+		/*!
+		\param Points Array of NumPoints points
+		\param Sum Array of NumPoints, filled with the sum of tube values
+		\param SumOfSquares Array of NumPoints, filled with the sum of squared tube values
+		*/
+		void sumsAt(const Vector3* Points, size_t NumPoints, double* Sum, double* SumOfSquares) const;
+
+		//!Find sum and sum of squares of the tube values at a point, with their derivatives
+		/*!
+		\param Point Point to evaluate at
+		\param Sum Filled with the sum of tube values and its derivatives
+		\param SumOfSquares Filled with the sum of squared tube values and its derivatives
+		*/
+		void derivativesAt(const Vector3 & Point, ValueAndDerivatives & Sum, ValueAndDerivatives & SumOfSquares) const;
+
+	private:
+		//Grid cell containing (X,Y), -1 if off the grid or there is no index
+		int _cellOf(double X, double Y) const;
+		//True if charged tube t is cut at (X,Y)
+		bool _isCut(size_t t, double X, double Y) const;
+
+		//Charged tubes, one entry per tube in each
+		std::vector<double> _CentreX{};
+		std::vector<double> _CentreY{};
+		std::vector<double> _Radius{};
+		std::vector<double> _SecLambda{};
+		std::vector<double> _InvCov00{};
+		std::vector<double> _InvCov01{};
+		std::vector<double> _InvCov11{};
+		std::vector<GaussTube*> _ChargedTubes{};
+		//XY distance from the circle beyond which the tube is cut, infinite if never
+		std::vector<double> _Envelope{};
+
+		//Index, a square grid of cells in XY each listing (in increasing order) the charged tubes whose envelope
+		//overlaps it. Points off the grid visit all tubes.
+		double _CutSigmas=0.0;
+		int _GridCells=0;
+		double _GridX0=0.0;
+		double _GridY0=0.0;
+		double _CellSize=0.0;
+		std::vector<unsigned> _CellStart{};
+		std::vector<unsigned> _CellTubes{};
+
+		//Neutral tubes are always evaluated by the tube
+		std::vector<GaussTube*> _NeutralTubes{};
+
+		//Points are done in blocks of this size on the stack
+		static const size_t _BlockSize = 16;
+		//The grid covers the track reference points by this much in XY, with this many cells a side
+		static const double _IndexMargin;
+		static const int _IndexCells;
+	};
+}
+}
+#endif //GAUSSTUBEARRAY_H
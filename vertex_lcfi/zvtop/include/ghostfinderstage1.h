@@ -3,9 +3,9 @@
 
 #include "../../util/inc/vector3.h"
 #include "../include/vertexfitterlsm.h"
+#include "../include/ghostfitengine.h"
 #include "../../inc/track.h"
 #include <vector>
-#include <map>
 
 namespace vertex_lcfi
 {
@@ -48,22 +48,54 @@ and ignores the position of the Interaction Point. This should be fixed in a fut
 		Track* findGhost(double InitialWidth, double MaxChi2Allowed, const Vector3 & JetDir, const std::vector<Track*> & JetTracks, InteractionPoint* IP);
 	
 		
+		//!Number of threads the ghost fits to the jet tracks are shared between, see GhostFitEngine
+		int numberOfThreads() const {return _Engine.numberOfThreads();}
+		int &numberOfThreads() {return _Engine.numberOfThreads();}
+		
+		//!Whether the ghost direction is fitted to the jet tracks, false by default
+		/*!
+		The jet tracks given to findGhost have long been ignored (the code taking them was commented
+		out when the jet direction became an input), so the ghost direction only comes from the jet
+		core weighting. If true the ghost is fitted to each of the tracks as described in the
+		GhostTrack paper, through GhostFitEngine, and the minimiser steps on gradientAt. False keeps the
+		results as they were, the minimiser stepping on finite differences of the jet core weighting.
+		*/
+		bool fitToJetTracks() const {return _FitToJetTracks;}
+		bool &fitToJetTracks() {return _FitToJetTracks;}
+		
 		//method that gives a value for chi2 at a point, this specific name
 		//is used so that the function minimiser template can be used.
 		double valueAt(std::vector<double> CurrentAngles);
 
+		//!Gradient of valueAt with respect to the ghost angles, used by the minimiser in place of finite differences when fitToJetTracks()
+		/*!
+		The derivative of the chi squared of each ghost-track fit comes from GhostFitEngine, the jet core
+		weighting is differentiated here. The chi squared jumps where a track crosses L=0, there the
+		gradient is that of the side the angles are on.
+		*/
+		void gradientAt(const std::vector<double> & CurrentAngles, std::vector<double> & Gradient);
+
 	private:
 		Track _makeGhost(std::vector<double> Angles, double Width);
 		double _tanLambda(double theta);
 		void _fillLZeroChis();
-		double _findAdjustedWidth(TrackState* GhostTrack,double CurrentWidth, std::vector<TrackState*> & JetTracks, double MaxChi2Allowed);
+		double _findAdjustedWidth(const std::vector<double> & Angles, double CurrentWidth, double MaxChi2Allowed);
+		//Fits of the ghost with each jet track, the last are kept as the minimiser asks for the
+		//gradient at the point it has just valued and the width is adjusted at the point it ends on
+		const std::vector<GhostFitEngine::Fit> & _fitsAt(const std::vector<double> & Angles, double Width);
 		
 		double _CurrentWidth=0.0;
 		Vector3 _JetDir{};
 		int _UseChiEquation=0;
+		bool _FitToJetTracks=false;
 		std::vector<TrackState*> _JetTracks{};
-		std::map<TrackState*,double> _ChiToLZero{};
+		//In the order of _JetTracks
+		std::vector<double> _ChiToLZero{};
 		VertexFitterLSM _Fitter{};
+		GhostFitEngine _Engine{};
+		std::vector<GhostFitEngine::Fit> _Fits{};
+		std::vector<double> _FitAngles{};
+		double _FitWidth=0.0;
 	};
 }
 }
@@ -0,0 +1,93 @@
+#ifndef GHOSTFITENGINE_H
+#define GHOSTFITENGINE_H
+
+#include "../../util/inc/vector3.h"
+#include "../../inc/trackpath.h"
+#include <vector>
+#include <cstddef>
+
+using vertex_lcfi::util::Vector3;
+
+namespace vertex_lcfi
+{
+	class TrackState;
+
+namespace ZVTOP
+{
+//!Two prong fits of a ghost track with each track of a jet, for the ghost direction search
+/*!
+GhostFinderStage1 fits the ghost with every jet track at each trial direction. The ghost is a
+straight line through the origin, so rather than making a ghost TrackState and running
+VertexFitterLSM for each pair the engine solves each pair directly:
+<br>- The terms of a track that don't depend on the ghost (its TrackPath and inverse d0/z0 errors)
+are taken once by setTracks().
+<br>- The closest approach of the track and the ghost is found by TrackPath::pcaToLine, with the
+ghost position along its line in closed form.
+<br>- The vertex and its chi squared follow as in the two prong seed of VertexFitterLSM, the
+point between the closest approaches weighted by the error of each track across the line joining
+them. Over that distance the track is taken as straight.
+<br>The derivatives of each chi squared with respect to the ghost angles are found along with it,
+for the gradient GhostFinderStage1 gives its minimiser.
+<br>The fits of the tracks are independent of each other, with more than one thread they are
+shared out with ThreadPool::parallelFor. Other than the tracks no state is kept, so an engine
+can be used by several threads at once.
+*/
+	class GhostFitEngine
+	{
+	public:
+		//!Fit of the ghost with one track
+		struct Fit
+		{
+			//!Vertex position
+			Vector3 Position{};
+			//!Chi squared of the vertex, ghost and track
+			double ChiSquared=0.0;
+			//!Distance of the vertex along the ghost from the origin
+			double L=0.0;
+			//!Square of the distance between the ghost and the track at closest approach
+			double Separation2=0.0;
+			//!Derivatives of ChiSquared with respect to the phi and theta of the ghost
+			double ChiSquaredByAngle[2]={0.0,0.0};
+		};
+
+		//!Take the ghost independent terms of each track, the TrackStates are neither changed nor kept
+		void setTracks(const std::vector<TrackState*> & Tracks);
+
+		//!Number of tracks given to setTracks
+		inline size_t numTracks() const {return _Tracks.size();}
+
+		//!Fit a ghost with each track
+		/*!
+		\param Angles Phi and theta of the ghost direction
+		\param Width Width of the ghost
+		\param Fits Filled with the fit of each track, in the order given to setTracks
+		*/
+		void fitAll(const std::vector<double> & Angles, double Width, std::vector<Fit> & Fits) const;
+
+		//!Number of threads the fits are shared between
+		int numberOfThreads() const {return _NumberOfThreads;}
+		int &numberOfThreads() {return _NumberOfThreads;}
+
+	private:
+		struct TrackTerms
+		{
+			TrackPath Path;
+			double Inverse00,Inverse01,Inverse11;
+		};
+		struct GhostTerms
+		{
+			Vector3 Direction;
+			//Derivatives of Direction with respect to phi and theta
+			Vector3 DirectionByAngle[2];
+			double SinPhi,CosPhi,TanLambda;
+			double Inverse00,Inverse11;
+		};
+
+		Fit _fit(const TrackTerms & Track, const GhostTerms & Ghost) const;
+
+		std::vector<TrackTerms> _Tracks{};
+		int _NumberOfThreads=1;
+	};
+}
+}
+#endif //GHOSTFITENGINE_H
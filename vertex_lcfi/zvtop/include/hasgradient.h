@@ -0,0 +1,28 @@
+#ifndef HASGRADIENT_H
+#define HASGRADIENT_H
+
+#include <utility>
+
+namespace vertex_lcfi
+{
+namespace ZVTOP
+{
+	//!True if T has a method "void gradientAt(const P & Point, P & Gradient)"
+	/*!
+	The minimisers use this to take the gradient from the function class where it can give it
+	analytically, rather than from finite differences of valueAt. Functions without the method
+	need no changes.
+	*/
+	template <class T, class P>
+	class HasGradientAt
+	{
+		template <class U>
+		static char _test(decltype(std::declval<U&>().gradientAt(std::declval<const P&>(), std::declval<P&>()))*);
+		template <class U>
+		static long _test(...);
+	public:
+		static const bool value = (sizeof(_test<T>(0)) == sizeof(char));
+	};
+}
+}
+#endif //HASGRADIENT_H
@@ -2,9 +2,13 @@
 #define LEVMARMINIMISER_H
 
 #include <cmath>
+#include <iostream>
+#include <type_traits>
 #include "../../util/inc/vector3.h"
 #include "../../util/inc/matrix.h"
-#include <fstream.h> 
+#include "hasgradient.h"
+
+using namespace vertex_lcfi::util;
 
 namespace vertex_lcfi
 {
@@ -14,17 +18,21 @@ namespace ZVTOP
 	//arbitary function, although it does use ZVTOP specifics (e.g. Vector3).
 	//Only prerequisite is that <T> has a method "double valueAt( Vector3 )" that returns
 	//the value of the function (be it the chi2 or whatever) at the point given
+	//If <T> also has "void gradientAt( const Vector3 &, Vector3 & )" the Jacobian is
+	//taken from it rather than from finite differences
 	template <class T>
 	class FunctionMinimiser
 	{
 	public:
 		FunctionMinimiser( T* funcClass, double initialDelta, unsigned int decimalPlaces );
 		~FunctionMinimiser(){};//I doubt this will be derived from but stick it in anyway
-		ZVTOP::Vector3 Minimise( ZVTOP::Vector3 seedPoint ,double muin,double vin);
+		Vector3 Minimise( Vector3 seedPoint ,double muin,double vin);
 	protected:
 		//Method that finds a vector that 'points down hill' by examining the rate of
 		//change of the function at the point "point".
-		ZVTOP::Vector3 _Jacobian(ZVTOP::Vector3 point);
+		Vector3 _Jacobian(const Vector3 & point, double valueAtPoint);
+		Vector3 _Jacobian(const Vector3 & point, double valueAtPoint, std::true_type);
+		Vector3 _Jacobian(const Vector3 & point, double valueAtPoint, std::false_type);
 	
 		T* _pFunc;
 		double _initialDelta;//The offset that the change in the function is examined at (plus and minus).
@@ -41,7 +49,7 @@ namespace ZVTOP
 	}
 
 	template <class T>
-	ZVTOP::Vector3 FunctionMinimiser<T>::Minimise( ZVTOP::Vector3 seedPoint ,double muin,double vin)
+	Vector3 FunctionMinimiser<T>::Minimise( Vector3 seedPoint ,double muin,double vin)
 	{
 		using namespace ZVTOP;
 		Vector3 oldPos = seedPoint;
@@ -65,7 +73,7 @@ namespace ZVTOP
 			//std::cout << "Value " << currentValue << std::endl; 
 			if (currentValue<0.000000001)
 				break;
-			Vector3 J = _Jacobian(oldPos);
+			Vector3 J = _Jacobian(oldPos, currentValue);
 			Matrix3x3 JTJ= outer_prod(trans(J),J);
 			double mu = muin;
 			double v = vin;
@@ -128,10 +136,23 @@ namespace ZVTOP
 	}
 
 	template <class T>
-	ZVTOP::Vector3 FunctionMinimiser<T>::_Jacobian( ZVTOP::Vector3 point)
+	Vector3 FunctionMinimiser<T>::_Jacobian( const Vector3 & point, double valueAtPoint)
+	{
+		return this->_Jacobian( point, valueAtPoint, std::integral_constant<bool, HasGradientAt<T, Vector3>::value>() );
+	}
+
+	template <class T>
+	Vector3 FunctionMinimiser<T>::_Jacobian( const Vector3 & point, double /*valueAtPoint*/, std::true_type)
 	{
-		using ZVTOP::Vector3;
-		double valueAtPoint=_pFunc->valueAt( point );
+		Vector3 gradient;
+		_pFunc->gradientAt( point, gradient );
+		return gradient;
+	}
+
+	template <class T>
+	Vector3 FunctionMinimiser<T>::_Jacobian( const Vector3 & point, double valueAtPoint, std::false_type)
+	{
+
 		//std::cout << valueAtPoint ;
 		double delta = (fabs(valueAtPoint)+1.0)*0.000001;
 		//std::cout << _pFunc->valueAt(point + Vector3(delta,0,0)) << " " << _pFunc->valueAt(point + Vector3(0,delta,0)) << " " << _pFunc->valueAt(point + Vector3(0,0,delta)) << std::endl;
@@ -3,6 +3,8 @@
 
 #include <cmath>
 #include <vector>
+#include <type_traits>
+#include "hasgradient.h"
 
 /*#define DEBUG_MINFINDER*/			//uncomment to print some info to the screen
 
@@ -14,6 +16,9 @@ namespace ZVTOP
 	//arbitary function, although it does use ZVTOP specifics (e.g. Vector3).
 	//Only prerequisite is that <T> has a method "double valueAt( Vector3 )" that returns
 	//the value of the function (be it the chi2 or whatever) at the point given
+	//If <T> also has "void gradientAt( const std::vector<double> &, std::vector<double> & )"
+	//the down hill direction is taken from it rather than from finite differences, unless
+	//useGradient() is set false
 	template <class T>
 	class FunctionMinimiser
 	{
@@ -21,16 +26,30 @@ namespace ZVTOP
 		FunctionMinimiser( T* funcClass, double initialDelta, unsigned int decimalPlaces );
 		~FunctionMinimiser(){};//I doubt this will be derived from but stick it in anyway
 		std::vector<double> Minimise( const std::vector<double> & seedPoint );
+		//Number of steps taken by the last Minimise
+		long int numIterations() const {return _iterations;}
+		//Number of calls of valueAt and gradientAt made by the last Minimise
+		long int numValueEvaluations() const {return _valueEvaluations;}
+		long int numGradientEvaluations() const {return _gradientEvaluations;}
+		//Whether gradientAt is used when <T> has it, true by default
+		bool useGradient() const {return _useGradient;}
+		bool &useGradient() {return _useGradient;}
 		FunctionMinimiser<T>(const FunctionMinimiser<T>&) = delete;
 		FunctionMinimiser<T>& operator=(const FunctionMinimiser<T>&) = delete;
 	protected:
 		//Method that finds a vector that 'points down hill' by examining the rate of
-		//change of the function at the point "point".
-		std::vector<double> _findChangeRateVector( std::vector<double> point, double delta );
+		//change of the function at the point "point", where it has the value "valueAtPoint".
+		void _findChangeRateVector( const std::vector<double> & point, double valueAtPoint, std::vector<double> & jacobian );
+		void _findChangeRateVector( const std::vector<double> & point, double valueAtPoint, std::vector<double> & jacobian, std::true_type );
+		void _findChangeRateVector( const std::vector<double> & point, double valueAtPoint, std::vector<double> & jacobian, std::false_type );
 	
 		T* _pFunc;
 		double _initialDelta=0.0;//The offset that the change in the function is examined at (plus and minus).
 		double _precision=0.0; //how many decimal places are required
+		long int _iterations=0;
+		long int _valueEvaluations=0;
+		long int _gradientEvaluations=0;
+		bool _useGradient=true;
 	};
 
 	template <class T>
@@ -56,6 +75,11 @@ namespace ZVTOP
 		jacobian.clear();
 		//std::cout << "Start minimisation" <<std::endl;
 		long int iterations=0;//how long it takes to find (for debug purposes)
+		_valueEvaluations=0;
+		_gradientEvaluations=0;
+		//Value at the current point, only changes when we step
+		double currentValue=_pFunc->valueAt(inspectionPoint);
+		++_valueEvaluations;
 		//while( we don't know the position to enough precision )
 		do
 		{
@@ -64,7 +88,7 @@ namespace ZVTOP
 			{
 				iterations++;
 				//Find down hill vector, then make it the size of the current step
-				jacobian = _findChangeRateVector( inspectionPoint, currentDelta );
+				_findChangeRateVector( inspectionPoint, currentValue, jacobian );
 				//Make length of current step and add to current point
 				for (std::vector<double>::iterator iJacobian = jacobian.begin();iJacobian < jacobian.end();++iJacobian)
 				{
@@ -83,11 +107,14 @@ namespace ZVTOP
 				//if (inspectionPoint.size()==2) std::cout << iterations << " " << _pFunc->valueAt(jacobian) << std::endl;
 				//If the step we are going to take takes us uphill then we have found a minimum so break the inner loop and go to higher precision
 				//std::cout.flush();
-					if (_pFunc->valueAt(inspectionPoint)<_pFunc->valueAt(jacobian))
+					double stepValue=_pFunc->valueAt(jacobian);
+					++_valueEvaluations;
+					if (currentValue<stepValue)
 						break;
 				//TODO should make step smaller here	
 					
 					inspectionPoint=jacobian;
+					currentValue=stepValue;
 				//if (inspectionPoint.size()==3)
 				//	std::cout << inspectionPoint[0] << " " << inspectionPoint[1] << " " << inspectionPoint[2] << std::endl;
 				//do some checks in case of infinities 
@@ -115,6 +142,7 @@ namespace ZVTOP
 		} while( currentDelta>_precision );
 		//std::cout << mult << " " << iterations << std::endl;
 		//}
+		_iterations=iterations;
 		//double f;
 		//std::cin >> f;
 #ifdef DEBUG_MINFINDER
@@ -130,19 +158,36 @@ namespace ZVTOP
 	}
 
 	template <class T>
-	std::vector<double> FunctionMinimiser<T>::_findChangeRateVector(std::vector<double> point, double delta)
+	void FunctionMinimiser<T>::_findChangeRateVector(const std::vector<double> & point, double valueAtPoint, std::vector<double> & jacobian)
 	{
-		double valueAtPoint=_pFunc->valueAt( point );
-		delta = (fabs(valueAtPoint)+1.0)*0.000001;
-		std::vector<double> jacobian;
-		for (std::vector<double>::iterator iPoint = point.begin();iPoint < point.end();++iPoint)
+		this->_findChangeRateVector( point, valueAtPoint, jacobian, std::integral_constant<bool, HasGradientAt<T, std::vector<double> >::value>() );
+	}
+
+	template <class T>
+	void FunctionMinimiser<T>::_findChangeRateVector(const std::vector<double> & point, double valueAtPoint, std::vector<double> & jacobian, std::true_type)
+	{
+		if (!_useGradient)
 		{
-			(*iPoint) += delta;
-			jacobian.push_back((_pFunc->valueAt(point)-valueAtPoint)/delta);
-			(*iPoint) -= delta;
+			this->_findChangeRateVector( point, valueAtPoint, jacobian, std::false_type() );
+			return;
+		}
+		_pFunc->gradientAt( point, jacobian );
+		++_gradientEvaluations;
+	}
+
+	template <class T>
+	void FunctionMinimiser<T>::_findChangeRateVector(const std::vector<double> & point, double valueAtPoint, std::vector<double> & jacobian, std::false_type)
+	{
+		double delta = (fabs(valueAtPoint)+1.0)*0.000001;
+		std::vector<double> offsetPoint = point;
+		jacobian.resize(point.size());
+		for (size_t i = 0;i < point.size();++i)
+		{
+			offsetPoint[i] += delta;
+			jacobian[i] = (_pFunc->valueAt(offsetPoint)-valueAtPoint)/delta;
+			++_valueEvaluations;
+			offsetPoint[i] = point[i];
 		}
-		return jacobian;
-	
 	}
 
 	template <class T>
@@ -0,0 +1,91 @@
+#ifndef STRATEGYPROVIDER_H
+#define STRATEGYPROVIDER_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+namespace vertex_lcfi
+{
+namespace ZVTOP
+{
+	class VertexFitter;
+	class VertexResolver;
+	class VertexFuncMaxFinder;
+
+//!Source of the VertexFitter, VertexResolver and VertexFuncMaxFinder used by candidate vertices
+/*!
+A CandidateVertex given a provider (CandidateVertex::strategies) asks it for an algorithm
+object each time it fits, resolves or finds a maximum, rather than keeping one object. So a
+provider can hand out objects with working state (as VertexFitterLSM) without them being used
+by two threads at once, whichever threads the vertices are used on.
+<br>Where the provider has nothing to give (null) the vertex uses the fallback of the thread,
+see CandidateVertex::FallbackVertexFitter.
+*/
+	class StrategyProvider
+	{
+	public:
+		virtual ~StrategyProvider() {}
+		//!Fitter for the calling thread, null for the fallback
+		virtual VertexFitter* fitter() = 0;
+		//!Resolver for the calling thread, null for the fallback
+		virtual VertexResolver* resolver() = 0;
+		//!Max finder for the calling thread, null for the fallback
+		virtual VertexFuncMaxFinder* maxFinder() = 0;
+	};
+
+//!StrategyProvider giving each thread its own objects
+/*!
+Objects are made with the given functions the first time a thread asks the provider for them,
+and belong to the provider. A null function gives null, so the fallback of the thread.
+<br>No locks are taken. Each thread remembers the objects of the last few providers it used, a
+new set is made if the provider has been forgotten and the old set is kept unused until the
+provider is deleted. Making and keeping a set should be cheap, as for the algorithms here.
+<br>An object holding state for a jet, as the kept decisions of VertexResolverGoldenSection,
+is only valid as long as that state is, so such a provider should be made for each jet:
+<br><pre>ThreadStrategyProvider Strategies(0, [](){return new VertexResolverGoldenSection();}, 0);</pre>
+<br><pre>VFinder.strategies() = &Strategies;</pre>
+*/
+	class ThreadStrategyProvider :
+		public StrategyProvider
+	{
+	public:
+		typedef std::function<VertexFitter*()> FitterMaker;
+		typedef std::function<VertexResolver*()> ResolverMaker;
+		typedef std::function<VertexFuncMaxFinder*()> MaxFinderMaker;
+
+		//!Constructor
+		/*!
+		\param MakeFitter Makes a new fitter, null for the fallback
+		\param MakeResolver Makes a new resolver, null for the fallback
+		\param MakeMaxFinder Makes a new max finder, null for the fallback
+		*/
+		ThreadStrategyProvider(FitterMaker MakeFitter = FitterMaker(), ResolverMaker MakeResolver = ResolverMaker(), MaxFinderMaker MakeMaxFinder = MaxFinderMaker());
+		//!Deletes the objects made for every thread, none may still be in use
+		~ThreadStrategyProvider();
+		ThreadStrategyProvider(const ThreadStrategyProvider&) = delete;
+		ThreadStrategyProvider& operator=(const ThreadStrategyProvider&) = delete;
+
+		VertexFitter* fitter();
+		VertexResolver* resolver();
+		VertexFuncMaxFinder* maxFinder();
+
+		//!Number of sets of objects made so far, one per thread using the provider unless some were forgotten
+		int numSets() const {return _NumSets.load();}
+
+	private:
+		struct Set;
+		Set* _setOfThisThread();
+
+		FitterMaker _MakeFitter;
+		ResolverMaker _MakeResolver;
+		MaxFinderMaker _MakeMaxFinder;
+		//Never reused, so a thread can't mistake a new provider for a deleted one at the same address
+		const unsigned long _Id;
+		//Singly linked list of every set made, added to from any thread
+		std::atomic<Set*> _Sets{nullptr};
+		std::atomic<int> _NumSets{0};
+	};
+}
+}
+#endif //STRATEGYPROVIDER_H
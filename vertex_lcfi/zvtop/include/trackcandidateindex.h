@@ -0,0 +1,89 @@
+#ifndef TRACKCANDIDATEINDEX_H
+#define TRACKCANDIDATEINDEX_H
+
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+
+namespace vertex_lcfi
+{
+	class Track;
+namespace ZVTOP
+{
+	class CandidateVertex;
+
+//!Which candidate vertices hold each track, for the track clustering stages of ZVTOP
+/*!
+Tracks and candidates are referred to by dense ids, tracks by their position in the list
+given at construction and candidates in the order they are added. For each track the ids of
+the candidates holding it are kept in increasing order, and for each candidate the ids of its
+tracks, so finding the candidates of a track costs the number of them rather than a scan of
+every candidate and its tracks.
+<br>Changes made through the index (removeTrack, merge) keep it up to date, after the tracks of
+a candidate are changed any other way call update. Ids of removed candidates are not reused.
+*/
+	class TrackCandidateIndex
+	{
+	public:
+		//!Id returned for a track or candidate not in the index
+		static const size_t NotFound = size_t(-1);
+
+		//!Index of the given tracks, with no candidates
+		TrackCandidateIndex(const std::vector<Track*> & Tracks);
+
+		//!Add a candidate with its current tracks
+		/*!
+		\return Id of the candidate
+		*/
+		size_t addCandidate(CandidateVertex* Candidate);
+
+		//!Take a candidate out of the index, the candidate itself is not changed
+		void removeCandidate(size_t Candidate);
+
+		//!Read the tracks of a candidate again
+		void update(size_t Candidate);
+
+		//!Remove a track from a candidate, see CandidateVertex::removeTrack
+		/*!
+		\return True if the candidate had the track
+		*/
+		bool removeTrack(size_t Candidate, size_t Track);
+
+		//!Merge candidate From into Into, see CandidateVertex::mergeCandidateVertex, From is taken out of the index
+		void merge(size_t Into, size_t From);
+
+		//!Candidate of an id, null if it was removed
+		inline CandidateVertex* candidate(size_t Candidate) const {return _Candidates[Candidate];}
+		//!True if the candidate is in the index
+		inline bool hasCandidate(size_t Candidate) const {return _Candidates[Candidate] != 0;}
+		//!Id of a candidate, NotFound if it is not in the index
+		size_t candidateId(const CandidateVertex* Candidate) const;
+		//!Number of candidate ids given out, including removed ones
+		inline size_t numCandidates() const {return _Candidates.size();}
+
+		//!Track of an id
+		inline Track* track(size_t Track) const {return _Tracks[Track];}
+		//!Id of a track, NotFound if it was not given at construction
+		size_t trackId(const Track* Track) const;
+
+		//!Ids of the candidates holding a track, in increasing order
+		inline const std::vector<size_t> & candidatesOf(size_t Track) const {return _CandidatesOfTrack[Track];}
+		//!Ids of the tracks of a candidate, in increasing order
+		inline const std::vector<size_t> & tracksOf(size_t Candidate) const {return _TracksOfCandidate[Candidate];}
+
+	private:
+		void _link(size_t Candidate, size_t Track);
+		void _unlinkAll(size_t Candidate);
+		void _linkAll(size_t Candidate);
+
+		std::vector<Track*> _Tracks;
+		std::unordered_map<const Track*,size_t> _TrackIds{};
+		//Null once removed
+		std::vector<CandidateVertex*> _Candidates{};
+		std::unordered_map<const CandidateVertex*,size_t> _CandidateIds{};
+		std::vector<std::vector<size_t> > _CandidatesOfTrack;
+		std::vector<std::vector<size_t> > _TracksOfCandidate{};
+	};
+}
+}
+#endif //TRACKCANDIDATEINDEX_H
@@ -0,0 +1,56 @@
+#ifndef TRACKPAIRFILTER_H
+#define TRACKPAIRFILTER_H
+
+#include <vector>
+#include <cstddef>
+
+namespace vertex_lcfi
+{
+	class Track;
+namespace ZVTOP
+{
+//!Geometric pre-selection of track pairs before two prong vertex fitting
+/*!
+Rejects pairs of tracks that are too far apart to form a two prong vertex without
+fitting them. The helix of each track is projected to its circle in the XY plane:
+<br>If the circles of a pair do not cross, the gap between them is a lower bound on
+the XY distance of the tracks.
+<br>If they do cross, the tracks are replaced by their tangent lines at each crossing
+and the smaller 3D distance between the lines is taken.
+<br>A pair is rejected if this distance exceeds MaxSigmas times the combined d0 (and, for
+crossing circles, z0) error of the two tracks.
+<br>Pairs with a neutral track are always kept, as are all pairs if MaxSigmas is not
+positive. Circles are used whole, so the test never depends on which way a track goes.
+<br>The tracks are not modified and are only read at construction.
+*/
+	class TrackPairFilter
+	{
+	public:
+		//!Precompute the circle of each track
+		/*!
+		\param Tracks Tracks, pairs are referred to by index into this list
+		\param MaxSigmas Number of combined errors beyond which a pair is rejected, 0 to keep all
+		*/
+		TrackPairFilter(const std::vector<Track*> & Tracks, double MaxSigmas);
+
+		//!True if tracks i and j may form a vertex and should be fitted
+		bool mayVertex(size_t i, size_t j) const;
+
+	private:
+		struct Circle
+		{
+			bool Charged;
+			double CentreX, CentreY, Radius;
+			double InvR, Phi, Z0, TanLambda;
+			double D0Variance, Z0Variance;
+		};
+
+		//3D distance of the tangent lines at the circle crossing (X,Y)
+		double _tangentDistance(const Circle & A, const Circle & B, double X, double Y) const;
+
+		std::vector<Circle> _Circles{};
+		double _MaxSigmas;
+	};
+}
+}
+#endif //TRACKPAIRFILTER_H
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <list>
+#include <utility>
 #include "../../util/inc/vector3.h"
 
 using namespace vertex_lcfi::util;
@@ -17,6 +18,7 @@ namespace ZVTOP
 	class CandidateVertex;
 	class InteractionPoint;
 	class VertexFunction;
+	class StrategyProvider;
 	
 //!Vertex Finding object - classic ZVTOP
 /*!
@@ -45,12 +47,61 @@ Note new mwmory management
 		bool removeTrack(Track* const Track);
 		bool clearIP();
 
+		//!Number of threads used for the two prong fits and vertex function maxima, 1 runs serially
+		/*!
+		The unresolved pairs for clustering are also found in parallel.
+		The result does not depend on the number of threads.
+		*/
+		int numberOfThreads() const {return _NumberOfThreads;}
+		int &numberOfThreads() {return _NumberOfThreads;}
+
+		//!Track pairs further apart than this many combined errors are not fitted, 0 fits all
+		/*!
+		See TrackPairFilter.
+		*/
+		double pairCutSigmas() const {return _PairCutSigmas;}
+		double &pairCutSigmas() {return _PairCutSigmas;}
+
+		//!Gaussian tubes are taken as zero beyond this many sigmas of a point, 0 evaluates all
+		/*!
+		See GaussTubeArray::buildIndex, the vertex function is less by at most VertexFunctionClassic::maxNeglected.
+		*/
+		double tubeCutSigmas() const {return _TubeCutSigmas;}
+		double &tubeCutSigmas() {return _TubeCutSigmas;}
+
+		//!Provider of the fitter, resolver and max finder of the candidate vertices, null (default) for the CandidateVertex fallbacks
+		/*!
+		It is asked for them by each thread working on the vertices, so with more than one thread it must give each thread
+		its own objects where they hold state (as ThreadStrategyProvider). Not owned by the finder.
+		*/
+		StrategyProvider* strategies() const {return _Strategies;}
+		StrategyProvider* &strategies() {return _Strategies;}
+
+		//!Candidate vertices update their fits as tracks are added and removed, see CandidateVertex::incrementalFit
+		bool incrementalFit() const {return _IncrementalFit;}
+		bool &incrementalFit() {return _IncrementalFit;}
+
+		//!Number of points the vertex function was found at in the last findVertices
+		long numVertexFuncValues() const {return _NumVertexFuncValues;}
+		//!Number of points the vertex function derivatives were found at in the last findVertices
+		long numVertexFuncDerivatives() const {return _NumVertexFuncDerivatives;}
+
+		//!Number of track pairs considered for two prong vertices in the last findVertices
+		int numPairsTried() const {return _NumPairsTried;}
+		//!Number of those rejected by the pair pre-selection without a fit
+		int numPairsCut() const {return _NumPairsCut;}
+
 		//run ZVRES!
 		std::list<CandidateVertex*> findVertices();
 
 	private:
 		std::vector<CandidateVertex*> _removeOneTrackNoIPVertices(std::list<CandidateVertex*>* CVList);
-		void _ifNoIPAddIP(std::list<CandidateVertex*>* CVList);
+		//Returns the vertex added, null if there was already one with the IP
+		CandidateVertex* _ifNoIPAddIP(std::list<CandidateVertex*>* CVList);
+		void _makeTwoProngsParallel(const std::vector<std::pair<int,int> > & Pairs, std::vector<CandidateVertex*> & ChiPassed, std::vector<Vector3> & ChiPassedPositions);
+		void _findVertexFuncMaxParallel(const std::list<CandidateVertex*> & CVList);
+		//For each vertex the indices of those it is not resolved from (by V(r) maxima), in increasing order
+		void _findUnresolvedPairs(const std::vector<CandidateVertex*> & CVs, std::vector<std::vector<size_t> > & Unresolved);
 
 		std::vector<Track*> _TrackList{};
 		InteractionPoint* _IP=nullptr;
@@ -62,6 +113,15 @@ Note new mwmory management
 		double _TwoProngCut=0.0;
 		double _TrackTrimCut=0.0;
 		double _ResolverCutOff=0.0;
+		int _NumberOfThreads=1;
+		double _PairCutSigmas=0.0;
+		double _TubeCutSigmas=0.0;
+		int _NumPairsTried=0;
+		int _NumPairsCut=0;
+		StrategyProvider* _Strategies=nullptr;
+		bool _IncrementalFit=false;
+		long _NumVertexFuncValues=0;
+		long _NumVertexFuncDerivatives=0;
 		
 	};
 }
@@ -16,6 +16,7 @@ namespace ZVTOP
 	//Forward Declarations
 	class CandidateVertex;
 	class InteractionPoint;
+	class StrategyProvider;
 	
 //!Vertex Finding object - classic ZVTOP
 /*!
@@ -43,6 +44,15 @@ Perform the ghost track algorithm on a set of tracks
         	double &initialGhostWidth() {return _InitialGhostWidth;}
         	double maxChi2Allowed() const {return _MaxChi2Allowed;}
         	double &maxChi2Allowed() {return _MaxChi2Allowed;}
+        	//!Number of threads the ghost fits to the tracks are shared between
+        	int numberOfThreads() const {return _NumberOfThreads;}
+        	int &numberOfThreads() {return _NumberOfThreads;}
+        	//!Whether the ghost direction is fitted to the tracks, see GhostFinderStage1::fitToJetTracks
+        	bool fitGhostToTracks() const {return _FitGhostToTracks;}
+        	bool &fitGhostToTracks() {return _FitGhostToTracks;}
+        	//!Provider of the fitter, resolver and max finder of the candidate vertices, null (default) for the CandidateVertex fallbacks
+        	StrategyProvider* strategies() const {return _Strategies;}
+        	StrategyProvider* &strategies() {return _Strategies;}
         	
 		// returns true if track was in set and removed
 		bool removeTrack(Track* const Track);
@@ -58,6 +68,9 @@ Perform the ghost track algorithm on a set of tracks
 		double _MinimumProbability=0.0;
 		double _InitialGhostWidth=0.0;
 		double _MaxChi2Allowed=0.0;
+		int _NumberOfThreads=1;
+		bool _FitGhostToTracks=false;
+		StrategyProvider* _Strategies=nullptr;
 		
 		std::vector<Track*> _TrackList{};
 		InteractionPoint* _IP=nullptr;
@@ -3,6 +3,7 @@
 
 #include "../../util/inc/vector3.h"
 #include "../../util/inc/matrix.h"
+#include "../../util/inc/smallvector.h"
 #include <vector>
 
 using namespace vertex_lcfi::util;
@@ -17,6 +18,24 @@ namespace ZVTOP
 	class CandidateVertex;
 	class InteractionPoint;
 
+//!Result of a vertex fit
+/*!
+The chi squared of each track is in the same order as the tracks given to the fitter,
+for vertices of up to LCFI_SMALLVECTOR_SIZE tracks filling this makes no heap allocation.
+*/
+	struct VertexFitResult
+	{
+		//!Fitted position
+		Vector3 Position{};
+		//!Error of the fitted position, only filled in if asked for
+		Matrix3x3 PositionError{};
+		//!Chi squared of the fit, the sum of the tracks and the IP
+		double ChiSquaredOfFit=0.0;
+		//!Chi squared contribution of the IP, zero if there is none
+		double ChiSquaredOfIP=0.0;
+		//!Chi squared contribution of each track, in the order of the fitted tracks
+		SmallVector<double> ChiSquaredOfTrack{};
+	};
 	
 //!Vertex Fitter Interface
 /*!
@@ -30,8 +49,8 @@ Pure virtual class interface class, cannot be instantiated.
 	public:
 		virtual void fitVertex(const std::vector<TrackState*> & Tracks, InteractionPoint* IP, Vector3 & Result) = 0;
 		virtual void fitVertex(const std::vector<TrackState*> & Tracks, InteractionPoint* IP, Vector3 & Result, double & ChiSquaredOfFit) = 0;
-		virtual void fitVertex(const std::vector<TrackState*> & Tracks, InteractionPoint* IP, Vector3 & Result, double & ChiSquaredOfFit, std::map<TrackState*,double> & ChiSquaredOfTrack,double & ChiSquaredOfIP) = 0;
-		virtual void fitVertex(const std::vector<TrackState*> & Tracks, InteractionPoint* IP, Vector3 & Result, Matrix3x3 & ResultError, double & ChiSquaredOfFit, std::map<TrackState*,double> & ChiSquaredOfTrack,double & ChiSquaredOfIP) = 0;
+		//!Fit filling in Result, the error of the position is only worked out if CalculateError is set
+		virtual void fitVertex(const std::vector<TrackState*> & Tracks, InteractionPoint* IP, VertexFitResult & Result, bool CalculateError) = 0;
 		virtual ~VertexFitter() {}
 	};
 }
@@ -21,6 +21,20 @@ namespace ZVTOP
 	public VertexFitter
 	{
 	public:
+		//!How the starting point of the minimisation is found
+		/*!
+		PairwiseSeed averages the two prong fits of every pair of tracks, O(N^2).
+		<br>LinearSeed solves the weighted least squares problem of the tracks replaced by straight
+		lines at their reference points, then once more with the lines taken at the points nearest
+		that solution, O(N). It falls back to PairwiseSeed if the lines don't fix a point.
+		<br>Either way fits that are not minimised (two tracks without the IP, or one with it) keep
+		the pairwise seed, as there the seed is the result.
+		<br>PairwiseSeed is the default, so existing results are unchanged. LinearSeed lands at the
+		minimum of the chi squared of the tracks, so the minimiser only has to confirm it, where from
+		the pairwise seed it often stops short of the minimum along the jet direction.
+		*/
+		enum SeedType {PairwiseSeed, LinearSeed};
+
 		VertexFitterLSM();
 		~VertexFitterLSM(){}
 		VertexFitterLSM(const VertexFitterLSM&) = delete;
@@ -28,23 +42,42 @@ namespace ZVTOP
 		//CandidateVertex fitVertex(const std::vector<TrackState*> & Tracks, InteractionPoint* IP, bool CalculateError);
 		void fitVertex(const std::vector<TrackState*> & Tracks, InteractionPoint* IP, Vector3 & Result); 
 		void fitVertex(const std::vector<TrackState*> & Tracks, InteractionPoint* IP, Vector3 & Result, double & ChiSquaredOfFit);
-		void fitVertex(const std::vector<TrackState*> & Tracks, InteractionPoint* IP, Vector3 & Result, double & ChiSquaredOfFit, std::map<TrackState*,double> & ChiSquaredOfTrack,double & ChiSquaredOfIP);
-		void fitVertex(const std::vector<TrackState*> & Tracks, InteractionPoint* IP, Vector3 & Result, Matrix3x3 & ResultError, double & ChiSquaredOfFit, std::map<TrackState*,double> & ChiSquaredOfTrack,double & ChiSquaredOfIP);
+		void fitVertex(const std::vector<TrackState*> & Tracks, InteractionPoint* IP, VertexFitResult & Result, bool CalculateError);
 		//method that gives a value for chi2 at a point, this specific name
 		//is used so that the function minimiser template can be used.
 		double valueAt( const Vector3 & point );
 		double valueAt( const std::vector<double> & point );
+		//gradient of valueAt at "point", found analytically, so the minimiser
+		//doesn't have to take finite differences of valueAt
+		void gradientAt( const Vector3 & point, Vector3 & Gradient );
+		void gradientAt( const std::vector<double> & point, std::vector<double> & Gradient );
 		
 		void setSeed(Vector3 Seed);
 		void setInitialStep(double Step);
+		//!Seed used when no manual seed is set, PairwiseSeed by default
+		void setSeedType(SeedType Type);
+
+		//!Number of minimiser steps in the last fit, 0 if it was not minimised
+		long int lastIterations() const {return _LastIterations;}
+		//!Total number of minimiser steps over all fits
+		long int totalIterations() const {return _TotalIterations;}
+		//!Number of fits that were minimised
+		long int numMinimisations() const {return _NumMinimisations;}
 	private:
 		std::vector<TrackState*> _trackStateList{};//a copy of the trackStates being fitted
 		InteractionPoint* _ip=nullptr;
 		Vector3 _ManualSeed{};
 		bool _UseManualSeed=false;
 		double _InitialStep=0.0;
+		SeedType _SeedType=PairwiseSeed;
+		long int _LastIterations=0;
+		long int _TotalIterations=0;
+		long int _NumMinimisations=0;
+		bool _linearSeed(const std::vector<TrackState*> & Tracks, Vector3 & Seed);
 		double _chi2Contribution( const Vector3 & point, TrackState* pTrackState );//contribution from each individual track
 		double _chi2Contribution( const Vector3 & point, InteractionPoint* pIP );  //the contribution from the ip only (N.B. pIP could be NULL)
+		Vector3 _chi2Gradient( const Vector3 & point, TrackState* pTrackState );//gradient of each contribution with respect to point
+		Vector3 _chi2Gradient( const Vector3 & point, InteractionPoint* pIP );
 	};
 }
 }
@@ -3,6 +3,7 @@
 
 #include "vertexfuncmaxfinder.h"
 #include "../../util/inc/vector3.h"
+#include <vector>
 
 namespace vertex_lcfi
 {
@@ -31,6 +32,9 @@ by stepping till minimum reached. Currently hard wired step size.
 		Vector3 _CurrentPos{};
 		double _CurrentValue=0;
 		VertexFunction* _Function=nullptr;
+		//Forward and backward probe of _minimiseAlongAxis, kept to save allocating them every step
+		std::vector<Vector3> _ProbePoints{};
+		std::vector<double> _ProbeValues{};
 
 
 		void _minimiseAlongAxis(const Vector3 & Step);
@@ -0,0 +1,49 @@
+#ifndef VERTEXFUNCMAXFINDERNEWTON_H
+#define VERTEXFUNCMAXFINDERNEWTON_H
+
+#include "vertexfuncmaxfinder.h"
+#include "../../util/inc/vector3.h"
+
+namespace vertex_lcfi
+{
+namespace ZVTOP
+{
+	class VertexFunction;
+
+//!Trust region Newton VertexFuncMaxFinder
+/*!
+Climbs to the nearest maximum with Newton steps on the analytic gradient and second
+derivatives of the vertex function (VertexFunction::derivativesAt). Steps are kept
+inside a trust radius, where the function is not locally concave or the Newton step
+is too long the second derivatives are damped (Levenberg-Marquardt) until the step
+fits. A step is only taken if it increases the function, the radius then grows or
+shrinks with how well the quadratic model predicted the increase.
+<br>The radius starts at 2 microns, as the first step of VertexFuncMaxFinderClassicStepper,
+and is capped at MaxRadius so that the search can't jump a valley to a further maximum.
+<br>Finding stops when a step is below Precision, typically after a few tens of evaluations
+where the classic stepper needs hundreds.
+<br>The finder holds no state between calls so one instance can be used by several threads.
+The function must implement derivativesAt (as VertexFunctionClassic), with zero derivatives
+the start point is returned.
+*/
+	class VertexFuncMaxFinderNewton :
+		public VertexFuncMaxFinder
+	{
+	public:
+		//!Constructor
+		/*!
+		\param MaxRadius Largest step in mm
+		\param Precision Step in mm below which the maximum is taken as found
+		*/
+		VertexFuncMaxFinderNewton(double MaxRadius = 0.01, double Precision = 0.0001);
+		Vector3 findNearestMaximum(const Vector3 & StartPoint, VertexFunction* VertexFunction);
+
+	private:
+		double _MaxRadius;
+		double _Precision;
+		static const double _InitialRadius;
+		static const int _MaxIterations;
+	};
+}
+}
+#endif //VERTEXFUNCMAXFINDERNEWTON_H
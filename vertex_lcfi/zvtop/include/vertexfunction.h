@@ -30,8 +30,26 @@ Pure virtual class interface class, cannot be instantiated.
 	public:
 		//Query Methods
 		virtual double valueAt(const Vector3 & Point) const = 0;
-		virtual Matrix3x3 firstDervAt(const Vector3 &Point) const = 0;
+		//!Value at each of Points, Values is resized to match
+		/*! Default just calls valueAt for each point, override if batches can be done faster*/
+		virtual void valuesAt(const std::vector<Vector3> & Points, std::vector<double> & Values) const
+		{
+			Values.resize(Points.size());
+			for (size_t i = 0; i < Points.size(); ++i)
+				Values[i] = this->valueAt(Points[i]);
+		}
+		//!Gradient at Point
+		virtual Vector3 firstDervAt(const Vector3 &Point) const = 0;
+		//!Matrix of second derivatives at Point
 		virtual Matrix3x3 secondDervAt(const Vector3 &Point) const = 0;
+		//!Value, gradient and matrix of second derivatives at Point, the value is returned
+		/*! Default calls valueAt, firstDervAt and secondDervAt, override if they can share work*/
+		virtual double derivativesAt(const Vector3 & Point, Vector3 & Gradient, Matrix3x3 & Hessian) const
+		{
+			Gradient = this->firstDervAt(Point);
+			Hessian = this->secondDervAt(Point);
+			return this->valueAt(Point);
+		}
 		virtual ~VertexFunction() {}	
 	};
 }
@@ -2,9 +2,11 @@
 #define VERTEXFUNCTIONCLASSIC_H
 
 #include "vertexfunction.h"
+#include "gausstubearray.h"
 #include "../../util/inc/vector3.h"
 #include "../../util/inc/matrix.h"
 #include <vector>
+#include <atomic>
 
 namespace vertex_lcfi
 {
@@ -34,10 +36,15 @@ V(\mathbf{r})\rightarrow V(\mathbf{r})exp(-K_{\alpha}\alpha^2)
 \f] 
 Where \f$ \alpha\f$ is the angle between JetAxis and \f$ \mathbf{r}\f$. \f$ K_{IP}\f$ is then just a weight on the Jet Axis.
 
-\todo Derivative functions not yet implemented.
+The gradient and second derivatives are analytic, see derivativesAt. Where the
+function is cut (behind the IP, or no tube contributing) the derivatives are zero.
 
 This class constucts GaussTube and GaussEllipsoid objects and uses thier valueAt(Vector3 Point) to perform the evaluation,
-how the tubes are evaluated depends on them.
+how the tubes are evaluated depends on them. The tubes are also packed into a GaussTubeArray which is
+used for all evaluation, valuesAt evaluates a batch of points in one pass over the tubes.
+<br>Given a TubeCutSigmas the tubes are indexed at construction and those further than that from a point
+are taken as zero there, see GaussTubeArray::buildIndex. The max finders and resolvers evaluate through
+this function, so all use the index.
 
 Destruction cleans up all GaussTube and GaussEllipsoid objects created.
  \author Ben Jeffery (b.jeffery1@physics.ox.ac.uk)
@@ -50,21 +57,36 @@ Destruction cleans up all GaussTube and GaussEllipsoid objects created.
 	{
 	public:
 		//!Constructor
-		/*! Creates GaussTubes as needed from Tracks */
-		VertexFunctionClassic(std::vector<Track*> & Tracks , const double Kip, const double Kalpha, const Vector3 & JetAxis);
+		/*! Creates GaussTubes as needed from Tracks, tubes are cut beyond TubeCutSigmas, 0 for none */
+		VertexFunctionClassic(std::vector<Track*> & Tracks , const double Kip, const double Kalpha, const Vector3 & JetAxis, const double TubeCutSigmas = 0.0);
 		//!Constructor
-		/*! Creates GaussTubes and GaussEllipsoids as needed from Tracks and IP*/
-		VertexFunctionClassic(std::vector<Track*> & Tracks , InteractionPoint* IP, const double Kip, const double Kalpha, const Vector3 & JetAxis);
+		/*! Creates GaussTubes and GaussEllipsoids as needed from Tracks and IP, tubes are cut beyond TubeCutSigmas, 0 for none */
+		VertexFunctionClassic(std::vector<Track*> & Tracks , InteractionPoint* IP, const double Kip, const double Kalpha, const Vector3 & JetAxis, const double TubeCutSigmas = 0.0);
 		//!Destructor
 		~VertexFunctionClassic();
 		VertexFunctionClassic(const vertex_lcfi::ZVTOP::VertexFunctionClassic&) = delete;
 		VertexFunctionClassic& operator=(const vertex_lcfi::ZVTOP::VertexFunctionClassic&) = delete;
 		//!Find the value of the vertex function at Point
 		double valueAt(const Vector3 & Point) const;
-		//!Find the spacial derivative of the vertex function at Point (not implemented)
-		Matrix3x3 firstDervAt(const Vector3 & Point) const;
-		//!Find the 2nd spacial derivative of the vertex function at Point (not implemented)
+		//!Find the value of the vertex function at each of Points
+		void valuesAt(const std::vector<Vector3> & Points, std::vector<double> & Values) const;
+		//!Find the gradient of the vertex function at Point
+		Vector3 firstDervAt(const Vector3 & Point) const;
+		//!Find the 2nd spacial derivatives of the vertex function at Point
 		Matrix3x3 secondDervAt(const Vector3 & Point) const;
+		//!Find the value, gradient and 2nd derivatives of the vertex function at Point in one pass
+		double derivativesAt(const Vector3 & Point, Vector3 & Gradient, Matrix3x3 & Hessian) const;
+
+		//!Most the sum of tube values (and so the f_i sums above) can be reduced at a point by the tube cut
+		inline double maxNeglected() const
+		{return _TubeArray.maxNeglected();}
+
+		//!Number of points the value has been found at since construction
+		inline long numValues() const
+		{return _NumValues;}
+		//!Number of points the derivatives have been found at since construction
+		inline long numDerivatives() const
+		{return _NumDerivatives;}
 	
 	private:
 		//This is seperated his as later on we might want to take and add tracks willy-nilly so I
@@ -72,14 +94,21 @@ Destruction cleans up all GaussTube and GaussEllipsoid objects created.
 		std::vector<VertexFunctionElement*> _AllElements{};
 		std::vector<VertexFunctionElement*> _ElementsNewedByThis{};
 		std::vector<GaussTube*> _Tubes{};
+		GaussTubeArray _TubeArray{};
 		GaussEllipsoid* _Ellipsoid=nullptr;
 		
 		double _Kip=0.0;
 		double _Kalpha=0.0;
 		Vector3 _JetAxis{};
 		
-		double _sumOfTubes(const Vector3 & Point) const;
-		double _sumOfSquaredTubes(const Vector3 & Point) const;
+		//Evaluation counts, the function may be used from several threads
+		mutable std::atomic<long> _NumValues{0};
+		mutable std::atomic<long> _NumDerivatives{0};
+		
+		//Value from the tube sums, adding the IP and jet axis terms
+		double _combine(const Vector3 & Point, const double SumOfTubes, const double SumOfSquaredTubes) const;
+		//As _combine with the derivatives
+		ValueAndDerivatives _combineDerivatives(const Vector3 & Point, const ValueAndDerivatives & Tubes, const ValueAndDerivatives & SquaredTubes) const;
 
 	};
 }
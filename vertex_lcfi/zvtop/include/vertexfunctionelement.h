@@ -2,6 +2,7 @@
 #define VERTEXFUNCTIONELEMENT_H
 
 #include "../../util/inc/vector3.h"
+#include "../../util/inc/smallmatrix.h"
 
 using namespace vertex_lcfi::util;
 
@@ -10,6 +11,54 @@ namespace vertex_lcfi
 namespace ZVTOP
 {
 
+//!Value of a function with its gradient and matrix of second derivatives at a point
+/*!
+Used for the analytic derivatives of the vertex function, the elements and their
+sums are all held in this form. Starts as zero.
+*/
+	struct ValueAndDerivatives
+	{
+		double Value;
+		double Gradient[3];
+		SmallSymMatrix<3> Hessian;
+		ValueAndDerivatives(): Value(0.0), Hessian()
+		{Gradient[0] = Gradient[1] = Gradient[2] = 0.0;}
+	};
+
+	//!Add Weight times Element to Sum and Weight times its square to SumOfSquares, with their derivatives
+	inline void addToSums(const ValueAndDerivatives & Element, const double Weight, ValueAndDerivatives & Sum, ValueAndDerivatives & SumOfSquares)
+	{
+		const double f = Element.Value;
+		Sum.Value += Weight*f;
+		SumOfSquares.Value += Weight*f*f;
+		for (int i = 0; i < 3; ++i)
+		{
+			Sum.Gradient[i] += Weight*Element.Gradient[i];
+			SumOfSquares.Gradient[i] += 2.0*Weight*f*Element.Gradient[i];
+			for (int j = 0; j <= i; ++j)
+			{
+				Sum.Hessian(i,j) += Weight*Element.Hessian(i,j);
+				SumOfSquares.Hessian(i,j) += 2.0*Weight*(Element.Gradient[i]*Element.Gradient[j] + f*Element.Hessian(i,j));
+			}
+		}
+	}
+
+	//!S1 - S2/S1 with its derivatives, the vertex function from its sum and sum of squares. S1 must be positive.
+	inline ValueAndDerivatives sumMinusRatio(const ValueAndDerivatives & S1, const ValueAndDerivatives & S2)
+	{
+		ValueAndDerivatives Result;
+		const double Ratio = S2.Value/S1.Value;
+		Result.Value = S1.Value - Ratio;
+		for (int i = 0; i < 3; ++i)
+			Result.Gradient[i] = S1.Gradient[i] - (S2.Gradient[i] - Ratio*S1.Gradient[i])/S1.Value;
+		for (int i = 0; i < 3; ++i)
+			for (int j = 0; j <= i; ++j)
+				Result.Hessian(i,j) = S1.Hessian(i,j) - (S2.Hessian(i,j) - Ratio*S1.Hessian(i,j))/S1.Value
+					+ (S2.Gradient[i]*S1.Gradient[j] + S1.Gradient[i]*S2.Gradient[j])/(S1.Value*S1.Value)
+					- 2.0*Ratio*S1.Gradient[i]*S1.Gradient[j]/(S1.Value*S1.Value);
+		return Result;
+	}
+
 //!Vertex Fuction Element (Tubes, ellipse) Interface
 /*!
 Pure virtual class interface class, cannot be instantiated.
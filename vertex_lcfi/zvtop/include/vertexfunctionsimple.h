@@ -25,7 +25,8 @@ V(\mathbf{r})= \sum_{i=0}^N f_i(\mathbf{r})-\frac{\sum_{i=0}^N f_i^2(\mathbf{r})
 \f] 
 for the Track and InteractionPoint objects given to it at construction.
 No Kip,Kalpha modifications.
-\todo Derivative functions not yet implemented.
+The gradient and second derivatives are analytic, from those of the GaussTube and GaussEllipsoid
+objects, and zero where no tube contributes.
 
 This class constucts GaussTube and GaussEllipsoid objects and uses thier valueAt(Vector3 Point) to perform the evaluation,
 how the tubes are evaluated depends on them.
@@ -51,8 +52,9 @@ Destruction cleans up all GaussTube and GaussEllipsoid objects created.
 
 		//Query Methods
 		double valueAt(const Vector3 & Point) const;
-		Matrix3x3 firstDervAt(const Vector3 & Point) const;
+		Vector3 firstDervAt(const Vector3 & Point) const;
 		Matrix3x3 secondDervAt(const Vector3 & Point) const;
+		double derivativesAt(const Vector3 & Point, Vector3 & Gradient, Matrix3x3 & Hessian) const;
 	
 	private:
 		//This is seperated his as later on we might want to take and add tracks willy-nilly so I
@@ -0,0 +1,68 @@
+#ifndef VERTEXRESOLVERGOLDENSECTION_H
+#define VERTEXRESOLVERGOLDENSECTION_H
+
+#include "../../util/inc/vector3.h"
+#include "vertexresolver.h"
+
+#include <map>
+
+namespace vertex_lcfi
+{
+namespace ZVTOP
+{
+	class VertexFunction;
+
+//!VertexResolver searching for the minimum of the vertex function with golden section steps
+/*!
+Resolves as VertexResolverEqualSteps, the points are resolved if the vertex function somewhere
+on the line between them is below Threshold times the lower of the two end values, and points
+closer than 10 microns are never resolved.
+<br>Rather than sampling the line at fixed steps the minimum is bracketed with a golden section
+search, stopping as soon as a point below the threshold is found, or once the bracket is shorter
+than Precision of the line. This takes fewer evaluations of the function than equal steps for
+the same accuracy where the function has a single minimum between the points.
+<br>The decision for each pair of points is kept, so asking again (in either order) costs no
+evaluations. The kept decisions are only valid for one vertex function, they are dropped when
+another function is given. As the address of a deleted function may be reused, a resolver should
+not be kept between events, or clearMemo() should be called at the start of each one.
+<br>As the resolver holds state it must not be used by more than one thread at a time.
+*/
+	class VertexResolverGoldenSection :
+		public VertexResolver
+	{
+	public:
+		//!Constructor
+		/*!
+		\param Precision Length of the final bracket as a fraction of the line between the points
+		*/
+		VertexResolverGoldenSection(double Precision = 0.1);
+		bool areResolved(const Vector3& Vertex1, const Vector3& Vertex2, VertexFunction const * VertexFunction, const double Threshold) const;
+
+		//!Forget all kept decisions
+		void clearMemo();
+
+		//!Number of pairs resolved by searching
+		long numSearched() const {return _NumSearched;}
+		//!Number of pairs answered from the kept decisions
+		long numMemoHits() const {return _NumMemoHits;}
+
+	private:
+		//The two points in a fixed order and the threshold
+		struct Key
+		{
+			double Coord[7];
+			bool operator<(const Key & Other) const;
+		};
+
+		bool _search(const Vector3& Vertex1, const Vector3& Vertex2, VertexFunction const * VertexFunction, const double Threshold) const;
+
+		double _Precision;
+		mutable std::map<Key,bool> _Memo{};
+		mutable VertexFunction const * _MemoFunction=nullptr;
+		mutable long _NumSearched=0;
+		mutable long _NumMemoHits=0;
+	};
+}
+}
+
+#endif //VERTEXRESOLVERGOLDENSECTION_H
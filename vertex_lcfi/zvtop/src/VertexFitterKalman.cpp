@@ -11,7 +11,6 @@
 
 */
 
-#include <map>
 #include "../include/VertexFitterKalman.h"
 #include "../include/interactionpoint.h"
 #include "../include/vertexfitterlsm.h"
@@ -66,10 +65,11 @@ namespace vertex_lcfi { namespace ZVTOP {
     {  
       VertexFitterLSM fitterLSM;
       if( m_useManualSeed ) fitterLSM.setSeed(m_manualSeed);
-      std::map<TrackState*,double> ChiSquaredOfTracks;
-      double ChiSquaredOfIP;      
-      fitterLSM.fitVertex(Tracks, IP, Result, ResultError, 
-                          ChiSquaredOfFit, ChiSquaredOfTracks, ChiSquaredOfIP);      
+      VertexFitResult LSMResult;
+      fitterLSM.fitVertex(Tracks, IP, LSMResult, true);
+      Result = LSMResult.Position;
+      ResultError = LSMResult.PositionError;
+      ChiSquaredOfFit = LSMResult.ChiSquaredOfFit;
       fP[0] = Result.x();
       fP[1] = Result.y();
       fP[2] = Result.z();
@@ -319,38 +319,25 @@ namespace vertex_lcfi { namespace ZVTOP {
   
   void VertexFitterKalman::fitVertex(const std::vector<TrackState*> & Tracks, 
                                      InteractionPoint* IP, 
-                                     Vector3 & Result, double & ChiSquaredOfFit, 
-                                     std::map<TrackState*,double> & ChiSquaredOfTrack,
-                                     double & ChiSquaredOfIP) 
-  {		
-    Matrix3x3 ResultError;
-    this->fitVertex(Tracks, IP, Result, ResultError, ChiSquaredOfFit,
-                    ChiSquaredOfTrack, ChiSquaredOfIP);
-
-  }
-  
-
-  void VertexFitterKalman::fitVertex(const std::vector<TrackState*> & Tracks, 
-                                     InteractionPoint* IP, 
-                                     Vector3 & Result, Matrix3x3 & ResultError, 
-                                     double & ChiSquaredOfFit, 
-                                     std::map<TrackState*,double> & ChiSquaredOfTrack,
-                                     double & ChiSquaredOfIP) {
+                                     VertexFitResult & Result, 
+                                     bool /*CalculateError*/) {
     
-    this->fitVertex(Tracks, IP, Result, ResultError, ChiSquaredOfFit);
+    //* The error comes with the fit, so is always filled in
+    this->fitVertex(Tracks, IP, Result.Position, Result.PositionError, 
+                    Result.ChiSquaredOfFit);
     
-    ChiSquaredOfTrack.clear();
+    Result.ChiSquaredOfTrack.clear();
     std::vector<TrackState*>::const_iterator its;
     for( its = Tracks.begin(); Tracks.end() != its; its++ ) 
     {
       TState  myState(*its);      
       TState* state = &myState;      
       double chi2 =  getDeviationFromVertex( state, fP, fC );
-      ChiSquaredOfTrack.insert( std::pair<TrackState*,double>( (*its), chi2 ) );
+      Result.ChiSquaredOfTrack.push_back( chi2 );
     }
     
-    ChiSquaredOfIP = 0;    
-    if( IP ) ChiSquaredOfIP = IP->chi2(Result);
+    Result.ChiSquaredOfIP = 0;    
+    if( IP ) Result.ChiSquaredOfIP = IP->chi2(Result.Position);
 
   }  
   
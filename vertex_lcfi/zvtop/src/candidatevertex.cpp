@@ -7,6 +7,8 @@
 #include "../include/vertexresolverequalsteps.h"
 #include "../include/vertexfuncmaxfinder.h"
 #include "../include/vertexfuncmaxfinderclassicstepper.h"
+#include "../include/strategyprovider.h"
+#include "../include/interactionpoint.h"
 #include "../../inc/trackstate.h"
 #include "../include/vertexfunction.h"
 #include "../../util/inc/util.h"
@@ -20,10 +22,6 @@ namespace vertex_lcfi
 {
 namespace ZVTOP
 {
-VertexFitter* CandidateVertex::_FallbackFitter;
-VertexResolver* CandidateVertex::_FallbackResolver;
-VertexFuncMaxFinder* CandidateVertex::_FallbackMaxFinder;
-
 //Construct from tracks and vertex function
 CandidateVertex::CandidateVertex(const std::vector<TrackState*>& Tracks, VertexFunction* VertexFunction, VertexFitter* Fitter, VertexResolver* Resolver, VertexFuncMaxFinder* MaxFinder)
         : _Fitter(Fitter),_Resolver(Resolver),_MaxFinder(MaxFinder),_IP(0),_TrackStates(Tracks),_VertexFunction(VertexFunction),_VertexFuncMaxIsValid(0),_FitIsValid(0),_ErrorOfFitIsValid(0)
@@ -34,8 +32,8 @@ CandidateVertex::CandidateVertex(const std::vector<TrackState*>& Tracks, Interac
         : _Fitter(Fitter),_Resolver(Resolver),_MaxFinder(MaxFinder),_IP(IP),_TrackStates(Tracks),_VertexFunction(VertexFunction),_VertexFuncMaxIsValid(0),_FitIsValid(0),_ErrorOfFitIsValid(0)
 {/*NO OP*/}
 
-CandidateVertex::CandidateVertex(const Vector3 & Position, const Matrix3x3 & PositionError, double ChiSquaredOfFit, std::map<TrackState*,double> ChiSquaredOfTrack, double ChiSquaredOfIP)
-	:_Position(Position),_PositionError(PositionError),_ChiSquaredOfFit(ChiSquaredOfFit),_ChiSquaredOfTrack(ChiSquaredOfTrack),_ChiSquaredOfIP(ChiSquaredOfIP),_FitIsValid(1),_ErrorOfFitIsValid(1)
+CandidateVertex::CandidateVertex(const std::vector<TrackState*>& Tracks, InteractionPoint* IP, const VertexFitResult & Fit)
+	:_IP(IP),_TrackStates(Tracks),_Fit(Fit),_FitIsValid(1),_ErrorOfFitIsValid(1)
 {/*NO OP*/}
 
 CandidateVertex::CandidateVertex(const std::vector<CandidateVertex*> & Vertices, VertexFitter* Fitter, VertexResolver* Resolver, VertexFuncMaxFinder* MaxFinder)
@@ -68,8 +66,7 @@ bool CandidateVertex::removeTrackState(TrackState* const TrackToRemove)
     std::vector<TrackState*>::iterator position = find(_TrackStates.begin(), _TrackStates.end(), TrackToRemove);
     if (position!=_TrackStates.end()) //Found
     {
-        _TrackStates.erase(position);
-        this->invalidateFit();
+        this->_eraseTrackState(position);
         return 1;
     }
     else
@@ -84,8 +81,7 @@ bool CandidateVertex::removeTrack(Track * const TrackToRemove)
     //iTrack now points to end or the track we want to remove
     if (iTrack!=_TrackStates.end())
     {
-        _TrackStates.erase(iTrack);
-        this->invalidateFit();
+        this->_eraseTrackState(iTrack);
         return 1;
     }
     else
@@ -94,7 +90,36 @@ bool CandidateVertex::removeTrack(Track * const TrackToRemove)
 
 void CandidateVertex::addTrackState(TrackState* TrackToAdd)
 {
+    this->_addTrackState(TrackToAdd, 0);
+}
+
+void CandidateVertex::_addTrackState(TrackState* TrackToAdd, const FitTerms* Terms)
+{
+    this->_beforeTrackChange();
     _TrackStates.push_back(TrackToAdd);
+    if (_InformationIsValid)
+    {
+        FitTerms NewTerms;
+        if (Terms)
+            NewTerms = *Terms;
+        else
+            _makeFitTerms(TrackToAdd, _Fit.Position, NewTerms);
+        _TrackTerms.push_back(NewTerms);
+        this->_addTerms(NewTerms);
+    }
+    this->invalidateFit();
+}
+
+void CandidateVertex::_eraseTrackState(std::vector<TrackState*>::iterator iTrack)
+{
+    this->_beforeTrackChange();
+    if (_InformationIsValid)
+    {
+        std::vector<FitTerms>::iterator iTerms = _TrackTerms.begin() + (iTrack - _TrackStates.begin());
+        this->_subtractTerms(*iTerms);
+        _TrackTerms.erase(iTerms);
+    }
+    _TrackStates.erase(iTrack);
     this->invalidateFit();
 }
 
@@ -119,6 +144,8 @@ void CandidateVertex::setIP(InteractionPoint* IP)
 
 void CandidateVertex::mergeCandidateVertex(const CandidateVertex* SourceVertex)
 {
+	//Before setIP drops the fit the terms would be made from
+	this->_beforeTrackChange();
     //Check which func max is biggest and keep it.
 	if (this->vertexFuncMaxValue() < SourceVertex->vertexFuncMaxValue())
 	{
@@ -131,10 +158,14 @@ void CandidateVertex::mergeCandidateVertex(const CandidateVertex* SourceVertex)
 			this->setIP(SourceVertex->interactionPoint());
 	
 	std::vector<TrackState*> SourceList = SourceVertex->trackStateList();
+	//Take the terms of the source's tracks if it has them, rather than making them again
+	std::vector<FitTerms> SourceTerms;
+	if (SourceVertex->_InformationIsValid)
+		SourceTerms = SourceVertex->_TrackTerms;
     for (std::vector<TrackState*>::iterator iSourceTrack = SourceList.begin();iSourceTrack != SourceList.end();++iSourceTrack)
     {
         this->removeTrack((*iSourceTrack)->parentTrack());	//Removing before we add ensures no duplicates.
-        this->addTrackState(*iSourceTrack);
+        this->_addTrackState(*iSourceTrack, SourceTerms.empty() ? 0 : &SourceTerms[iSourceTrack - SourceList.begin()]);
     }
 }
 
@@ -166,16 +197,9 @@ int CandidateVertex::trimByProb(const double ProbThreshold)
 	if (Prob < ProbThreshold)
         {
 		//Find Track with Highest Chi Squared
-		TrackState* HighTrack = 0;
-		double HighChiSquared = -1;
-		for (std::vector<TrackState*>::iterator iTrackState = _TrackStates.begin();iTrackState != _TrackStates.end();++iTrackState)
-		{
-		    if (this->chiSquaredOfTrack(*iTrackState) > HighChiSquared)   //Refit happens when chiSquaredOfTrackChecks
-		    {
-			HighChiSquared = this->chiSquaredOfTrack(*iTrackState);
-			HighTrack = *iTrackState;
-		    }
-		}
+		double HighChiSquared;
+		size_t High = this->_highestChiSquaredTrack(HighChiSquared);
+		TrackState* HighTrack = (High < _TrackStates.size() ? _TrackStates[High] : 0);
 		//std::cout << HighChiSquared << std::endl;
 		//std::cout << this->trackStateList().size() << std::endl;
 		this->removeTrackState(HighTrack);
@@ -204,16 +228,9 @@ int CandidateVertex::trimByChi2(const double Chi2Threshold)
     do
     {
         //Find Track with Highest Chi Squared
-        TrackState* HighTrack = 0;
-        double		HighChiSquared = -1;
-        for (std::vector<TrackState*>::iterator iTrackState = _TrackStates.begin();iTrackState != _TrackStates.end();++iTrackState)
-        {
-            if (this->chiSquaredOfTrack(*iTrackState) > HighChiSquared)   //Refit happens when chiSquaredOfTrackChecks
-            {
-                HighChiSquared = this->chiSquaredOfTrack(*iTrackState);
-                HighTrack = *iTrackState;
-            }
-        }
+        double		HighChiSquared;
+        size_t High = this->_highestChiSquaredTrack(HighChiSquared);   //Refit happens here if needed
+        TrackState* HighTrack = (High < _TrackStates.size() ? _TrackStates[High] : 0);
         //If this track is above threshold then remove it
         if (HighChiSquared > Chi2Threshold)
         {
@@ -239,17 +256,9 @@ int CandidateVertex::trimByChi2(const double Chi2Threshold, VertexFitter* Fitter
         //Refit now to make sure we have a fit that used the fitter specified, other wise chiSquaredOfTrack will invoke default!
         this->refit(Fitter); //TODO CHECK FIT OK
         //Find Track with Highest Chi Squared
-        //TODO This could be more fast/clever
-    	TrackState* HighTrack = 0;
-        double		HighChiSquared = -1;
-        for (std::vector<TrackState*>::iterator iTrackState = _TrackStates.begin();iTrackState != _TrackStates.end();++iTrackState)
-        {
-            if (this->chiSquaredOfTrack(*iTrackState) > HighChiSquared)
-            {
-                HighChiSquared = this->chiSquaredOfTrack(*iTrackState);
-                HighTrack = *iTrackState;
-            }
-        }
+        double		HighChiSquared;
+        size_t High = this->_highestChiSquaredTrack(HighChiSquared);
+        TrackState* HighTrack = (High < _TrackStates.size() ? _TrackStates[High] : 0);
         //If this track is above threshold then remove it
         if (HighChiSquared > Chi2Threshold)
         {
@@ -278,35 +287,99 @@ void CandidateVertex::invalidateFit() const
 
 void CandidateVertex::refit(bool CalculateError) const
 {
-	if (CalculateError) 
-	{
-		_Fitter->fitVertex(this->trackStateList(), this->interactionPoint(),_Position,_ChiSquaredOfFit,_ChiSquaredOfTrack,_ChiSquaredOfIP);
-	}
-	else
-	{
-		_Fitter->fitVertex(this->trackStateList(), this->interactionPoint(),_Position,_PositionError,_ChiSquaredOfFit,_ChiSquaredOfTrack,_ChiSquaredOfIP);
-	}
+	//The information form holds only the tracks, so vertices with the IP (which the fitter may use,
+	//as VertexFitterLSM does with less than two tracks) are always fitted by the fitter
+	if (_InformationIsValid && !_IP && _TrackStates.size() > 1 && this->_solveInformation(CalculateError))
+		return;
+	this->_fitWith(this->_fitter(), CalculateError);
+}
+
+void CandidateVertex::refit(VertexFitter* Fitter,bool CalculateError) const
+{
+	this->_fitWith(Fitter, CalculateError);
+}
+
+void CandidateVertex::_fitWith(VertexFitter* Fitter, bool CalculateError) const
+{
+	Fitter->fitVertex(this->trackStateList(), this->interactionPoint(),_Fit,CalculateError);
 	_FitIsValid=1;
 	_ErrorOfFitIsValid=CalculateError;
 }
 
-void CandidateVertex::refit(VertexFitter* Fitter,bool CalculateError) const
+void CandidateVertex::_makeFitTerms(TrackState* Track, const Vector3 & Near, FitTerms & Terms)
 {
-    if (CalculateError) 
+	Track->swimToStateNearest(Near);
+	Terms.Weight = SmallSymMatrix<3>(Track->localVertexErrorContribution());
+	const double Point[3] = {Track->position().x(), Track->position().y(), Track->position().z()};
+	Terms.Weight.multiply(Point, Terms.WeightedPoint);
+}
+
+void CandidateVertex::_beforeTrackChange() const
+{
+	if (!_IncrementalFit || _InformationIsValid || !_FitIsValid)
+		return;
+	_Information = SmallSymMatrix<3>();
+	_WeightedSum[0] = _WeightedSum[1] = _WeightedSum[2] = 0.0;
+	_TrackTerms.resize(_TrackStates.size());
+	for (size_t i = 0; i < _TrackStates.size(); ++i)
 	{
-		Fitter->fitVertex(this->trackStateList(), this->interactionPoint(),_Position,_ChiSquaredOfFit,_ChiSquaredOfTrack,_ChiSquaredOfIP);
+		_makeFitTerms(_TrackStates[i], _Fit.Position, _TrackTerms[i]);
+		this->_addTerms(_TrackTerms[i]);
 	}
-	else
+	_InformationIsValid = 1;
+}
+
+void CandidateVertex::_addTerms(const FitTerms & Terms) const
+{
+	_Information += Terms.Weight;
+	for (short i = 0; i < 3; ++i)
+		_WeightedSum[i] += Terms.WeightedPoint[i];
+}
+
+void CandidateVertex::_subtractTerms(const FitTerms & Terms) const
+{
+	_Information -= Terms.Weight;
+	for (short i = 0; i < 3; ++i)
+		_WeightedSum[i] -= Terms.WeightedPoint[i];
+}
+
+bool CandidateVertex::_solveInformation(bool CalculateError) const
+{
+	double Solution[3];
+	if (!_Information.solve(_WeightedSum, Solution))
+		return 0;
+	_Fit.Position.x() = Solution[0];
+	_Fit.Position.y() = Solution[1];
+	_Fit.Position.z() = Solution[2];
+	if (CalculateError)
 	{
-		Fitter->fitVertex(this->trackStateList(), this->interactionPoint(),_Position,_PositionError,_ChiSquaredOfFit,_ChiSquaredOfTrack,_ChiSquaredOfIP);
+		SmallSymMatrix<3> Error(_Information);
+		Error.invert();
+		Error.copyTo(_Fit.PositionError);
 	}
+	//Chi squared as VertexFitterLSM fills it in
+	_Fit.ChiSquaredOfFit = 0;
+	_Fit.ChiSquaredOfTrack.clear();
+	for (std::vector<TrackState*>::const_iterator iTrack = _TrackStates.begin();iTrack != _TrackStates.end();++iTrack)
+	{
+		double Chi = (*iTrack)->chi2(_Fit.Position);
+		_Fit.ChiSquaredOfTrack.push_back(Chi);
+		_Fit.ChiSquaredOfFit += Chi;
+	}
+	_Fit.ChiSquaredOfIP = 0.0;
 	_FitIsValid=1;
 	_ErrorOfFitIsValid=CalculateError;
+	return 1;
 }
 
 bool CandidateVertex::findVertexFuncMax() const
 {
-	_VertexFuncMaxPosition = _MaxFinder->findNearestMaximum(this->position(), _VertexFunction);
+	return this->findVertexFuncMax(this->_maxFinder());
+}
+
+bool CandidateVertex::findVertexFuncMax(VertexFuncMaxFinder* MaxFinder) const
+{
+	_VertexFuncMaxPosition = MaxFinder->findNearestMaximum(this->position(), _VertexFunction);
 	_VertexFuncMaxValue = _VertexFunction->valueAt(_VertexFuncMaxPosition);
         _VertexFuncMaxIsValid = 1;
         return 1;
@@ -318,26 +391,27 @@ bool CandidateVertex::isResolvedFrom(CandidateVertex* const Vertex, const double
 	switch (Type)
 	{
 		case FittedPosition:
-			return _Resolver->areResolved(this->position(), Vertex->position(), _VertexFunction, Threshold);
+			return this->_resolver()->areResolved(this->position(), Vertex->position(), _VertexFunction, Threshold);
 			break;
 		case NearestMaximum:
-			return _Resolver->areResolved(this->vertexFuncMaxPosition(), Vertex->vertexFuncMaxPosition(), _VertexFunction, Threshold);
+			return this->_resolver()->areResolved(this->vertexFuncMaxPosition(), Vertex->vertexFuncMaxPosition(), _VertexFunction, Threshold);
 			break;
 	}
 	//TODO Throw as not supported
 	return 0;
 }
 
-bool CandidateVertex::isResolvedFrom(CandidateVertex* const Vertex, const double Threshold, CandidateVertex::eResolveType Type, VertexResolver* /*Resolver*/ ) const
+bool CandidateVertex::isResolvedFrom(CandidateVertex* const Vertex, const double Threshold, CandidateVertex::eResolveType Type, VertexResolver* Resolver ) const
 {
 	//Todo null vertex pointer check
+	if (!Resolver) Resolver = this->_resolver();
 	switch (Type)
 	{
 		case FittedPosition:
-			return _Resolver->areResolved(this->position(), Vertex->position(), _VertexFunction, Threshold);
+			return Resolver->areResolved(this->position(), Vertex->position(), _VertexFunction, Threshold);
 			break;
 		case NearestMaximum:
-			return _Resolver->areResolved(this->vertexFuncMaxPosition(), Vertex->vertexFuncMaxPosition(), _VertexFunction, Threshold);
+			return Resolver->areResolved(this->vertexFuncMaxPosition(), Vertex->vertexFuncMaxPosition(), _VertexFunction, Threshold);
 			break;
 	}
 	//TODO Throw as not supported
@@ -356,28 +430,28 @@ const Vector3 & CandidateVertex::position() const
 {
 	if (!_FitIsValid)
         this->refit(); //TODO CHECK FIT OK
-	return _Position;
+	return _Fit.Position;
 }
 
 const Matrix3x3 & CandidateVertex::positionError() const //TODO WHATS UP HERE WITH WINDOWS COMPLILING
 {
     if (!_ErrorOfFitIsValid)
         this->refit(1);
-    return _PositionError;
+    return _Fit.PositionError;
 }
 
 double CandidateVertex::distanceTo(const Vector3 & Point) const
 {
     if (!_FitIsValid)
         this->refit(); //TODO CHECK FIT OK
-    return _Position.distanceTo(Point);
+    return _Fit.Position.distanceTo(Point);
 }
 
 double CandidateVertex::distanceTo(const CandidateVertex* const Vertex) const
 {
     if (!_FitIsValid)
         this->refit(); //TODO CHECK FIT OK
-    return (_Position.subtract(Vertex->position())).mag();
+    return (_Fit.Position.subtract(Vertex->position())).mag();
 }
 
 
@@ -404,14 +478,14 @@ const Vector3 & CandidateVertex::vertexFuncMaxPosition() const
 
 double CandidateVertex::chiSquaredOfTrack(TrackState* Track) const
 {
-    //TODO I'm pretty sure this can be done faster, as this is the paranoid way
 	if (!_FitIsValid)
         this->refit(); //TODO CHECK FIT OK
-	std::map<TrackState*,double>::iterator iTrack = _ChiSquaredOfTrack.find(Track);
-    if(iTrack == _ChiSquaredOfTrack.end())
+	//The chi squareds are in the order of the tracks
+	std::vector<TrackState*>::const_iterator iTrack = std::find(_TrackStates.begin(), _TrackStates.end(), Track);
+    if(iTrack == _TrackStates.end())
         return -1;
     else
-        return _ChiSquaredOfTrack[Track];
+        return _Fit.ChiSquaredOfTrack[iTrack - _TrackStates.begin()];
 }
 
 double CandidateVertex::chiSquaredOfIP() const
@@ -420,39 +494,34 @@ double CandidateVertex::chiSquaredOfIP() const
 	{
 		if (!_FitIsValid)
         this->refit();
-		return _ChiSquaredOfIP;
+		return _Fit.ChiSquaredOfIP;
 	}
 	else
 		return 0;
 }
 
-const std::map<TrackState*, double> & CandidateVertex::chiSquaredOfAllTracks() const
+const SmallVector<double> & CandidateVertex::chiSquaredOfAllTracks() const
 {
   if (!_FitIsValid) {
     this->refit(); //TODO CHECK FIT OK
   }
-  return _ChiSquaredOfTrack;
+  return _Fit.ChiSquaredOfTrack;
 }
 
 double CandidateVertex::chiSquaredOfFit() const
 {
     if (!_FitIsValid)
         this->refit(); //TODO CHECK FIT OK
-    return _ChiSquaredOfFit;
+    return _Fit.ChiSquaredOfFit;
 }
 
 double CandidateVertex::maxChiSquaredOfTrackIP() const
 {
-	if  (!_FitIsValid)
-		this->refit();
 	//Find Track with Highest Chi Squared
-	//TODO This could be more fast/clever
-	double HighChiSquared = 0;
-	for (std::vector<TrackState*>::const_iterator iTrackState = _TrackStates.begin();iTrackState != _TrackStates.end();++iTrackState)
-	{
-		if (this->chiSquaredOfTrack(*iTrackState) > HighChiSquared)
-			HighChiSquared = this->chiSquaredOfTrack(*iTrackState);
-	}
+	double HighChiSquared;
+	this->_highestChiSquaredTrack(HighChiSquared);
+	if (!(HighChiSquared > 0))
+		HighChiSquared = 0;
 	//Check the IP too
 	if (_IP)
 	{
@@ -462,35 +531,62 @@ double CandidateVertex::maxChiSquaredOfTrackIP() const
 	return HighChiSquared;
 }
 
+size_t CandidateVertex::_highestChiSquaredTrack(double & HighChiSquared) const
+{
+	if (!_FitIsValid)
+		this->refit(); //TODO CHECK FIT OK
+	size_t HighTrack = _TrackStates.size();
+	HighChiSquared = -1;
+	for (size_t i = 0; i < _TrackStates.size(); ++i)
+	{
+		if (_Fit.ChiSquaredOfTrack[i] > HighChiSquared)
+		{
+			HighChiSquared = _Fit.ChiSquaredOfTrack[i];
+			HighTrack = i;
+		}
+	}
+	return HighTrack;
+}
+
+VertexFitter* CandidateVertex::_fitter() const
+{
+	if (_Fitter) return _Fitter;
+	VertexFitter* Fitter = _Strategies ? _Strategies->fitter() : 0;
+	return Fitter ? Fitter : _getFallbackFitter();
+}
+
+VertexResolver* CandidateVertex::_resolver() const
+{
+	if (_Resolver) return _Resolver;
+	VertexResolver* Resolver = _Strategies ? _Strategies->resolver() : 0;
+	return Resolver ? Resolver : _getFallbackResolver();
+}
+
+VertexFuncMaxFinder* CandidateVertex::_maxFinder() const
+{
+	if (_MaxFinder) return _MaxFinder;
+	VertexFuncMaxFinder* MaxFinder = _Strategies ? _Strategies->maxFinder() : 0;
+	return MaxFinder ? MaxFinder : _getFallbackMaxFinder();
+}
+
+//The last resort of _fitter(), _resolver() and _maxFinder(). Made on first use by each thread, so never
+//shared between threads and need no locking
 VertexFitter* CandidateVertex::_getFallbackFitter()
 {
-    if (!_FallbackFitter)
-        {
-        	_FallbackFitter = new FallbackVertexFitter();
-        	MemoryManager<VertexFitter>::Run()->registerObject(_FallbackFitter);
-       	}
-        
-    return _FallbackFitter;
+    static thread_local FallbackVertexFitter Fitter;
+    return &Fitter;
 }
 
 VertexResolver* CandidateVertex::_getFallbackResolver()
 {
-    if (!_FallbackResolver)
-    {
-    	_FallbackResolver = new FallbackVertexResolver();
-       	MemoryManager<VertexResolver>::Run()->registerObject(_FallbackResolver);
-    }
-    return _FallbackResolver;
+    static thread_local FallbackVertexResolver Resolver;
+    return &Resolver;
 }
 
 VertexFuncMaxFinder* CandidateVertex::_getFallbackMaxFinder()
 {
-    if (!_FallbackMaxFinder)
-    {
-        _FallbackMaxFinder = new FallbackVertexFuncMaxFinder();
-       	MemoryManager<VertexFuncMaxFinder>::Run()->registerObject(_FallbackMaxFinder);
-    }
-    return _FallbackMaxFinder;
+    static thread_local FallbackVertexFuncMaxFinder MaxFinder;
+    return &MaxFinder;
 }
 }
 }
@@ -16,8 +16,28 @@ namespace vertex_lcfi { namespace ZVTOP
 		Vector3 RelativePoint = Point-(_IP->position());
 		//Calculate value of UNNORMALISED gaussian at point from covarience matrix
 		//Lyons pp 60
-		SymMatrix3x3 InvErr = _IP->inverseErrorMatrix();
-		return exp(-0.5 * prec_inner_prod(RelativePoint,prec_prod(InvErr, RelativePoint)));
+		return exp(-0.5 * quadraticForm3(_IP->inverseErrorMatrix(), RelativePoint));
+	}
+
+	ValueAndDerivatives GaussEllipsoid::derivativesAt(const Vector3 & Point) const
+	{
+		const Matrix3x3 & InvError = _IP->inverseErrorMatrix();
+		const Vector3 & Position = _IP->position();
+		const double r[3] = {Point.x()-Position.x(), Point.y()-Position.y(), Point.z()-Position.z()};
+		//W.r, W being the inverse error matrix
+		double Wr[3];
+		for (int i = 0; i < 3; ++i)
+			Wr[i] = InvError(i,0)*r[0] + InvError(i,1)*r[1] + InvError(i,2)*r[2];
+		ValueAndDerivatives Result;
+		Result.Value = exp(-0.5*(r[0]*Wr[0] + r[1]*Wr[1] + r[2]*Wr[2]));
+		//Gradient -f.W.r, second derivatives f.(W.r.r^T.W - W)
+		for (int i = 0; i < 3; ++i)
+		{
+			Result.Gradient[i] = -Result.Value*Wr[i];
+			for (int j = 0; j <= i; ++j)
+				Result.Hessian(i,j) = Result.Value*(Wr[i]*Wr[j] - 0.5*(InvError(i,j)+InvError(j,i)));
+		}
+		return Result;
 	}
 
 	InteractionPoint* GaussEllipsoid::ip()
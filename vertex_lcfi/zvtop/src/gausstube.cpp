@@ -1,43 +1,153 @@
 #include "../include/gausstube.h"
-#include "../../inc/trackstate.h"
 #include "../../inc/track.h"
 #include <math.h>
 
 namespace vertex_lcfi { namespace ZVTOP
 {
+  const double GaussTube::_MinZResidual = 0.0001; //0.1 Micron
+
   GaussTube::GaussTube(Track* Track):
-    //We make a trackstate to be used by the tube, with the appropriate swimmer
-    _TrackState( new TrackState(Track) )
-  {}
+    _Path(Track->path()),
+    _InverseCovariance(Track->inversePositionCovarianceAt(0)),
+    _SecLambda(sqrt(1.0+Track->helixRep().tanLambda()*Track->helixRep().tanLambda()))
+  {
+  }
 	
 	double GaussTube::valueAt(const Vector3 & Point) const
 	{
 		//Calculate value of UNNORMALISED gaussian at point from covarience matrix
-		boost::numeric::ublas::bounded_vector<double,2> Residual;
-		//XY Dist in 2D
-		_TrackState->swimToStateNearestXY(Point);
-		Residual(0) = _TrackState->xyDistanceTo(Point);
-		//Z in 3D
-		_TrackState->swimToStateNearest(Point);
-		//The 3Ddist , 2Ddist and distance on z plane form a right triangle, convert to zaxis by dividing by sin theta 
-		//Check hypotenuse longest
-		if (_TrackState->distanceTo(Point) < Residual(0)) 
-			Residual(1) = 0 ;
-		else
-			Residual(1) = sqrt(_TrackState->distanceTo2(Point)-pow(Residual(0),2))*sqrt(pow(_TrackState->parentTrack()->helixRep().tanLambda(),2)+1.0);
+		//Residuals in XY and along z from the path, nothing is swum so the tube is not changed
+		const Vector3 d = _Path.positionAt(_Path.pcaTo(Point)).subtract(Point);
+		double XY, u[3], Curvature;
+		this->_xyResidual(Point, XY, u, Curvature);
 		
 		// Value of tube = -0.5exp(res.inv(V).res) - Lyons pp 60
-		boost::numeric::ublas::bounded_vector<double,2> temp = prec_prod(_TrackState->inversePositionCovarMatrix(), Residual);
-		//std::cout << exp(-0.5 * prec_inner_prod(Residual,temp)) << std::endl;
-		return exp(-0.5 * prec_inner_prod(Residual,temp));
+		return exp(-0.5 * this->_exponent(XY, d.mag2() - XY*XY));
 				
 	}
 
-	GaussTube::~GaussTube()
+	void GaussTube::_xyResidual(const Vector3 & Point, double & Residual, double u[3], double & Curvature) const
+	{
+		//For a helix |rho-R| from the circle centre, for a line the distance from it which is flat across
+		u[0] = u[1] = u[2] = 0.0;
+		Curvature = 0.0;
+		if (_Path.isCharged())
+		{
+			const double cx = Point.x()-_Path.centreX();
+			const double cy = Point.y()-_Path.centreY();
+			const double rho = sqrt(cx*cx+cy*cy);
+			const double Radius = fabs(1.0/_Path.helixRep().invR());
+			Residual = fabs(rho - Radius);
+			if (rho > 0.0)
+			{
+				const double Sign = (rho > Radius) ? 1.0 : -1.0;
+				u[0] = Sign*cx/rho;
+				u[1] = Sign*cy/rho;
+				Curvature = Sign/rho;
+			}
+		}
+		else
+		{
+			const Vector3 XYOffset = Point.subtract(_Path.positionAt(_Path.xyPCATo(Point)));
+			Residual = XYOffset.mag(RPhi);
+			if (Residual > 0.0)
+			{
+				u[0] = XYOffset.x()/Residual;
+				u[1] = XYOffset.y()/Residual;
+			}
+		}
+	}
+
+	double GaussTube::_exponent(const double XY, const double w) const
 	{
-          delete _TrackState;
-          _TrackState=nullptr;
+		//Same expression as GaussTubeArray::sumsAt so the value is identical
+		if (w > 0.0)
+		{
+			const double Z = sqrt(w)*_SecLambda;
+			return XY*XY*_InverseCovariance(0,0) + 2.0*XY*Z*_InverseCovariance(0,1) + Z*Z*_InverseCovariance(1,1);
+		}
+		return XY*XY*_InverseCovariance(0,0);
+	}
+
+	ValueAndDerivatives GaussTube::derivativesAt(const Vector3 & Point) const
+	{
+		//Path minus point d, direction T and dT/ds at the 3D POCA
+		Vector3 Position, T, Bend;
+		_Path.positionAt(_Path.pcaTo(Point), Position, T, Bend);
+		const Vector3 d = Position.subtract(Point);
+		//Second derivative of half the squared distance wrt s
+		const double f2 = T.mag2() + d.dot(Bend);
+		const double dist2 = d.mag2();
+
+		//XY residual, gradient and second derivatives
+		double res0, u[3], Curvature;
+		this->_xyResidual(Point, res0, u, Curvature);
+		double Grad0[3];
+		SmallSymMatrix<3> Hess0;
+		for (int i = 0; i < 3; ++i)
+		{
+			Grad0[i] = u[i];
+			for (int j = 0; j <= i; ++j)
+				Hess0(i,j) = (i < 2 && j < 2) ? Curvature*((i == j ? 1.0 : 0.0) - u[i]*u[j]) : 0.0;
+		}
+
+		//w = dist2-res0^2, the z residual is sqrt(w)*secLambda. dist2 has gradient -2d and, as the
+		//POCA moves along the path with the point, second derivatives 2(I-T.T^T/f2)
+		const double TOverF2 = (f2 > 0.0) ? 1.0/f2 : 0.0;
+		const double Td[3] = {T.x(), T.y(), T.z()};
+		const double dd[3] = {d.x(), d.y(), d.z()};
+		double GradW[3];
+		SmallSymMatrix<3> HessW;
+		for (int i = 0; i < 3; ++i)
+		{
+			GradW[i] = -2.0*dd[i] - 2.0*res0*Grad0[i];
+			for (int j = 0; j <= i; ++j)
+				HessW(i,j) = 2.0*((i == j ? 1.0 : 0.0) - Td[i]*Td[j]*TOverF2) - 2.0*(Grad0[i]*Grad0[j] + res0*Hess0(i,j));
+		}
+
+		//Exponent q(res0,w) and its partial derivatives
+		const double A = _InverseCovariance(0,0);
+		const double B = _InverseCovariance(0,1);
+		const double C = _InverseCovariance(1,1);
+		const double S = _SecLambda;
+		const double w = dist2 - res0*res0;
+		const double q = this->_exponent(res0, w);
+		double q0, qw, q00, q0w, qww;
+		if (w > 0.0)
+		{
+			const double rootW = sqrt(w);
+			const double res1 = rootW*S;
+			const double rootWd = (rootW > _MinZResidual) ? rootW : _MinZResidual;
+			q0 = 2.0*A*res0 + 2.0*B*res1;
+			qw = B*S*res0/rootWd + C*S*S;
+			q00 = 2.0*A;
+			q0w = B*S/rootWd;
+			qww = -0.5*B*S*res0/(rootWd*rootWd*rootWd);
+		}
+		else
+		{
+			q0 = 2.0*A*res0;
+			qw = q0w = qww = 0.0;
+			q00 = 2.0*A;
+		}
+
+		//Tube exp(-q/2)
+		ValueAndDerivatives Result;
+		double GradQ[3];
+		for (int i = 0; i < 3; ++i)
+			GradQ[i] = q0*Grad0[i] + qw*GradW[i];
+		Result.Value = exp(-0.5*q);
+		for (int i = 0; i < 3; ++i)
+		{
+			Result.Gradient[i] = -0.5*Result.Value*GradQ[i];
+			for (int j = 0; j <= i; ++j)
+			{
+				const double HessQ = q00*Grad0[i]*Grad0[j] + q0w*(Grad0[i]*GradW[j] + GradW[i]*Grad0[j])
+					+ qww*GradW[i]*GradW[j] + q0*Hess0(i,j) + qw*HessW(i,j);
+				Result.Hessian(i,j) = Result.Value*(0.25*GradQ[i]*GradQ[j] - 0.5*HessQ);
+			}
+		}
+		return Result;
 	}
 
 }}
-	
@@ -0,0 +1,286 @@
+#include "../include/gausstubearray.h"
+#include "../include/gausstube.h"
+#include "../../inc/track.h"
+#include "../../util/inc/helixrep.h"
+#include "../../util/inc/matrix.h"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+namespace vertex_lcfi { namespace ZVTOP
+{
+	const double GaussTubeArray::_IndexMargin = 50.0; //5 cm
+	const int GaussTubeArray::_IndexCells = 64;
+
+	void GaussTubeArray::addTube(Track* Track, GaussTube* Tube)
+	{
+		if (_CutSigmas > 0.0)
+			this->buildIndex(0.0);
+		if (fabs(Track->charge())<0.000001)
+		{
+			_NeutralTubes.push_back(Tube);
+			return;
+		}
+		const TrackPath & Path = Tube->path();
+		const HelixRep & H = Path.helixRep();
+		_CentreX.push_back(Path.centreX());
+		_CentreY.push_back(Path.centreY());
+		_Radius.push_back(fabs(1.0/H.invR()));
+		_SecLambda.push_back(sqrt(1.0+H.tanLambda()*H.tanLambda()));
+
+		//Position covariance is not propagated, so the same all along the track
+		const SymMatrix2x2 & InvCov = Tube->inverseCovariance();
+		_InvCov00.push_back(InvCov(0,0));
+		_InvCov01.push_back(InvCov(0,1));
+		_InvCov11.push_back(InvCov(1,1));
+		_ChargedTubes.push_back(Tube);
+		_Envelope.push_back(std::numeric_limits<double>::infinity());
+	}
+
+	void GaussTubeArray::buildIndex(double CutSigmas)
+	{
+		_CutSigmas = 0.0;
+		_GridCells = 0;
+		_CellStart.clear();
+		_CellTubes.clear();
+		std::fill(_Envelope.begin(), _Envelope.end(), std::numeric_limits<double>::infinity());
+		const size_t NumTubes = _ChargedTubes.size();
+		if (!(CutSigmas > 0.0) || NumTubes == 0)
+			return;
+		_CutSigmas = CutSigmas;
+
+		//The residual vector r has r.V^-1.r >= smallest eigenvalue * |r|^2, and |r| is at least the XY residual
+		double MinX = std::numeric_limits<double>::max();
+		double MinY = MinX;
+		double MaxX = -MinX;
+		double MaxY = -MinX;
+		for (size_t t = 0; t < NumTubes; ++t)
+		{
+			const double a = _InvCov00[t];
+			const double b = _InvCov01[t];
+			const double c = _InvCov11[t];
+			const double Smallest = 0.5*(a+c) - sqrt(0.25*(a-c)*(a-c) + b*b);
+			if (Smallest > 0.0)
+				_Envelope[t] = CutSigmas/sqrt(Smallest);
+			const HelixRep & H = _ChargedTubes[t]->path().helixRep();
+			const double RefX = -H.d0()*sin(H.phi());
+			const double RefY = H.d0()*cos(H.phi());
+			MinX = std::min(MinX, RefX);
+			MaxX = std::max(MaxX, RefX);
+			MinY = std::min(MinY, RefY);
+			MaxY = std::max(MaxY, RefY);
+		}
+		const int N = _IndexCells;
+		_GridX0 = MinX - _IndexMargin;
+		_GridY0 = MinY - _IndexMargin;
+		_CellSize = (std::max(MaxX-MinX, MaxY-MinY) + 2.0*_IndexMargin)/N;
+
+		//Cells each tube's envelope (an annulus) overlaps, row by row. Cells wholly inside the hole of the
+		//annulus are left out. Widened a little so that rounding can only add cells.
+		std::vector<std::pair<unsigned,unsigned> > Entries;
+		const double Slack = 1e-6*_CellSize;
+		for (size_t t = 0; t < NumTubes; ++t)
+		{
+#ifdef WIN32
+			if (!_finite(_Envelope[t]))
+#else
+			if (!std::isfinite(_Envelope[t]))
+#endif
+			{
+				for (int Cell = 0; Cell < N*N; ++Cell)
+					Entries.push_back(std::make_pair(unsigned(Cell), unsigned(t)));
+				continue;
+			}
+			const double cx = _CentreX[t];
+			const double cy = _CentreY[t];
+			const double Outer = _Radius[t] + _Envelope[t] + Slack;
+			const double Inner = _Radius[t] - _Envelope[t] - Slack;
+			for (int iy = 0; iy < N; ++iy)
+			{
+				const double ya = _GridY0 + iy*_CellSize;
+				const double yb = ya + _CellSize;
+				const double NearY = (cy < ya) ? ya-cy : ((cy > yb) ? cy-yb : 0.0);
+				const double FarY = std::max(fabs(ya-cy), fabs(yb-cy));
+				if (NearY > Outer)
+					continue;
+				const double OuterHalf = sqrt(Outer*Outer - NearY*NearY);
+				const double Low = std::max(0.0, floor((cx-OuterHalf-_GridX0)/_CellSize));
+				const double High = std::min(double(N-1), floor((cx+OuterHalf-_GridX0)/_CellSize));
+				const double InnerHalf = (Inner > FarY) ? sqrt(Inner*Inner - FarY*FarY) : 0.0;
+				for (int ix = int(Low); ix <= int(High) && Low <= High; ++ix)
+				{
+					const double xa = _GridX0 + ix*_CellSize;
+					if (xa > cx-InnerHalf && xa+_CellSize < cx+InnerHalf)
+						continue;
+					Entries.push_back(std::make_pair(unsigned(iy*N+ix), unsigned(t)));
+				}
+			}
+		}
+
+		//Into one list ordered by cell, keeping the tube order within each
+		_CellStart.assign(N*N+1, 0);
+		for (std::vector<std::pair<unsigned,unsigned> >::const_iterator iEntry = Entries.begin();iEntry != Entries.end();++iEntry)
+			++_CellStart[iEntry->first+1];
+		for (int Cell = 0; Cell < N*N; ++Cell)
+			_CellStart[Cell+1] += _CellStart[Cell];
+		_CellTubes.resize(Entries.size());
+		std::vector<unsigned> Next(_CellStart.begin(), _CellStart.end()-1);
+		for (std::vector<std::pair<unsigned,unsigned> >::const_iterator iEntry = Entries.begin();iEntry != Entries.end();++iEntry)
+			_CellTubes[Next[iEntry->first]++] = iEntry->second;
+		_GridCells = N;
+	}
+
+	double GaussTubeArray::maxNeglected() const
+	{
+		if (!(_CutSigmas > 0.0))
+			return 0.0;
+		return _ChargedTubes.size()*exp(-0.5*_CutSigmas*_CutSigmas);
+	}
+
+	int GaussTubeArray::_cellOf(double X, double Y) const
+	{
+		if (_GridCells == 0)
+			return -1;
+		const double CellX = (X-_GridX0)/_CellSize;
+		const double CellY = (Y-_GridY0)/_CellSize;
+		if (!(CellX >= 0.0 && CellX < _GridCells && CellY >= 0.0 && CellY < _GridCells))
+			return -1;
+		return int(CellY)*_GridCells + int(CellX);
+	}
+
+	bool GaussTubeArray::_isCut(size_t t, double X, double Y) const
+	{
+		const double dx = X-_CentreX[t];
+		const double dy = Y-_CentreY[t];
+		return fabs(sqrt(dx*dx+dy*dy) - _Radius[t]) > _Envelope[t];
+	}
+
+	void GaussTubeArray::sumsAt(const Vector3* Points, size_t NumPoints, double* Sum, double* SumOfSquares) const
+	{
+		const size_t NumTubes = _ChargedTubes.size();
+		for (size_t BlockStart = 0; BlockStart < NumPoints; BlockStart += _BlockSize)
+		{
+			const size_t m = (NumPoints-BlockStart < _BlockSize) ? NumPoints-BlockStart : _BlockSize;
+			double px[_BlockSize], py[_BlockSize], pz[_BlockSize];
+			double sum[_BlockSize], sumSq[_BlockSize];
+			for (size_t k = 0; k < m; ++k)
+			{
+				px[k] = Points[BlockStart+k].x();
+				py[k] = Points[BlockStart+k].y();
+				pz[k] = Points[BlockStart+k].z();
+				sum[k] = 0;
+				sumSq[k] = 0;
+			}
+
+			//Distinct cells of the block, each point refers to one (or -1 if off the grid). The cell lists
+			//are in tube order so one cursor each steps through them alongside the tube loop.
+			int PointCell[_BlockSize];
+			int Cells[_BlockSize];
+			unsigned Cursor[_BlockSize];
+			size_t NumCells = 0;
+			for (size_t k = 0; k < m; ++k)
+			{
+				const int Cell = this->_cellOf(px[k], py[k]);
+				PointCell[k] = -1;
+				if (Cell < 0) continue;
+				size_t j = 0;
+				while (j < NumCells && Cells[j] != Cell) ++j;
+				if (j == NumCells)
+				{
+					Cells[j] = Cell;
+					Cursor[j] = _CellStart[Cell];
+					++NumCells;
+				}
+				PointCell[k] = int(j);
+			}
+
+			for (size_t t = 0; t < NumTubes; ++t)
+			{
+				//Points whose cell doesn't list this tube are skipped
+				bool InCell[_BlockSize];
+				for (size_t j = 0; j < NumCells; ++j)
+				{
+					InCell[j] = (Cursor[j] < _CellStart[Cells[j]+1] && _CellTubes[Cursor[j]] == t);
+					if (InCell[j]) ++Cursor[j];
+				}
+				bool skip[_BlockSize];
+				bool anyPoint = false;
+				for (size_t k = 0; k < m; ++k)
+				{
+					skip[k] = (PointCell[k] >= 0 && !InCell[PointCell[k]]);
+					anyPoint = anyPoint || !skip[k];
+				}
+				if (!anyPoint) continue;
+
+				//XY residual, and the points that pass the cut for the 3D POCA
+				double res0[_BlockSize];
+				double ax[_BlockSize], ay[_BlockSize], az[_BlockSize];
+				double s[_BlockSize], dist2[_BlockSize];
+				size_t ActiveIndex[_BlockSize];
+				size_t NumActive = 0;
+				for (size_t k = 0; k < m; ++k)
+				{
+					if (skip[k]) continue;
+					double dx = px[k]-_CentreX[t];
+					double dy = py[k]-_CentreY[t];
+					res0[k] = fabs(sqrt(dx*dx+dy*dy) - _Radius[t]);
+					if (res0[k] > _Envelope[t])
+						continue;
+					ax[NumActive] = px[k];
+					ay[NumActive] = py[k];
+					az[NumActive] = pz[k];
+					ActiveIndex[NumActive] = k;
+					++NumActive;
+				}
+				_ChargedTubes[t]->path().pcasTo(ax, ay, az, NumActive, s, dist2);
+
+				//Tube value from the residuals, as GaussTube::valueAt
+				for (size_t a = 0; a < NumActive; ++a)
+				{
+					const size_t k = ActiveIndex[a];
+					double res1 = 0;
+					if (dist2[a] > res0[k]*res0[k])
+						res1 = sqrt(dist2[a] - res0[k]*res0[k])*_SecLambda[t];
+					double value = exp(-0.5*(res0[k]*res0[k]*_InvCov00[t] + 2.0*res0[k]*res1*_InvCov01[t] + res1*res1*_InvCov11[t]));
+					sum[k] += value;
+					sumSq[k] += value*value;
+				}
+			}
+
+			for (std::vector<GaussTube*>::const_iterator iTube = _NeutralTubes.begin();iTube != _NeutralTubes.end();++iTube)
+			{
+				for (size_t k = 0; k < m; ++k)
+				{
+					double value = (*iTube)->valueAt(Points[BlockStart+k]);
+					sum[k] += value;
+					sumSq[k] += value*value;
+				}
+			}
+
+			for (size_t k = 0; k < m; ++k)
+			{
+				Sum[BlockStart+k] = sum[k];
+				SumOfSquares[BlockStart+k] = sumSq[k];
+			}
+		}
+	}
+
+	void GaussTubeArray::derivativesAt(const Vector3 & Point, ValueAndDerivatives & Sum, ValueAndDerivatives & SumOfSquares) const
+	{
+		Sum = ValueAndDerivatives();
+		SumOfSquares = ValueAndDerivatives();
+		//Tubes of the cell of the point, or all of them off the grid
+		const int Cell = this->_cellOf(Point.x(), Point.y());
+		const size_t First = (Cell < 0) ? 0 : _CellStart[Cell];
+		const size_t Last = (Cell < 0) ? _ChargedTubes.size() : _CellStart[Cell+1];
+		for (size_t i = First; i < Last; ++i)
+		{
+			const size_t t = (Cell < 0) ? i : _CellTubes[i];
+			if (this->_isCut(t, Point.x(), Point.y()))
+				continue;
+			addToSums(_ChargedTubes[t]->derivativesAt(Point), 1.0, Sum, SumOfSquares);
+		}
+		for (std::vector<GaussTube*>::const_iterator iTube = _NeutralTubes.begin();iTube != _NeutralTubes.end();++iTube)
+			addToSums((*iTube)->derivativesAt(Point), 1.0, Sum, SumOfSquares);
+	}
+}}
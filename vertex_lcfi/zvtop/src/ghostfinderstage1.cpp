@@ -18,7 +18,7 @@ namespace vertex_lcfi { namespace ZVTOP
 	{
 	}
 	
-  Track* GhostFinderStage1::findGhost(double InitialWidth, double MaxChi2Allowed, const Vector3 & JetDir, const std::vector<Track*> & /*JetTracks*/, InteractionPoint* /*IP*/)
+  Track* GhostFinderStage1::findGhost(double InitialWidth, double MaxChi2Allowed, const Vector3 & JetDir, const std::vector<Track*> & JetTracks, InteractionPoint* /*IP*/)
 	{
 		//TODO Upgrade to movable IP (requires more clever ghost creation)
 		//TODO confirm precision is that required from paper
@@ -34,6 +34,12 @@ namespace vertex_lcfi { namespace ZVTOP
 		//}
 		//_JetDir = _JetDir.unit();
 		_JetDir=JetDir.unit();
+		_JetTracks.clear();
+		if (_FitToJetTracks)
+		{
+			for( std::vector<Track*>::const_iterator iTrack=JetTracks.begin(); iTrack != JetTracks.end(); ++iTrack)
+				_JetTracks.push_back((*iTrack)->makeState());
+		}
 		//Now convert the Seed direction to phi theta for seed track - LC-DET-2006-004
 		double SeedTheta = acos(_JetDir.z());
 		double SeedPhi = acos(_JetDir.x()/sin(SeedTheta));
@@ -52,19 +58,22 @@ namespace vertex_lcfi { namespace ZVTOP
 		_UseChiEquation=1;
 		//and we must fill the L=0 chi values for stage 1 chi squared formula
 		this->_fillLZeroChis();
+		//The parts of the ghost fits that don't depend on the ghost are taken once
+		_Engine.setTracks(_JetTracks);
+		_FitAngles.clear();
 		
 		//Create a minimiser				//init step//decplaces
 		FunctionMinimiser<GhostFinderStage1> minimiser( this, 0.04, 4 );
+		//The analytic gradient is only used for the fits to the jet tracks, without them the steps
+		//on finite differences and the ghost directions they give are kept
+		minimiser.useGradient() = _FitToJetTracks;
 			
 		//Minimise track direction nb this uses the valueAt function of this class.
 		std::vector<double> CurrentAngles = minimiser.Minimise(SeedAngles);
 		//std::cout << "MiniPhi, MinTheta:  " << CurrentAngles[0] << " " << CurrentAngles[1] << std::endl;
 		
-		//Make a GT for the resizing
-		Track CurrentGT = _makeGhost(CurrentAngles, _CurrentWidth);
-		TrackState GhostTS = TrackState(&CurrentGT);
 		//Resize width of Ghost to make it consistant with jet tracks with L>0
-		_CurrentWidth = _findAdjustedWidth(&GhostTS,_CurrentWidth,_JetTracks,MaxChi2Allowed);
+		_CurrentWidth = _findAdjustedWidth(CurrentAngles,_CurrentWidth,MaxChi2Allowed);
 		//Restore the width if it became smaller than what we started with
 		if (_CurrentWidth < InitialWidth) _CurrentWidth = InitialWidth;
 		//std::cout << "W: " << _CurrentWidth*10000 << std::endl;
@@ -77,18 +86,13 @@ namespace vertex_lcfi { namespace ZVTOP
 		//std::cout << "MiniPhi, MinTheta:  " << CurrentAngles[0] << " " << CurrentAngles[1] << std::endl;
 		
 		//Resize again to make consistant with Jet tracks with L>0
-		//Make a GT for the resizing
-		CurrentGT = _makeGhost(CurrentAngles, _CurrentWidth);
-		GhostTS = TrackState(&CurrentGT);
-		//Resize width of Ghost to make it consistant with jet tracks with L>0
-		_CurrentWidth = _findAdjustedWidth(&GhostTS,_CurrentWidth,_JetTracks,MaxChi2Allowed);
+		_CurrentWidth = _findAdjustedWidth(CurrentAngles,_CurrentWidth,MaxChi2Allowed);
 		//Restore the width if it became smaller than what we started with
 		if (_CurrentWidth < InitialWidth) _CurrentWidth = InitialWidth;
 		//std::cout << "W: " << _CurrentWidth*10000 << std::endl;
 		
 		//We're done
-		Track* ResultGhost = new Track();
-		MemoryManager<Track>::Event()->registerObject(ResultGhost);
+		Track* ResultGhost = MemoryManager<Track>::Event()->create();
 		*ResultGhost = _makeGhost(CurrentAngles, _CurrentWidth);
 		
 		//outfile << CurrentAngles[0] <<" " << CurrentAngles[1] << std::endl;
@@ -99,39 +103,24 @@ namespace vertex_lcfi { namespace ZVTOP
 	double GhostFinderStage1::valueAt(std::vector<double> CurrentAngles)
 	{
 		//We're working out the value of the Chi Squared at a perticular Ghost Track angle 
-		//We make a ghost track with that angle and make a fit with each of the JetTracks in turn
+		//We fit the ghost at that angle with each of the JetTracks in turn
 		//working out L and adding the chi squareds as in the formula of stage one or two according to the value of L
-		Track CurrentGT = _makeGhost(CurrentAngles, _CurrentWidth);
-		TrackState GhostTS = TrackState(&CurrentGT);
+		const std::vector<GhostFitEngine::Fit> & Fits = this->_fitsAt(CurrentAngles, _CurrentWidth);
 		
 		double TotalChiSq = 0.0;
 		//Loop over jet Tracks
-		for (std::vector<TrackState*>::iterator iJetTrack = _JetTracks.begin();iJetTrack < _JetTracks.end();++iJetTrack)
+		for (size_t i = 0;i < Fits.size();++i)
 		{
-			//Make a fit
-			std::vector<TrackState*> TrackStates;
-			TrackStates.clear();
-			GhostTS.resetToRef();
-			TrackStates.push_back(&GhostTS);
-			TrackStates.push_back(*iJetTrack);
-			
-			Vector3 VertexPos;
-			double ChiOfFit;
-			_Fitter.fitVertex(TrackStates,0,VertexPos,ChiOfFit);			
-			//Reset GT to ref, use GT orgin and momentum to calculate L
-			GhostTS.resetToRef();
-			//nb ghost was reset to ref so is at IP
-			double L = (VertexPos.subtract(GhostTS.position())).dot(CurrentGT.momentum());
 			double ChiContribution;
-			if (L >= 0.0)
+			if (Fits[i].L >= 0.0)
 			{
-				ChiContribution = ChiOfFit;
+				ChiContribution = Fits[i].ChiSquared;
 			}
 			else
 			{
 				//Depending whether we are at stage 1 or 2 modify chi squared
 				if (_UseChiEquation == 1)
-					ChiContribution = _ChiToLZero[(*iJetTrack)] - ChiOfFit;
+					ChiContribution = _ChiToLZero[i] - Fits[i].ChiSquared;
 				else
 					ChiContribution = 0.0;
 			}
@@ -141,7 +130,8 @@ namespace vertex_lcfi { namespace ZVTOP
 		
 		//Jet Core Weighting
 		//TODO Experimental and unverified to be helpful
-		double ajet = (CurrentGT.momentum().unit()).dot(_JetDir);
+		Vector3 GhostDirection(cos(CurrentAngles[0])*sin(CurrentAngles[1]),sin(CurrentAngles[0])*sin(CurrentAngles[1]),cos(CurrentAngles[1]));
+		double ajet = (GhostDirection.unit()).dot(_JetDir);
 		if (ajet >= 1.0) ajet = 1.0; 
 		ajet = acos(ajet);
 		ajet = pow(fabs(ajet-0.02),0.8);
@@ -150,6 +140,53 @@ namespace vertex_lcfi { namespace ZVTOP
 		
 	}
 
+	void GhostFinderStage1::gradientAt(const std::vector<double> & CurrentAngles, std::vector<double> & Gradient)
+	{
+		//Same terms as valueAt, differentiated with respect to phi and theta of the ghost
+		const std::vector<GhostFitEngine::Fit> & Fits = this->_fitsAt(CurrentAngles, _CurrentWidth);
+		const double Phi = CurrentAngles[0];
+		const double Theta = CurrentAngles[1];
+		const Vector3 Direction = Vector3(cos(Phi)*sin(Theta),sin(Phi)*sin(Theta),cos(Theta)).unit();
+		const Vector3 DirectionByPhi(-sin(Phi)*sin(Theta),cos(Phi)*sin(Theta),0.0);
+		const Vector3 DirectionByTheta(cos(Phi)*cos(Theta),sin(Phi)*cos(Theta),-sin(Theta));
+		Gradient.assign(2,0.0);
+		
+		//Loop over jet Tracks
+		for (size_t i = 0;i < Fits.size();++i)
+		{
+			//Sign of the fit chi squared in the contribution, the L=0 chi is fixed
+			double Sign;
+			if (Fits[i].L >= 0.0)
+				Sign = 1.0;
+			else
+				Sign = (_UseChiEquation == 1) ? -1.0 : 0.0;
+			Gradient[0] += Sign*Fits[i].ChiSquaredByAngle[0];
+			Gradient[1] += Sign*Fits[i].ChiSquaredByAngle[1];
+		}
+		
+		//Jet Core Weighting, pow((|a-0.02|^0.8)/0.3,2) with a the angle to the jet
+		double CosAngle = Direction.dot(_JetDir);
+		if (CosAngle >= 1.0) CosAngle = 1.0; 
+		double Angle = acos(CosAngle);
+		double Offset = Angle-0.02;
+		double ByAngle = 0.0;
+		if (Offset != 0.0)
+			ByAngle = (Offset > 0.0 ? 1.6 : -1.6)*pow(fabs(Offset),0.6)/(0.3*0.3);
+		double SinAngle = sin(Angle);
+		if (SinAngle > 1e-9)
+		{
+			Gradient[0] -= ByAngle*DirectionByPhi.dot(_JetDir)/SinAngle;
+			Gradient[1] -= ByAngle*DirectionByTheta.dot(_JetDir)/SinAngle;
+		}
+		else
+		{
+			//The angle has no gradient on the jet axis, take its rate of increase moving off
+			//the axis in each angle, as the forward differences would
+			Gradient[0] += ByAngle*fabs(sin(Theta));
+			Gradient[1] += ByAngle;
+		}
+	}
+
 	double GhostFinderStage1::_tanLambda(double theta)
 	{
 		return tan((3.141592654/2.0)-theta);
@@ -160,7 +197,7 @@ namespace vertex_lcfi { namespace ZVTOP
 	void GhostFinderStage1::_fillLZeroChis()
 	{
 		//We're working out the chi squared of a fit of ghost and jet track if constrained with L=0
-		//We put them in a map for the valueAt() function so it doesn't have to work it out again and again
+		//We keep them for the valueAt() function so it doesn't have to work it out again and again
 		_ChiToLZero.clear();	
 		for( std::vector<TrackState*>::const_iterator iTrack=_JetTracks.begin(); iTrack != _JetTracks.end(); ++iTrack)
 		{
@@ -178,8 +215,7 @@ namespace vertex_lcfi { namespace ZVTOP
 			double ChiOfFit;
 			_Fitter.fitVertex(TrackStates,&IP,VertexPos,ChiOfFit);			
 			
-			//Insert into map of values
-			_ChiToLZero.insert( std::pair<TrackState*,double>( (*iTrack),(2*((*iTrack)->chi2(VertexPos)+IP.chi2(VertexPos))) ) );
+			_ChiToLZero.push_back(2*((*iTrack)->chi2(VertexPos)+IP.chi2(VertexPos)));
 		}
 	}
 	
@@ -203,36 +239,36 @@ namespace vertex_lcfi { namespace ZVTOP
 		return Track(0,H,mom,0.0,V,std::vector<int>());
 	}
 	
-	double GhostFinderStage1::_findAdjustedWidth(TrackState* GhostTrack,double CurrentWidth, std::vector<TrackState*> & JetTracks, double MaxChi2Allowed)
+	const std::vector<GhostFitEngine::Fit> & GhostFinderStage1::_fitsAt(const std::vector<double> & Angles, double Width)
+	{
+		if (Angles != _FitAngles || Width != _FitWidth)
+		{
+			_Engine.fitAll(Angles, Width, _Fits);
+			_FitAngles = Angles;
+			_FitWidth = Width;
+		}
+		return _Fits;
+	}
+	
+	double GhostFinderStage1::_findAdjustedWidth(const std::vector<double> & Angles, double CurrentWidth, double MaxChi2Allowed)
 	{
 		//Find out what width ghost makes the tracks with L>0 have no chi squared bigger than MaxAllowed
 		
-		if (!JetTracks.empty())
+		if (!_JetTracks.empty())
 		{
 			//Find track with biggest chi squared for tracks with L > 0
+			//Usually the fits of the last step of the minimiser
+			const std::vector<GhostFitEngine::Fit> & Fits = this->_fitsAt(Angles, CurrentWidth);
 			double MaxChiOfFit = -1;
-			TrackState* HiChiTrack = 0;
-			Vector3 HiChiVertexPos;
-			for (std::vector<TrackState*>::iterator iJetTrack = JetTracks.begin();iJetTrack < JetTracks.end();++iJetTrack)
+			const GhostFitEngine::Fit* HiChiFit = 0;
+			for (std::vector<GhostFitEngine::Fit>::const_iterator iFit = Fits.begin();iFit != Fits.end();++iFit)
 			{
-				//Make a fit
-				std::vector<TrackState*> TrackStates;
-				TrackStates.clear();
-				TrackStates.push_back(GhostTrack);
-				TrackStates.push_back(*iJetTrack);
-				
-				Vector3 VertexPos;
-				double ChiOfFit;
-				_Fitter.fitVertex(TrackStates,0,VertexPos,ChiOfFit);
-				GhostTrack->resetToRef();
-				double L = (VertexPos.subtract(GhostTrack->position())).dot(GhostTrack->parentTrack()->momentum());
-				if (L>0)
+				if (iFit->L>0)
 				{
-					if (ChiOfFit > MaxChiOfFit)
+					if (iFit->ChiSquared > MaxChiOfFit)
 					{
-						MaxChiOfFit = ChiOfFit;
-						HiChiTrack = (*iJetTrack);
-						HiChiVertexPos = VertexPos;
+						MaxChiOfFit = iFit->ChiSquared;
+						HiChiFit = &(*iFit);
 					}
 				}		
 			}
@@ -240,11 +276,10 @@ namespace vertex_lcfi { namespace ZVTOP
 			//We found the track that gives the largest chi squared vertex so we now adjust width to make it MaxChiAllowed
 			//The ghost is then consistant with all the tracks to that chi
 			//TODO Reference to maths for this
-			if(HiChiTrack)
+			if(HiChiFit)
 			{		
-				HiChiTrack->swimToStateNearest(HiChiVertexPos);
-				GhostTrack->swimToStateNearest(HiChiVertexPos);
-				double trackdist2 = GhostTrack->position().distanceTo2(HiChiTrack->position());
+				//Ghost and track are nearest the vertex where they are nearest each other
+				double trackdist2 = HiChiFit->Separation2;
 				double trackErr2 = (trackdist2/MaxChiOfFit) - (CurrentWidth*CurrentWidth);
 				if((trackdist2-(MaxChi2Allowed*trackErr2)) < 0.0 )
 					return CurrentWidth;
@@ -0,0 +1,142 @@
+#include "../include/ghostfitengine.h"
+
+#include "../../inc/trackstate.h"
+#include "../../inc/track.h"
+#include "../../util/inc/helixrep.h"
+#include "../../util/inc/matrix.h"
+#include "../../util/inc/threadpool.h"
+#include <cmath>
+
+namespace vertex_lcfi { namespace ZVTOP
+{
+	namespace
+	{
+		//Chi squared of a point at Offset from a straight track, with xy direction (Cos,Sin)
+		//Residuals as TrackState::chi2, across the track in xy and along z at the xy closest approach
+		inline double lineChi2(const Vector3 & Offset, double Cos, double Sin, double TanLambda, double Inverse00, double Inverse01, double Inverse11)
+		{
+			const double XY = fabs(Cos*Offset.y()-Sin*Offset.x());
+			const double Z = fabs(Offset.z()-TanLambda*(Cos*Offset.x()+Sin*Offset.y()));
+			return Inverse00*XY*XY + 2.0*Inverse01*XY*Z + Inverse11*Z*Z;
+		}
+
+		//Change of lineChi2 to first order in the changes (by d) of its arguments, the track's
+		//Inverse00 and Inverse01 are fixed
+		inline double lineChi2Change(const Vector3 & Offset, const Vector3 & dOffset, double Cos, double dCos, double Sin, double dSin, double TanLambda, double dTanLambda, double Inverse00, double Inverse01, double Inverse11, double dInverse11)
+		{
+			const double XY = Cos*Offset.y()-Sin*Offset.x();
+			const double dXY = dCos*Offset.y()+Cos*dOffset.y()-dSin*Offset.x()-Sin*dOffset.x();
+			const double Along = Cos*Offset.x()+Sin*Offset.y();
+			const double Z = Offset.z()-TanLambda*Along;
+			const double dZ = dOffset.z()-dTanLambda*Along-TanLambda*(dCos*Offset.x()+Cos*dOffset.x()+dSin*Offset.y()+Sin*dOffset.y());
+			//The cross term takes the absolute residuals
+			const double Sign = ((XY < 0.0) != (Z < 0.0)) ? -1.0 : 1.0;
+			return 2.0*Inverse00*XY*dXY + 2.0*Inverse01*Sign*(dXY*Z+XY*dZ) + dInverse11*Z*Z + 2.0*Inverse11*Z*dZ;
+		}
+	}
+
+	void GhostFitEngine::setTracks(const std::vector<TrackState*> & Tracks)
+	{
+		_Tracks.clear();
+		_Tracks.reserve(Tracks.size());
+		for (std::vector<TrackState*>::const_iterator iTrack = Tracks.begin();iTrack != Tracks.end();++iTrack)
+		{
+			const SymMatrix2x2 & Inverse = (*iTrack)->inversePositionCovarMatrix();
+			TrackTerms Terms;
+			Terms.Path = (*iTrack)->path();
+			Terms.Inverse00 = Inverse(0,0);
+			Terms.Inverse01 = Inverse(0,1);
+			Terms.Inverse11 = Inverse(1,1);
+			_Tracks.push_back(Terms);
+		}
+	}
+
+	void GhostFitEngine::fitAll(const std::vector<double> & Angles, double Width, std::vector<Fit> & Fits) const
+	{
+		//The ghost as made by GhostFinderStage1, through the origin with d0 error Width and
+		//z0 error Width/cos(lambda)
+		GhostTerms Ghost;
+		Ghost.SinPhi = sin(Angles[0]);
+		Ghost.CosPhi = cos(Angles[0]);
+		Ghost.TanLambda = tan((3.141592654/2.0)-Angles[1]);
+		Ghost.Direction = Vector3(Ghost.CosPhi*sin(Angles[1]),Ghost.SinPhi*sin(Angles[1]),cos(Angles[1]));
+		Ghost.DirectionByAngle[0] = Vector3(-Ghost.SinPhi*sin(Angles[1]),Ghost.CosPhi*sin(Angles[1]),0.0);
+		Ghost.DirectionByAngle[1] = Vector3(Ghost.CosPhi*cos(Angles[1]),Ghost.SinPhi*cos(Angles[1]),-sin(Angles[1]));
+		Ghost.Inverse00 = 1.0/(Width*Width);
+		Ghost.Inverse11 = 1.0/(Width*Width*(1.0+Ghost.TanLambda*Ghost.TanLambda));
+
+		Fits.resize(_Tracks.size());
+		if (_NumberOfThreads > 1 && _Tracks.size() > 1)
+		{
+			util::ThreadPool::instance()->parallelFor(_Tracks.size(), _NumberOfThreads, [&](size_t Task, size_t)
+			{
+				Fits[Task] = this->_fit(_Tracks[Task], Ghost);
+			});
+		}
+		else
+		{
+			for (size_t i = 0;i < _Tracks.size();++i)
+				Fits[i] = this->_fit(_Tracks[i], Ghost);
+		}
+	}
+
+	GhostFitEngine::Fit GhostFitEngine::_fit(const TrackTerms & Track, const GhostTerms & Ghost) const
+	{
+		const Vector3 & G = Ghost.Direction;
+		//Closest approach of the track to the ghost line, which passes through the origin
+		Vector3 T,T1,T2;
+		Track.Path.positionAt(Track.Path.pcaToLine(Vector3(0,0,0), G), T, T1, T2);
+		
+		const Vector3 GhostPoint = G.mult(T.dot(G));
+		const Vector3 Join = T.subtract(GhostPoint);
+		//The xy part of T1 is the unit xy direction of the track
+		const double ChiTrack = lineChi2(Join, T1.x(), T1.y(), Track.Path.helixRep().tanLambda(), Track.Inverse00, Track.Inverse01, Track.Inverse11);
+		Fit Result;
+		Result.Separation2 = Join.mag2();
+		const bool Separated = (Result.Separation2 > (0.0001/1000.0)*(0.0001/1000.0));
+		const double ChiGhost = Separated ? lineChi2(Join, Ghost.CosPhi, Ghost.SinPhi, Ghost.TanLambda, Ghost.Inverse00, 0.0, Ghost.Inverse11) : 0.0;
+		if (Separated)
+		{
+			//As the two prong seed of VertexFitterLSM the vertex divides the join in the ratio of the
+			//squared errors of ghost and track along it, each found from its chi squared of the join
+			const double Fraction = ChiTrack/(ChiGhost+ChiTrack);
+			Result.Position = GhostPoint.add(Join.mult(Fraction));
+			//Fraction^2*ChiGhost + (1-Fraction)^2*ChiTrack
+			Result.ChiSquared = ChiGhost*ChiTrack/(ChiGhost+ChiTrack);
+		}
+		else
+		{
+			Result.Position = GhostPoint;
+			Result.ChiSquared = ChiTrack;
+		}
+		//The ghost starts at the origin
+		Result.L = Result.Position.dot(G);
+		
+		//As the ghost turns the closest approach moves along the track by dS, found from Join.T1 = 0
+		//staying true, and the join, the track direction there and the ghost errors change with it
+		const double GhostT = G.dot(T);
+		const Vector3 AcrossT1 = T1.subtract(G.mult(G.dot(T1)));
+		const double JoinT1BySwim = AcrossT1.mag2()+Join.dot(T2);
+		for (short a = 0;a < 2;++a)
+		{
+			const Vector3 & GBy = Ghost.DirectionByAngle[a];
+			const double dS = (JoinT1BySwim > 0.0) ? (GhostT*GBy.dot(T1)+GBy.dot(T)*G.dot(T1))/JoinT1BySwim : 0.0;
+			const Vector3 dJoin = AcrossT1.mult(dS).subtract(GBy.mult(GhostT)).subtract(G.mult(GBy.dot(T)));
+			const double dChiTrack = lineChi2Change(Join, dJoin, T1.x(), T2.x()*dS, T1.y(), T2.y()*dS, Track.Path.helixRep().tanLambda(), 0.0, Track.Inverse00, Track.Inverse01, Track.Inverse11, 0.0);
+			if (Separated)
+			{
+				//Phi turns the xy direction of the ghost, theta its tan lambda and so its z0 error
+				const double dCos = (a == 0) ? -Ghost.SinPhi : 0.0;
+				const double dSin = (a == 0) ? Ghost.CosPhi : 0.0;
+				const double dTanLambda = (a == 1) ? -(1.0+Ghost.TanLambda*Ghost.TanLambda) : 0.0;
+				const double dInverse11 = (a == 1) ? 2.0*Ghost.TanLambda*Ghost.Inverse11 : 0.0;
+				const double dChiGhost = lineChi2Change(Join, dJoin, Ghost.CosPhi, dCos, Ghost.SinPhi, dSin, Ghost.TanLambda, dTanLambda, Ghost.Inverse00, 0.0, Ghost.Inverse11, dInverse11);
+				const double Sum = ChiGhost+ChiTrack;
+				Result.ChiSquaredByAngle[a] = (ChiTrack*ChiTrack*dChiGhost+ChiGhost*ChiGhost*dChiTrack)/(Sum*Sum);
+			}
+			else
+				Result.ChiSquaredByAngle[a] = dChiTrack;
+		}
+		return Result;
+	}
+}}
@@ -39,7 +39,7 @@ namespace vertex_lcfi { namespace ZVTOP
 		//std::cout << "Err: " << _InvErrorMatrix<< std::endl;
 		//std::cout << "Err: " << this->inverseErrorMatrix()<< std::endl;
 		//std::cout << "Chi2: " << prec_inner_prod(trans(Residual),prec_prod(this->inverseErrorMatrix(), Residual))<< std::endl<< std::endl;
-		return prec_inner_prod(trans(Residual),prec_prod(this->inverseErrorMatrix(), Residual));
+		return quadraticForm3(this->inverseErrorMatrix(), Residual);
 	}
 }}
 
@@ -0,0 +1,84 @@
+#include "../include/strategyprovider.h"
+
+#include "../include/vertexfitter.h"
+#include "../include/vertexresolver.h"
+#include "../include/vertexfuncmaxfinder.h"
+
+namespace vertex_lcfi { namespace ZVTOP
+{
+	namespace
+	{
+		//Ids start at 1, so an unused cache entry (0) matches no provider
+		std::atomic<unsigned long> NextProviderId(1);
+
+		//Number of providers each thread remembers the set of
+		const unsigned CacheSize = 4;
+	}
+
+	struct ThreadStrategyProvider::Set
+	{
+		std::unique_ptr<VertexFitter> Fitter;
+		std::unique_ptr<VertexResolver> Resolver;
+		std::unique_ptr<VertexFuncMaxFinder> MaxFinder;
+		Set* Next;
+	};
+
+	ThreadStrategyProvider::ThreadStrategyProvider(FitterMaker MakeFitter, ResolverMaker MakeResolver, MaxFinderMaker MakeMaxFinder)
+	: _MakeFitter(MakeFitter),_MakeResolver(MakeResolver),_MakeMaxFinder(MakeMaxFinder),_Id(NextProviderId++)
+	{
+	}
+
+	ThreadStrategyProvider::~ThreadStrategyProvider()
+	{
+		Set* Next = _Sets.load();
+		while (Next)
+		{
+			Set* ToDelete = Next;
+			Next = Next->Next;
+			delete ToDelete;
+		}
+	}
+
+	VertexFitter* ThreadStrategyProvider::fitter()
+	{
+		return _MakeFitter ? this->_setOfThisThread()->Fitter.get() : 0;
+	}
+
+	VertexResolver* ThreadStrategyProvider::resolver()
+	{
+		return _MakeResolver ? this->_setOfThisThread()->Resolver.get() : 0;
+	}
+
+	VertexFuncMaxFinder* ThreadStrategyProvider::maxFinder()
+	{
+		return _MakeMaxFinder ? this->_setOfThisThread()->MaxFinder.get() : 0;
+	}
+
+	ThreadStrategyProvider::Set* ThreadStrategyProvider::_setOfThisThread()
+	{
+		struct CacheEntry
+		{
+			unsigned long Id;
+			Set* Mine;
+		};
+		static thread_local CacheEntry Cache[CacheSize] = {};
+		static thread_local unsigned NextEntry = 0;
+		for (unsigned i = 0;i < CacheSize;++i)
+			if (Cache[i].Id == _Id)
+				return Cache[i].Mine;
+
+		Set* Mine = new Set;
+		if (_MakeFitter) Mine->Fitter.reset(_MakeFitter());
+		if (_MakeResolver) Mine->Resolver.reset(_MakeResolver());
+		if (_MakeMaxFinder) Mine->MaxFinder.reset(_MakeMaxFinder());
+		//Push onto the list of sets, only the destructor reads it
+		Mine->Next = _Sets.load(std::memory_order_relaxed);
+		while (!_Sets.compare_exchange_weak(Mine->Next, Mine, std::memory_order_release, std::memory_order_relaxed))
+			;
+		++_NumSets;
+		Cache[NextEntry].Id = _Id;
+		Cache[NextEntry].Mine = Mine;
+		NextEntry = (NextEntry+1) % CacheSize;
+		return Mine;
+	}
+}}
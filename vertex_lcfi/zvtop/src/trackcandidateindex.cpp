@@ -0,0 +1,107 @@
+#include "../include/trackcandidateindex.h"
+#include "../include/candidatevertex.h"
+#include "../../inc/trackstate.h"
+
+#include <algorithm>
+
+namespace vertex_lcfi { namespace ZVTOP
+{
+	const size_t TrackCandidateIndex::NotFound;
+
+	TrackCandidateIndex::TrackCandidateIndex(const std::vector<Track*> & Tracks)
+	: _Tracks(Tracks), _CandidatesOfTrack(Tracks.size())
+	{
+		//A track given twice is known by its first id
+		for (size_t i = 0;i < _Tracks.size();++i)
+			_TrackIds.insert(std::make_pair(_Tracks[i], i));
+	}
+
+	size_t TrackCandidateIndex::addCandidate(CandidateVertex* Candidate)
+	{
+		const size_t Id = _Candidates.size();
+		_Candidates.push_back(Candidate);
+		_TracksOfCandidate.push_back(std::vector<size_t>());
+		_CandidateIds[Candidate] = Id;
+		this->_linkAll(Id);
+		return Id;
+	}
+
+	void TrackCandidateIndex::removeCandidate(size_t Candidate)
+	{
+		if (!this->hasCandidate(Candidate)) return;
+		this->_unlinkAll(Candidate);
+		_CandidateIds.erase(_Candidates[Candidate]);
+		_Candidates[Candidate] = 0;
+	}
+
+	void TrackCandidateIndex::update(size_t Candidate)
+	{
+		if (!this->hasCandidate(Candidate)) return;
+		this->_unlinkAll(Candidate);
+		this->_linkAll(Candidate);
+	}
+
+	bool TrackCandidateIndex::removeTrack(size_t Candidate, size_t Track)
+	{
+		if (!_Candidates[Candidate]->removeTrack(_Tracks[Track]))
+			return 0;
+		//Read the tracks back in case the candidate held the track twice
+		this->update(Candidate);
+		return 1;
+	}
+
+	void TrackCandidateIndex::merge(size_t Into, size_t From)
+	{
+		_Candidates[Into]->mergeCandidateVertex(_Candidates[From]);
+		//Into now has the tracks of both
+		const std::vector<size_t> & FromTracks = _TracksOfCandidate[From];
+		for (std::vector<size_t>::const_iterator iTrack = FromTracks.begin();iTrack != FromTracks.end();++iTrack)
+			this->_link(Into, *iTrack);
+		this->removeCandidate(From);
+	}
+
+	size_t TrackCandidateIndex::candidateId(const CandidateVertex* Candidate) const
+	{
+		std::unordered_map<const CandidateVertex*,size_t>::const_iterator iFound = _CandidateIds.find(Candidate);
+		return (iFound == _CandidateIds.end()) ? NotFound : iFound->second;
+	}
+
+	size_t TrackCandidateIndex::trackId(const Track* Track) const
+	{
+		std::unordered_map<const vertex_lcfi::Track*,size_t>::const_iterator iFound = _TrackIds.find(Track);
+		return (iFound == _TrackIds.end()) ? NotFound : iFound->second;
+	}
+
+	void TrackCandidateIndex::_link(size_t Candidate, size_t Track)
+	{
+		std::vector<size_t> & Tracks = _TracksOfCandidate[Candidate];
+		std::vector<size_t>::iterator iTrack = std::lower_bound(Tracks.begin(), Tracks.end(), Track);
+		if (iTrack != Tracks.end() && *iTrack == Track)
+			return;
+		Tracks.insert(iTrack, Track);
+		std::vector<size_t> & Candidates = _CandidatesOfTrack[Track];
+		Candidates.insert(std::lower_bound(Candidates.begin(), Candidates.end(), Candidate), Candidate);
+	}
+
+	void TrackCandidateIndex::_unlinkAll(size_t Candidate)
+	{
+		std::vector<size_t> & Tracks = _TracksOfCandidate[Candidate];
+		for (std::vector<size_t>::const_iterator iTrack = Tracks.begin();iTrack != Tracks.end();++iTrack)
+		{
+			std::vector<size_t> & Candidates = _CandidatesOfTrack[*iTrack];
+			Candidates.erase(std::lower_bound(Candidates.begin(), Candidates.end(), Candidate));
+		}
+		Tracks.clear();
+	}
+
+	void TrackCandidateIndex::_linkAll(size_t Candidate)
+	{
+		const std::vector<TrackState*> & States = _Candidates[Candidate]->trackStateList();
+		for (std::vector<TrackState*>::const_iterator iState = States.begin();iState != States.end();++iState)
+		{
+			const size_t Track = this->trackId((*iState)->parentTrack());
+			if (Track != NotFound)
+				this->_link(Candidate, Track);
+		}
+	}
+}}
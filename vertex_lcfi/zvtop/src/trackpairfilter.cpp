@@ -0,0 +1,103 @@
+#include "../include/trackpairfilter.h"
+#include "../../inc/track.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace vertex_lcfi { namespace ZVTOP
+{
+	TrackPairFilter::TrackPairFilter(const std::vector<Track*> & Tracks, double MaxSigmas)
+	: _MaxSigmas(MaxSigmas)
+	{
+		for (std::vector<Track*>::const_iterator iTrack = Tracks.begin();iTrack != Tracks.end();++iTrack)
+		{
+			const Track* MyTrack = *iTrack;
+			const HelixRep & H = MyTrack->helixRep();
+			Circle C;
+			C.Charged = (H.invR() != 0.0);
+			C.InvR = H.invR();
+			C.Phi = H.phi();
+			C.Z0 = H.z0();
+			C.TanLambda = H.tanLambda();
+			C.D0Variance = MyTrack->covarianceMatrix()(0,0);
+			C.Z0Variance = MyTrack->covarianceMatrix()(3,3);
+			if (C.Charged)
+			{
+				//Same parametrisation as TrackState
+				const double SinPhi = sin(H.phi());
+				const double CosPhi = cos(H.phi());
+				C.CentreX = -H.d0()*SinPhi + SinPhi/H.invR();
+				C.CentreY = H.d0()*CosPhi - CosPhi/H.invR();
+				C.Radius = fabs(1.0/H.invR());
+			}
+			else
+			{
+				C.CentreX = C.CentreY = C.Radius = 0.0;
+			}
+			_Circles.push_back(C);
+		}
+	}
+
+	bool TrackPairFilter::mayVertex(size_t i, size_t j) const
+	{
+		if (!(_MaxSigmas > 0.0)) return true;
+		const Circle & A = _Circles[i];
+		const Circle & B = _Circles[j];
+		if (!A.Charged || !B.Charged) return true;
+
+		const double DX = B.CentreX - A.CentreX;
+		const double DY = B.CentreY - A.CentreY;
+		const double D = sqrt(DX*DX + DY*DY);
+		const double XYVariance = A.D0Variance + B.D0Variance;
+
+		//Circles apart or one inside the other, the gap is the closest the tracks get in XY
+		double Gap = 0.0;
+		if (D > A.Radius + B.Radius)
+			Gap = D - (A.Radius + B.Radius);
+		else if (D < fabs(A.Radius - B.Radius))
+			Gap = fabs(A.Radius - B.Radius) - D;
+		if (Gap > 0.0)
+			return Gap*Gap <= _MaxSigmas*_MaxSigmas*XYVariance;
+		//Concentric, shouldn't happen for real tracks
+		if (D == 0.0) return true;
+
+		//Crossing points
+		const double Along = (A.Radius*A.Radius - B.Radius*B.Radius + D*D)/(2.0*D);
+		const double Across = sqrt(std::max(0.0, A.Radius*A.Radius - Along*Along));
+		const double MidX = A.CentreX + Along*DX/D;
+		const double MidY = A.CentreY + Along*DY/D;
+		const double Distance = std::min(_tangentDistance(A, B, MidX - Across*DY/D, MidY + Across*DX/D),
+		                                 _tangentDistance(A, B, MidX + Across*DY/D, MidY - Across*DX/D));
+		const double Variance = XYVariance + A.Z0Variance + B.Z0Variance;
+		return Distance*Distance <= _MaxSigmas*_MaxSigmas*Variance;
+	}
+
+	double TrackPairFilter::_tangentDistance(const Circle & A, const Circle & B, double X, double Y) const
+	{
+		//Arc length (in XY) of each track at the crossing, giving the height and direction there
+		const double PsiA = atan2(-A.InvR*(X - A.CentreX), A.InvR*(Y - A.CentreY));
+		const double PsiB = atan2(-B.InvR*(X - B.CentreX), B.InvR*(Y - B.CentreY));
+		const double SA = std::remainder(A.Phi - PsiA, 6.283185307179586)/A.InvR;
+		const double SB = std::remainder(B.Phi - PsiB, 6.283185307179586)/B.InvR;
+		double DZ = (B.Z0 + SB*B.TanLambda) - (A.Z0 + SA*A.TanLambda);
+		//Either track may cross on another turn, which the fit could find, so take the nearest
+		const double PitchA = fabs(6.283185307179586*A.TanLambda/A.InvR);
+		const double PitchB = fabs(6.283185307179586*B.TanLambda/B.InvR);
+		if (PitchA > 0.0) DZ = std::min(fabs(DZ), fabs(std::remainder(DZ, PitchA)));
+		if (PitchB > 0.0) DZ = std::min(fabs(DZ), fabs(std::remainder(DZ, PitchB)));
+
+		//Distance of two lines through (X,Y,ZA) and (X,Y,ZB) with directions U and V
+		const double UX = cos(PsiA), UY = sin(PsiA), UZ = A.TanLambda;
+		const double VX = cos(PsiB), VY = sin(PsiB), VZ = B.TanLambda;
+		const double NX = UY*VZ - UZ*VY;
+		const double NY = UZ*VX - UX*VZ;
+		const double NZ = UX*VY - UY*VX;
+		const double N2 = NX*NX + NY*NY + NZ*NZ;
+		const double U2 = UX*UX + UY*UY + UZ*UZ;
+		//Separation is (0,0,DZ)
+		if (N2 > 1e-12*U2*(VX*VX + VY*VY + VZ*VZ))
+			return fabs(DZ*NZ)/sqrt(N2);
+		//Parallel, distance from one line to a point on the other
+		return fabs(DZ)*sqrt((UX*UX + UY*UY)/U2);
+	}
+}}
@@ -5,10 +5,17 @@
 #include "../include/interactionpoint.h"
 #include "../include/vertexfunction.h"
 #include "../include/vertexfunctionclassic.h"
+#include "../include/trackpairfilter.h"
+#include "../include/trackcandidateindex.h"
 #include "../../inc/trackstate.h"
+#include "../include/strategyprovider.h"
+#include "../include/vertexfitterlsm.h"
+#include "../include/vertexfuncmaxfinderclassicstepper.h"
 #include "../../util/inc/memorymanager.h"
+#include "../../util/inc/threadpool.h"
 #include <vector>
 #include <list>
+#include <memory>
 #include <ctime>
 namespace vertex_lcfi { namespace ZVTOP
 {
@@ -112,8 +119,9 @@ std::list<CandidateVertex*> VertexFinderClassic::findVertices()
 	using std::cout;using std::endl;clock_t start,pstart;int debug=0;
 	//Make vertex function
 	/*////////////////////////////////////////////////////////DEBUGLINE*/if (debug) {cout << "Constructing Vertex Function....."; cout.flush();pstart=clock();}start=clock();
-	_VF = new VertexFunctionClassic(_TrackList,_IP,_Kip,_Kalpha,_JetAxis);
-	MemoryManager<VertexFunctionClassic>::Event()->registerObject(dynamic_cast<VertexFunctionClassic*>(_VF));
+	VertexFunctionClassic* VF = new VertexFunctionClassic(_TrackList,_IP,_Kip,_Kalpha,_JetAxis,_TubeCutSigmas);
+	MemoryManager<VertexFunctionClassic>::Event()->registerObject(VF);
+	_VF = VF;
 	/*////////////////////////////////////////////////////////DEBUGLINE*/if (debug) {cout << "\tdone!\t\t\t" << ((double)clock()-(double)pstart)*1000.0/CLOCKS_PER_SEC << "ms" << endl; cout.flush();}
 	//Make two prong candidates, discarding if above chi squared cut, remembering to assign vertex function
 	//std::cout << "1";
@@ -130,37 +138,61 @@ std::list<CandidateVertex*> VertexFinderClassic::findVertices()
 		TrackState* Track = (*iTrack)->makeState(); 
 		TrackStates.push_back(Track);
 	}
+	//Pairs worth fitting, those clearly apart are dropped before making a vertex
+	TrackPairFilter PairFilter(_TrackList, _PairCutSigmas);
+	std::vector<std::pair<int,int> > Pairs;
 	for (int OuterIndex=0;OuterIndex < N-1;++OuterIndex)
 	{
 		for (int InnerIndex=OuterIndex+1;InnerIndex < N;++InnerIndex)
+		{
+			if (PairFilter.mayVertex(OuterIndex,InnerIndex))
+				Pairs.push_back(std::make_pair(OuterIndex,InnerIndex));
+		}
+	}
+	_NumPairsTried = N*(N-1)/2;
+	_NumPairsCut = _NumPairsTried - Pairs.size();
+	//Two prongs passing the chi squared cut, and thier fitted positions
+	std::vector<CandidateVertex*> ChiPassed;
+	std::vector<Vector3> ChiPassedPositions;
+	if (_NumberOfThreads > 1)
+		_makeTwoProngsParallel(Pairs, ChiPassed, ChiPassedPositions);
+	else
+	for (std::vector<std::pair<int,int> >::const_iterator iPair = Pairs.begin();iPair != Pairs.end();++iPair)
+	{
+		std::vector<TrackState*> Tracks;
+		Tracks.push_back(TrackStates[iPair->first]);
+		Tracks.push_back(TrackStates[iPair->second]);
+		
+		CandidateVertex* CV = MemoryManager<CandidateVertex>::Event()->create(Tracks,_VF);
+		CV->strategies() = _Strategies;
+		CV->incrementalFit() = _IncrementalFit;
+		//If we keep this one as chi squared lower than cut we add it to our lists
+		if (CV->maxChiSquaredOfTrackIP() <= _TwoProngCut)
+		{
+			ChiPassed.push_back(CV);
+			ChiPassedPositions.push_back(CV->position());
+		}
+		else
+		{
+			/*////////////////////////////////////////////////////////DEBUGLINE*/if (debug<0) std::cout << "-";
+		}
+	}
+	//Cut on V(r) at the fitted positions, evaluated as one batch
+	{
+		std::vector<double> ChiPassedValues;
+		_VF->valuesAt(ChiPassedPositions, ChiPassedValues);
+		for (size_t i = 0; i < ChiPassed.size(); ++i)
+		{
+			if (ChiPassedValues[i]>0.001)
 			{
-				std::vector<TrackState*> Tracks;
-				Tracks.push_back(TrackStates[OuterIndex]);
-				Tracks.push_back(TrackStates[InnerIndex]);
-				
-				CandidateVertex* CV = new CandidateVertex(Tracks,_VF);
-				MemoryManager<CandidateVertex>::Event()->registerObject(CV);
-				//If we keep this one as chi squared lower than cut we add it to our lists
-				//TODO cut on V(r) from FORTRAN, keep?
-				/*ofstream case2file ("chi2track.txt", ofstream::out | ofstream::app);
-					if (case2file.is_open())
-					{
-						Track1->swimToStateNearest(Track2);
-						Track2->swimToStateNearest(Track1->position());
-						case2file << Track1->position().distanceTo(Track2->position()) << " " << CV->chiSquaredOfFit() << std::endl;
-					}*/
-				if (CV->maxChiSquaredOfTrackIP() <= _TwoProngCut && CV->vertexFuncValue()>0.001)
-				{
-					CVList.push_back(CV);
-					/*////////////////////////////////////////////////////////DEBUGLINE*/if (debug<0) std::cout << "2-prong of:" << TrackStates[OuterIndex]->parentTrack()->trackingNum() << "," << TrackStates[InnerIndex]->parentTrack()->trackingNum() << " @ " << CV->position() << std::endl;
-				}
-				else
-				{
-					/*////////////////////////////////////////////////////////DEBUGLINE*/if (debug<0) std::cout << "-";
-				}
-				//cout << OuterIndex << ":" << InnerIndex <<" ";
-				//cout.flush();
+				CVList.push_back(ChiPassed[i]);
+				/*////////////////////////////////////////////////////////DEBUGLINE*/if (debug<0) std::cout << "2-prong of:" << ChiPassed[i]->trackStateList()[0]->parentTrack()->trackingNum() << "," << ChiPassed[i]->trackStateList()[1]->parentTrack()->trackingNum() << " @ " << ChiPassed[i]->position() << std::endl;
+			}
+			else
+			{
+				/*////////////////////////////////////////////////////////DEBUGLINE*/if (debug<0) std::cout << "-";
 			}
+		}
 	}
 	//cout  << endl;
 	//Now we make the ones that contain an IP if we have an IP
@@ -175,8 +207,9 @@ std::list<CandidateVertex*> VertexFinderClassic::findVertices()
 				std::vector<TrackState*> Tracks;
 				Tracks.push_back(TrackStates[Index]);
 				
-				CandidateVertex* CV = new CandidateVertex(Tracks,_IP,_VF);
-				MemoryManager<CandidateVertex>::Event()->registerObject(CV);
+				CandidateVertex* CV = MemoryManager<CandidateVertex>::Event()->create(Tracks,_IP,_VF);
+				CV->strategies() = _Strategies;
+				CV->incrementalFit() = _IncrementalFit;
 				/*ofstream case2file ("chiip.txt", ofstream::out | ofstream::app);
 					if (case2file.is_open())
 					{
@@ -212,6 +245,9 @@ std::list<CandidateVertex*> VertexFinderClassic::findVertices()
 	//if (CVList.empty()) return CVList;
 	
 	/*////////////////////////////////////////////////////////DEBUGLINE*/if (debug) {cout << "Find V(r) max....."; cout.flush();pstart=clock();}
+	if (_NumberOfThreads > 1)
+		_findVertexFuncMaxParallel(CVList);
+	else
 	for (std::list<CandidateVertex*>::iterator iCV = CVList.begin();iCV != CVList.end();++iCV)
 		{
 			(*iCV)->findVertexFuncMax();
@@ -219,6 +255,10 @@ std::list<CandidateVertex*> VertexFinderClassic::findVertices()
 	/*////////////////////////////////////////////////////////DEBUGLINE*/if (debug) {cout << "\t\t\tdone!" << " "<< CVList.size() << " Vertices" << "\t" << ((double(clock())-double(pstart))/CLOCKS_PER_SEC)*1000 << "ms" <<endl; cout.flush();}
 	/*////////////////////////////////////////////////////////DEBUGLINE*///if (debug>1) {for (std::list<CandidateVertex*>::iterator iCV = CVList.begin();iCV != CVList.end();++iCV) cout << **iCV <<endl;}
 	/*////////////////////////////////////////////////////////DEBUGLINE*/if (debug) {cout << "Track removal based on clustering....."; cout.flush();pstart=clock();}
+	//The CV's holding each track, kept up to date from here on
+	TrackCandidateIndex Index(_TrackList);
+	for (std::list<CandidateVertex*>::iterator iCV = CVList.begin();iCV != CVList.end();++iCV)
+		Index.addCandidate(*iCV);
 	//We now make sure the track k is only associated with the CV with highest
 	//V(r) at fitted position (not nearest maxima) in any unresolved set currently associated with the track
 	std::vector<CandidateVertex*> RemoveFrom;
@@ -226,11 +266,12 @@ std::list<CandidateVertex*> VertexFinderClassic::findVertices()
 	//Loop over tracks
 	for (std::vector<Track*>::iterator iTrack = _TrackList.begin();iTrack != _TrackList.end();++iTrack)
 	{
-		//Get a list of the CV's associated with this Track
+		//Get a list of the CV's associated with this Track, in the order of CVList as ids are
 		std::list<CandidateVertex*> AssocCVs;
-		for (std::list<CandidateVertex*>::iterator iCV = CVList.begin();iCV != CVList.end();++iCV)
+		const std::vector<size_t> & Holding = Index.candidatesOf(Index.trackId(*iTrack));
+		for (std::vector<size_t>::const_iterator iCV = Holding.begin();iCV != Holding.end();++iCV)
 		{
-			if ((*iCV)->hasTrack(*iTrack)) AssocCVs.push_back(*iCV);
+			AssocCVs.push_back(Index.candidate(*iCV));
 		}
 		if (AssocCVs.empty())
 		{
@@ -280,7 +321,7 @@ std::list<CandidateVertex*> VertexFinderClassic::findVertices()
 	std::vector<Track*>::iterator iTrack = TrackToRemove.begin();
 	for (std::vector<CandidateVertex*>::iterator iCV = RemoveFrom.begin();iCV != RemoveFrom.end();++iCV)
 	{
-		(*iCV)->removeTrack(*iTrack);
+		Index.removeTrack(Index.candidateId(*iCV), Index.trackId(*iTrack));
 		++iTrack;
 	}
 	//std::cout << "3";
@@ -317,6 +358,7 @@ std::list<CandidateVertex*> VertexFinderClassic::findVertices()
 		for (std::vector<CandidateVertex*>::iterator iCVertex=removed.begin();iCVertex != removed.end();++iCVertex)
 			{
 				CVList.remove(*iCVertex);
+				Index.removeCandidate(Index.candidateId(*iCVertex));
 			}
 	}
 	/*////////////////////////////////////////////////////////DEBUGLINE*/if (debug) {cout << "done!" << " "<< CVList.size() << " Vertices" << "\t" << ((double(clock())-double(pstart))/CLOCKS_PER_SEC)*1000 << "ms" << endl; cout.flush();}
@@ -331,67 +373,51 @@ std::list<CandidateVertex*> VertexFinderClassic::findVertices()
 	//Get lists of CV's that are unresolved. then merge.
 	if (!CVList.empty())
 	{
-		std::list<std::list<CandidateVertex*> > ClusterLists;
-		do
+		//The clusters are the connected parts of the graph of unresolved pairs. Each is seeded
+		//with its highest V(r)max vertex and grown breadth first taking the others in V(r)max
+		//order, so the vertices merge in the same order as growing the clusters from the list.
+		std::vector<CandidateVertex*> CVs(CVList.begin(), CVList.end());
+		std::vector<std::vector<size_t> > Unresolved;
+		_findUnresolvedPairs(CVs, Unresolved);
+		std::vector<std::vector<size_t> > Clusters;
+		std::vector<bool> InCluster(CVs.size(), false);
+		for (size_t Seed = 0;Seed < CVs.size();++Seed)
 		{
-			//Get the CV with highest v(r) as seed for a cluster
-			CandidateVertex* Seed = *CVList.begin();
-			//Remove it from the CV list
-			CVList.erase(CVList.begin());
-			//Add it to its cluster
-			std::list<CandidateVertex*> Cluster;
-			Cluster.push_back(Seed);
-			int added = 0;
-			do 
+			if (InCluster[Seed]) continue;
+			std::vector<size_t> Cluster(1, Seed);
+			InCluster[Seed] = true;
+			for (size_t Member = 0;Member < Cluster.size();++Member)
 			{
-				//Iterate over cluster
-				added = 0;
-				std::list<CandidateVertex*>::iterator iCVertex;
-				for (iCVertex=Cluster.begin();iCVertex != Cluster.end();++iCVertex)
+				const std::vector<size_t> & Neighbours = Unresolved[Cluster[Member]];
+				for (std::vector<size_t>::const_iterator iNeighbour = Neighbours.begin();iNeighbour != Neighbours.end();++iNeighbour)
 				{
-					//Iterate over the remaining CV's
-					std::list<CandidateVertex*>::iterator iVertex;
-					for (iVertex=CVList.begin();iVertex != CVList.end();++iVertex)
+					if (!InCluster[*iNeighbour])
 					{
-						//If not resolved
-						if (!(*iCVertex)->isResolvedFrom(*iVertex,_ResolverCutOff, CandidateVertex::NearestMaximum))
-						{
-							//Add to this Cluster
-							Cluster.push_back(*iVertex);
-							++added;
-						}
+						InCluster[*iNeighbour] = true;
+						Cluster.push_back(*iNeighbour);
 					}
-					//Remove from the CVList
-					for (std::list<CandidateVertex*>::iterator iCVertex2=Cluster.begin();iCVertex2 != Cluster.end();++iCVertex2)
-					{
-						CVList.remove(*iCVertex2);
-					}
-							
 				}
-				//Keep looping over the cluster till none added
-			} while (added > 0);
-			//Add the cluster the cluster list
-			ClusterLists.push_back(Cluster);
+			}
+			Clusters.push_back(Cluster);
 		}
-		while (!CVList.empty());
 		/*////////////////////////////////////////////////////////DEBUGLINE*/if (debug) {cout << "\tdone!" <<  "\t\t\t" << ((double(clock())-double(pstart))/CLOCKS_PER_SEC)*1000 << "ms" << endl; cout.flush();}
-		/*////////////////////////////////////////////////////////DEBUGLINE*/if (debug>1) {for (std::list<CandidateVertex*>::iterator iCV = CVList.begin();iCV != CVList.end();++iCV) cout << **iCV <<endl;}
 		/*////////////////////////////////////////////////////////DEBUGLINE*/if (debug) {cout << "Merging....."; cout.flush();pstart=clock();}
 		//We now have nice lists of clusters, so we can merge away
-		std::list<std::list<CandidateVertex*> >::iterator iList;
-		for (iList=ClusterLists.begin();iList != ClusterLists.end();++iList)
+		CVList.clear();
+		for (std::vector<std::vector<size_t> >::const_iterator iCluster = Clusters.begin();iCluster != Clusters.end();++iCluster)
 		{
-			std::list<CandidateVertex*>::iterator iVertex;
-			for (iVertex=(++((*iList).begin()));iVertex != (*iList).end(); ++iVertex)
+			CandidateVertex* Merged = CVs[iCluster->front()];
+			for (std::vector<size_t>::const_iterator iMember = iCluster->begin()+1;iMember != iCluster->end();++iMember)
 			{
-				(*((*iList).begin()))->mergeCandidateVertex(*iVertex);
+				Index.merge(Index.candidateId(Merged), Index.candidateId(CVs[*iMember]));
 			}
 			//Add the resulting merged CV back to the master list
-			CVList.push_back(*((*iList).begin()));
+			CVList.push_back(Merged);
 		}
 	}
 	
-	_ifNoIPAddIP(&CVList);
+	if (CandidateVertex* Added = _ifNoIPAddIP(&CVList))
+		Index.addCandidate(Added);
 	
 	/*////////////////////////////////////////////////////////DEBUGLINE*/if (debug) {cout << "\t\t\t\tdone!" << " "<< CVList.size() << " Vertices" << "\t" << ((double(clock())-double(pstart))/CLOCKS_PER_SEC)*1000 << "ms" << endl; cout.flush();}
 	/*////////////////////////////////////////////////////////DEBUGLINE*/if (debug>1) {for (std::list<CandidateVertex*>::iterator iCV = CVList.begin();iCV != CVList.end();++iCV) cout << **iCV <<endl;}
@@ -405,40 +431,78 @@ std::list<CandidateVertex*> VertexFinderClassic::findVertices()
 	//Chi square track cutting
 	for (std::list<CandidateVertex*>::iterator iVertex=CVList.begin();iVertex != CVList.end();++iVertex)
 	{
-		(*iVertex)->trimByChi2(_TrackTrimCut);
+		if ((*iVertex)->trimByChi2(_TrackTrimCut))
+			Index.update(Index.candidateId(*iVertex));
 	}
 	/*////////////////////////////////////////////////////////DEBUGLINE*/if (debug) {cout << "\t\tdone!" << " "<< CVList.size() << " Vertices" << "\t" << ((double(clock())-double(pstart))/CLOCKS_PER_SEC)*1000 << "ms" << endl; cout.flush();}
 	
 	/*////////////////////////////////////////////////////////DEBUGLINE*/if (debug) {cout << "Discard <2 Track Vertices....."; cout.flush();}pstart=clock();
 	//Discard <2 track CV's
-	_removeOneTrackNoIPVertices(&CVList);
+	{
+		std::vector<CandidateVertex*> removed = _removeOneTrackNoIPVertices(&CVList);
+		for (std::vector<CandidateVertex*>::iterator iCVertex=removed.begin();iCVertex != removed.end();++iCVertex)
+			Index.removeCandidate(Index.candidateId(*iCVertex));
+	}
 	/*////////////////////////////////////////////////////////DEBUGLINE*/if (debug) {cout << "\t\tdone!" << " "<< CVList.size() << " Vertices" << "\t" << ((double(clock())-double(pstart))/CLOCKS_PER_SEC)*1000 << "ms" << endl; cout.flush();}
 	/*////////////////////////////////////////////////////////DEBUGLINE*/if (debug>1) {for (std::list<CandidateVertex*>::iterator iCV = CVList.begin();iCV != CVList.end();++iCV) cout << **iCV <<endl;}
 	/*////////////////////////////////////////////////////////DEBUGLINE*/if (debug) {cout << "Claim tracks by V(r)....."; cout.flush();pstart=clock();}
 	//Decending order of V(r) claim tracks from lower to ensure each track only in one vertex.
-	std::list<CandidateVertex*> LosingList;
-	std::list<CandidateVertex*> LeftToDo;
-	for (std::list<CandidateVertex*>::iterator iCVertex=CVList.begin();iCVertex != CVList.end();++iCVertex)
+	//The losers of a claim are the later CV's holding the claimed tracks (or all later ones
+	//if the claimer has the IP), only those can drop to 1 track with no IP and be removed.
+	std::vector<CandidateVertex*> ClaimOrder(CVList.begin(), CVList.end());
+	std::vector<size_t> Rank(Index.numCandidates(), ClaimOrder.size());
+	for (size_t i = 0;i < ClaimOrder.size();++i)
+		Rank[Index.candidateId(ClaimOrder[i])] = i;
+	for (size_t i = 0;i < ClaimOrder.size();++i)
 	{
-		LosingList.push_back(*iCVertex);
-		LeftToDo.push_back(*iCVertex);	
-	}
-	while (!LeftToDo.empty()) 
-	{
-		//Remove the one thats claiming (the higest one) from the losing list
-		LosingList.erase(LosingList.begin());
-		//Claim from the others
-		(*LeftToDo.begin())->claimTracksFrom(LosingList);
-		LeftToDo.erase(LeftToDo.begin());
+		CandidateVertex* Claimer = ClaimOrder[i];
+		//Removed by an earlier claim
+		if (Index.candidateId(Claimer) == TrackCandidateIndex::NotFound)
+			continue;
+		std::vector<size_t> Losers;
+		//Only one IP so if we have it they can't
+		if (Claimer->interactionPoint())
+		{
+			for (size_t j = i+1;j < ClaimOrder.size();++j)
+			{
+				const size_t Loser = Index.candidateId(ClaimOrder[j]);
+				if (Loser != TrackCandidateIndex::NotFound && ClaimOrder[j]->removeIP())
+					Losers.push_back(Loser);
+			}
+		}
+		//Find the claimed tracks first, as removing them changes the lists of the index
+		std::vector<std::pair<size_t,size_t> > Claimed;
+		for (std::vector<TrackState*>::const_iterator iTrackState = Claimer->trackStateList().begin();iTrackState != Claimer->trackStateList().end();++iTrackState)
+		{
+			const size_t Track = Index.trackId((*iTrackState)->parentTrack());
+			if (Track == TrackCandidateIndex::NotFound) continue;
+			const std::vector<size_t> & Holding = Index.candidatesOf(Track);
+			for (std::vector<size_t>::const_iterator iCV = Holding.begin();iCV != Holding.end();++iCV)
+			{
+				if (Rank[*iCV] > i && Rank[*iCV] < ClaimOrder.size())
+					Claimed.push_back(std::make_pair(*iCV, Track));
+			}
+		}
+		for (std::vector<std::pair<size_t,size_t> >::const_iterator iClaim = Claimed.begin();iClaim != Claimed.end();++iClaim)
+		{
+			Index.removeTrack(iClaim->first, iClaim->second);
+			Losers.push_back(iClaim->first);
+		}
 		//Remove CVs that are now just 1 track (with no IP) or no tracks
-		std::vector<CandidateVertex*> removed = _removeOneTrackNoIPVertices(&CVList);
-		//And remove them from the remaining losing vertices	
-		for (std::vector<CandidateVertex*>::iterator iCVertex=removed.begin();iCVertex != removed.end();++iCVertex)
+		for (std::vector<size_t>::const_iterator iLoser = Losers.begin();iLoser != Losers.end();++iLoser)
 		{
-			LosingList.remove(*iCVertex);
-			LeftToDo.remove(*iCVertex);
+			CandidateVertex* Loser = Index.candidate(*iLoser);
+			if (Loser && Loser->trackStateList().size() < 2 && !Loser->interactionPoint())
+				Index.removeCandidate(*iLoser);
 		}
-	} ;
+	}
+	//Keep the survivors in order
+	CVList.clear();
+	for (std::vector<CandidateVertex*>::const_iterator iCVertex = ClaimOrder.begin();iCVertex != ClaimOrder.end();++iCVertex)
+	{
+		if (Index.candidateId(*iCVertex) != TrackCandidateIndex::NotFound)
+			CVList.push_back(*iCVertex);
+	}
 
 	/*////////////////////////////////////////////////////////DEBUGLINE*/if (debug) {cout << "\t\tdone!" << " "<< CVList.size() << " Vertices" << "\t" << ((double(clock())-double(pstart))/CLOCKS_PER_SEC)*1000 << "ms" << endl; cout.flush();}
 	/*////////////////////////////////////////////////////////DEBUGLINE*/if (debug>1) {for (std::list<CandidateVertex*>::iterator iCV = CVList.begin();iCV != CVList.end();++iCV) cout << **iCV <<endl;}
@@ -448,6 +512,8 @@ std::list<CandidateVertex*> VertexFinderClassic::findVertices()
 	//std::cout << "7";
 	CVList.sort(IPDistAscending(_IP));
 	//Done
+	_NumVertexFuncValues = VF->numValues();
+	_NumVertexFuncDerivatives = VF->numDerivatives();
 	return CVList;
 }	
 	
@@ -473,18 +539,128 @@ std::vector<CandidateVertex*> VertexFinderClassic::_removeOneTrackNoIPVertices(s
 
 }
 
-void VertexFinderClassic::_ifNoIPAddIP(std::list<CandidateVertex*>* CVList)
+void VertexFinderClassic::_makeTwoProngsParallel(const std::vector<std::pair<int,int> > & Pairs, std::vector<CandidateVertex*> & ChiPassed, std::vector<Vector3> & ChiPassedPositions)
+{
+	//Fitting swims the trackstates and uses the fitter's working space, so each thread (slot)
+	//gets its own copies of both, unless the strategies give each thread a fitter. Objects are
+	//made in a context per slot and handed over to ours at the end. Swims don't depend on the
+	//state's history, so the fits are the same as with shared states and the result is
+	//independent of the number of threads.
+	const size_t NumSlots = _NumberOfThreads;
+	const bool SlotsNeedFitters = !(_Strategies && _Strategies->fitter());
+	std::vector<std::unique_ptr<EventContext> > SlotContexts(NumSlots);
+	std::vector<std::vector<TrackState*> > SlotTrackStates(NumSlots);
+	std::vector<VertexFitter*> SlotFitters(NumSlots, (VertexFitter*)0);
+	for (size_t Slot = 0; Slot < NumSlots; ++Slot)
+		SlotContexts[Slot].reset(new EventContext());
+	
+	std::vector<CandidateVertex*> Results(Pairs.size(), (CandidateVertex*)0);
+	util::ThreadPool::instance()->parallelFor(Pairs.size(), NumSlots, [&](size_t Task, size_t Slot)
+	{
+		EventContext::Scope InSlotContext(SlotContexts[Slot].get());
+		if (SlotTrackStates[Slot].empty())
+		{
+			for (std::vector<Track*>::iterator iTrack = _TrackList.begin();iTrack != _TrackList.end();++iTrack)
+				SlotTrackStates[Slot].push_back((*iTrack)->makeState());
+			if (SlotsNeedFitters)
+				SlotFitters[Slot] = MemoryManager<CandidateVertex::FallbackVertexFitter>::Event()->create();
+		}
+		std::vector<TrackState*> Tracks;
+		Tracks.push_back(SlotTrackStates[Slot][Pairs[Task].first]);
+		Tracks.push_back(SlotTrackStates[Slot][Pairs[Task].second]);
+		CandidateVertex* CV = MemoryManager<CandidateVertex>::Event()->create(Tracks,_VF,SlotFitters[Slot]);
+		CV->strategies() = _Strategies;
+		CV->incrementalFit() = _IncrementalFit;
+		if (CV->maxChiSquaredOfTrackIP() <= _TwoProngCut)
+			Results[Task] = CV;
+	});
+	
+	for (size_t Slot = 0; Slot < NumSlots; ++Slot)
+		EventContext::current()->takeObjectsFrom(*SlotContexts[Slot]);
+	//In pair order, as the serial loop
+	for (std::vector<CandidateVertex*>::iterator iCV = Results.begin();iCV != Results.end();++iCV)
+	{
+		if (*iCV)
+		{
+			ChiPassed.push_back(*iCV);
+			ChiPassedPositions.push_back((*iCV)->position());
+		}
+	}
+}
+
+void VertexFinderClassic::_findVertexFuncMaxParallel(const std::list<CandidateVertex*> & CVList)
+{
+	//The max finders keep their current position while stepping, so one per slot unless the
+	//strategies give each thread a max finder
+	std::vector<CandidateVertex*> CVs(CVList.begin(), CVList.end());
+	if (_Strategies && _Strategies->maxFinder())
+	{
+		util::ThreadPool::instance()->parallelFor(CVs.size(), _NumberOfThreads, [&](size_t Task, size_t)
+		{
+			CVs[Task]->findVertexFuncMax();
+		});
+		return;
+	}
+	std::vector<VertexFuncMaxFinder*> SlotMaxFinders;
+	for (int Slot = 0; Slot < _NumberOfThreads; ++Slot)
+		SlotMaxFinders.push_back(MemoryManager<CandidateVertex::FallbackVertexFuncMaxFinder>::Event()->create());
+	util::ThreadPool::instance()->parallelFor(CVs.size(), _NumberOfThreads, [&](size_t Task, size_t Slot)
+	{
+		CVs[Task]->findVertexFuncMax(SlotMaxFinders[Slot]);
+	});
+}
+
+void VertexFinderClassic::_findUnresolvedPairs(const std::vector<CandidateVertex*> & CVs, std::vector<std::vector<size_t> > & Unresolved)
+{
+	//Each pair is tried once, the vertex earlier in the list resolving itself from the later.
+	//Row i holds the later vertices unresolved from vertex i, so rows can be found in parallel.
+	//Each thread resolves with the resolver the strategies give it, or its own fallback.
+	const size_t NumCVs = CVs.size();
+	std::vector<std::vector<size_t> > Later(NumCVs);
+	auto FindRow = [&](size_t i)
+	{
+		for (size_t j = i+1;j < NumCVs;++j)
+			if (!CVs[i]->isResolvedFrom(CVs[j], _ResolverCutOff, CandidateVertex::NearestMaximum))
+				Later[i].push_back(j);
+	};
+	if (_NumberOfThreads > 1)
+	{
+		//The V(r) maxima of all the vertices were found above, so they are only read here
+		util::ThreadPool::instance()->parallelFor(NumCVs, _NumberOfThreads, [&](size_t Task, size_t)
+		{
+			FindRow(Task);
+		});
+	}
+	else
+		for (size_t i = 0;i < NumCVs;++i)
+			FindRow(i);
+	
+	//Both ways round, each list in increasing order as the earlier rows are done first
+	Unresolved.assign(NumCVs, std::vector<size_t>());
+	for (size_t i = 0;i < NumCVs;++i)
+	{
+		for (std::vector<size_t>::const_iterator j = Later[i].begin();j != Later[i].end();++j)
+		{
+			Unresolved[i].push_back(*j);
+			Unresolved[*j].push_back(i);
+		}
+	}
+}
+
+CandidateVertex* VertexFinderClassic::_ifNoIPAddIP(std::list<CandidateVertex*>* CVList)
 {
 	//Loop over CV's
 	for (std::list<CandidateVertex*>::iterator iVertex=CVList->begin();iVertex != CVList->end();++iVertex)
 	{
-		if ((*iVertex)->interactionPoint()) return;
+		if ((*iVertex)->interactionPoint()) return 0;
 	}
 	//None was found so add one!
 	std::vector<TrackState*> Tracks;
-	CandidateVertex* CV = new CandidateVertex(Tracks,_IP,_VF);
-	MemoryManager<CandidateVertex>::Event()->registerObject(CV);
+	CandidateVertex* CV = MemoryManager<CandidateVertex>::Event()->create(Tracks,_IP,_VF);
+	CV->strategies() = _Strategies;
+	CV->incrementalFit() = _IncrementalFit;
 	CVList->push_back(CV);
+	return CV;
 }
 
 }}
@@ -94,15 +94,18 @@ std::list<CandidateVertex*> VertexFinderGhost::findVertices()
         else
         {
             std::list<CandidateVertex*> ret;
-            CandidateVertex* CV = new CandidateVertex(std::vector<TrackState*>(),_IP,0);
-            MemoryManager<CandidateVertex>::Event()->registerObject(CV);
+            CandidateVertex* CV = MemoryManager<CandidateVertex>::Event()->create(std::vector<TrackState*>(),_IP,(VertexFunction*)0);
+            CV->strategies() = _Strategies;
             ret.push_back(CV);
             return ret;
         }
     }
 	/*////////////////////////////////////////////////////////DEBUGLINE*/if (debug) {cout << "Initial Ghost direction finding and resize...."; cout.flush();pstart=clock();start=clock();}
 	//First we find the ghost
-	Track* GhostTrack = GhostFinderStage1().findGhost(_InitialGhostWidth,_MaxChi2Allowed,_SeedDirection,_TrackList,_IP);
+	GhostFinderStage1 GhostFinder;
+	GhostFinder.numberOfThreads() = _NumberOfThreads;
+	GhostFinder.fitToJetTracks() = _FitGhostToTracks;
+	Track* GhostTrack = GhostFinder.findGhost(_InitialGhostWidth,_MaxChi2Allowed,_SeedDirection,_TrackList,_IP);
 	/*////////////////////////////////////////////////////////DEBUGLINE*/if (debug) {cout << "\tdone!\t\t\t" << ((double)clock()-(double)pstart)*1000.0/CLOCKS_PER_SEC << "ms" << endl; cout.flush();}
 	
 	//Make trackstates of the tracks
@@ -125,15 +128,15 @@ std::list<CandidateVertex*> VertexFinderGhost::findVertices()
 		std::vector<TrackState*> Tracks;
 		Tracks.push_back(*iTrack);
 		Tracks.push_back(GhostTrackState);
-		CandidateVertex* CV = new CandidateVertex(Tracks,(InteractionPoint*)0,0);
-		MemoryManager<CandidateVertex>::Event()->registerObject(CV);
+		CandidateVertex* CV = MemoryManager<CandidateVertex>::Event()->create(Tracks,(InteractionPoint*)0,(VertexFunction*)0);
+		CV->strategies() = _Strategies;
 		Candidates.push_back(CV);
 	}
 	//And add a CV with just the IP
 	{
 		std::vector<TrackState*> Tracks;
-		CandidateVertex* CV = new CandidateVertex(Tracks,_IP,0);
-		MemoryManager<CandidateVertex>::Event()->registerObject(CV);
+		CandidateVertex* CV = MemoryManager<CandidateVertex>::Event()->create(Tracks,_IP,(VertexFunction*)0);
+		CV->strategies() = _Strategies;
 		Candidates.push_back(CV);		
 	}
 	/*////////////////////////////////////////////////////////DEBUGLINE*/if (debug) {cout << "\tdone!" << " "<< Candidates.size() << " Candidates" << "\t" << ((double(clock())-double(start))/CLOCKS_PER_SEC)*1000 << "ms" <<endl; cout.flush();}
@@ -154,8 +157,8 @@ std::list<CandidateVertex*> VertexFinderGhost::findVertices()
 			ToMerge.push_back(*iOuterCV);
 			ToMerge.push_back(*iInnerCV);
 			
-			CandidateVertex* Merged = new CandidateVertex(ToMerge);
-			MemoryManager<CandidateVertex>::Event()->registerObject(Merged);
+			CandidateVertex* Merged = MemoryManager<CandidateVertex>::Event()->create(ToMerge);
+			Merged->strategies() = _Strategies;
 			//If we merged the ghost and ip, just keep the IP
 			if (Merged->hasTrack(GhostTrack) && Merged->interactionPoint())
 			{
@@ -235,8 +238,8 @@ std::list<CandidateVertex*> VertexFinderGhost::findVertices()
 					ToMerge.push_back(MostProbableVertex);
 					ToMerge.push_back(*iCV);
 					
-					CandidateVertex* Merged = new CandidateVertex(ToMerge);
-					MemoryManager<CandidateVertex>::Event()->registerObject(Merged);
+					CandidateVertex* Merged = MemoryManager<CandidateVertex>::Event()->create(ToMerge);
+					Merged->strategies() = _Strategies;
 					TrialMergedCandidates.push_back(Merged);
 					
 					VerticesContainedIn[Merged] = ToMerge;
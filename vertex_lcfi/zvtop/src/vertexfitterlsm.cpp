@@ -20,6 +20,7 @@
 #include "../include/interactionpoint.h"
 #include "../../util/inc/matrix.h"
 #include "../../util/inc/vector3.h"
+#include "../../util/inc/smallmatrix.h"
 
 namespace vertex_lcfi { namespace ZVTOP
 {
@@ -36,11 +37,14 @@ namespace vertex_lcfi { namespace ZVTOP
 		//TODO Throw something if we have <2 objects to fit?
 		//Find seed position, we do a load of 2 prong fits and take the average 
 		Vector3 Seed(0,0,0);
+		//Minimise the chi squared if we have more than 2 objects to fit
+		const bool Minimise = (Tracks.size()>2 || (Tracks.size()>1 && IP));
+		const bool LinearSeeded = (!_UseManualSeed && Minimise && _SeedType==LinearSeed && this->_linearSeed(Tracks,Seed));
 		if (_UseManualSeed)
 		{
 			Seed = _ManualSeed;
 		}
-		else
+		else if (!LinearSeeded)
 		{
 			if (Tracks.size()>1)
 			{
@@ -109,8 +113,8 @@ namespace vertex_lcfi { namespace ZVTOP
 		}
 		//TODO Minimisation needed qfor two object fits? Check if seed is close enough
 		//std::cout << "Seed " << Seed <<std::endl;
-		//Minimise the chi squared if we havee more than 2 objects to fit
-		if (Tracks.size()>2 || (Tracks.size()>1 && IP))
+		_LastIterations = 0;
+		if (Minimise)
 		//if (Tracks.size()>1)
 		{
 		//for (double mu=1;mu<10000;mu=mu+((10000-1)/9))
@@ -121,7 +125,15 @@ namespace vertex_lcfi { namespace ZVTOP
 				//Create a minimiser
 				//std::cout << Seed << std::endl;
 				ZVTOP::FunctionMinimiser<ZVTOP::VertexFitterLSM> minimiser( this, _InitialStep, 6 );
+				//The analytic gradient is only used from the linear seed, which is at the minimum already.
+				//From other seeds the fixed steps follow the exact gradient a long way down the narrow
+				//valley along the track directions, where the finite differences stop short, so there
+				//they are kept along with the results they give
+				minimiser.useGradient() = LinearSeeded;
 				std::vector<double> result = minimiser.Minimise(Seed.stlVector());//,1,2);
+				_LastIterations = minimiser.numIterations();
+				_TotalIterations += _LastIterations;
+				++_NumMinimisations;
 				Result.x() = result[0];
 				Result.y() = result[1];
 				Result.z() = result[2];
@@ -145,39 +157,35 @@ namespace vertex_lcfi { namespace ZVTOP
 		ChiSquaredOfFit += _chi2Contribution( Result, IP );
 		
 	}
-	void VertexFitterLSM::fitVertex(const std::vector<TrackState*> & Tracks, InteractionPoint* IP, Vector3 & Result, double & ChiSquaredOfFit, std::map<TrackState*,double> & ChiSquaredOfTrack,double & ChiSquaredOfIP)
-	{			
-		
-		this->fitVertex(Tracks,IP,Result);
+	void VertexFitterLSM::fitVertex(const std::vector<TrackState*> & Tracks, InteractionPoint* IP, VertexFitResult & Result, bool CalculateError)
+	{
+		this->fitVertex(Tracks,IP,Result.Position);
 		//fill in ChiSquaredOfTrack and of fit
-		ChiSquaredOfFit = 0;
-		ChiSquaredOfTrack.clear();
+		Result.ChiSquaredOfFit = 0;
+		Result.ChiSquaredOfTrack.clear();
 		for( std::vector<TrackState*>::const_iterator i=Tracks.begin(); i<Tracks.end(); i++ )
 		{
-			double chi = _chi2Contribution( Result, (*i) );
-			ChiSquaredOfTrack.insert( std::pair<TrackState*,double>( (*i), chi ) );
-			ChiSquaredOfFit += chi;
+			double chi = _chi2Contribution( Result.Position, (*i) );
+			Result.ChiSquaredOfTrack.push_back( chi );
+			Result.ChiSquaredOfFit += chi;
 		}
 		//fill in ChiSquaredOfIP if no IP this just gives zero
-		ChiSquaredOfIP=_chi2Contribution( Result, IP );
-		ChiSquaredOfFit += ChiSquaredOfIP;
-	}
-
-	void VertexFitterLSM::fitVertex(const std::vector<TrackState*> & Tracks, InteractionPoint* IP, Vector3 & Result, Matrix3x3 & ResultError, double & ChiSquaredOfFit, std::map<TrackState*,double> & ChiSquaredOfTrack,double & ChiSquaredOfIP)
-	{
-		this->fitVertex(Tracks,IP,Result,ChiSquaredOfFit,ChiSquaredOfTrack,ChiSquaredOfIP);
+		Result.ChiSquaredOfIP=_chi2Contribution( Result.Position, IP );
+		Result.ChiSquaredOfFit += Result.ChiSquaredOfIP;
+		if (!CalculateError)
+			return;
 		//set the total of the covariances to zero so that they can be added as we go
-		ResultError.clear();
+		Result.PositionError.clear();
 		if (Tracks.size()>1)
 		{
 			for( std::vector<TrackState*>::const_iterator i=Tracks.begin(); i<Tracks.end(); i++ )
 			{
-				ResultError += (*i)->vertexErrorContribution(Result);
+				Result.PositionError += (*i)->vertexErrorContribution(Result.Position);
 			}
-			ResultError = InvertMatrix(ResultError);
+			Result.PositionError = InvertMatrix(Result.PositionError);
 		}
 		else
-			if (IP) ResultError = IP->errorMatrix();
+			if (IP) Result.PositionError = IP->errorMatrix();
 	}
 	
 	double VertexFitterLSM::valueAt(const Vector3 & point)
@@ -203,6 +211,28 @@ namespace vertex_lcfi { namespace ZVTOP
 		return this->valueAt(Vector3(point[0],point[1],point[2]));
 	}
 
+	void VertexFitterLSM::gradientAt(const Vector3 & point, Vector3 & Gradient)
+	{
+		//Sum of the gradients of the same terms as valueAt
+		Gradient = Vector3(0,0,0);
+		for( std::vector<TrackState*>::iterator i=_trackStateList.begin(); i<_trackStateList.end(); i++ )
+		{
+			Gradient = Gradient.add(_chi2Gradient( point, (*i) ));
+		}
+		if (_trackStateList.size()<2)
+		Gradient = Gradient.add(_chi2Gradient( point, _ip ));
+	}
+
+	void VertexFitterLSM::gradientAt(const std::vector<double> & point, std::vector<double> & Gradient)
+	{
+		Vector3 Result;
+		this->gradientAt(Vector3(point[0],point[1],point[2]),Result);
+		Gradient.resize(3);
+		Gradient[0] = Result.x();
+		Gradient[1] = Result.y();
+		Gradient[2] = Result.z();
+	}
+
 	void VertexFitterLSM::setSeed(Vector3 Seed)
 	{
 		_UseManualSeed = true;
@@ -213,6 +243,43 @@ namespace vertex_lcfi { namespace ZVTOP
 	{
 		_InitialStep = Step;
 	}
+
+	void VertexFitterLSM::setSeedType(SeedType Type)
+	{
+		_SeedType = Type;
+	}
+
+	bool VertexFitterLSM::_linearSeed(const std::vector<TrackState*> & Tracks, Vector3 & Seed)
+	{
+		//Each track as the line through its position along its direction there, weighted by the
+		//inverse of its error across that direction. The chi squared of the lines is quadratic so
+		//is minimised by the solution of (Sum W).x = Sum W.p
+		for (short Pass=0;Pass<2;++Pass)
+		{
+			SmallSymMatrix<3> Information;
+			double WeightedSum[3] = {0.0,0.0,0.0};
+			for (std::vector<TrackState*>::const_iterator iTrack = Tracks.begin();iTrack != Tracks.end();++iTrack)
+			{
+				//First pass at the reference point, then at the point nearest the first solution
+				if (Pass==0)
+					(*iTrack)->resetToRef();
+				else
+					(*iTrack)->swimToStateNearest(Seed);
+				SmallSymMatrix<3> Weight((*iTrack)->localVertexErrorContribution());
+				const double Point[3] = {(*iTrack)->position().x(), (*iTrack)->position().y(), (*iTrack)->position().z()};
+				double WeightedPoint[3];
+				Weight.multiply(Point, WeightedPoint);
+				Information += Weight;
+				for (short i=0;i<3;++i)
+					WeightedSum[i] += WeightedPoint[i];
+			}
+			double Solution[3];
+			if (!Information.solve(WeightedSum, Solution))
+				return 0;
+			Seed = Vector3(Solution[0],Solution[1],Solution[2]);
+		}
+		return 1;
+	}
 	
 	double VertexFitterLSM::_chi2Contribution( const Vector3 & point, TrackState* pTrackState )
 	{
@@ -225,4 +292,24 @@ namespace vertex_lcfi { namespace ZVTOP
 		if( 0==pIP ) return 0;
 		else return pIP->chi2(point);
 	}
+
+	Vector3 VertexFitterLSM::_chi2Gradient( const Vector3 & point, TrackState* pTrackState )
+	{
+		Vector3 Gradient(0,0,0);
+		if( 0!=pTrackState ) pTrackState->chi2(point,Gradient);
+		return Gradient;
+	}
+
+	Vector3 VertexFitterLSM::_chi2Gradient( const Vector3 & point, InteractionPoint* pIP )
+	{
+		Vector3 Gradient(0,0,0);
+		if( 0==pIP ) return Gradient;
+		//chi2 is r.M.r with r = point - ip, M not necessarily symmetric
+		const Vector3 Residual = point.subtract(pIP->position());
+		const Matrix3x3 & Inverse = pIP->inverseErrorMatrix();
+		for (short i=0;i<3;++i)
+			for (short j=0;j<3;++j)
+				Gradient(i) += (Inverse(i,j)+Inverse(j,i))*Residual(j);
+		return Gradient;
+	}
 }}
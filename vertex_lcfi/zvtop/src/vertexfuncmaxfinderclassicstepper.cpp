@@ -1,6 +1,7 @@
 #include "../include/vertexfuncmaxfinderclassicstepper.h"
 #include "../../util/inc/vector3.h"
 #include "../include/vertexfunction.h"
+#include <vector>
 
 namespace vertex_lcfi { namespace ZVTOP
 {
@@ -39,8 +40,12 @@ namespace vertex_lcfi { namespace ZVTOP
 		double oldvalue;
 		Vector3 startpos = _CurrentPos;
 		Vector3 oldpos;
-		double Forward = _Function->valueAt(_CurrentPos+Step);
-		double Backward = _Function->valueAt(_CurrentPos-Step);
+		_ProbePoints.resize(2);
+		_ProbePoints[0] = _CurrentPos+Step;
+		_ProbePoints[1] = _CurrentPos-Step;
+		_Function->valuesAt(_ProbePoints, _ProbeValues);
+		double Forward = _ProbeValues[0];
+		double Backward = _ProbeValues[1];
 		
 		if (Forward != Backward)
 		{
@@ -0,0 +1,93 @@
+#include "../include/vertexfuncmaxfindernewton.h"
+#include "../include/vertexfunction.h"
+#include "../../util/inc/vector3.h"
+#include "../../util/inc/matrix.h"
+#include "../../util/inc/smallmatrix.h"
+#include <cmath>
+
+namespace vertex_lcfi { namespace ZVTOP
+{
+	const double VertexFuncMaxFinderNewton::_InitialRadius = 2.0/1000.0; //2 Micron
+	const int VertexFuncMaxFinderNewton::_MaxIterations = 100;
+
+	VertexFuncMaxFinderNewton::VertexFuncMaxFinderNewton(double MaxRadius, double Precision)
+	: _MaxRadius(MaxRadius),_Precision(Precision)
+	{
+	}
+
+	Vector3 VertexFuncMaxFinderNewton::findNearestMaximum(const Vector3 & StartPoint, VertexFunction* VertexFunction)
+	{
+		Vector3 Position = StartPoint;
+		Vector3 Gradient;
+		Matrix3x3 Hessian;
+		double Value = VertexFunction->derivativesAt(Position, Gradient, Hessian);
+		double Radius = (_InitialRadius < _MaxRadius) ? _InitialRadius : _MaxRadius;
+		for (int Iteration = 0; Iteration < _MaxIterations; ++Iteration)
+		{
+			const double g[3] = {Gradient(0), Gradient(1), Gradient(2)};
+			const double GradientMag = sqrt(g[0]*g[0] + g[1]*g[1] + g[2]*g[2]);
+			//Flat, at the maximum or somewhere the function is cut
+			if (!(GradientMag > 0.0))
+				break;
+
+			//Going uphill the curvature is minus the second derivatives, solve Curvature.Step = Gradient
+			//damping the curvature until it is positive definite and the step is within the radius
+			SmallSymMatrix<3> Curvature;
+			for (int i = 0; i < 3; ++i)
+				for (int j = 0; j <= i; ++j)
+					Curvature(i,j) = -0.5*(Hessian(i,j) + Hessian(j,i));
+			double Step[3];
+			double Length = 0.0;
+			double Damping = 0.0;
+			for (int Attempt = 0;; ++Attempt)
+			{
+				SmallSymMatrix<3> Damped = Curvature;
+				for (int i = 0; i < 3; ++i)
+					Damped(i,i) += Damping;
+				if (Damped.solve(g, Step))
+				{
+					Length = sqrt(Step[0]*Step[0] + Step[1]*Step[1] + Step[2]*Step[2]);
+					if (Length <= Radius) break;
+				}
+				if (Attempt == 64)
+				{
+					//Can't happen for finite derivatives, go along the gradient
+					for (int i = 0; i < 3; ++i)
+						Step[i] = g[i]*Radius/GradientMag;
+					Length = Radius;
+					break;
+				}
+				Damping = (Damping > 0.0) ? 2.0*Damping : GradientMag/Radius;
+			}
+
+			//Compare the increase with that of the quadratic model
+			const double Predicted = g[0]*Step[0] + g[1]*Step[1] + g[2]*Step[2] - 0.5*Curvature.quadraticForm(Step);
+			Vector3 Trial(Position.x()+Step[0], Position.y()+Step[1], Position.z()+Step[2]);
+			Vector3 TrialGradient;
+			Matrix3x3 TrialHessian;
+			const double TrialValue = VertexFunction->derivativesAt(Trial, TrialGradient, TrialHessian);
+			const double Ratio = (Predicted > 0.0) ? (TrialValue-Value)/Predicted : 0.0;
+			if (TrialValue > Value)
+			{
+				Position = Trial;
+				Value = TrialValue;
+				Gradient = TrialGradient;
+				Hessian = TrialHessian;
+				if (Length < _Precision)
+					break;
+				if (Ratio < 0.25)
+					Radius = 0.25*Length;
+				else if (Ratio > 0.75 && Damping > 0.0) //Step was held back by the radius
+					Radius = (2.0*Radius < _MaxRadius) ? 2.0*Radius : _MaxRadius;
+			}
+			else
+			{
+				Radius = 0.25*Length;
+				if (Radius < _Precision)
+					break;
+			}
+		}
+		return Position;
+	}
+
+}}
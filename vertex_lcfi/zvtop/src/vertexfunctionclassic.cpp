@@ -8,7 +8,7 @@
 
 namespace vertex_lcfi { namespace ZVTOP
 {		
-	VertexFunctionClassic::VertexFunctionClassic(std::vector<Track*> & Tracks, const double Kip, const double Kalpha, const Vector3 & JetAxis)
+	VertexFunctionClassic::VertexFunctionClassic(std::vector<Track*> & Tracks, const double Kip, const double Kalpha, const Vector3 & JetAxis, const double TubeCutSigmas)
 	{
 		_Kip=Kip;
 		_Kalpha=Kalpha;
@@ -19,13 +19,15 @@ namespace vertex_lcfi { namespace ZVTOP
 			GaussTube* element= new GaussTube(*iTrack);
 			_AllElements.push_back(element);
 			_Tubes.push_back(element);
+			_TubeArray.addTube(*iTrack, element);
 			_ElementsNewedByThis.push_back(element);
 		}
+		_TubeArray.buildIndex(TubeCutSigmas);
 		_Ellipsoid=0;
 	
 	}
 
-	VertexFunctionClassic::VertexFunctionClassic(std::vector<Track*> & Tracks, InteractionPoint* IP, const double Kip, const double Kalpha, const Vector3 & JetAxis)
+	VertexFunctionClassic::VertexFunctionClassic(std::vector<Track*> & Tracks, InteractionPoint* IP, const double Kip, const double Kalpha, const Vector3 & JetAxis, const double TubeCutSigmas)
 	{
 		_Kip=Kip;
 		_Kalpha=Kalpha;
@@ -35,8 +37,10 @@ namespace vertex_lcfi { namespace ZVTOP
 			GaussTube* element= new GaussTube(*iTrack);
 			_AllElements.push_back(element);
 			_Tubes.push_back(element);
+			_TubeArray.addTube(*iTrack, element);
 			_ElementsNewedByThis.push_back(element);
 		}
+		_TubeArray.buildIndex(TubeCutSigmas);
 		if (IP)
 		{
 			GaussEllipsoid* element= new GaussEllipsoid(IP);
@@ -62,18 +66,38 @@ namespace vertex_lcfi { namespace ZVTOP
 	{
 		double SumOfTubes = 0;
 		double SumOfSquaredTubes = 0;
+		++_NumValues;
+		_TubeArray.sumsAt(&Point, 1, &SumOfTubes, &SumOfSquaredTubes);
+		return this->_combine(Point, SumOfTubes, SumOfSquaredTubes);
+	}
+	
+	void VertexFunctionClassic::valuesAt(const std::vector<Vector3> & Points, std::vector<double> & Values) const
+	{
+		Values.resize(Points.size());
+		if (Points.empty()) return;
+		_NumValues += Points.size();
+		//The resolver and stepper batches are a few points, so they go through the stack
+		const size_t SmallBatch = 16;
+		double SmallSums[2*SmallBatch];
+		std::vector<double> LargeSums;
+		double* SumOfTubes = SmallSums;
+		if (Points.size() > SmallBatch)
+		{
+			LargeSums.resize(2*Points.size());
+			SumOfTubes = &LargeSums[0];
+		}
+		double* SumOfSquaredTubes = SumOfTubes+Points.size();
+		_TubeArray.sumsAt(&Points[0], Points.size(), SumOfTubes, SumOfSquaredTubes);
+		for (size_t i = 0; i < Points.size(); ++i)
+			Values[i] = this->_combine(Points[i], SumOfTubes[i], SumOfSquaredTubes[i]);
+	}
+	
+	double VertexFunctionClassic::_combine(const Vector3 & Point, const double SumOfTubes, const double SumOfSquaredTubes) const
+	{
 		double dlong = 0;
 		double dmag = 0;
 		//TODO make other constants parameters
 	
-		//Now add up the tubes
-		for (std::vector<GaussTube*>::const_iterator iTube = _Tubes.begin();iTube != _Tubes.end();++iTube)
-		{
-			double Tube = (*iTube)->valueAt(Point);
-			SumOfTubes += Tube;
-			SumOfSquaredTubes += (Tube*Tube);
-		}
-		
 		//And IP if we have one
 		double IPValue = 0;
 		if (_Ellipsoid)
@@ -105,20 +129,113 @@ namespace vertex_lcfi { namespace ZVTOP
 			return 0;
 	}
 	
-	Matrix3x3 VertexFunctionClassic::firstDervAt(const Vector3& /*Point*/) const
+	Vector3 VertexFunctionClassic::firstDervAt(const Vector3& Point) const
 	{
-	//	TODO Implement if needed this funcion could be one class up
-		return Matrix3x3();
+		Vector3 Gradient;
+		Matrix3x3 Hessian;
+		this->derivativesAt(Point, Gradient, Hessian);
+		return Gradient;
 	}
-
 	
-	Matrix3x3 VertexFunctionClassic::secondDervAt(const Vector3& /*Point*/) const
+	Matrix3x3 VertexFunctionClassic::secondDervAt(const Vector3& Point) const
 	{
-	//	TODO Implement if needed this funcion could be one class up
-		return Matrix3x3();
+		Vector3 Gradient;
+		Matrix3x3 Hessian;
+		this->derivativesAt(Point, Gradient, Hessian);
+		return Hessian;
 	}
-
 	
+	double VertexFunctionClassic::derivativesAt(const Vector3 & Point, Vector3 & Gradient, Matrix3x3 & Hessian) const
+	{
+		++_NumDerivatives;
+		ValueAndDerivatives Tubes;
+		ValueAndDerivatives SquaredTubes;
+		_TubeArray.derivativesAt(Point, Tubes, SquaredTubes);
+		ValueAndDerivatives Result = this->_combineDerivatives(Point, Tubes, SquaredTubes);
+		for (int i = 0; i < 3; ++i)
+			Gradient(i) = Result.Gradient[i];
+		Result.Hessian.copyTo(Hessian);
+		return Result.Value;
+	}
+	
+	ValueAndDerivatives VertexFunctionClassic::_combineDerivatives(const Vector3 & Point, const ValueAndDerivatives & Tubes, const ValueAndDerivatives & SquaredTubes) const
+	{
+		//The value exactly as valueAt, flat where that is cut (-1 behind the IP)
+		ValueAndDerivatives Result;
+		Result.Value = this->_combine(Point, Tubes.Value, SquaredTubes.Value);
+		if (Result.Value == -1.0 || !(Tubes.Value > 0))
+			return Result;
+		
+		//S1 = Kip.f0 + sum f, S2 = Kip.f0^2 + sum f^2, V = S1 - S2/S1
+		ValueAndDerivatives S1 = Tubes;
+		ValueAndDerivatives S2 = SquaredTubes;
+		if (_Ellipsoid)
+			addToSums(_Ellipsoid->derivativesAt(Point), _Kip, S1, S2);
+		const ValueAndDerivatives Unfactored = sumMinusRatio(S1, S2);
+		const double* GradV = Unfactored.Gradient;
+		const SmallSymMatrix<3> & HessV = Unfactored.Hessian;
+		
+		//Jet axis factor exp(-Kalpha.alpha^2), alpha = atan2(dtran-0.005,dlong+0.01) as in _combine
+		double dtran = 0;
+		double dlong = 0;
+		double Axis[3] = {0,0,0};
+		double Relative[3] = {0,0,0};
+		if (_Ellipsoid)
+		{
+			const Vector3 & IPPosition = _Ellipsoid->ip()->position();
+			const double AxisMag = _JetAxis.mag();
+			for (int i = 0; i < 3; ++i)
+			{
+				Axis[i] = _JetAxis(i)/AxisMag;
+				Relative[i] = Point(i) - IPPosition(i);
+			}
+			dlong = Point.subtract(IPPosition).dot(_JetAxis) / AxisMag;
+			const double dmag = _Ellipsoid->ip()->distanceTo(Point);
+			dtran = sqrt(dmag*dmag - dlong*dlong);
+		}
+		if (dtran > 0.005)
+		{
+			double Tran[3];
+			for (int i = 0; i < 3; ++i)
+				Tran[i] = (Relative[i] - dlong*Axis[i])/dtran;
+			const double a = dlong + 0.01;
+			const double b = dtran - 0.005;
+			const double r2 = a*a + b*b;
+			const double alpha = atan2(b, a);
+			const double alphaA = -b/r2;
+			const double alphaB = a/r2;
+			const double alphaAA = 2.0*a*b/(r2*r2);
+			const double alphaAB = (b*b - a*a)/(r2*r2);
+			double GradAlpha[3];
+			for (int i = 0; i < 3; ++i)
+				GradAlpha[i] = alphaA*Axis[i] + alphaB*Tran[i];
+			const double Factor = exp(-_Kalpha*alpha*alpha);
+			const double V = Unfactored.Value;
+			double GradK[3];
+			for (int i = 0; i < 3; ++i)
+				GradK[i] = -2.0*_Kalpha*alpha*Factor*GradAlpha[i];
+			for (int i = 0; i < 3; ++i)
+			{
+				for (int j = 0; j <= i; ++j)
+				{
+					//dtran has second derivatives (I - Axis.Axis^T - Tran.Tran^T)/dtran
+					const double HessTran = ((i == j ? 1.0 : 0.0) - Axis[i]*Axis[j] - Tran[i]*Tran[j])/dtran;
+					const double HessAlpha = alphaAA*(Axis[i]*Axis[j] - Tran[i]*Tran[j])
+						+ alphaAB*(Axis[i]*Tran[j] + Tran[i]*Axis[j]) + alphaB*HessTran;
+					const double HessK = Factor*(4.0*_Kalpha*_Kalpha*alpha*alpha*GradAlpha[i]*GradAlpha[j]
+						- 2.0*_Kalpha*(GradAlpha[i]*GradAlpha[j] + alpha*HessAlpha));
+					Result.Hessian(i,j) = Factor*HessV(i,j) + V*HessK + GradV[i]*GradK[j] + GradK[i]*GradV[j];
+				}
+				Result.Gradient[i] = Factor*GradV[i] + V*GradK[i];
+			}
+		}
+		else
+		{
+			for (int i = 0; i < 3; ++i)
+				Result.Gradient[i] = GradV[i];
+			Result.Hessian = HessV;
+		}
+		return Result;
+	}
 
 }}
-
@@ -67,17 +67,41 @@ namespace vertex_lcfi { namespace ZVTOP
 			return 0;
 	}
 	
-	Matrix3x3 VertexFunctionSimple::firstDervAt(const Vector3& /*Point*/) const
+	Vector3 VertexFunctionSimple::firstDervAt(const Vector3& Point) const
 	{
-	//	TODO Implement if needed this funcion could be one class up
-		return Matrix3x3();
+		Vector3 Gradient;
+		Matrix3x3 Hessian;
+		this->derivativesAt(Point, Gradient, Hessian);
+		return Gradient;
 	}
 
 	
-	Matrix3x3 VertexFunctionSimple::secondDervAt(const Vector3&/*Point*/) const
+	Matrix3x3 VertexFunctionSimple::secondDervAt(const Vector3& Point) const
 	{
-	//	TODO Implement if needed this funcion could be one class up
-		return Matrix3x3();
+		Vector3 Gradient;
+		Matrix3x3 Hessian;
+		this->derivativesAt(Point, Gradient, Hessian);
+		return Hessian;
+	}
+
+	double VertexFunctionSimple::derivativesAt(const Vector3 & Point, Vector3 & Gradient, Matrix3x3 & Hessian) const
+	{
+		//As valueAt, with the IP given unit weight
+		ValueAndDerivatives S1;
+		ValueAndDerivatives S2;
+		for (std::vector<GaussTube*>::const_iterator iTube = _Tubes.begin();iTube != _Tubes.end();++iTube)
+			addToSums((*iTube)->derivativesAt(Point), 1.0, S1, S2);
+		ValueAndDerivatives Result;
+		if (S1.Value > 0)
+		{
+			if (_Ellipsoid)
+				addToSums(_Ellipsoid->derivativesAt(Point), 1.0, S1, S2);
+			Result = sumMinusRatio(S1, S2);
+		}
+		for (int i = 0; i < 3; ++i)
+			Gradient(i) = Result.Gradient[i];
+		Result.Hessian.copyTo(Hessian);
+		return Result.Value;
 	}
 
 	
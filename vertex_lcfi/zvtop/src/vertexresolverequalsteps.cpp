@@ -1,6 +1,7 @@
 #include "../include/vertexresolverequalsteps.h"
 #include "../../util/inc/vector3.h"
 #include "../include/vertexfunction.h"
+#include <vector>
 
 namespace vertex_lcfi { namespace ZVTOP
 {
@@ -22,25 +23,39 @@ namespace vertex_lcfi { namespace ZVTOP
 		Vector3 Step = ResolveLine/NumSteps;
 		if (Step.mag()>0)
 		{
-			//Find which vertex has min VF
-			double VertexMin = VF->valueAt(Vertex1);
-			double Vertex2Value = VF->valueAt(Vertex2);
-			if (Vertex2Value < VertexMin)
-				VertexMin = Vertex2Value;
+			//Find which vertex has min VF, both ends in one batch
+			std::vector<Vector3> Points(2);
+			std::vector<double> Values;
+			Points[0] = Vertex1;
+			Points[1] = Vertex2;
+			VF->valuesAt(Points, Values);
+			double VertexMin = Values[0];
+			if (Values[1] < VertexMin)
+				VertexMin = Values[1];
 			
 			if (!(VertexMin > 0))   //Check for bad denominator
 				return 0;
 		
 			//Now starting 1 step away from Vertex1 step along evaluating VF
 			//Note Numsteps -1 as we have the ends covered
+			//A few steps are evaluated per batch, so most resolved pairs still stop
+			//well short of Vertex2
+			const short StepsPerBatch = 3;
 			Vector3 CurrentPoint = Vertex1+Step;
-		
-			for (short i=0;i<(NumSteps-1);++i)
+			for (short i=0;i<(NumSteps-1);i+=StepsPerBatch)
 			{
-				double CurrentValue = VF->valueAt(CurrentPoint);
-				if ((CurrentValue/VertexMin) < Threshold)
-					return 1;
-				CurrentPoint = CurrentPoint+Step;
+				Points.clear();
+				for (short j=i;j<(NumSteps-1) && j<i+StepsPerBatch;++j)
+				{
+					Points.push_back(CurrentPoint);
+					CurrentPoint = CurrentPoint+Step;
+				}
+				VF->valuesAt(Points, Values);
+				for (size_t j=0;j<Values.size();++j)
+				{
+					if ((Values[j]/VertexMin) < Threshold)
+						return 1;
+				}
 			}
 			
 			//None of them passed the criteria so we are unresolved
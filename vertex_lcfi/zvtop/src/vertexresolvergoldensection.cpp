@@ -0,0 +1,123 @@
+#include "../include/vertexresolvergoldensection.h"
+#include "../../util/inc/vector3.h"
+#include "../include/vertexfunction.h"
+#include <vector>
+
+namespace vertex_lcfi { namespace ZVTOP
+{
+	namespace
+	{
+		//Golden section fractions, (3-sqrt(5))/2 and (sqrt(5)-1)/2
+		const double LowFraction = 0.3819660112501051;
+		const double HighFraction = 0.6180339887498949;
+	}
+
+	bool VertexResolverGoldenSection::Key::operator<(const Key & Other) const
+	{
+		for (short i=0;i<7;++i)
+		{
+			if (Coord[i] < Other.Coord[i]) return true;
+			if (Other.Coord[i] < Coord[i]) return false;
+		}
+		return false;
+	}
+
+	VertexResolverGoldenSection::VertexResolverGoldenSection(double Precision)
+	: _Precision(Precision)
+	{
+	}
+
+	void VertexResolverGoldenSection::clearMemo()
+	{
+		_Memo.clear();
+		_MemoFunction = 0;
+	}
+
+	bool VertexResolverGoldenSection::areResolved(const Vector3& Vertex1, const Vector3& Vertex2, VertexFunction const * VF, const double Threshold) const
+	{
+		//Same cut as VertexResolverEqualSteps
+		if (Vertex1.distanceTo(Vertex2)<(10.0/1000.0)) return 0;
+
+		if (VF != _MemoFunction)
+		{
+			_Memo.clear();
+			_MemoFunction = VF;
+		}
+
+		//Order the points so that the pair is the same either way round
+		bool Swap = false;
+		for (short i=0;i<3;++i)
+		{
+			if (Vertex1(i) != Vertex2(i))
+			{
+				Swap = Vertex2(i) < Vertex1(i);
+				break;
+			}
+		}
+		const Vector3 & First = Swap ? Vertex2 : Vertex1;
+		const Vector3 & Second = Swap ? Vertex1 : Vertex2;
+		Key MyKey = {{First.x(),First.y(),First.z(),Second.x(),Second.y(),Second.z(),Threshold}};
+
+		std::map<Key,bool>::const_iterator iFound = _Memo.find(MyKey);
+		if (iFound != _Memo.end())
+		{
+			++_NumMemoHits;
+			return iFound->second;
+		}
+		++_NumSearched;
+		bool Resolved = this->_search(First, Second, VF, Threshold);
+		_Memo.insert(std::make_pair(MyKey, Resolved));
+		return Resolved;
+	}
+
+	bool VertexResolverGoldenSection::_search(const Vector3& Vertex1, const Vector3& Vertex2, VertexFunction const * VF, const double Threshold) const
+	{
+		Vector3 ResolveLine = Vertex2-Vertex1;
+
+		//Evaluate the ends and the first two golden section points in one batch
+		std::vector<Vector3> Points;
+		Points.reserve(4);
+		Points.push_back(Vertex1);
+		Points.push_back(Vertex2);
+		Points.push_back(Vector3(Vertex1+ResolveLine*LowFraction));
+		Points.push_back(Vector3(Vertex1+ResolveLine*HighFraction));
+		std::vector<double> Values;
+		VF->valuesAt(Points, Values);
+
+		double VertexMin = Values[0];
+		if (Values[1] < VertexMin)
+			VertexMin = Values[1];
+		if (!(VertexMin > 0))   //Check for bad denominator
+			return 0;
+		const double Cut = Threshold*VertexMin;
+
+		//Bracket [Low,High] with interior points at Inner < Outer
+		double Low = 0.0, High = 1.0;
+		double Inner = LowFraction, Outer = HighFraction;
+		double InnerValue = Values[2], OuterValue = Values[3];
+		while (1)
+		{
+			if (InnerValue < Cut || OuterValue < Cut)
+				return 1;
+			if ((High-Low) < _Precision)
+				return 0;
+			//Keep the side of the lower point, reusing the other interior point
+			if (InnerValue < OuterValue)
+			{
+				High = Outer;
+				Outer = Inner;
+				OuterValue = InnerValue;
+				Inner = Low + LowFraction*(High-Low);
+				InnerValue = VF->valueAt(Vector3(Vertex1+ResolveLine*Inner));
+			}
+			else
+			{
+				Low = Inner;
+				Inner = Outer;
+				InnerValue = OuterValue;
+				Outer = Low + HighFraction*(High-Low);
+				OuterValue = VF->valueAt(Vector3(Vertex1+ResolveLine*Outer));
+			}
+		}
+	}
+}}